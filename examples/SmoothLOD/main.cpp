@@ -27,8 +27,8 @@ SOFTWARE.
 #include "PolyVox/Density.h"
 #include "PolyVox/MarchingCubesSurfaceExtractor.h"
 #include "PolyVox/Mesh.h"
+#include "PolyVox/Mipmap.h"
 #include "PolyVox/RawVolume.h"
-#include "PolyVox/VolumeResampler.h"
 
 #include <QApplication>
 
@@ -90,8 +90,7 @@ protected:
 
 		RawVolume<uint8_t> volDataLowLOD(PolyVox::Region(Vector3DInt32(0, 0, 0), Vector3DInt32(15, 31, 31)));
 
-		VolumeResampler< RawVolume<uint8_t>, RawVolume<uint8_t> > volumeResampler(&volData, PolyVox::Region(Vector3DInt32(0, 0, 0), Vector3DInt32(31, 63, 63)), &volDataLowLOD, volDataLowLOD.getEnclosingRegion());
-		volumeResampler.execute();
+		downsampleVolume(&volData, PolyVox::Region(Vector3DInt32(0, 0, 0), Vector3DInt32(31, 63, 63)), &volDataLowLOD, MipmapModes::Average);
 
 		//Extract the surface
 		auto meshLowLOD = extractMarchingCubesMesh(&volDataLowLOD, volDataLowLOD.getEnclosingRegion());
@@ -27,12 +27,17 @@
 
 #include "Impl/RandomUnitVectors.h"
 #include "Impl/RandomVectors.h"
+#include "Impl/Utility.h"
 
 #include "Array.h"
 #include "Region.h"
 #include "Raycast.h"
+#include "RegionScheduler.h"
 
 #include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace PolyVox
 {
@@ -69,9 +74,73 @@ namespace PolyVox
 	// This will require C++11 rvalue references which is why I haven't made the
 	// change yet.
 
+	/// The parallel ambient occlusion calculator divides the output array into cubic tiles of this many elements along each
+	/// side. Each tile is a unit of work for a thread, and has its own sequence of random vectors so that the results do not
+	/// depend on how many threads were used.
+	const int32_t AmbientOcclusionTileSideLength = 8;
+
+	/// The parallel ambient occlusion calculator traces the rays for each output element together in packets of this size.
+	const uint32_t AmbientOcclusionRayPacketSize = 8;
+
 	/// Calculate the ambient occlusion for the volume
 	template<typename VolumeType, typename IsVoxelTransparentCallback>
 	void calculateAmbientOcclusion(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback);
+
+	/// Calculate the ambient occlusion for the volume, sharing the work between several threads
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void calculateAmbientOcclusionParallel(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, uint32_t uNoOfThreads = 0);
+	/// Calculate the ambient occlusion for the volume, sharing the work between the threads of an existing scheduler
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void calculateAmbientOcclusionParallel(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, RegionScheduler& scheduler);
+
+	/// An AmbientOcclusionField holds the result of an ambient occlusion calculation along with the parameters which produced it,
+	/// so that after the volume has been edited it can bring the result up to date by recomputing only the affected elements.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The results are computed in the same way as by calculateAmbientOcclusionParallel(). In particular, each element always
+	/// receives the same rays, which means that after any sequence of updates the result is identical to that of recomputing
+	/// the whole field from scratch.
+	///
+	/// An edit can only affect an element if one of the element's rays can reach the changed voxels. This means the elements
+	/// which need recomputing are those within \a fRayLength of the change, so the cost of an update is proportional to the
+	/// size of the edit plus the ray length rather than to the size of the whole region.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	class AmbientOcclusionField
+	{
+	public:
+		/// Creates a field covering \a region, with the given number of output elements along each axis. Nothing is computed until calculate() is called.
+		AmbientOcclusionField(VolumeType* volInput, const Region& region, uint32_t uArrayWidth, uint32_t uArrayHeight, uint32_t uArrayDepth,
+			float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, uint32_t uNoOfThreads = 0);
+
+		/// Computes the ambient occlusion for every element of the field.
+		void calculate(void);
+
+		/// Recomputes the elements which could have been affected by changes to the voxels in \a regChanged.
+		void update(const Region& regChanged);
+		/// Recomputes the elements which could have been affected by changes to the voxels in any of \a vecChangedRegions.
+		void update(const std::vector<Region>& vecChangedRegions);
+
+		/// Gets the elements of the field (in array coordinates) which could be affected by changes to the voxels in \a regChanged.
+		/// Returns false if there are none.
+		bool getAffectedElements(const Region& regChanged, Region& regAffectedElements) const;
+
+		/// Gets the computed ambient occlusion values.
+		const Array<3, uint8_t>& getResult(void) const;
+		/// Gets the region of the volume which the field covers.
+		const Region& getRegion(void) const;
+
+	private:
+		void calculateTiles(const std::vector<Region>& vecAffectedElements);
+
+		VolumeType* m_volInput;
+		Region m_regRegion;
+		float m_fRayLength;
+		uint8_t m_uNoOfSamplesPerOutputElement;
+		IsVoxelTransparentCallback m_isVoxelTransparentCallback;
+		RegionScheduler m_scheduler;
+
+		Array<3, uint8_t> m_arrayResult;
+	};
 }
 
 #include "AmbientOcclusionCalculator.inl"
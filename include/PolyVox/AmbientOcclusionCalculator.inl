@@ -24,6 +24,23 @@
 
 namespace PolyVox
 {
+	// Makes sure that the size of the region is an exact multiple of the size of the array.
+	inline void validateAmbientOcclusionArguments(Array<3, uint8_t>* arrayResult, const Region& region)
+	{
+		if (region.getWidthInVoxels() % arrayResult->getDimension(0) != 0)
+		{
+			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array width.");
+		}
+		if (region.getHeightInVoxels() % arrayResult->getDimension(1) != 0)
+		{
+			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array height.");
+		}
+		if (region.getDepthInVoxels() % arrayResult->getDimension(2) != 0)
+		{
+			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array depth.");
+		}
+	}
+
 	/**
 	 * This function fills a 3D array with ambient occlusion values computed by raycasting through the volume.
 	 * This approach to ambient occlusion is only appropriate for relatvely small volumes, otherwise it will 
@@ -45,19 +62,7 @@ namespace PolyVox
 	template<typename VolumeType, typename IsVoxelTransparentCallback>
 	void calculateAmbientOcclusion(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback)
 	{
-		//Make sure that the size of the volume is an exact multiple of the size of the array.
-		if (region.getWidthInVoxels() % arrayResult->getDimension(0) != 0)
-		{
-			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array width.");
-		}
-		if (region.getHeightInVoxels() % arrayResult->getDimension(1) != 0)
-		{
-			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array height.");
-		}
-		if (region.getDepthInVoxels() % arrayResult->getDimension(2) != 0)
-		{
-			POLYVOX_THROW(std::invalid_argument, "Volume width must be an exact multiple of array depth.");
-		}
+		validateAmbientOcclusionArguments(arrayResult, region);
 
 		uint16_t uRandomUnitVectorIndex = 0;
 		uint16_t uRandomVectorIndex = 0;
@@ -89,11 +94,11 @@ namespace PolyVox
 		const Vector3DFloat v3dOffset(0.5f, 0.5f, 0.5f);
 
 		//This loop iterates over the bottom-lower-left voxel in each of the cells in the output array
-		for (uint16_t z = region.getLowerZ(); z <= region.getUpperZ(); z += iRatioZ)
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += iRatioZ)
 		{
-			for (uint16_t y = region.getLowerY(); y <= region.getUpperY(); y += iRatioY)
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += iRatioY)
 			{
-				for (uint16_t x = region.getLowerX(); x <= region.getUpperX(); x += iRatioX)
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += iRatioX)
 				{
 					//Compute a start position corresponding to 
 					//the centre of the cell in the output array.
@@ -139,9 +144,402 @@ namespace PolyVox
 						POLYVOX_ASSERT((fVisibility >= 0.0f) && (fVisibility <= 1.0f), "Visibility value out of range.");
 					}
 
-					(*arrayResult)(z / iRatioZ, y / iRatioY, x / iRatioX) = static_cast<uint8_t>(255.0f * fVisibility);
+					(*arrayResult)((x - region.getLowerX()) / iRatioX, (y - region.getLowerY()) / iRatioY, (z - region.getLowerZ()) / iRatioZ) = static_cast<uint8_t>(255.0f * fVisibility);
+				}
+			}
+		}
+	}
+
+	// Gives each tile of the output array a different starting point in the tables of random vectors. It only depends on the
+	// position of the tile, which means a given output element always receives the same rays wherever it gets computed.
+	inline uint32_t ambientOcclusionTileSeed(int32_t iTileX, int32_t iTileY, int32_t iTileZ)
+	{
+		return (static_cast<uint32_t>(iTileX) * 73856093u) ^ (static_cast<uint32_t>(iTileY) * 19349663u) ^ (static_cast<uint32_t>(iTileZ) * 83492791u);
+	}
+
+	// Computes the ambient occlusion for the elements of the output array which lie in 'regElements' (given in array
+	// coordinates). These must all belong to the same tile. This is the unit of work for the parallel calculator.
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void calculateAmbientOcclusionForElements(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, const Region& regElements, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback)
+	{
+		const int32_t iTileX = regElements.getLowerX() / AmbientOcclusionTileSideLength;
+		const int32_t iTileY = regElements.getLowerY() / AmbientOcclusionTileSideLength;
+		const int32_t iTileZ = regElements.getLowerZ() / AmbientOcclusionTileSideLength;
+		POLYVOX_ASSERT(regElements.getUpperX() / AmbientOcclusionTileSideLength == iTileX, "Elements must all be in the same tile.");
+		POLYVOX_ASSERT(regElements.getUpperY() / AmbientOcclusionTileSideLength == iTileY, "Elements must all be in the same tile.");
+		POLYVOX_ASSERT(regElements.getUpperZ() / AmbientOcclusionTileSideLength == iTileZ, "Elements must all be in the same tile.");
+
+		const int32_t iRatioX = region.getWidthInVoxels() / arrayResult->getDimension(0);
+		const int32_t iRatioY = region.getHeightInVoxels() / arrayResult->getDimension(1);
+		const int32_t iRatioZ = region.getDepthInVoxels() / arrayResult->getDimension(2);
+		const Vector3DFloat v3dHalfRatio(iRatioX * 0.5f, iRatioY * 0.5f, iRatioZ * 0.5f);
+		const Vector3DFloat v3dOffset(0.5f, 0.5f, 0.5f);
+
+		// Voxels outside the region are treated as transparent, so rays get clipped against the faces of the region and stop as soon as they
+		// leave it. As in raycastWithEndpoints() we work in a space which is shifted by half a voxel, so that voxels occupy the unit cubes.
+		const float fMinX = static_cast<float>(region.getLowerX()), fMaxX = static_cast<float>(region.getUpperX() + 1);
+		const float fMinY = static_cast<float>(region.getLowerY()), fMaxY = static_cast<float>(region.getUpperY() + 1);
+		const float fMinZ = static_cast<float>(region.getLowerZ()), fMaxZ = static_cast<float>(region.getUpperZ() + 1);
+
+		const uint32_t uTileSeed = ambientOcclusionTileSeed(
+			region.getLowerX() + iTileX * AmbientOcclusionTileSideLength * iRatioX,
+			region.getLowerY() + iTileY * AmbientOcclusionTileSideLength * iRatioY,
+			region.getLowerZ() + iTileZ * AmbientOcclusionTileSideLength * iRatioZ);
+
+		// The state of each ray in the packet, as in raycastWithEndpoints().
+		typename VolumeType::Sampler sampler(volInput);
+		int32_t i[AmbientOcclusionRayPacketSize], j[AmbientOcclusionRayPacketSize], k[AmbientOcclusionRayPacketSize];
+		int32_t iend[AmbientOcclusionRayPacketSize], jend[AmbientOcclusionRayPacketSize], kend[AmbientOcclusionRayPacketSize];
+		int32_t di[AmbientOcclusionRayPacketSize], dj[AmbientOcclusionRayPacketSize], dk[AmbientOcclusionRayPacketSize];
+		float tx[AmbientOcclusionRayPacketSize], ty[AmbientOcclusionRayPacketSize], tz[AmbientOcclusionRayPacketSize];
+		float deltatx[AmbientOcclusionRayPacketSize], deltaty[AmbientOcclusionRayPacketSize], deltatz[AmbientOcclusionRayPacketSize];
+
+		for (int32_t iElementZ = regElements.getLowerZ(); iElementZ <= regElements.getUpperZ(); iElementZ++)
+		{
+			for (int32_t iElementY = regElements.getLowerY(); iElementY <= regElements.getUpperY(); iElementY++)
+			{
+				for (int32_t iElementX = regElements.getLowerX(); iElementX <= regElements.getUpperX(); iElementX++)
+				{
+					//Compute a start position corresponding to the centre of the cell in the output array.
+					Vector3DFloat v3dStart(
+						static_cast<float>(region.getLowerX() + iElementX * iRatioX),
+						static_cast<float>(region.getLowerY() + iElementY * iRatioY),
+						static_cast<float>(region.getLowerZ() + iElementZ * iRatioZ));
+					v3dStart -= v3dOffset;
+					v3dStart += v3dHalfRatio;
+
+					const uint32_t uIndexInTile = (iElementX - iTileX * AmbientOcclusionTileSideLength) +
+						AmbientOcclusionTileSideLength * ((iElementY - iTileY * AmbientOcclusionTileSideLength) +
+						AmbientOcclusionTileSideLength * (iElementZ - iTileZ * AmbientOcclusionTileSideLength));
+					const uint32_t uFirstSample = uTileSeed + uIndexInTile * uNoOfSamplesPerOutputElement;
+
+					//Keep track of how many rays did not hit anything
+					uint32_t uVisibleDirections = 0;
+
+					for (uint32_t uFirstRayInPacket = 0; uFirstRayInPacket < uNoOfSamplesPerOutputElement; uFirstRayInPacket += AmbientOcclusionRayPacketSize)
+					{
+						const uint32_t uNoOfRaysInPacket = (std::min)(AmbientOcclusionRayPacketSize, uNoOfSamplesPerOutputElement - uFirstRayInPacket);
+
+						for (uint32_t ray = 0; ray < uNoOfRaysInPacket; ray++)
+						{
+							const uint32_t uSample = uFirstSample + uFirstRayInPacket + ray;
+
+							//Jitter the start position within the cell, and pick a direction. The prime table sizes avoid repetition.
+							Vector3DFloat v3dJitter = randomVectors[uSample % 1019];
+							v3dJitter *= v3dHalfRatio;
+							const Vector3DFloat v3dRayStart = v3dStart + v3dJitter + v3dOffset;
+
+							Vector3DFloat v3dRayDirection = randomUnitVectors[uSample % 1021];
+							v3dRayDirection *= fRayLength;
+
+							const float x1 = v3dRayStart.getX();
+							const float y1 = v3dRayStart.getY();
+							const float z1 = v3dRayStart.getZ();
+
+							//Find where the ray leaves the region, and end it there if that is before its full length.
+							float tExit = 1.0f;
+							if (v3dRayDirection.getX() > 0.0f) tExit = (std::min)(tExit, (fMaxX - x1) / v3dRayDirection.getX());
+							if (v3dRayDirection.getX() < 0.0f) tExit = (std::min)(tExit, (fMinX - x1) / v3dRayDirection.getX());
+							if (v3dRayDirection.getY() > 0.0f) tExit = (std::min)(tExit, (fMaxY - y1) / v3dRayDirection.getY());
+							if (v3dRayDirection.getY() < 0.0f) tExit = (std::min)(tExit, (fMinY - y1) / v3dRayDirection.getY());
+							if (v3dRayDirection.getZ() > 0.0f) tExit = (std::min)(tExit, (fMaxZ - z1) / v3dRayDirection.getZ());
+							if (v3dRayDirection.getZ() < 0.0f) tExit = (std::min)(tExit, (fMinZ - z1) / v3dRayDirection.getZ());
+							tExit = (std::max)(tExit, 0.0f);
+
+							const float x2 = x1 + v3dRayDirection.getX() * tExit;
+							const float y2 = y1 + v3dRayDirection.getY() * tExit;
+							const float z2 = z1 + v3dRayDirection.getZ() * tExit;
+
+							//Points exactly on the upper faces would round to outside the region, so clamp them back in.
+							i[ray] = clamp(static_cast<int32_t>(floorf(x1)), region.getLowerX(), region.getUpperX());
+							j[ray] = clamp(static_cast<int32_t>(floorf(y1)), region.getLowerY(), region.getUpperY());
+							k[ray] = clamp(static_cast<int32_t>(floorf(z1)), region.getLowerZ(), region.getUpperZ());
+							iend[ray] = clamp(static_cast<int32_t>(floorf(x2)), region.getLowerX(), region.getUpperX());
+							jend[ray] = clamp(static_cast<int32_t>(floorf(y2)), region.getLowerY(), region.getUpperY());
+							kend[ray] = clamp(static_cast<int32_t>(floorf(z2)), region.getLowerZ(), region.getUpperZ());
+
+							di[ray] = ((x1 < x2) ? 1 : ((x1 > x2) ? -1 : 0));
+							dj[ray] = ((y1 < y2) ? 1 : ((y1 > y2) ? -1 : 0));
+							dk[ray] = ((z1 < z2) ? 1 : ((z1 > z2) ? -1 : 0));
+
+							deltatx[ray] = 1.0f / std::abs(x2 - x1);
+							deltaty[ray] = 1.0f / std::abs(y2 - y1);
+							deltatz[ray] = 1.0f / std::abs(z2 - z1);
+
+							const float minx = floorf(x1), maxx = minx + 1.0f;
+							tx[ray] = ((x1 > x2) ? (x1 - minx) : (maxx - x1)) * deltatx[ray];
+							const float miny = floorf(y1), maxy = miny + 1.0f;
+							ty[ray] = ((y1 > y2) ? (y1 - miny) : (maxy - y1)) * deltaty[ray];
+							const float minz = floorf(z1), maxz = minz + 1.0f;
+							tz[ray] = ((z1 > z2) ? (z1 - minz) : (maxz - z1)) * deltatz[ray];
+						}
+
+						//Now trace each ray of the packet in turn. Keeping the state of the ray being traced in locals (rather
+						//than interleaving the rays) lets the compiler keep it in registers, which measured noticeably faster.
+						for (uint32_t ray = 0; ray < uNoOfRaysInPacket; ray++)
+						{
+							int32_t iCurrentX = i[ray], iCurrentY = j[ray], iCurrentZ = k[ray];
+							const int32_t iEndX = iend[ray], iEndY = jend[ray], iEndZ = kend[ray];
+							const int32_t iStepX = di[ray], iStepY = dj[ray], iStepZ = dk[ray];
+							float fTX = tx[ray], fTY = ty[ray], fTZ = tz[ray];
+							const float fDeltaTX = deltatx[ray], fDeltaTY = deltaty[ray], fDeltaTZ = deltatz[ray];
+							sampler.setPosition(iCurrentX, iCurrentY, iCurrentZ);
+
+							for (;;)
+							{
+								if (!isVoxelTransparentCallback(sampler.getVoxel()))
+								{
+									break;
+								}
+
+								if (fTX <= fTY && fTX <= fTZ)
+								{
+									if (iCurrentX == iEndX)
+									{
+										++uVisibleDirections;
+										break;
+									}
+									fTX += fDeltaTX;
+									iCurrentX += iStepX;
+									if (iStepX == 1) sampler.movePositiveX(); else sampler.moveNegativeX();
+								}
+								else if (fTY <= fTZ)
+								{
+									if (iCurrentY == iEndY)
+									{
+										++uVisibleDirections;
+										break;
+									}
+									fTY += fDeltaTY;
+									iCurrentY += iStepY;
+									if (iStepY == 1) sampler.movePositiveY(); else sampler.moveNegativeY();
+								}
+								else
+								{
+									if (iCurrentZ == iEndZ)
+									{
+										++uVisibleDirections;
+										break;
+									}
+									fTZ += fDeltaTZ;
+									iCurrentZ += iStepZ;
+									if (iStepZ == 1) sampler.movePositiveZ(); else sampler.moveNegativeZ();
+								}
+							}
+						}
+					}
+
+					//Zero samples gives a fully visible result (see calculateAmbientOcclusion()).
+					float fVisibility = 1.0f;
+					if (uNoOfSamplesPerOutputElement > 0)
+					{
+						fVisibility = static_cast<float>(uVisibleDirections) / static_cast<float>(uNoOfSamplesPerOutputElement);
+						POLYVOX_ASSERT((fVisibility >= 0.0f) && (fVisibility <= 1.0f), "Visibility value out of range.");
+					}
+
+					(*arrayResult)(iElementX, iElementY, iElementZ) = static_cast<uint8_t>(255.0f * fVisibility);
+				}
+			}
+		}
+	}
+
+	/**
+	 * This function computes the same kind of ambient occlusion as calculateAmbientOcclusion(), but is designed to run much faster:
+	 *
+	 * - The output array is split into tiles (see AmbientOcclusionTileSideLength) which are shared between \a uNoOfThreads threads.
+	 *   Each tile draws its rays from its own deterministic sequence, so the result is the same however many threads are used.
+	 * - Voxels outside of \a region are treated as transparent. Rays are therefore clipped to the region before they are traced
+	 *   and can stop as soon as they leave it, rather than marching their full length. If occluders outside the region should
+	 *   contribute then pass a larger region.
+	 * - The rays for each output element are traced together in packets (see AmbientOcclusionRayPacketSize).
+	 *
+	 * Because the rays are drawn differently the results are not identical to those of calculateAmbientOcclusion(), but they
+	 * are statistically equivalent. Element (x, y, z) of the array corresponds to the cell at the same position relative to
+	 * the lower corner of \a region.
+	 *
+	 * Threads only read from the volume, but they do so through their own samplers at the same time. This requires the volume
+	 * to report \a SupportsConcurrentReads (as RawVolume does) and a single thread is used for volumes which do not. Code which
+	 * calculates ambient occlusion repeatedly can create a RegionScheduler once and pass it to the other overload instead.
+	 *
+	 * \param volInput The volume to calculate the ambient occlusion for
+	 * \param[out] arrayResult The output of the calculator
+	 * \param region The region of the volume for which the occlusion should be calculated
+	 * \param fRayLength The length for each test ray
+	 * \param uNoOfSamplesPerOutputElement The number of samples to calculate the occlusion
+	 * \param isVoxelTransparentCallback A callback which takes a \a VoxelType and returns a \a bool whether the voxel is transparent. It will be called from several threads.
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void calculateAmbientOcclusionParallel(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(VolumeType::SupportsConcurrentReads ? uNoOfThreads : 1, AmbientOcclusionTileSideLength);
+		calculateAmbientOcclusionParallel(volInput, arrayResult, region, fRayLength, uNoOfSamplesPerOutputElement, isVoxelTransparentCallback, scheduler);
+	}
+
+	/**
+	 * As above, but the tiles are shared between the threads of \a scheduler. They are always AmbientOcclusionTileSideLength
+	 * elements across whatever tile size the scheduler was created with, so the result doesn't depend on it. Volumes which do
+	 * not report \a SupportsConcurrentReads are locked while each tile is calculated, so only one thread does useful work.
+	 *
+	 * \param volInput The volume to calculate the ambient occlusion for
+	 * \param[out] arrayResult The output of the calculator
+	 * \param region The region of the volume for which the occlusion should be calculated
+	 * \param fRayLength The length for each test ray
+	 * \param uNoOfSamplesPerOutputElement The number of samples to calculate the occlusion
+	 * \param isVoxelTransparentCallback A callback which takes a \a VoxelType and returns a \a bool whether the voxel is transparent. It will be called from several threads.
+	 * \param scheduler The scheduler whose threads the tiles are shared between
+	 */
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void calculateAmbientOcclusionParallel(VolumeType* volInput, Array<3, uint8_t>* arrayResult, const Region& region, float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, RegionScheduler& scheduler)
+	{
+		validateAmbientOcclusionArguments(arrayResult, region);
+
+		// The tiles are measured in output elements, from the lower corner of the array.
+		const Region regArray(0, 0, 0, static_cast<int32_t>(arrayResult->getDimension(0)) - 1, static_cast<int32_t>(arrayResult->getDimension(1)) - 1,
+			static_cast<int32_t>(arrayResult->getDimension(2)) - 1);
+
+		VolumeLocks<VolumeType> locks(scheduler, volInput, volInput);
+		scheduler.forEachTile(regArray, AmbientOcclusionTileSideLength, [&](const Region& regElements, uint32_t /*uTile*/, uint32_t /*uWorker*/)
+		{
+			std::unique_lock<std::mutex> lock;
+			if (locks.getSrcMutex())
+			{
+				lock = std::unique_lock<std::mutex>(*locks.getSrcMutex());
+			}
+
+			calculateAmbientOcclusionForElements(volInput, arrayResult, region, regElements, fRayLength, uNoOfSamplesPerOutputElement, isVoxelTransparentCallback);
+		});
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::AmbientOcclusionField(VolumeType* volInput, const Region& region, uint32_t uArrayWidth, uint32_t uArrayHeight, uint32_t uArrayDepth,
+		float fRayLength, uint8_t uNoOfSamplesPerOutputElement, IsVoxelTransparentCallback isVoxelTransparentCallback, uint32_t uNoOfThreads)
+		:m_volInput(volInput)
+		, m_regRegion(region)
+		, m_fRayLength(fRayLength)
+		, m_uNoOfSamplesPerOutputElement(uNoOfSamplesPerOutputElement)
+		, m_isVoxelTransparentCallback(isVoxelTransparentCallback)
+		, m_scheduler(VolumeType::SupportsConcurrentReads ? uNoOfThreads : 1, AmbientOcclusionTileSideLength)
+		, m_arrayResult(uArrayWidth, uArrayHeight, uArrayDepth)
+	{
+		validateAmbientOcclusionArguments(&m_arrayResult, m_regRegion);
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::calculate(void)
+	{
+		calculateAmbientOcclusionParallel(m_volInput, &m_arrayResult, m_regRegion, m_fRayLength, m_uNoOfSamplesPerOutputElement, m_isVoxelTransparentCallback, m_scheduler);
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::update(const Region& regChanged)
+	{
+		update(std::vector<Region>(1, regChanged));
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::update(const std::vector<Region>& vecChangedRegions)
+	{
+		std::vector<Region> vecAffectedElements;
+		for (auto regChanged : vecChangedRegions)
+		{
+			Region regAffectedElements;
+			if (getAffectedElements(regChanged, regAffectedElements))
+			{
+				vecAffectedElements.push_back(regAffectedElements);
+			}
+		}
+
+		calculateTiles(vecAffectedElements);
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	bool AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::getAffectedElements(const Region& regChanged, Region& regAffectedElements) const
+	{
+		// A ray can visit voxels up to its length away from the voxel it starts in, plus one more for the
+		// voxels it clips the corners of. Voxels outside the field's region never affect it (see
+		// calculateAmbientOcclusionParallel()), so the grown change can be cropped to the region.
+		Region regInfluence = regChanged;
+		regInfluence.grow(static_cast<int32_t>(std::ceil(m_fRayLength)) + 1);
+		if (!intersects(regInfluence, m_regRegion))
+		{
+			return false;
+		}
+		regInfluence.cropTo(m_regRegion);
+
+		// Now find the elements whose cells overlap it.
+		const int32_t iRatioX = m_regRegion.getWidthInVoxels() / m_arrayResult.getDimension(0);
+		const int32_t iRatioY = m_regRegion.getHeightInVoxels() / m_arrayResult.getDimension(1);
+		const int32_t iRatioZ = m_regRegion.getDepthInVoxels() / m_arrayResult.getDimension(2);
+
+		regAffectedElements = Region(
+			(regInfluence.getLowerX() - m_regRegion.getLowerX()) / iRatioX,
+			(regInfluence.getLowerY() - m_regRegion.getLowerY()) / iRatioY,
+			(regInfluence.getLowerZ() - m_regRegion.getLowerZ()) / iRatioZ,
+			(regInfluence.getUpperX() - m_regRegion.getLowerX()) / iRatioX,
+			(regInfluence.getUpperY() - m_regRegion.getLowerY()) / iRatioY,
+			(regInfluence.getUpperZ() - m_regRegion.getLowerZ()) / iRatioZ);
+		return true;
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	const Array<3, uint8_t>& AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::getResult(void) const
+	{
+		return m_arrayResult;
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	const Region& AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::getRegion(void) const
+	{
+		return m_regRegion;
+	}
+
+	template<typename VolumeType, typename IsVoxelTransparentCallback>
+	void AmbientOcclusionField<VolumeType, IsVoxelTransparentCallback>::calculateTiles(const std::vector<Region>& vecAffectedElements)
+	{
+		// Work is still divided into the same tiles as for a full calculation. Where several changes touch a
+		// tile we recompute the bounds of what they touch, which keeps each tile to a single unit of work.
+		std::map<uint32_t, Region> mapTiles;
+		const int32_t iTilesX = (static_cast<int32_t>(m_arrayResult.getDimension(0)) + AmbientOcclusionTileSideLength - 1) / AmbientOcclusionTileSideLength;
+		const int32_t iTilesY = (static_cast<int32_t>(m_arrayResult.getDimension(1)) + AmbientOcclusionTileSideLength - 1) / AmbientOcclusionTileSideLength;
+
+		for (auto regElements : vecAffectedElements)
+		{
+			for (int32_t iTileZ = regElements.getLowerZ() / AmbientOcclusionTileSideLength; iTileZ <= regElements.getUpperZ() / AmbientOcclusionTileSideLength; iTileZ++)
+			{
+				for (int32_t iTileY = regElements.getLowerY() / AmbientOcclusionTileSideLength; iTileY <= regElements.getUpperY() / AmbientOcclusionTileSideLength; iTileY++)
+				{
+					for (int32_t iTileX = regElements.getLowerX() / AmbientOcclusionTileSideLength; iTileX <= regElements.getUpperX() / AmbientOcclusionTileSideLength; iTileX++)
+					{
+						Region regTile(iTileX * AmbientOcclusionTileSideLength, iTileY * AmbientOcclusionTileSideLength, iTileZ * AmbientOcclusionTileSideLength,
+							(iTileX + 1) * AmbientOcclusionTileSideLength - 1, (iTileY + 1) * AmbientOcclusionTileSideLength - 1, (iTileZ + 1) * AmbientOcclusionTileSideLength - 1);
+						regTile.cropTo(regElements);
+
+						const uint32_t uTile = static_cast<uint32_t>(iTileX + iTilesX * (iTileY + iTilesY * iTileZ));
+						auto iter = mapTiles.find(uTile);
+						if (iter == mapTiles.end())
+						{
+							mapTiles.insert(std::make_pair(uTile, regTile));
+						}
+						else
+						{
+							iter->second.accumulate(regTile);
+						}
+					}
 				}
 			}
 		}
+
+		std::vector<Region> vecTiles;
+		vecTiles.reserve(mapTiles.size());
+		for (auto& tile : mapTiles)
+		{
+			vecTiles.push_back(tile.second);
+		}
+
+		m_scheduler.forEachTask(static_cast<uint32_t>(vecTiles.size()), [&](uint32_t uTile, uint32_t /*uWorker*/)
+		{
+			calculateAmbientOcclusionForElements(m_volInput, &m_arrayResult, m_regRegion, vecTiles[uTile], m_fRayLength, m_uNoOfSamplesPerOutputElement, m_isVoxelTransparentCallback);
+		});
 	}
 }
@@ -43,6 +43,14 @@ namespace PolyVox
 	public:
 		typedef _VoxelType VoxelType;
 
+		/// Whether several threads may read from the volume at the same time (each through its own Sampler). Volumes
+		/// which support this redefine it as true, and algorithms which can run in parallel fall back to a single thread
+		/// for volumes which do not.
+		static const bool SupportsConcurrentReads = false;
+		/// Whether several threads may write to the volume at the same time, provided that no two of them write to the same voxel
+		/// and no thread reads a voxel which another is writing. As above, volumes which support this redefine it as true.
+		static const bool SupportsConcurrentWrites = false;
+
 #ifndef SWIG
 		template <typename DerivedVolumeType>
 		class Sampler
@@ -134,6 +142,22 @@ namespace PolyVox
 		/// Assignment operator
 		BaseVolume& operator=(const BaseVolume& rhs);
 	};
+
+#ifndef SWIG
+	/// Gives the sampler which an algorithm can use on a volume once it knows that every voxel it will access lies inside the region
+	/// \a regAccessed. By default this is just the volume's normal Sampler, but volumes which have a faster sampler without bounds
+	/// checks (such as RawVolume) specialise this. Algorithms should only use \a type when isUsable() returns true.
+	template <typename VolumeType>
+	struct UncheckedSamplerType
+	{
+		typedef typename VolumeType::Sampler type;
+
+		static bool isUsable(const VolumeType* /*volume*/, const Region& /*regAccessed*/)
+		{
+			return false;
+		}
+	};
+#endif // SWIG
 }
 
 #include "BaseVolume.inl"
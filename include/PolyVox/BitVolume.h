@@ -0,0 +1,201 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_BitVolume_H__
+#define __PolyVox_BitVolume_H__
+
+#include "BaseVolume.h"
+#include "Region.h"
+#include "Vector.h"
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept> //For invalid_argument, out_of_range
+
+namespace PolyVox
+{
+	namespace BitOperations
+	{
+		/**
+		 * The ways in which BitVolume::combine() can merge the voxels of another volume into a BitVolume.
+		 */
+		enum BitOperation
+		{
+			And, ///< A voxel stays set only if it is also set in the other volume
+			Or, ///< A voxel becomes set if it is set in the other volume
+			Xor ///< A voxel is flipped if it is set in the other volume
+		};
+	}
+	typedef BitOperations::BitOperation BitOperation;
+
+	/// The BitVolume is a fixed size volume which stores each voxel in a single bit, and so is intended for occupancy data
+	/// (for example solid/empty information for collision detection or pathfinding). It uses an eighth of the memory of a
+	/// RawVolume<uint8_t> of the same size.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	///
+	/// As well as the usual voxel access and Sampler, which let it be used with the existing algorithms, the BitVolume provides
+	/// operations which work on 64 voxels at a time. Each row of voxels along the x axis is stored as a sequence of 64 bit words,
+	/// so getRow() can read 64 neighbouring voxels at once, and fill(), combine(), countSetVoxels() and findFirstSetVoxel() work
+	/// a word at a time rather than a voxel at a time.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	class BitVolume : public BaseVolume<bool>
+	{
+	public:
+#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<bool>::Sampler< BitVolume > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<bool>::template Sampler< BitVolume > //This line works on GCC
+#endif
+		{
+		public:
+			Sampler(BitVolume* volume);
+			~Sampler();
+
+			inline bool getVoxel(void) const;
+
+			inline bool setVoxel(bool tValue);
+
+			inline bool peekVoxel1nx1ny1nz(void) const;
+			inline bool peekVoxel1nx1ny0pz(void) const;
+			inline bool peekVoxel1nx1ny1pz(void) const;
+			inline bool peekVoxel1nx0py1nz(void) const;
+			inline bool peekVoxel1nx0py0pz(void) const;
+			inline bool peekVoxel1nx0py1pz(void) const;
+			inline bool peekVoxel1nx1py1nz(void) const;
+			inline bool peekVoxel1nx1py0pz(void) const;
+			inline bool peekVoxel1nx1py1pz(void) const;
+
+			inline bool peekVoxel0px1ny1nz(void) const;
+			inline bool peekVoxel0px1ny0pz(void) const;
+			inline bool peekVoxel0px1ny1pz(void) const;
+			inline bool peekVoxel0px0py1nz(void) const;
+			inline bool peekVoxel0px0py0pz(void) const;
+			inline bool peekVoxel0px0py1pz(void) const;
+			inline bool peekVoxel0px1py1nz(void) const;
+			inline bool peekVoxel0px1py0pz(void) const;
+			inline bool peekVoxel0px1py1pz(void) const;
+
+			inline bool peekVoxel1px1ny1nz(void) const;
+			inline bool peekVoxel1px1ny0pz(void) const;
+			inline bool peekVoxel1px1ny1pz(void) const;
+			inline bool peekVoxel1px0py1nz(void) const;
+			inline bool peekVoxel1px0py0pz(void) const;
+			inline bool peekVoxel1px0py1pz(void) const;
+			inline bool peekVoxel1px1py1nz(void) const;
+			inline bool peekVoxel1px1py0pz(void) const;
+			inline bool peekVoxel1px1py1pz(void) const;
+
+		private:
+			// Reads a voxel near the current one, without going through the Region of the volume.
+			inline bool peekVoxel(int32_t iXOffset, int32_t iYOffset, int32_t iZOffset) const;
+		};
+#endif // SWIG
+
+	public:
+		/// Reading from a BitVolume does not modify it, so it is safe to do from several threads at once.
+		static const bool SupportsConcurrentReads = true;
+
+		/// Constructor for creating a fixed size volume, in which every voxel is initially clear.
+		BitVolume(const Region& regValid);
+
+		/// Destructor
+		~BitVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		bool getBorderValue(void) const;
+		/// Gets a Region representing the extents of the Volume.
+		const Region& getEnclosingRegion(void) const;
+
+		/// Gets the width of the volume in voxels.
+		int32_t getWidth(void) const;
+		/// Gets the height of the volume in voxels.
+		int32_t getHeight(void) const;
+		/// Gets the depth of the volume in voxels.
+		int32_t getDepth(void) const;
+
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		bool getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		bool getVoxel(const Vector3DInt32& v3dPos) const;
+		/// Gets the 64 voxels starting at the given position and running along the x axis
+		uint64_t getRow(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(bool tBorder);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		void setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, bool tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		void setVoxel(const Vector3DInt32& v3dPos, bool tValue);
+		/// Sets up to 64 voxels starting at the given position and running along the x axis
+		void setRow(int32_t uXPos, int32_t uYPos, int32_t uZPos, uint64_t uBits, uint32_t uNoOfVoxels = 64);
+
+		/// Sets every voxel in a region to the same value
+		void fill(const Region& region, bool tValue);
+		/// Merges the voxels of another volume into the same region of this one
+		void combine(const BitVolume& other, const Region& region, BitOperation eOperation);
+		/// Counts the voxels in a region which are set
+		uint64_t countSetVoxels(const Region& region) const;
+		/// Finds the nearest voxel which is set along an axis
+		bool findFirstSetVoxel(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dDirection, Vector3DInt32& v3dResult) const;
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		BitVolume(const BitVolume& rhs);
+
+		/// Assignment operator
+		BitVolume& operator=(const BitVolume& rhs);
+
+	private:
+		// The first word of the row of voxels at the given position relative to the lower corner of the volume.
+		const uint64_t* getRowData(int32_t iLocalYPos, int32_t iLocalZPos) const;
+		uint64_t* getRowData(int32_t iLocalYPos, int32_t iLocalZPos);
+
+		// Reads the 64 bits of a row starting at iLocalXPos (which must be inside the row). Bits past the end of the row are zero.
+		uint64_t readBits(const uint64_t* pRow, int32_t iLocalXPos) const;
+		// Writes the bits of uBits which are set in uMask to the 64 bits of a row starting at iLocalXPos.
+		void writeBits(uint64_t* pRow, int32_t iLocalXPos, uint64_t uBits, uint64_t uMask);
+
+		// The mask of the first uNoOfBits bits of a word.
+		static uint64_t getLowBitsMask(uint32_t uNoOfBits);
+
+		// The extent of the volume
+		Region m_regValidRegion;
+
+		// The words making up each row, and the data itself. The padding bits after the end of each row are always clear.
+		uint32_t m_uWordsPerRow;
+		std::unique_ptr<uint64_t[]> m_pData;
+
+		// The border value
+		bool m_tBorderValue;
+	};
+}
+
+#include "BitVolume.inl"
+#include "BitVolumeSampler.inl"
+
+#endif //__PolyVox_BitVolume_H__
@@ -0,0 +1,444 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "Impl/Utility.h"
+
+#include <algorithm>
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a volume with a fixed size which is specified as a parameter.
+	/// \param regValid Specifies the minimum and maximum valid voxel positions.
+	////////////////////////////////////////////////////////////////////////////////
+	inline BitVolume::BitVolume(const Region& regValid)
+		:BaseVolume<bool>()
+		, m_regValidRegion(regValid)
+		, m_uWordsPerRow(0)
+		, m_tBorderValue(false)
+	{
+		POLYVOX_THROW_IF(getWidth() <= 0, std::invalid_argument, "Volume width must be greater than zero.");
+		POLYVOX_THROW_IF(getHeight() <= 0, std::invalid_argument, "Volume height must be greater than zero.");
+		POLYVOX_THROW_IF(getDepth() <= 0, std::invalid_argument, "Volume depth must be greater than zero.");
+
+		m_uWordsPerRow = (static_cast<uint32_t>(getWidth()) + 63) / 64;
+		const uint32_t uNoOfWords = m_uWordsPerRow * getHeight() * getDepth();
+		m_pData.reset(new uint64_t[uNoOfWords]);
+		std::fill(m_pData.get(), m_pData.get() + uNoOfWords, uint64_t(0));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	inline BitVolume::BitVolume(const BitVolume& /*rhs*/)
+		:BaseVolume<bool>()
+	{
+		POLYVOX_THROW(not_implemented, "Volume copy constructor not implemented for performance reasons.");
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume
+	////////////////////////////////////////////////////////////////////////////////
+	inline BitVolume::~BitVolume()
+	{
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	inline BitVolume& BitVolume::operator=(const BitVolume& /*rhs*/)
+	{
+		POLYVOX_THROW(not_implemented, "Volume assignment operator not implemented for performance reasons.");
+		return *this;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	inline bool BitVolume::getBorderValue(void) const
+	{
+		return m_tBorderValue;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return A Region representing the extent of the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	inline const Region& BitVolume::getEnclosingRegion(void) const
+	{
+		return m_regValidRegion;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The width of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the width is 64.
+	/// \sa getHeight(), getDepth()
+	////////////////////////////////////////////////////////////////////////////////
+	inline int32_t BitVolume::getWidth(void) const
+	{
+		return m_regValidRegion.getUpperX() - m_regValidRegion.getLowerX() + 1;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The height of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the height is 64.
+	/// \sa getWidth(), getDepth()
+	////////////////////////////////////////////////////////////////////////////////
+	inline int32_t BitVolume::getHeight(void) const
+	{
+		return m_regValidRegion.getUpperY() - m_regValidRegion.getLowerY() + 1;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The depth of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the depth is 64.
+	/// \sa getWidth(), getHeight()
+	////////////////////////////////////////////////////////////////////////////////
+	inline int32_t BitVolume::getDepth(void) const
+	{
+		return m_regValidRegion.getUpperZ() - m_regValidRegion.getLowerZ() + 1;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	inline bool BitVolume::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if (m_regValidRegion.containsPoint(uXPos, uYPos, uZPos))
+		{
+			const int32_t iLocalXPos = uXPos - m_regValidRegion.getLowerX();
+			const uint64_t* pRow = getRowData(uYPos - m_regValidRegion.getLowerY(), uZPos - m_regValidRegion.getLowerZ());
+			return ((pRow[iLocalXPos >> 6] >> (iLocalXPos & 63)) & 1) != 0;
+		}
+		else
+		{
+			return m_tBorderValue;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	inline bool BitVolume::getVoxel(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Bit \c i of the result is the voxel at <tt>(uXPos + i, uYPos, uZPos)</tt>, so for example the voxels which have a set
+	/// neighbour in the positive x direction are given by <tt>getRow(x + 1, y, z)</tt>. Voxels outside the volume have the border value.
+	/// \param uXPos The \c x position of the first voxel
+	/// \param uYPos The \c y position of the voxels
+	/// \param uZPos The \c z position of the voxels
+	/// \return The voxel values, one per bit
+	////////////////////////////////////////////////////////////////////////////////
+	inline uint64_t BitVolume::getRow(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		const uint64_t uBorderBits = m_tBorderValue ? ~uint64_t(0) : uint64_t(0);
+
+		const int32_t iLocalXPos = uXPos - m_regValidRegion.getLowerX();
+		if ((uYPos < m_regValidRegion.getLowerY()) || (uYPos > m_regValidRegion.getUpperY()) ||
+			(uZPos < m_regValidRegion.getLowerZ()) || (uZPos > m_regValidRegion.getUpperZ()) ||
+			(iLocalXPos >= getWidth()) || (iLocalXPos <= -64))
+		{
+			return uBorderBits;
+		}
+
+		const uint64_t* pRow = getRowData(uYPos - m_regValidRegion.getLowerY(), uZPos - m_regValidRegion.getLowerZ());
+
+		// Work out which bits of the result lie inside the volume, and read them.
+		const uint32_t uFirstInside = static_cast<uint32_t>((std::max)(0, -iLocalXPos));
+		const uint32_t uEndInside = static_cast<uint32_t>((std::min)(64, getWidth() - iLocalXPos));
+		const uint64_t uInsideMask = getLowBitsMask(uEndInside) & ~getLowBitsMask(uFirstInside);
+		const uint64_t uBits = (iLocalXPos >= 0) ? readBits(pRow, iLocalXPos) : (readBits(pRow, 0) << uFirstInside);
+
+		return (uBits & uInsideMask) | (uBorderBits & ~uInsideMask);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::setBorderValue(bool tBorder)
+	{
+		m_tBorderValue = tBorder;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, bool tValue)
+	{
+		if (m_regValidRegion.containsPoint(uXPos, uYPos, uZPos) == false)
+		{
+			POLYVOX_THROW(std::out_of_range, "Position is outside valid region");
+		}
+
+		const int32_t iLocalXPos = uXPos - m_regValidRegion.getLowerX();
+		uint64_t* pWord = getRowData(uYPos - m_regValidRegion.getLowerY(), uZPos - m_regValidRegion.getLowerZ()) + (iLocalXPos >> 6);
+		const uint64_t uBit = uint64_t(1) << (iLocalXPos & 63);
+		*pWord = tValue ? (*pWord | uBit) : (*pWord & ~uBit);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::setVoxel(const Vector3DInt32& v3dPos, bool tValue)
+	{
+		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This is the counterpart of getRow(), so voxel <tt>(uXPos + i, uYPos, uZPos)</tt> is set to bit \c i of \a uBits.
+	/// \param uXPos The \c x position of the first voxel
+	/// \param uYPos The \c y position of the voxels
+	/// \param uZPos The \c z position of the voxels
+	/// \param uBits The voxel values, one per bit
+	/// \param uNoOfVoxels The number of voxels to set, all of which must lie inside the volume
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::setRow(int32_t uXPos, int32_t uYPos, int32_t uZPos, uint64_t uBits, uint32_t uNoOfVoxels)
+	{
+		POLYVOX_THROW_IF((uNoOfVoxels == 0) || (uNoOfVoxels > 64), std::invalid_argument, "A row must contain between 1 and 64 voxels");
+		POLYVOX_THROW_IF(!m_regValidRegion.containsPoint(uXPos, uYPos, uZPos) || !m_regValidRegion.containsPoint(uXPos + static_cast<int32_t>(uNoOfVoxels) - 1, uYPos, uZPos),
+			std::out_of_range, "Row is outside the volume");
+
+		uint64_t* pRow = getRowData(uYPos - m_regValidRegion.getLowerY(), uZPos - m_regValidRegion.getLowerZ());
+		writeBits(pRow, uXPos - m_regValidRegion.getLowerX(), uBits, getLowBitsMask(uNoOfVoxels));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param region The voxels to set, which must lie inside the volume.
+	/// \param tValue The value to which the voxels will be set
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::fill(const Region& region, bool tValue)
+	{
+		POLYVOX_THROW_IF(!m_regValidRegion.containsRegion(region), std::out_of_range, "Region is outside the volume");
+
+		const uint64_t uBits = tValue ? ~uint64_t(0) : uint64_t(0);
+		const int32_t iLocalLowerX = region.getLowerX() - m_regValidRegion.getLowerX();
+		const int32_t iLocalUpperX = region.getUpperX() - m_regValidRegion.getLowerX();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				uint64_t* pRow = getRowData(y - m_regValidRegion.getLowerY(), z - m_regValidRegion.getLowerZ());
+				for (int32_t x = iLocalLowerX; x <= iLocalUpperX; x += 64)
+				{
+					writeBits(pRow, x, uBits, getLowBitsMask((std::min)(64, iLocalUpperX - x + 1)));
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Each voxel of this volume in the region is combined with the voxel at the same position in the other volume. The volumes
+	/// do not need to have the same extents, but the region must lie inside both of them.
+	/// \param other The volume to take the second operand of each operation from
+	/// \param region The voxels to combine
+	/// \param eOperation How to combine the voxels
+	////////////////////////////////////////////////////////////////////////////////
+	inline void BitVolume::combine(const BitVolume& other, const Region& region, BitOperation eOperation)
+	{
+		POLYVOX_THROW_IF(!m_regValidRegion.containsRegion(region), std::out_of_range, "Region is outside the volume");
+		POLYVOX_THROW_IF(!other.m_regValidRegion.containsRegion(region), std::out_of_range, "Region is outside the other volume");
+
+		const int32_t iLocalLowerX = region.getLowerX() - m_regValidRegion.getLowerX();
+		const int32_t iLocalUpperX = region.getUpperX() - m_regValidRegion.getLowerX();
+		const int32_t iOtherOffsetX = m_regValidRegion.getLowerX() - other.m_regValidRegion.getLowerX();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				uint64_t* pRow = getRowData(y - m_regValidRegion.getLowerY(), z - m_regValidRegion.getLowerZ());
+				const uint64_t* pOtherRow = other.getRowData(y - other.m_regValidRegion.getLowerY(), z - other.m_regValidRegion.getLowerZ());
+				for (int32_t x = iLocalLowerX; x <= iLocalUpperX; x += 64)
+				{
+					const uint64_t uBits = readBits(pRow, x);
+					const uint64_t uOtherBits = other.readBits(pOtherRow, x + iOtherOffsetX);
+
+					uint64_t uResult = 0;
+					switch (eOperation)
+					{
+					case BitOperations::And:
+						uResult = uBits & uOtherBits;
+						break;
+					case BitOperations::Or:
+						uResult = uBits | uOtherBits;
+						break;
+					case BitOperations::Xor:
+						uResult = uBits ^ uOtherBits;
+						break;
+					}
+
+					writeBits(pRow, x, uResult, getLowBitsMask((std::min)(64, iLocalUpperX - x + 1)));
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param region The voxels to count, which must lie inside the volume.
+	/// \return The number of voxels in the region which are set
+	////////////////////////////////////////////////////////////////////////////////
+	inline uint64_t BitVolume::countSetVoxels(const Region& region) const
+	{
+		POLYVOX_THROW_IF(!m_regValidRegion.containsRegion(region), std::out_of_range, "Region is outside the volume");
+
+		uint64_t uNoOfSetVoxels = 0;
+		const int32_t iLocalLowerX = region.getLowerX() - m_regValidRegion.getLowerX();
+		const int32_t iLocalUpperX = region.getUpperX() - m_regValidRegion.getLowerX();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				const uint64_t* pRow = getRowData(y - m_regValidRegion.getLowerY(), z - m_regValidRegion.getLowerZ());
+				for (int32_t x = iLocalLowerX; x <= iLocalUpperX; x += 64)
+				{
+					uNoOfSetVoxels += countBits(readBits(pRow, x) & getLowBitsMask((std::min)(64, iLocalUpperX - x + 1)));
+				}
+			}
+		}
+		return uNoOfSetVoxels;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Searches from the start position (inclusive) until the edge of the volume. Along the x axis this tests 64 voxels at a time.
+	/// \param v3dStart The position to start searching from
+	/// \param v3dDirection The direction to search in, which must be a unit vector along one of the axes
+	/// \param v3dResult Set to the position of the first set voxel, if there is one
+	/// \return Whether a set voxel was found
+	////////////////////////////////////////////////////////////////////////////////
+	inline bool BitVolume::findFirstSetVoxel(const Vector3DInt32& v3dStart, const Vector3DInt32& v3dDirection, Vector3DInt32& v3dResult) const
+	{
+		const int32_t iNoOfNonZero = (v3dDirection.getX() != 0 ? 1 : 0) + (v3dDirection.getY() != 0 ? 1 : 0) + (v3dDirection.getZ() != 0 ? 1 : 0);
+		POLYVOX_THROW_IF((iNoOfNonZero != 1) || (v3dDirection.lengthSquared() != 1), std::invalid_argument, "Direction must be a unit vector along one of the axes");
+
+		if (!m_regValidRegion.containsPoint(v3dStart))
+		{
+			return false;
+		}
+
+		Vector3DInt32 v3dLocalPos = v3dStart - m_regValidRegion.getLowerCorner();
+
+		if (v3dDirection.getX() != 0)
+		{
+			const uint64_t* pRow = getRowData(v3dLocalPos.getY(), v3dLocalPos.getZ());
+			int32_t iWord = v3dLocalPos.getX() >> 6;
+			const uint32_t uBit = v3dLocalPos.getX() & 63;
+
+			// Mask out the bits of the first word which lie behind the start position.
+			uint64_t uBits = pRow[iWord] & ((v3dDirection.getX() > 0) ? ~getLowBitsMask(uBit) : getLowBitsMask(uBit + 1));
+			while (uBits == 0)
+			{
+				iWord += v3dDirection.getX();
+				if ((iWord < 0) || (iWord >= static_cast<int32_t>(m_uWordsPerRow)))
+				{
+					return false;
+				}
+				uBits = pRow[iWord];
+			}
+
+			// The padding bits are always clear, so the bit found must be inside the volume.
+			const uint32_t uFoundBit = (v3dDirection.getX() > 0) ? findLowestSetBit(uBits) : findHighestSetBit(uBits);
+			v3dResult = Vector3DInt32(v3dStart.getX() - v3dLocalPos.getX() + iWord * 64 + static_cast<int32_t>(uFoundBit), v3dStart.getY(), v3dStart.getZ());
+			return true;
+		}
+
+		for (Vector3DInt32 v3dPos = v3dStart; m_regValidRegion.containsPoint(v3dPos); v3dPos += v3dDirection)
+		{
+			if (getVoxel(v3dPos))
+			{
+				v3dResult = v3dPos;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Calculate the memory usage of the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	inline uint32_t BitVolume::calculateSizeInBytes(void)
+	{
+		return m_uWordsPerRow * getHeight() * getDepth() * sizeof(uint64_t);
+	}
+
+	inline const uint64_t* BitVolume::getRowData(int32_t iLocalYPos, int32_t iLocalZPos) const
+	{
+		return m_pData.get() + (static_cast<uint32_t>(iLocalZPos) * getHeight() + iLocalYPos) * m_uWordsPerRow;
+	}
+
+	inline uint64_t* BitVolume::getRowData(int32_t iLocalYPos, int32_t iLocalZPos)
+	{
+		return m_pData.get() + (static_cast<uint32_t>(iLocalZPos) * getHeight() + iLocalYPos) * m_uWordsPerRow;
+	}
+
+	inline uint64_t BitVolume::readBits(const uint64_t* pRow, int32_t iLocalXPos) const
+	{
+		const uint32_t uWord = static_cast<uint32_t>(iLocalXPos) >> 6;
+		const uint32_t uBit = static_cast<uint32_t>(iLocalXPos) & 63;
+
+		uint64_t uBits = pRow[uWord] >> uBit;
+		if ((uBit != 0) && (uWord + 1 < m_uWordsPerRow))
+		{
+			uBits |= pRow[uWord + 1] << (64 - uBit);
+		}
+		return uBits;
+	}
+
+	inline void BitVolume::writeBits(uint64_t* pRow, int32_t iLocalXPos, uint64_t uBits, uint64_t uMask)
+	{
+		const uint32_t uWord = static_cast<uint32_t>(iLocalXPos) >> 6;
+		const uint32_t uBit = static_cast<uint32_t>(iLocalXPos) & 63;
+
+		pRow[uWord] = (pRow[uWord] & ~(uMask << uBit)) | ((uBits & uMask) << uBit);
+		if (uBit != 0)
+		{
+			// Callers never write past the end of the row, so there is a next word whenever this mask is not empty.
+			const uint64_t uNextMask = uMask >> (64 - uBit);
+			if (uNextMask != 0)
+			{
+				pRow[uWord + 1] = (pRow[uWord + 1] & ~uNextMask) | ((uBits >> (64 - uBit)) & uNextMask);
+			}
+		}
+	}
+
+	inline uint64_t BitVolume::getLowBitsMask(uint32_t uNoOfBits)
+	{
+		return (uNoOfBits >= 64) ? ~uint64_t(0) : ((uint64_t(1) << uNoOfBits) - 1);
+	}
+}
@@ -0,0 +1,206 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	inline BitVolume::Sampler::Sampler(BitVolume* volume)
+		:BaseVolume<bool>::template Sampler< BitVolume >(volume)
+	{
+	}
+
+	inline BitVolume::Sampler::~Sampler()
+	{
+	}
+
+	inline bool BitVolume::Sampler::getVoxel(void) const
+	{
+		return peekVoxel(0, 0, 0);
+	}
+
+	inline bool BitVolume::Sampler::setVoxel(bool tValue)
+	{
+		if (this->mVolume->getEnclosingRegion().containsPoint(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume))
+		{
+			this->mVolume->setVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume, tValue);
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1ny1nz(void) const
+	{
+		return peekVoxel(-1, -1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1ny0pz(void) const
+	{
+		return peekVoxel(-1, -1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1ny1pz(void) const
+	{
+		return peekVoxel(-1, -1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx0py1nz(void) const
+	{
+		return peekVoxel(-1, 0, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx0py0pz(void) const
+	{
+		return peekVoxel(-1, 0, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx0py1pz(void) const
+	{
+		return peekVoxel(-1, 0, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1py1nz(void) const
+	{
+		return peekVoxel(-1, 1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1py0pz(void) const
+	{
+		return peekVoxel(-1, 1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1nx1py1pz(void) const
+	{
+		return peekVoxel(-1, 1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1ny1nz(void) const
+	{
+		return peekVoxel(0, -1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1ny0pz(void) const
+	{
+		return peekVoxel(0, -1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1ny1pz(void) const
+	{
+		return peekVoxel(0, -1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px0py1nz(void) const
+	{
+		return peekVoxel(0, 0, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px0py0pz(void) const
+	{
+		return peekVoxel(0, 0, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px0py1pz(void) const
+	{
+		return peekVoxel(0, 0, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1py1nz(void) const
+	{
+		return peekVoxel(0, 1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1py0pz(void) const
+	{
+		return peekVoxel(0, 1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel0px1py1pz(void) const
+	{
+		return peekVoxel(0, 1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1ny1nz(void) const
+	{
+		return peekVoxel(1, -1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1ny0pz(void) const
+	{
+		return peekVoxel(1, -1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1ny1pz(void) const
+	{
+		return peekVoxel(1, -1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px0py1nz(void) const
+	{
+		return peekVoxel(1, 0, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px0py0pz(void) const
+	{
+		return peekVoxel(1, 0, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px0py1pz(void) const
+	{
+		return peekVoxel(1, 0, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1py1nz(void) const
+	{
+		return peekVoxel(1, 1, -1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1py0pz(void) const
+	{
+		return peekVoxel(1, 1, 0);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel1px1py1pz(void) const
+	{
+		return peekVoxel(1, 1, 1);
+	}
+
+	inline bool BitVolume::Sampler::peekVoxel(int32_t iXOffset, int32_t iYOffset, int32_t iZOffset) const
+	{
+		const Region& regValid = this->mVolume->m_regValidRegion;
+		const int32_t iLocalXPos = this->mXPosInVolume + iXOffset - regValid.getLowerX();
+		const int32_t iLocalYPos = this->mYPosInVolume + iYOffset - regValid.getLowerY();
+		const int32_t iLocalZPos = this->mZPosInVolume + iZOffset - regValid.getLowerZ();
+
+		// Negative positions become large unsigned values, so one comparison per axis finds positions outside the volume.
+		if ((static_cast<uint32_t>(iLocalXPos) < static_cast<uint32_t>(this->mVolume->getWidth())) &&
+			(static_cast<uint32_t>(iLocalYPos) < static_cast<uint32_t>(this->mVolume->getHeight())) &&
+			(static_cast<uint32_t>(iLocalZPos) < static_cast<uint32_t>(this->mVolume->getDepth())))
+		{
+			const uint64_t* pRow = this->mVolume->getRowData(iLocalYPos, iLocalZPos);
+			return ((pRow[iLocalXPos >> 6] >> (iLocalXPos & 63)) & 1) != 0;
+		}
+		return this->mVolume->m_tBorderValue;
+	}
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_Brush_H__
+#define __PolyVox_Brush_H__
+
+#include "PagedVolume.h"
+#include "RawVolume.h"
+#include "Region.h"
+#include "Vector.h"
+
+namespace PolyVox
+{
+	/**
+	 * \file
+	 *
+	 * Brush editing
+	 *
+	 * applyBrush() edits every voxel inside a shape, combining the shape with the existing contents of the volume in
+	 * one of the ways given by BrushOperation. The shapes are described by signed distance functions: BoxBrush,
+	 * SphereBrush and CapsuleBrush cover the common cases and SdfBrush wraps any other function. A voxel is inside a
+	 * brush if the distance at its position is zero or less.
+	 *
+	 * Rather than evaluating the shape at every voxel, the brush is clipped to each chunk (or to the RawVolume) and
+	 * the result is split into octants until each part is known to be entirely inside or entirely outside the shape.
+	 * Parts which are entirely inside are written in one go. Inside a PagedVolume chunk these parts are aligned cubes,
+	 * which occupy a single contiguous range of the chunk's Morton ordered data, so they are filled with std::fill().
+	 * Only voxels close to the surface of the shape are evaluated individually, and chunks which the shape does not
+	 * touch are never loaded. Other volume types are edited with getVoxel() and setVoxel().
+	 *
+	 * applyBrush() returns the region which the brush covered so that the caller knows what to extract again.
+	 * Surface extractors look at the neighbours of each voxel, so meshes touching this region should be rebuilt as
+	 * well (or the region grown by one voxel before extraction). As with volume copying, the volume should not be
+	 * accessed from other threads while a brush is being applied.
+	 */
+
+	namespace BrushOperations
+	{
+		/// The ways in which a brush can be combined with the existing contents of a volume.
+		enum BrushOperation
+		{
+			Union, ///< Voxels inside the brush are set to the brush value.
+			Subtract, ///< Voxels inside the brush are set to the empty value.
+			Replace ///< Voxels inside the brush which are not empty are set to the brush value, to repaint existing shapes.
+		};
+	}
+	typedef BrushOperations::BrushOperation BrushOperation;
+
+	/// A brush covering every voxel of a Region.
+	class BoxBrush
+	{
+	public:
+		BoxBrush(const Region& region);
+
+		Region getBounds(void) const;
+		float getSignedDistance(const Vector3DFloat& v3dPos) const;
+
+	private:
+		Region m_regBounds;
+		Vector3DFloat m_v3dCentre;
+		Vector3DFloat m_v3dHalfExtents;
+	};
+
+	/// A brush covering every voxel within \a fRadius of a point.
+	class SphereBrush
+	{
+	public:
+		SphereBrush(const Vector3DFloat& v3dCentre, float fRadius);
+
+		Region getBounds(void) const;
+		float getSignedDistance(const Vector3DFloat& v3dPos) const;
+
+	private:
+		Vector3DFloat m_v3dCentre;
+		float m_fRadius;
+	};
+
+	/// A brush covering every voxel within \a fRadius of a line segment, which is useful for tunnels and strokes.
+	class CapsuleBrush
+	{
+	public:
+		CapsuleBrush(const Vector3DFloat& v3dStart, const Vector3DFloat& v3dEnd, float fRadius);
+
+		Region getBounds(void) const;
+		float getSignedDistance(const Vector3DFloat& v3dPos) const;
+
+	private:
+		Vector3DFloat m_v3dStart;
+		Vector3DFloat m_v3dEnd;
+		float m_fRadius;
+	};
+
+	/**
+	 * A brush defined by a user supplied signed distance function.
+	 *
+	 * The function is called as 'function(v3dPos)' and should return a float which is negative inside the shape and
+	 * positive outside it. Only voxels inside \a regBounds are edited. The function must not change faster than the
+	 * distance moved (as is the case for a true distance function) because whole blocks of voxels are classified
+	 * from the distance at their centre. A function which overestimates distances can cause voxels to be missed.
+	 */
+	template <typename DistanceFunction>
+	class SdfBrush
+	{
+	public:
+		SdfBrush(const Region& regBounds, DistanceFunction function);
+
+		Region getBounds(void) const;
+		float getSignedDistance(const Vector3DFloat& v3dPos) const;
+
+	private:
+		Region m_regBounds;
+		DistanceFunction m_function;
+	};
+
+	/// Creates an SdfBrush, deducing the type of the function.
+	template <typename DistanceFunction>
+	SdfBrush<DistanceFunction> makeSdfBrush(const Region& regBounds, DistanceFunction function);
+
+	/// Applies \a brush to \a pVolume, returning the region covered by the brush.
+	template< typename VolumeType, typename BrushType >
+	Region applyBrush(VolumeType* pVolume, const BrushType& brush, BrushOperation eOperation, typename VolumeType::VoxelType tValue, typename VolumeType::VoxelType tEmptyValue = typename VolumeType::VoxelType());
+
+	/// Sets every voxel in \a region to \a tValue.
+	template< typename VolumeType >
+	void fillRegion(VolumeType* pVolume, const Region& region, typename VolumeType::VoxelType tValue);
+
+	/// Implements applyBrush(). It is a friend of the volume classes so that it can access their storage directly.
+	class BrushApplier
+	{
+	public:
+		template< typename VolumeType, typename BrushType >
+		static Region apply(VolumeType* pVolume, const BrushType& brush, BrushOperation eOperation, typename VolumeType::VoxelType tValue, typename VolumeType::VoxelType tEmptyValue);
+
+		template< typename VoxelType, RawVolumeLayout eLayout, typename BrushType >
+		static Region apply(RawVolume<VoxelType, eLayout>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue);
+
+		template< typename VoxelType, typename BrushType >
+		static Region apply(PagedVolume<VoxelType>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue);
+
+		// The generic overload is a better match for the fixed chunk size volumes than the one above, so they are forwarded to it explicitly.
+		template< typename VoxelType, uint16_t ChunkSideLength, typename BrushType >
+		static Region apply(PagedVolume<VoxelType, ChunkSideLength>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue);
+
+	private:
+		template< typename BrushType, typename BoxFunction, typename VoxelFunction >
+		static void classify(const BrushType& brush, const Region& regBounds, const Region& regBox, BoxFunction& boxFunction, VoxelFunction& voxelFunction);
+
+		template< typename VoxelType >
+		static void applyToVoxel(VoxelType& tVoxel, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue);
+
+		template< typename VoxelType >
+		static void applyToRun(VoxelType* pVoxels, uint32_t uCount, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue);
+	};
+}
+
+#include "Brush.inl"
+
+#endif //__PolyVox_Brush_H__
@@ -0,0 +1,432 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param region The voxels covered by the brush.
+	////////////////////////////////////////////////////////////////////////////////
+	inline BoxBrush::BoxBrush(const Region& region)
+		:m_regBounds(region)
+	{
+		POLYVOX_THROW_IF(!region.isValid(), std::invalid_argument, "The region of a box brush must be valid.");
+
+		// The faces lie half a voxel outside the region so that the distance is negative at every voxel inside it.
+		m_v3dCentre = Vector3DFloat(static_cast<float>(region.getLowerX() + region.getUpperX()), static_cast<float>(region.getLowerY() + region.getUpperY()),
+			static_cast<float>(region.getLowerZ() + region.getUpperZ())) * 0.5f;
+		m_v3dHalfExtents = Vector3DFloat(static_cast<float>(region.getWidthInVoxels()), static_cast<float>(region.getHeightInVoxels()),
+			static_cast<float>(region.getDepthInVoxels())) * 0.5f;
+	}
+
+	inline Region BoxBrush::getBounds(void) const
+	{
+		return m_regBounds;
+	}
+
+	inline float BoxBrush::getSignedDistance(const Vector3DFloat& v3dPos) const
+	{
+		const float fX = std::abs(v3dPos.getX() - m_v3dCentre.getX()) - m_v3dHalfExtents.getX();
+		const float fY = std::abs(v3dPos.getY() - m_v3dCentre.getY()) - m_v3dHalfExtents.getY();
+		const float fZ = std::abs(v3dPos.getZ() - m_v3dCentre.getZ()) - m_v3dHalfExtents.getZ();
+
+		const Vector3DFloat v3dOutside((std::max)(fX, 0.0f), (std::max)(fY, 0.0f), (std::max)(fZ, 0.0f));
+		return v3dOutside.length() + (std::min)((std::max)(fX, (std::max)(fY, fZ)), 0.0f);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dCentre The centre of the sphere.
+	/// \param fRadius The radius of the sphere.
+	////////////////////////////////////////////////////////////////////////////////
+	inline SphereBrush::SphereBrush(const Vector3DFloat& v3dCentre, float fRadius)
+		:m_v3dCentre(v3dCentre)
+		,m_fRadius(fRadius)
+	{
+		POLYVOX_THROW_IF(fRadius < 0.0f, std::invalid_argument, "The radius of a sphere brush cannot be negative.");
+	}
+
+	inline Region SphereBrush::getBounds(void) const
+	{
+		return Region(
+			static_cast<int32_t>(std::floor(m_v3dCentre.getX() - m_fRadius)), static_cast<int32_t>(std::floor(m_v3dCentre.getY() - m_fRadius)), static_cast<int32_t>(std::floor(m_v3dCentre.getZ() - m_fRadius)),
+			static_cast<int32_t>(std::ceil(m_v3dCentre.getX() + m_fRadius)), static_cast<int32_t>(std::ceil(m_v3dCentre.getY() + m_fRadius)), static_cast<int32_t>(std::ceil(m_v3dCentre.getZ() + m_fRadius)));
+	}
+
+	inline float SphereBrush::getSignedDistance(const Vector3DFloat& v3dPos) const
+	{
+		return (v3dPos - m_v3dCentre).length() - m_fRadius;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dStart The start of the line segment running through the capsule.
+	/// \param v3dEnd The end of the line segment running through the capsule.
+	/// \param fRadius The radius of the capsule.
+	////////////////////////////////////////////////////////////////////////////////
+	inline CapsuleBrush::CapsuleBrush(const Vector3DFloat& v3dStart, const Vector3DFloat& v3dEnd, float fRadius)
+		:m_v3dStart(v3dStart)
+		,m_v3dEnd(v3dEnd)
+		,m_fRadius(fRadius)
+	{
+		POLYVOX_THROW_IF(fRadius < 0.0f, std::invalid_argument, "The radius of a capsule brush cannot be negative.");
+	}
+
+	inline Region CapsuleBrush::getBounds(void) const
+	{
+		return Region(
+			static_cast<int32_t>(std::floor((std::min)(m_v3dStart.getX(), m_v3dEnd.getX()) - m_fRadius)),
+			static_cast<int32_t>(std::floor((std::min)(m_v3dStart.getY(), m_v3dEnd.getY()) - m_fRadius)),
+			static_cast<int32_t>(std::floor((std::min)(m_v3dStart.getZ(), m_v3dEnd.getZ()) - m_fRadius)),
+			static_cast<int32_t>(std::ceil((std::max)(m_v3dStart.getX(), m_v3dEnd.getX()) + m_fRadius)),
+			static_cast<int32_t>(std::ceil((std::max)(m_v3dStart.getY(), m_v3dEnd.getY()) + m_fRadius)),
+			static_cast<int32_t>(std::ceil((std::max)(m_v3dStart.getZ(), m_v3dEnd.getZ()) + m_fRadius)));
+	}
+
+	inline float CapsuleBrush::getSignedDistance(const Vector3DFloat& v3dPos) const
+	{
+		const Vector3DFloat v3dSegment = m_v3dEnd - m_v3dStart;
+		const Vector3DFloat v3dToPos = v3dPos - m_v3dStart;
+
+		// Find the closest point on the segment, which is the start if the capsule is really a sphere.
+		const float fSegmentLengthSquared = v3dSegment.lengthSquared();
+		float fAlong = 0.0f;
+		if (fSegmentLengthSquared > 0.0f)
+		{
+			fAlong = (std::min)((std::max)(v3dToPos.dot(v3dSegment) / fSegmentLengthSquared, 0.0f), 1.0f);
+		}
+
+		return (v3dToPos - v3dSegment * fAlong).length() - m_fRadius;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param regBounds The region outside of which no voxels are edited.
+	/// \param function The signed distance function.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename DistanceFunction>
+	SdfBrush<DistanceFunction>::SdfBrush(const Region& regBounds, DistanceFunction function)
+		:m_regBounds(regBounds)
+		,m_function(function)
+	{
+		POLYVOX_THROW_IF(!regBounds.isValid(), std::invalid_argument, "The bounds of a brush must be valid.");
+	}
+
+	template <typename DistanceFunction>
+	Region SdfBrush<DistanceFunction>::getBounds(void) const
+	{
+		return m_regBounds;
+	}
+
+	template <typename DistanceFunction>
+	float SdfBrush<DistanceFunction>::getSignedDistance(const Vector3DFloat& v3dPos) const
+	{
+		return m_function(v3dPos);
+	}
+
+	template <typename DistanceFunction>
+	SdfBrush<DistanceFunction> makeSdfBrush(const Region& regBounds, DistanceFunction function)
+	{
+		return SdfBrush<DistanceFunction>(regBounds, function);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pVolume The volume to edit.
+	/// \param brush The shape to edit, such as a BoxBrush or a SphereBrush.
+	/// \param eOperation How the brush is combined with the existing voxels.
+	/// \param tValue The value written by the Union and Replace operations.
+	/// \param tEmptyValue The value written by the Subtract operation, and left alone by the Replace operation.
+	/// \return The smallest region containing every voxel inside the brush (and inside the volume, for a RawVolume).
+	/// This is an inverted region (see Region::InvertedRegion()) if the brush did not cover any voxels.
+	////////////////////////////////////////////////////////////////////////////////
+	template< typename VolumeType, typename BrushType >
+	Region applyBrush(VolumeType* pVolume, const BrushType& brush, BrushOperation eOperation, typename VolumeType::VoxelType tValue, typename VolumeType::VoxelType tEmptyValue)
+	{
+		return BrushApplier::apply(pVolume, brush, eOperation, tValue, tEmptyValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pVolume The volume to edit.
+	/// \param region The region to fill.
+	/// \param tValue The value to write.
+	////////////////////////////////////////////////////////////////////////////////
+	template< typename VolumeType >
+	void fillRegion(VolumeType* pVolume, const Region& region, typename VolumeType::VoxelType tValue)
+	{
+		applyBrush(pVolume, BoxBrush(region), BrushOperations::Union, tValue);
+	}
+
+	template< typename VolumeType, typename BrushType >
+	Region BrushApplier::apply(VolumeType* pVolume, const BrushType& brush, BrushOperation eOperation, typename VolumeType::VoxelType tValue, typename VolumeType::VoxelType tEmptyValue)
+	{
+		typedef typename VolumeType::VoxelType VoxelType;
+
+		Region regAffected = Region::InvertedRegion();
+		auto applyToPosition = [&](int32_t iX, int32_t iY, int32_t iZ)
+		{
+			VoxelType tVoxel = pVolume->getVoxel(iX, iY, iZ);
+			applyToVoxel(tVoxel, eOperation, tValue, tEmptyValue);
+			pVolume->setVoxel(iX, iY, iZ, tVoxel);
+		};
+		auto boxFunction = [&](const Region& regBox)
+		{
+			for (int32_t z = regBox.getLowerZ(); z <= regBox.getUpperZ(); z++)
+			{
+				for (int32_t y = regBox.getLowerY(); y <= regBox.getUpperY(); y++)
+				{
+					for (int32_t x = regBox.getLowerX(); x <= regBox.getUpperX(); x++)
+					{
+						applyToPosition(x, y, z);
+					}
+				}
+			}
+			regAffected.accumulate(regBox);
+		};
+		auto voxelFunction = [&](int32_t iX, int32_t iY, int32_t iZ)
+		{
+			applyToPosition(iX, iY, iZ);
+			regAffected.accumulate(iX, iY, iZ);
+		};
+
+		const Region regBounds = brush.getBounds();
+		classify(brush, regBounds, regBounds, boxFunction, voxelFunction);
+		return regAffected;
+	}
+
+	template< typename VoxelType, RawVolumeLayout eLayout, typename BrushType >
+	Region BrushApplier::apply(RawVolume<VoxelType, eLayout>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue)
+	{
+		// Voxels outside the volume cannot be written, so the brush is clipped to it.
+		const Region& regValid = pVolume->m_regValidRegion;
+		Region regBounds = brush.getBounds();
+		if (!intersects(regBounds, regValid))
+		{
+			return Region::InvertedRegion();
+		}
+		regBounds.cropTo(regValid);
+
+		VoxelType* pData = pVolume->m_pData;
+		Region regAffected = Region::InvertedRegion();
+		auto boxFunction = [&](const Region& regBox)
+		{
+			const uint32_t uWidth = regBox.getWidthInVoxels();
+			const int32_t iLocalX = regBox.getLowerX() - regValid.getLowerX();
+			for (int32_t z = regBox.getLowerZ(); z <= regBox.getUpperZ(); z++)
+			{
+				for (int32_t y = regBox.getLowerY(); y <= regBox.getUpperY(); y++)
+				{
+					const int32_t iLocalY = y - regValid.getLowerY();
+					const int32_t iLocalZ = z - regValid.getLowerZ();
+					if (eLayout == RawVolumeLayouts::Linear)
+					{
+						applyToRun(pData + pVolume->getIndex(iLocalX, iLocalY, iLocalZ), uWidth, eOperation, tValue, tEmptyValue);
+					}
+					else
+					{
+						for (int32_t x = iLocalX; x < iLocalX + static_cast<int32_t>(uWidth); x++)
+						{
+							applyToVoxel(pData[pVolume->getIndex(x, iLocalY, iLocalZ)], eOperation, tValue, tEmptyValue);
+						}
+					}
+				}
+			}
+			regAffected.accumulate(regBox);
+		};
+		auto voxelFunction = [&](int32_t iX, int32_t iY, int32_t iZ)
+		{
+			applyToVoxel(pData[pVolume->getIndex(iX - regValid.getLowerX(), iY - regValid.getLowerY(), iZ - regValid.getLowerZ())], eOperation, tValue, tEmptyValue);
+			regAffected.accumulate(iX, iY, iZ);
+		};
+
+		classify(brush, regBounds, regBounds, boxFunction, voxelFunction);
+		return regAffected;
+	}
+
+	template< typename VoxelType, typename BrushType >
+	Region BrushApplier::apply(PagedVolume<VoxelType>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue)
+	{
+		const uint8_t uPower = pVolume->m_uChunkSideLengthPower;
+		const int32_t iChunkSideLength = pVolume->m_uChunkSideLength;
+		const Region regBounds = brush.getBounds();
+		Region regAffected = Region::InvertedRegion();
+
+		for (int32_t iChunkZ = regBounds.getLowerZ() >> uPower; iChunkZ <= (regBounds.getUpperZ() >> uPower); iChunkZ++)
+		{
+			for (int32_t iChunkY = regBounds.getLowerY() >> uPower; iChunkY <= (regBounds.getUpperY() >> uPower); iChunkY++)
+			{
+				for (int32_t iChunkX = regBounds.getLowerX() >> uPower; iChunkX <= (regBounds.getUpperX() >> uPower); iChunkX++)
+				{
+					const Vector3DInt32 v3dChunkPos(iChunkX * iChunkSideLength, iChunkY * iChunkSideLength, iChunkZ * iChunkSideLength);
+
+					// The chunk is only fetched when something inside it is written, so that chunks
+					// in the corners of the bounds which the brush doesn't reach are never paged in.
+					VoxelType* pData = nullptr;
+					auto getData = [&]()
+					{
+						if (!pData)
+						{
+							typename PagedVolume<VoxelType>::Chunk* pChunk = pVolume->getChunk(iChunkX, iChunkY, iChunkZ);
+							pChunk->markDataModified();
+							pData = pChunk->getData();
+						}
+						return pData;
+					};
+
+					// Splitting the chunk in half along each axis only ever gives aligned cubes, and each of
+					// those is a contiguous range in Morton order which can be written with a single loop.
+					auto boxFunction = [&](const Region& regBox)
+					{
+						const Vector3DInt32 v3dLocal = regBox.getLowerCorner() - v3dChunkPos;
+						const uint32_t uSideLength = regBox.getWidthInVoxels();
+						POLYVOX_ASSERT(uSideLength == regBox.getHeightInVoxels() && uSideLength == regBox.getDepthInVoxels(), "Brush boxes inside chunks should be cubes");
+						const uint32_t uStart = MortonTables::x[v3dLocal.getX()] | MortonTables::y[v3dLocal.getY()] | MortonTables::z[v3dLocal.getZ()];
+						applyToRun(getData() + uStart, uSideLength * uSideLength * uSideLength, eOperation, tValue, tEmptyValue);
+						regAffected.accumulate(regBox);
+					};
+					auto voxelFunction = [&](int32_t iX, int32_t iY, int32_t iZ)
+					{
+						const uint32_t uIndex = MortonTables::x[iX - v3dChunkPos.getX()] | MortonTables::y[iY - v3dChunkPos.getY()] | MortonTables::z[iZ - v3dChunkPos.getZ()];
+						applyToVoxel(getData()[uIndex], eOperation, tValue, tEmptyValue);
+						regAffected.accumulate(iX, iY, iZ);
+					};
+
+					const Region regChunk(v3dChunkPos, v3dChunkPos + Vector3DInt32(iChunkSideLength - 1, iChunkSideLength - 1, iChunkSideLength - 1));
+					classify(brush, regBounds, regChunk, boxFunction, voxelFunction);
+				}
+			}
+		}
+
+		return regAffected;
+	}
+
+	template< typename VoxelType, uint16_t ChunkSideLength, typename BrushType >
+	Region BrushApplier::apply(PagedVolume<VoxelType, ChunkSideLength>* pVolume, const BrushType& brush, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue)
+	{
+		return apply(static_cast<PagedVolume<VoxelType>*>(pVolume), brush, eOperation, tValue, tEmptyValue);
+	}
+
+	// Calls 'boxFunction(regBox)' for parts of 'regBox' which are entirely inside the brush and 'voxelFunction(x, y, z)' for the
+	// remaining voxels which are inside it. Each box is split into octants until it is known to be entirely inside or outside.
+	template< typename BrushType, typename BoxFunction, typename VoxelFunction >
+	void BrushApplier::classify(const BrushType& brush, const Region& regBounds, const Region& regBox, BoxFunction& boxFunction, VoxelFunction& voxelFunction)
+	{
+		if (!intersects(regBox, regBounds))
+		{
+			return;
+		}
+
+		const int32_t iWidth = regBox.getWidthInVoxels();
+		const int32_t iHeight = regBox.getHeightInVoxels();
+		const int32_t iDepth = regBox.getDepthInVoxels();
+		if ((iWidth == 1) && (iHeight == 1) && (iDepth == 1))
+		{
+			if (brush.getSignedDistance(Vector3DFloat(static_cast<float>(regBox.getLowerX()), static_cast<float>(regBox.getLowerY()), static_cast<float>(regBox.getLowerZ()))) <= 0.0f)
+			{
+				voxelFunction(regBox.getLowerX(), regBox.getLowerY(), regBox.getLowerZ());
+			}
+			return;
+		}
+
+		// No voxel in the box is further than this from its centre, so the distance at the centre tells us whether all the
+		// voxels are on the same side of the surface. The small amount of slack stops rounding errors from moving voxels which
+		// lie exactly on the surface, which are then evaluated individually like any others.
+		const Vector3DFloat v3dCentre(static_cast<float>(regBox.getLowerX() + regBox.getUpperX()), static_cast<float>(regBox.getLowerY() + regBox.getUpperY()),
+			static_cast<float>(regBox.getLowerZ() + regBox.getUpperZ()));
+		const Vector3DFloat v3dHalfDiagonal(static_cast<float>(iWidth - 1), static_cast<float>(iHeight - 1), static_cast<float>(iDepth - 1));
+		const float fRadius = v3dHalfDiagonal.length() * 0.5f + 0.01f;
+		const float fDistance = brush.getSignedDistance(v3dCentre * 0.5f);
+
+		if (fDistance > fRadius)
+		{
+			return;
+		}
+
+		if ((fDistance <= -fRadius) && regBounds.containsRegion(regBox))
+		{
+			boxFunction(regBox);
+			return;
+		}
+
+		// Visit the octants in Morton order, which keeps the writes inside a chunk moving forwards through its data.
+		const Vector3DInt32 v3dHalf(iWidth >> 1, iHeight >> 1, iDepth >> 1);
+		for (int32_t iZ = 0; iZ < ((iDepth > 1) ? 2 : 1); iZ++)
+		{
+			const int32_t iLowerZ = (iZ == 0) ? regBox.getLowerZ() : regBox.getLowerZ() + v3dHalf.getZ();
+			const int32_t iUpperZ = ((iZ == 0) && (iDepth > 1)) ? regBox.getLowerZ() + v3dHalf.getZ() - 1 : regBox.getUpperZ();
+			for (int32_t iY = 0; iY < ((iHeight > 1) ? 2 : 1); iY++)
+			{
+				const int32_t iLowerY = (iY == 0) ? regBox.getLowerY() : regBox.getLowerY() + v3dHalf.getY();
+				const int32_t iUpperY = ((iY == 0) && (iHeight > 1)) ? regBox.getLowerY() + v3dHalf.getY() - 1 : regBox.getUpperY();
+				for (int32_t iX = 0; iX < ((iWidth > 1) ? 2 : 1); iX++)
+				{
+					const int32_t iLowerX = (iX == 0) ? regBox.getLowerX() : regBox.getLowerX() + v3dHalf.getX();
+					const int32_t iUpperX = ((iX == 0) && (iWidth > 1)) ? regBox.getLowerX() + v3dHalf.getX() - 1 : regBox.getUpperX();
+					classify(brush, regBounds, Region(iLowerX, iLowerY, iLowerZ, iUpperX, iUpperY, iUpperZ), boxFunction, voxelFunction);
+				}
+			}
+		}
+	}
+
+	template< typename VoxelType >
+	void BrushApplier::applyToVoxel(VoxelType& tVoxel, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue)
+	{
+		switch (eOperation)
+		{
+		case BrushOperations::Union:
+			tVoxel = tValue;
+			break;
+		case BrushOperations::Subtract:
+			tVoxel = tEmptyValue;
+			break;
+		case BrushOperations::Replace:
+			if (tVoxel != tEmptyValue)
+			{
+				tVoxel = tValue;
+			}
+			break;
+		}
+	}
+
+	template< typename VoxelType >
+	void BrushApplier::applyToRun(VoxelType* pVoxels, uint32_t uCount, BrushOperation eOperation, VoxelType tValue, VoxelType tEmptyValue)
+	{
+		switch (eOperation)
+		{
+		case BrushOperations::Union:
+			std::fill(pVoxels, pVoxels + uCount, tValue);
+			break;
+		case BrushOperations::Subtract:
+			std::fill(pVoxels, pVoxels + uCount, tEmptyValue);
+			break;
+		case BrushOperations::Replace:
+			for (uint32_t ct = 0; ct < uCount; ct++)
+			{
+				if (pVoxels[ct] != tEmptyValue)
+				{
+					pVoxels[ct] = tValue;
+				}
+			}
+			break;
+		}
+	}
+}
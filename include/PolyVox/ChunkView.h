@@ -0,0 +1,112 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_ChunkView_H__
+#define __PolyVox_ChunkView_H__
+
+#include "Impl/ErrorHandling.h"
+#include "Impl/Morton.h"
+#include "Impl/PlatformDefinitions.h"
+
+#include "Region.h"
+
+namespace PolyVox
+{
+	namespace ChunkLayouts
+	{
+		/// The order in which the voxels of a ChunkView are stored.
+		enum ChunkLayout
+		{
+			Linear, ///< Voxels are stored in rows along x, with neighbours in y and z given by ChunkView::getYStride() and ChunkView::getZStride().
+			Morton ///< Voxels are stored in Morton order, so the voxel at (x, y, z) relative to the lower corner is at MortonTables::x[x] | MortonTables::y[y] | MortonTables::z[z].
+		};
+	}
+	typedef ChunkLayouts::ChunkLayout ChunkLayout;
+
+	/**
+	 * Direct access to the voxels of one chunk of a volume.
+	 *
+	 * RawVolume::forEachChunk() and PagedVolume::forEachChunk() pass one of these to their callback for each block of contiguous
+	 * storage which overlaps the requested region. This lets bulk algorithms (histograms, thresholding, replacing one material
+	 * with another, copies) work through a whole buffer at a time instead of looking up each voxel in the volume.
+	 *
+	 * getRegion() is the part of the requested region which lies in this chunk, and getChunkRegion() is the whole of the chunk.
+	 * Both are in volume coordinates. getData() points at the voxel in the lower corner of the chunk, and getLayout() says how
+	 * the rest follow it. getIndex() can be used to find any voxel, but code which cares about speed will usually switch on the
+	 * layout once and then walk the data itself.
+	 *
+	 * The data must not be written through getData(). Call getWritableData() instead, which marks the chunk as modified (so
+	 * that a PagedVolume saves it and rebuilds its reduced resolution levels) and gives it its own copy of any data which it
+	 * shares with other chunks. The pointer is only valid during the callback.
+	 */
+	template <typename VoxelType>
+	class ChunkView
+	{
+	public:
+		/// Called by getWritableData() with the context given to the constructor, returning the data to write to.
+		typedef VoxelType* (*ModifyFunction)(void* pContext);
+
+		/// Constructor, which is used by the volumes.
+		ChunkView(VoxelType* pData, ChunkLayout eLayout, const Region& regChunk, const Region& regView, int32_t iYStride, int32_t iZStride,
+			ModifyFunction pModifyFunction = nullptr, void* pModifyContext = nullptr);
+
+		/// Gets the voxels of the chunk, for reading.
+		const VoxelType* getData(void) const;
+		/// Marks the chunk as modified and gets its voxels for writing.
+		VoxelType* getWritableData(void);
+
+		/// Gets the order in which the voxels are stored.
+		ChunkLayout getLayout(void) const;
+		/// Gets the part of the requested region which is in this chunk.
+		const Region& getRegion(void) const;
+		/// Gets the whole of the chunk.
+		const Region& getChunkRegion(void) const;
+		/// Gets the distance between neighbouring voxels in y, for the linear layout.
+		int32_t getYStride(void) const;
+		/// Gets the distance between neighbouring voxels in z, for the linear layout.
+		int32_t getZStride(void) const;
+
+		/// Gets the position in the data of the voxel at the given position in the volume, which must be in the chunk.
+		uint32_t getIndex(int32_t iXPos, int32_t iYPos, int32_t iZPos) const;
+
+		/// Whether getWritableData() has been called.
+		bool isModified(void) const;
+
+	private:
+		VoxelType* m_pData;
+		ChunkLayout m_eLayout;
+		Region m_regChunk;
+		Region m_regView;
+		int32_t m_iYStride;
+		int32_t m_iZStride;
+
+		ModifyFunction m_pModifyFunction;
+		void* m_pModifyContext;
+		bool m_bModified;
+	};
+}
+
+#include "ChunkView.inl"
+
+#endif //__PolyVox_ChunkView_H__
@@ -0,0 +1,127 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pData The voxel in the lower corner of the chunk.
+	/// \param eLayout The order in which the voxels are stored.
+	/// \param regChunk The whole of the chunk, in volume coordinates.
+	/// \param regView The part of the chunk which is being visited.
+	/// \param iYStride The distance between neighbouring voxels in y, for the linear layout.
+	/// \param iZStride The distance between neighbouring voxels in z, for the linear layout.
+	/// \param pModifyFunction If not null, called the first time getWritableData() is called to get the data to write to.
+	/// \param pModifyContext Passed to \a pModifyFunction.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	ChunkView<VoxelType>::ChunkView(VoxelType* pData, ChunkLayout eLayout, const Region& regChunk, const Region& regView, int32_t iYStride, int32_t iZStride,
+		ModifyFunction pModifyFunction, void* pModifyContext)
+		:m_pData(pData)
+		,m_eLayout(eLayout)
+		,m_regChunk(regChunk)
+		,m_regView(regView)
+		,m_iYStride(iYStride)
+		,m_iZStride(iZStride)
+		,m_pModifyFunction(pModifyFunction)
+		,m_pModifyContext(pModifyContext)
+		,m_bModified(false)
+	{
+		POLYVOX_ASSERT(regChunk.containsRegion(regView), "The view must be inside the chunk");
+	}
+
+	template <typename VoxelType>
+	const VoxelType* ChunkView<VoxelType>::getData(void) const
+	{
+		return m_pData;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The returned pointer can differ from the one returned by getData() before this call (for example if the chunk
+	/// was sharing its data with others) so getData() should be called again if it is still needed.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType* ChunkView<VoxelType>::getWritableData(void)
+	{
+		if (!m_bModified)
+		{
+			if (m_pModifyFunction)
+			{
+				m_pData = m_pModifyFunction(m_pModifyContext);
+			}
+			m_bModified = true;
+		}
+		return m_pData;
+	}
+
+	template <typename VoxelType>
+	ChunkLayout ChunkView<VoxelType>::getLayout(void) const
+	{
+		return m_eLayout;
+	}
+
+	template <typename VoxelType>
+	const Region& ChunkView<VoxelType>::getRegion(void) const
+	{
+		return m_regView;
+	}
+
+	template <typename VoxelType>
+	const Region& ChunkView<VoxelType>::getChunkRegion(void) const
+	{
+		return m_regChunk;
+	}
+
+	template <typename VoxelType>
+	int32_t ChunkView<VoxelType>::getYStride(void) const
+	{
+		return m_iYStride;
+	}
+
+	template <typename VoxelType>
+	int32_t ChunkView<VoxelType>::getZStride(void) const
+	{
+		return m_iZStride;
+	}
+
+	template <typename VoxelType>
+	uint32_t ChunkView<VoxelType>::getIndex(int32_t iXPos, int32_t iYPos, int32_t iZPos) const
+	{
+		POLYVOX_ASSERT(m_regChunk.containsPoint(iXPos, iYPos, iZPos), "Position is outside the chunk");
+
+		const int32_t iLocalX = iXPos - m_regChunk.getLowerX();
+		const int32_t iLocalY = iYPos - m_regChunk.getLowerY();
+		const int32_t iLocalZ = iZPos - m_regChunk.getLowerZ();
+		if (m_eLayout == ChunkLayouts::Linear)
+		{
+			return iLocalX + iLocalY * m_iYStride + iLocalZ * m_iZStride;
+		}
+		return MortonTables::x[iLocalX] | MortonTables::y[iLocalY] | MortonTables::z[iLocalZ];
+	}
+
+	template <typename VoxelType>
+	bool ChunkView<VoxelType>::isModified(void) const
+	{
+		return m_bModified;
+	}
+}
@@ -0,0 +1,163 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_ConnectedComponents_H__
+#define __PolyVox_ConnectedComponents_H__
+
+#include "Impl/AStarPathfinderImpl.h" //For Connectivity
+#include "Impl/ErrorHandling.h"
+#include "Impl/PlatformDefinitions.h"
+#include "Impl/Utility.h"
+
+#include "Region.h"
+#include "RegionScheduler.h"
+#include "Vector.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace PolyVox
+{
+	/// A group of solid voxels which are connected to each other, as found by a ConnectedComponentLabeller.
+	struct ConnectedComponent
+	{
+		ConnectedComponent()
+			:uLabel(0)
+			,region(Region::InvertedRegion())
+			,uNoOfVoxels(0)
+		{
+		}
+
+		/// The label which the voxels of the component have in the label volume.
+		uint32_t uLabel;
+		/// The smallest region which contains all of the voxels of the component.
+		Region region;
+		/// The number of voxels in the component.
+		uint32_t uNoOfVoxels;
+	};
+
+	/// Finds the groups of connected solid voxels in a volume, and keeps them up to date as the volume is edited.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// Each solid voxel in \a regBounds is given the label of the component it belongs to in a second 'companion' volume of
+	/// uint32_t which covers the same region, while empty voxels are given a label of zero. A user supplied callback takes a
+	/// voxel and returns whether it is solid, and the Connectivity decides whether voxels which only share an edge or a corner
+	/// are connected. Voxels outside the bounds are never looked at, so components are only connected through the bounds.
+	/// The bounds and size of each component are available through getComponent(), which is what is needed to turn a piece
+	/// which has been blown off a structure into a separate physics object, for example.
+	///
+	/// The bounds are split into chunks of ConnectedComponentsChunkSideLength voxels, which are labelled on several threads at
+	/// once with a union-find over the voxels of each chunk. The labels which meet across the faces of the chunks are then
+	/// merged, and the final labels are written back in parallel. Reading and writing the volumes from several threads at once
+	/// requires them to report \a SupportsConcurrentReads and \a SupportsConcurrentWrites (as RawVolume does). Otherwise they
+	/// are locked while each chunk is read or written, but the labelling itself still runs in parallel.
+	///
+	/// After the volume has been edited, update() only relabels the components which touch the edited voxels. The labels of
+	/// every other component are left as they are, and the labels of the components which were touched may be reused.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	class ConnectedComponentLabeller
+	{
+		static_assert(std::is_same<typename LabelVolumeType::VoxelType, uint32_t>::value, "The label volume must store a uint32_t per voxel.");
+
+	public:
+		/// The side length of the chunks which are labelled in parallel.
+		static const int32_t ConnectedComponentsChunkSideLength = 32;
+
+		/// Creates a labeller which reads from \a volData and writes labels to \a volLabels. Nothing is computed until calculate() is called.
+		ConnectedComponentLabeller(VolumeType* volData, LabelVolumeType* volLabels, const Region& regBounds, IsVoxelSolidCallback isVoxelSolid,
+			Connectivity eConnectivity = SixConnected, uint32_t uNoOfThreads = 0);
+
+		/// Labels the whole of the bounds from scratch.
+		void calculate(void);
+
+		/// Brings the labels up to date after the voxels in \a regChanged have been modified, and returns the labels of the components which were created.
+		std::vector<uint32_t> update(const Region& regChanged);
+
+		/// Gets the region which is labelled.
+		const Region& getBounds(void) const;
+		/// Gets the number of components.
+		uint32_t getNoOfComponents(void) const;
+		/// Gets the labels of all the components, in increasing order.
+		std::vector<uint32_t> getComponentLabels(void) const;
+		/// Gets the component which has the given label.
+		const ConnectedComponent& getComponent(uint32_t uLabel) const;
+
+	private:
+		// While the labels are being computed, voxels hold the index of their component within their chunk with this bit set.
+		static const uint32_t ProvisionalLabelFlag = 0x80000000;
+
+		// The results of labelling a single chunk. The component of each label within the chunk is also stored.
+		struct ChunkLabels
+		{
+			uint32_t uFirstLabel;
+			std::vector<ConnectedComponent> vecComponents;
+			std::vector< std::pair<uint32_t, uint32_t> > vecEquivalences;
+		};
+
+		// Scratch memory which each worker reuses for every chunk it labels.
+		struct ChunkScratch
+		{
+			std::vector<uint32_t> vecParents;
+			std::vector<uint32_t> vecLabels;
+		};
+
+		void labelRegion(const Region& region, bool bKeepExistingLabels, std::vector<uint32_t>* pNewLabels);
+		void labelChunk(const Region& regChunk, bool bKeepExistingLabels, ChunkLabels& chunkLabels, ChunkScratch& scratch, std::mutex* pDataMutex, std::mutex* pLabelMutex);
+		void findEquivalences(const Region& region, const Region& regChunk, const std::vector<ChunkLabels>& vecChunks, ChunkLabels& chunkLabels, std::mutex* pLabelMutex) const;
+
+		// Union-find over indices into a vector of parents. The root of each set is its smallest member.
+		static uint32_t findRoot(std::vector<uint32_t>& vecParents, uint32_t uNode);
+		static void unite(std::vector<uint32_t>& vecParents, uint32_t uFirst, uint32_t uSecond);
+
+		uint32_t getChunkIndex(const Region& region, int32_t iX, int32_t iY, int32_t iZ) const;
+		uint32_t allocateLabel(void);
+		void freeLabel(uint32_t uLabel);
+
+		VolumeType* m_volData;
+		LabelVolumeType* m_volLabels;
+		Region m_regBounds;
+		IsVoxelSolidCallback m_isVoxelSolid;
+
+		// Kept between calls so that small updates don't have to start new threads.
+		RegionScheduler m_scheduler;
+
+		// The neighbours of a voxel which come before it when looping over x, then y, then z.
+		std::vector<Vector3DInt32> m_vecPrecedingNeighbours;
+
+		// Indexed by label, so the first entry is unused. Unused labels have no voxels.
+		std::vector<ConnectedComponent> m_vecComponents;
+		std::set<uint32_t> m_setFreeLabels;
+		uint32_t m_uNoOfComponents;
+	};
+}
+
+#include "ConnectedComponents.inl"
+
+#endif //__PolyVox_ConnectedComponents_H__
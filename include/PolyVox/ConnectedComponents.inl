@@ -0,0 +1,574 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param volData The volume to find the components of
+	/// \param volLabels The volume to write the labels into, which must cover \a regBounds
+	/// \param regBounds The region to label
+	/// \param isVoxelSolid A callback which takes a voxel and returns whether it is solid
+	/// \param eConnectivity Which neighbours of a voxel it is connected to
+	/// \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::ConnectedComponentLabeller(VolumeType* volData, LabelVolumeType* volLabels,
+		const Region& regBounds, IsVoxelSolidCallback isVoxelSolid, Connectivity eConnectivity, uint32_t uNoOfThreads)
+		:m_volData(volData)
+		,m_volLabels(volLabels)
+		,m_regBounds(regBounds)
+		,m_isVoxelSolid(isVoxelSolid)
+		,m_scheduler(uNoOfThreads, ConnectedComponentsChunkSideLength)
+		,m_uNoOfComponents(0)
+	{
+		POLYVOX_THROW_IF(!m_regBounds.isValid(), std::invalid_argument, "Connected component bounds are not valid.");
+
+		// Faces differ in one coordinate, edges in two and corners in three.
+		const int32_t iMaxNonZero = (eConnectivity == SixConnected) ? 1 : ((eConnectivity == EighteenConnected) ? 2 : 3);
+		for (int32_t iZ = -1; iZ <= 0; iZ++)
+		{
+			for (int32_t iY = -1; iY <= 1; iY++)
+			{
+				for (int32_t iX = -1; iX <= 1; iX++)
+				{
+					const bool bPreceding = (iZ < 0) || (iY < 0) || ((iY == 0) && (iX < 0));
+					const int32_t iNonZero = (iX != 0 ? 1 : 0) + (iY != 0 ? 1 : 0) + (iZ != 0 ? 1 : 0);
+					if (bPreceding && (iNonZero <= iMaxNonZero))
+					{
+						m_vecPrecedingNeighbours.push_back(Vector3DInt32(iX, iY, iZ));
+					}
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::calculate(void)
+	{
+		m_vecComponents.assign(1, ConnectedComponent());
+		m_setFreeLabels.clear();
+		m_uNoOfComponents = 0;
+
+		labelRegion(m_regBounds, false, nullptr);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Any component which has a voxel in or next to \a regChanged might have been split or joined to another, so all of
+	/// them are relabelled together. Their old labels are freed first, so the returned labels can include some of them.
+	/// \param regChanged The region containing the voxels which were modified
+	/// \return The labels of the components which replaced the ones touching \a regChanged
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	std::vector<uint32_t> ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::update(const Region& regChanged)
+	{
+		POLYVOX_THROW_IF(m_vecComponents.empty(), invalid_operation, "calculate() must be called before update().");
+
+		std::vector<uint32_t> vecNewLabels;
+		if (!intersects(regChanged, m_regBounds))
+		{
+			return vecNewLabels;
+		}
+
+		Region regCropped = regChanged;
+		regCropped.cropTo(m_regBounds);
+
+		// Find the components touching the change, and the region which they (and the change) cover.
+		Region regNeighbourhood = regCropped;
+		regNeighbourhood.grow(1);
+		regNeighbourhood.cropTo(m_regBounds);
+
+		std::vector<bool> vecAffected(m_vecComponents.size(), false);
+		Region regRelabel = regCropped;
+		for (int32_t iZ = regNeighbourhood.getLowerZ(); iZ <= regNeighbourhood.getUpperZ(); iZ++)
+		{
+			for (int32_t iY = regNeighbourhood.getLowerY(); iY <= regNeighbourhood.getUpperY(); iY++)
+			{
+				for (int32_t iX = regNeighbourhood.getLowerX(); iX <= regNeighbourhood.getUpperX(); iX++)
+				{
+					const uint32_t uLabel = m_volLabels->getVoxel(iX, iY, iZ);
+					POLYVOX_ASSERT(uLabel < m_vecComponents.size(), "Label volume has been modified since it was calculated.");
+					if ((uLabel != 0) && !vecAffected[uLabel])
+					{
+						vecAffected[uLabel] = true;
+						regRelabel.accumulate(m_vecComponents[uLabel].region);
+						freeLabel(uLabel);
+					}
+				}
+			}
+		}
+
+		// Clear the affected components, so that their voxels are labelled again along with any which have become solid.
+		VolumeLocks<VolumeType, LabelVolumeType> locks(m_scheduler, m_volData, m_volLabels);
+		m_scheduler.forEachTile(regRelabel, [&](const Region& regChunk, uint32_t /*uChunk*/, uint32_t /*uWorker*/)
+		{
+			std::unique_lock<std::mutex> labelLock;
+			if (locks.getDstMutex())
+			{
+				labelLock = std::unique_lock<std::mutex>(*locks.getDstMutex());
+			}
+
+			for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+				{
+					for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+					{
+						if (vecAffected[m_volLabels->getVoxel(iX, iY, iZ)])
+						{
+							m_volLabels->setVoxel(iX, iY, iZ, 0);
+						}
+					}
+				}
+			}
+		});
+
+		labelRegion(regRelabel, true, &vecNewLabels);
+		return vecNewLabels;
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	const Region& ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::getBounds(void) const
+	{
+		return m_regBounds;
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	uint32_t ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::getNoOfComponents(void) const
+	{
+		return m_uNoOfComponents;
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	std::vector<uint32_t> ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::getComponentLabels(void) const
+	{
+		std::vector<uint32_t> vecLabels;
+		vecLabels.reserve(m_uNoOfComponents);
+		for (uint32_t uLabel = 1; uLabel < m_vecComponents.size(); uLabel++)
+		{
+			if (m_vecComponents[uLabel].uNoOfVoxels > 0)
+			{
+				vecLabels.push_back(uLabel);
+			}
+		}
+		return vecLabels;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uLabel The label of the component, which must be one of those returned by getComponentLabels()
+	////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	const ConnectedComponent& ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::getComponent(uint32_t uLabel) const
+	{
+		POLYVOX_THROW_IF((uLabel == 0) || (uLabel >= m_vecComponents.size()) || (m_vecComponents[uLabel].uNoOfVoxels == 0), std::out_of_range,
+			"There is no component with the given label.");
+		return m_vecComponents[uLabel];
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::labelRegion(const Region& region, bool bKeepExistingLabels, std::vector<uint32_t>* pNewLabels)
+	{
+		VolumeLocks<VolumeType, LabelVolumeType> locks(m_scheduler, m_volData, m_volLabels);
+		WorkerLocal<ChunkScratch> scratch(m_scheduler);
+
+		// Label each chunk on its own. Voxels are left holding their index within the chunk's components.
+		std::vector<ChunkLabels> vecChunks(m_scheduler.getNoOfTiles(region));
+		m_scheduler.forEachTile(region, [&](const Region& regChunk, uint32_t uChunk, uint32_t uWorker)
+		{
+			labelChunk(regChunk, bKeepExistingLabels, vecChunks[uChunk], scratch.get(uWorker), locks.getSrcMutex(), locks.getDstMutex());
+		});
+
+		uint32_t uNoOfProvisionalLabels = 0;
+		for (auto& chunkLabels : vecChunks)
+		{
+			chunkLabels.uFirstLabel = uNoOfProvisionalLabels;
+			uNoOfProvisionalLabels += static_cast<uint32_t>(chunkLabels.vecComponents.size());
+		}
+
+		// Find the components which meet across the faces of the chunks, then join them.
+		m_scheduler.forEachTile(region, [&](const Region& regChunk, uint32_t uChunk, uint32_t /*uWorker*/)
+		{
+			findEquivalences(region, regChunk, vecChunks, vecChunks[uChunk], locks.getDstMutex());
+		});
+
+		std::vector<uint32_t> vecParents(uNoOfProvisionalLabels);
+		for (uint32_t uNode = 0; uNode < uNoOfProvisionalLabels; uNode++)
+		{
+			vecParents[uNode] = uNode;
+		}
+		for (const auto& chunkLabels : vecChunks)
+		{
+			for (const auto& equivalence : chunkLabels.vecEquivalences)
+			{
+				unite(vecParents, equivalence.first, equivalence.second);
+			}
+		}
+
+		// Give each joined component its final label. Roots are visited before the rest of their set, and in the order of
+		// the chunks, so the labels don't depend on the number of threads.
+		std::vector<uint32_t> vecFinalLabels(uNoOfProvisionalLabels);
+		for (const auto& chunkLabels : vecChunks)
+		{
+			for (uint32_t uLocal = 0; uLocal < chunkLabels.vecComponents.size(); uLocal++)
+			{
+				const uint32_t uProvisional = chunkLabels.uFirstLabel + uLocal;
+				const uint32_t uRoot = findRoot(vecParents, uProvisional);
+				if (uRoot == uProvisional)
+				{
+					vecFinalLabels[uProvisional] = allocateLabel();
+					if (pNewLabels)
+					{
+						pNewLabels->push_back(vecFinalLabels[uProvisional]);
+					}
+				}
+				else
+				{
+					vecFinalLabels[uProvisional] = vecFinalLabels[uRoot];
+				}
+
+				ConnectedComponent& component = m_vecComponents[vecFinalLabels[uProvisional]];
+				component.region.accumulate(chunkLabels.vecComponents[uLocal].region);
+				component.uNoOfVoxels += chunkLabels.vecComponents[uLocal].uNoOfVoxels;
+			}
+		}
+
+		// Replace the provisional labels with the final ones.
+		m_scheduler.forEachTile(region, [&](const Region& regChunk, uint32_t uChunk, uint32_t /*uWorker*/)
+		{
+			const ChunkLabels& chunkLabels = vecChunks[uChunk];
+			if (chunkLabels.vecComponents.empty())
+			{
+				return;
+			}
+
+			std::unique_lock<std::mutex> labelLock;
+			if (locks.getDstMutex())
+			{
+				labelLock = std::unique_lock<std::mutex>(*locks.getDstMutex());
+			}
+
+			for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+				{
+					for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+					{
+						const uint32_t uLabel = m_volLabels->getVoxel(iX, iY, iZ);
+						if (uLabel & ProvisionalLabelFlag)
+						{
+							m_volLabels->setVoxel(iX, iY, iZ, vecFinalLabels[chunkLabels.uFirstLabel + (uLabel & ~ProvisionalLabelFlag)]);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::labelChunk(const Region& regChunk, bool bKeepExistingLabels, ChunkLabels& chunkLabels,
+		ChunkScratch& scratch, std::mutex* pDataMutex, std::mutex* pLabelMutex)
+	{
+		const uint32_t NotSolid = (std::numeric_limits<uint32_t>::max)();
+
+		const int32_t iWidth = regChunk.getWidthInVoxels();
+		const int32_t iHeight = regChunk.getHeightInVoxels();
+		const int32_t iDepth = regChunk.getDepthInVoxels();
+		const int32_t iYStride = iWidth;
+		const int32_t iZStride = iWidth * iHeight;
+		const uint32_t uNoOfVoxels = static_cast<uint32_t>(iZStride * iDepth);
+
+		std::vector<uint32_t>& vecParents = scratch.vecParents;
+		std::vector<uint32_t>& vecLabels = scratch.vecLabels;
+		vecParents.resize(uNoOfVoxels);
+		vecLabels.assign(uNoOfVoxels, 0);
+
+		// Voxels which already have a label belong to components which aren't being relabelled, so they count as empty.
+		if (bKeepExistingLabels)
+		{
+			std::unique_lock<std::mutex> labelLock;
+			if (pLabelMutex)
+			{
+				labelLock = std::unique_lock<std::mutex>(*pLabelMutex);
+			}
+
+			uint32_t uIndex = 0;
+			for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+				{
+					for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+					{
+						vecLabels[uIndex++] = m_volLabels->getVoxel(iX, iY, iZ);
+					}
+				}
+			}
+		}
+
+		{
+			std::unique_lock<std::mutex> dataLock;
+			if (pDataMutex)
+			{
+				dataLock = std::unique_lock<std::mutex>(*pDataMutex);
+			}
+
+			uint32_t uIndex = 0;
+			for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+				{
+					for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+					{
+						const bool bSolid = (vecLabels[uIndex] == 0) && m_isVoxelSolid(m_volData->getVoxel(iX, iY, iZ));
+						vecParents[uIndex] = bSolid ? uIndex : NotSolid;
+						uIndex++;
+					}
+				}
+			}
+		}
+
+		// Join each solid voxel to the solid neighbours which have already been visited.
+		uint32_t uIndex = 0;
+		for (int32_t iZ = 0; iZ < iDepth; iZ++)
+		{
+			for (int32_t iY = 0; iY < iHeight; iY++)
+			{
+				for (int32_t iX = 0; iX < iWidth; iX++)
+				{
+					if (vecParents[uIndex] != NotSolid)
+					{
+						for (const auto& v3dOffset : m_vecPrecedingNeighbours)
+						{
+							const int32_t iNeighbourX = iX + v3dOffset.getX();
+							const int32_t iNeighbourY = iY + v3dOffset.getY();
+							const int32_t iNeighbourZ = iZ + v3dOffset.getZ();
+							if ((iNeighbourX < 0) || (iNeighbourX >= iWidth) || (iNeighbourY < 0) || (iNeighbourY >= iHeight) || (iNeighbourZ < 0))
+							{
+								continue;
+							}
+
+							const uint32_t uNeighbour = static_cast<uint32_t>(iNeighbourX + iNeighbourY * iYStride + iNeighbourZ * iZStride);
+							if (vecParents[uNeighbour] != NotSolid)
+							{
+								unite(vecParents, uIndex, uNeighbour);
+							}
+						}
+					}
+					uIndex++;
+				}
+			}
+		}
+
+		// Number the sets and find the bounds and size of each.
+		chunkLabels.vecComponents.clear();
+		chunkLabels.vecEquivalences.clear();
+		uIndex = 0;
+		for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+		{
+			for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+			{
+				for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+				{
+					if (vecParents[uIndex] != NotSolid)
+					{
+						const uint32_t uRoot = findRoot(vecParents, uIndex);
+						if (uRoot == uIndex)
+						{
+							vecLabels[uIndex] = static_cast<uint32_t>(chunkLabels.vecComponents.size()) | ProvisionalLabelFlag;
+							chunkLabels.vecComponents.push_back(ConnectedComponent());
+						}
+						else
+						{
+							vecLabels[uIndex] = vecLabels[uRoot];
+						}
+
+						ConnectedComponent& component = chunkLabels.vecComponents[vecLabels[uIndex] & ~ProvisionalLabelFlag];
+						component.region.accumulate(iX, iY, iZ);
+						component.uNoOfVoxels++;
+					}
+					uIndex++;
+				}
+			}
+		}
+
+		// When relabelling, only the voxels which were found to be solid are written.
+		if (bKeepExistingLabels && chunkLabels.vecComponents.empty())
+		{
+			return;
+		}
+
+		std::unique_lock<std::mutex> labelLock;
+		if (pLabelMutex)
+		{
+			labelLock = std::unique_lock<std::mutex>(*pLabelMutex);
+		}
+
+		uIndex = 0;
+		for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+		{
+			for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+			{
+				for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX++)
+				{
+					if (!bKeepExistingLabels || (vecParents[uIndex] != NotSolid))
+					{
+						m_volLabels->setVoxel(iX, iY, iZ, vecLabels[uIndex]);
+					}
+					uIndex++;
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::findEquivalences(const Region& region, const Region& regChunk,
+		const std::vector<ChunkLabels>& vecChunks, ChunkLabels& chunkLabels, std::mutex* pLabelMutex) const
+	{
+		if (chunkLabels.vecComponents.empty())
+		{
+			return;
+		}
+
+		std::unique_lock<std::mutex> labelLock;
+		if (pLabelMutex)
+		{
+			labelLock = std::unique_lock<std::mutex>(*pLabelMutex);
+		}
+
+		// Every pair of connected voxels in different chunks has one voxel on a face of its chunk, with the other one
+		// preceding it. Only the faces need to be visited, so inner rows just look at their first and last voxels.
+		for (int32_t iZ = regChunk.getLowerZ(); iZ <= regChunk.getUpperZ(); iZ++)
+		{
+			for (int32_t iY = regChunk.getLowerY(); iY <= regChunk.getUpperY(); iY++)
+			{
+				const bool bWholeRow = (iZ == regChunk.getLowerZ()) || (iZ == regChunk.getUpperZ()) || (iY == regChunk.getLowerY()) || (iY == regChunk.getUpperY());
+				const int32_t iStep = bWholeRow ? 1 : (std::max)(regChunk.getUpperX() - regChunk.getLowerX(), 1);
+				for (int32_t iX = regChunk.getLowerX(); iX <= regChunk.getUpperX(); iX += iStep)
+				{
+					const uint32_t uLabel = m_volLabels->getVoxel(iX, iY, iZ);
+					if (!(uLabel & ProvisionalLabelFlag))
+					{
+						continue;
+					}
+
+					for (const auto& v3dOffset : m_vecPrecedingNeighbours)
+					{
+						const int32_t iNeighbourX = iX + v3dOffset.getX();
+						const int32_t iNeighbourY = iY + v3dOffset.getY();
+						const int32_t iNeighbourZ = iZ + v3dOffset.getZ();
+						if (regChunk.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ) || !region.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ))
+						{
+							continue;
+						}
+
+						const uint32_t uNeighbourLabel = m_volLabels->getVoxel(iNeighbourX, iNeighbourY, iNeighbourZ);
+						if (uNeighbourLabel & ProvisionalLabelFlag)
+						{
+							const ChunkLabels& neighbourChunk = vecChunks[getChunkIndex(region, iNeighbourX, iNeighbourY, iNeighbourZ)];
+							const std::pair<uint32_t, uint32_t> equivalence(chunkLabels.uFirstLabel + (uLabel & ~ProvisionalLabelFlag),
+								neighbourChunk.uFirstLabel + (uNeighbourLabel & ~ProvisionalLabelFlag));
+
+							// Neighbouring voxels on a face usually repeat the same pair.
+							if (chunkLabels.vecEquivalences.empty() || (chunkLabels.vecEquivalences.back() != equivalence))
+							{
+								chunkLabels.vecEquivalences.push_back(equivalence);
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	uint32_t ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::findRoot(std::vector<uint32_t>& vecParents, uint32_t uNode)
+	{
+		// Path halving keeps the trees shallow without needing a second pass.
+		while (vecParents[uNode] != uNode)
+		{
+			vecParents[uNode] = vecParents[vecParents[uNode]];
+			uNode = vecParents[uNode];
+		}
+		return uNode;
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::unite(std::vector<uint32_t>& vecParents, uint32_t uFirst, uint32_t uSecond)
+	{
+		const uint32_t uFirstRoot = findRoot(vecParents, uFirst);
+		const uint32_t uSecondRoot = findRoot(vecParents, uSecond);
+		if (uFirstRoot < uSecondRoot)
+		{
+			vecParents[uSecondRoot] = uFirstRoot;
+		}
+		else
+		{
+			vecParents[uFirstRoot] = uSecondRoot;
+		}
+	}
+
+	// Matches the numbering of the tiles of the RegionScheduler.
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	uint32_t ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::getChunkIndex(const Region& region, int32_t iX, int32_t iY, int32_t iZ) const
+	{
+		const int32_t iLowerChunkX = floorDivide(region.getLowerX(), ConnectedComponentsChunkSideLength);
+		const int32_t iLowerChunkY = floorDivide(region.getLowerY(), ConnectedComponentsChunkSideLength);
+		const int32_t iLowerChunkZ = floorDivide(region.getLowerZ(), ConnectedComponentsChunkSideLength);
+		const int32_t iNoOfChunksX = floorDivide(region.getUpperX(), ConnectedComponentsChunkSideLength) - iLowerChunkX + 1;
+		const int32_t iNoOfChunksY = floorDivide(region.getUpperY(), ConnectedComponentsChunkSideLength) - iLowerChunkY + 1;
+
+		const int32_t iChunkX = floorDivide(iX, ConnectedComponentsChunkSideLength) - iLowerChunkX;
+		const int32_t iChunkY = floorDivide(iY, ConnectedComponentsChunkSideLength) - iLowerChunkY;
+		const int32_t iChunkZ = floorDivide(iZ, ConnectedComponentsChunkSideLength) - iLowerChunkZ;
+		return static_cast<uint32_t>(iChunkX + iNoOfChunksX * (iChunkY + iNoOfChunksY * iChunkZ));
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	uint32_t ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::allocateLabel(void)
+	{
+		uint32_t uLabel;
+		if (!m_setFreeLabels.empty())
+		{
+			uLabel = *m_setFreeLabels.begin();
+			m_setFreeLabels.erase(m_setFreeLabels.begin());
+		}
+		else
+		{
+			POLYVOX_THROW_IF(m_vecComponents.size() >= ProvisionalLabelFlag, std::out_of_range, "There are too many components to label.");
+			uLabel = static_cast<uint32_t>(m_vecComponents.size());
+			m_vecComponents.push_back(ConnectedComponent());
+		}
+
+		m_vecComponents[uLabel] = ConnectedComponent();
+		m_vecComponents[uLabel].uLabel = uLabel;
+		m_uNoOfComponents++;
+		return uLabel;
+	}
+
+	template<typename VolumeType, typename LabelVolumeType, typename IsVoxelSolidCallback>
+	void ConnectedComponentLabeller<VolumeType, LabelVolumeType, IsVoxelSolidCallback>::freeLabel(uint32_t uLabel)
+	{
+		m_vecComponents[uLabel] = ConnectedComponent();
+		m_setFreeLabels.insert(uLabel);
+		m_uNoOfComponents--;
+	}
+}
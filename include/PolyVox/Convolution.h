@@ -0,0 +1,168 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_Convolution_H__
+#define __PolyVox_Convolution_H__
+
+#include "Impl/ConvolutionImpl.h"
+#include "Impl/PlatformDefinitions.h"
+
+#include "Region.h"
+#include "Vector.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+#include <vector>
+
+namespace PolyVox
+{
+	/**
+	 * A kernel which is the product of three one dimensional kernels, one along each axis.
+	 *
+	 * Convolving with a separable kernel only costs the sum of the three kernel lengths per voxel, rather than their
+	 * product, so blurs such as the box and Gaussian filters should always be expressed this way. Each list of weights
+	 * must have an odd length and is centred on the voxel being filtered. The weighted sum is divided by the divisor,
+	 * which allows integer weights to describe fractional kernels.
+	 */
+	template <typename WeightType>
+	class SeparableKernel
+	{
+	public:
+		SeparableKernel(const std::vector<WeightType>& vecWeightsX, const std::vector<WeightType>& vecWeightsY, const std::vector<WeightType>& vecWeightsZ, WeightType tDivisor = WeightType(1));
+
+		const std::vector<WeightType>& getWeightsX(void) const { return m_vecWeightsX; }
+		const std::vector<WeightType>& getWeightsY(void) const { return m_vecWeightsY; }
+		const std::vector<WeightType>& getWeightsZ(void) const { return m_vecWeightsZ; }
+		WeightType getDivisor(void) const { return m_tDivisor; }
+		/// The distance the kernel extends from its centre along each axis.
+		Vector3DInt32 getRadius(void) const;
+
+	private:
+		std::vector<WeightType> m_vecWeightsX;
+		std::vector<WeightType> m_vecWeightsY;
+		std::vector<WeightType> m_vecWeightsZ;
+		WeightType m_tDivisor;
+	};
+
+	/**
+	 * A kernel with an independent weight for every offset in a small box.
+	 *
+	 * The weights are stored with x varying fastest, then y, then z, and each dimension must be odd so that the kernel
+	 * is centred on the voxel being filtered. The cost per voxel is the number of non-zero weights, so this is intended
+	 * for small kernels (such as 3x3x3) which can't be separated.
+	 */
+	template <typename WeightType>
+	class DenseKernel
+	{
+	public:
+		DenseKernel(uint32_t uWidth, uint32_t uHeight, uint32_t uDepth, const std::vector<WeightType>& vecWeights, WeightType tDivisor = WeightType(1));
+
+		/// Gets the weight at the given offset from the centre of the kernel.
+		WeightType getWeight(int32_t iX, int32_t iY, int32_t iZ) const;
+		WeightType getDivisor(void) const { return m_tDivisor; }
+		/// The distance the kernel extends from its centre along each axis.
+		Vector3DInt32 getRadius(void) const { return m_v3dRadius; }
+
+	private:
+		Vector3DInt32 m_v3dRadius;
+		std::vector<WeightType> m_vecWeights;
+		WeightType m_tDivisor;
+	};
+
+	/// Creates a kernel which averages the voxels in a cube, equivalent to the LowPassFilter.
+	template <typename WeightType>
+	SeparableKernel<WeightType> createBoxKernel(uint32_t uSideLength);
+
+	/// Creates a normalised Gaussian blur kernel, truncated at three standard deviations.
+	template <typename WeightType>
+	SeparableKernel<WeightType> createGaussianKernel(float fStandardDeviation);
+
+	/// Creates a kernel which subtracts the six face neighbours from the centre voxel, scaled by \a tAmount.
+	template <typename WeightType>
+	DenseKernel<WeightType> createSharpenKernel(WeightType tAmount = WeightType(1));
+
+	/**
+	 * Applies convolution kernels to a region of one volume and writes the results to another.
+	 *
+	 * The source and destination regions must have the same size. The source region is processed in blocks: each block
+	 * is read (along with the border needed by the kernel) into a dense buffer of \a AccumulationType and then convolved
+	 * with one pass per axis (for separable kernels) or one pass per weight (for dense kernels) over contiguous rows.
+	 * Voxels outside of the source region are read from the source volume as normal.
+	 *
+	 * As with the LowPassFilter, \a AccumulationType should be large enough to hold the weighted sums without overflowing.
+	 * When it is \a float the inner loops use SSE2 or AVX2 if the compiler has been told to target them (see
+	 * PlatformDefinitions.h), and the conversion back to 8 and 16-bit voxels is also vectorised. Results are rounded and
+	 * clamped to the range of integer voxel types. Voxels which are not plain numbers can be supported by specialising
+	 * ConvolutionVoxelTraits, as is done for Density.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	class ConvolutionFilter
+	{
+	public:
+		ConvolutionFilter(SrcVolumeType* pVolSrc, Region regSrc, DstVolumeType* pVolDst, Region regDst, uint32_t uBlockSideLength = 32);
+
+		/// Convolves the source with a separable kernel.
+		void execute(const SeparableKernel<AccumulationType>& kernel);
+		/// Convolves the source with a dense kernel.
+		void execute(const DenseKernel<AccumulationType>& kernel);
+		/// Writes the length of the (Sobel) gradient at each voxel, measured in voxel values per voxel.
+		void executeGradientMagnitude();
+
+	private:
+		typedef typename ConvolutionVoxelTraits<typename SrcVolumeType::VoxelType>::ValueType SrcValueType;
+		typedef typename ConvolutionVoxelTraits<typename DstVolumeType::VoxelType>::ValueType DstValueType;
+
+		// Calls 'function(regSrcBlock, v3dDstLowerCorner)' for each block after reading the block and its border into m_vecPadded.
+		template <typename BlockFunction>
+		void forEachBlock(const Vector3DInt32& v3dRadius, BlockFunction function);
+		// Convolves m_vecPadded with 'kernel' into m_vecResult.
+		void convolveBlock(const SeparableKernel<AccumulationType>& kernel, const Vector3DInt32& v3dBlockSize);
+		void convolveBlock(const DenseKernel<AccumulationType>& kernel, const Vector3DInt32& v3dBlockSize);
+		// Divides m_vecResult by 'tDivisor' and writes it to the destination.
+		void writeBlock(const Vector3DInt32& v3dBlockSize, const Vector3DInt32& v3dDstLowerCorner, AccumulationType tDivisor);
+
+		//Source data
+		SrcVolumeType* m_pVolSrc;
+		Region m_regSrc;
+
+		//Destination data
+		DstVolumeType* m_pVolDst;
+		Region m_regDst;
+
+		uint32_t m_uBlockSideLength;
+
+		// Working storage, kept between blocks.
+		Vector3DInt32 m_v3dPaddedSize;
+		std::vector<AccumulationType> m_vecPadded;
+		std::vector<AccumulationType> m_vecPassX;
+		std::vector<AccumulationType> m_vecPassY;
+		std::vector<AccumulationType> m_vecResult;
+	};
+}
+
+#include "Convolution.inl"
+
+#endif //__PolyVox_Convolution_H__
@@ -0,0 +1,353 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	template <typename WeightType>
+	SeparableKernel<WeightType>::SeparableKernel(const std::vector<WeightType>& vecWeightsX, const std::vector<WeightType>& vecWeightsY, const std::vector<WeightType>& vecWeightsZ, WeightType tDivisor)
+		:m_vecWeightsX(vecWeightsX)
+		, m_vecWeightsY(vecWeightsY)
+		, m_vecWeightsZ(vecWeightsZ)
+		, m_tDivisor(tDivisor)
+	{
+		POLYVOX_THROW_IF((m_vecWeightsX.size() % 2 == 0) || (m_vecWeightsY.size() % 2 == 0) || (m_vecWeightsZ.size() % 2 == 0),
+			std::invalid_argument, "Kernel lengths must be odd");
+		POLYVOX_THROW_IF(m_tDivisor == WeightType(0), std::invalid_argument, "Kernel divisor must not be zero");
+	}
+
+	template <typename WeightType>
+	Vector3DInt32 SeparableKernel<WeightType>::getRadius(void) const
+	{
+		return Vector3DInt32(static_cast<int32_t>(m_vecWeightsX.size() / 2), static_cast<int32_t>(m_vecWeightsY.size() / 2), static_cast<int32_t>(m_vecWeightsZ.size() / 2));
+	}
+
+	template <typename WeightType>
+	DenseKernel<WeightType>::DenseKernel(uint32_t uWidth, uint32_t uHeight, uint32_t uDepth, const std::vector<WeightType>& vecWeights, WeightType tDivisor)
+		:m_v3dRadius(static_cast<int32_t>(uWidth / 2), static_cast<int32_t>(uHeight / 2), static_cast<int32_t>(uDepth / 2))
+		, m_vecWeights(vecWeights)
+		, m_tDivisor(tDivisor)
+	{
+		POLYVOX_THROW_IF((uWidth % 2 == 0) || (uHeight % 2 == 0) || (uDepth % 2 == 0), std::invalid_argument, "Kernel dimensions must be odd");
+		POLYVOX_THROW_IF(m_vecWeights.size() != uWidth * uHeight * uDepth, std::invalid_argument, "Wrong number of kernel weights");
+		POLYVOX_THROW_IF(m_tDivisor == WeightType(0), std::invalid_argument, "Kernel divisor must not be zero");
+	}
+
+	template <typename WeightType>
+	WeightType DenseKernel<WeightType>::getWeight(int32_t iX, int32_t iY, int32_t iZ) const
+	{
+		POLYVOX_ASSERT((std::abs(iX) <= m_v3dRadius.getX()) && (std::abs(iY) <= m_v3dRadius.getY()) && (std::abs(iZ) <= m_v3dRadius.getZ()), "Offset is outside the kernel");
+		const int32_t iWidth = m_v3dRadius.getX() * 2 + 1;
+		const int32_t iHeight = m_v3dRadius.getY() * 2 + 1;
+		return m_vecWeights[(iX + m_v3dRadius.getX()) + (iY + m_v3dRadius.getY()) * iWidth + (iZ + m_v3dRadius.getZ()) * iWidth * iHeight];
+	}
+
+	/**
+	 * The weights are all one and the divisor is the number of voxels in the cube, so integer accumulation types are fine.
+	 */
+	template <typename WeightType>
+	SeparableKernel<WeightType> createBoxKernel(uint32_t uSideLength)
+	{
+		POLYVOX_THROW_IF(uSideLength % 2 == 0, std::invalid_argument, "Kernel side length must be odd");
+		std::vector<WeightType> vecWeights(uSideLength, WeightType(1));
+		return SeparableKernel<WeightType>(vecWeights, vecWeights, vecWeights, static_cast<WeightType>(uSideLength * uSideLength * uSideLength));
+	}
+
+	/**
+	 * The weights are fractional, so this is only available for floating point weight types.
+	 */
+	template <typename WeightType>
+	SeparableKernel<WeightType> createGaussianKernel(float fStandardDeviation)
+	{
+		static_assert(std::is_floating_point<WeightType>::value, "Gaussian kernels need floating point weights");
+		POLYVOX_THROW_IF(!(fStandardDeviation > 0.0f), std::invalid_argument, "Standard deviation must be greater than zero");
+
+		const int32_t iRadius = static_cast<int32_t>(std::ceil(fStandardDeviation * 3.0f));
+		std::vector<WeightType> vecWeights(iRadius * 2 + 1);
+		WeightType tSum(0);
+		for (int32_t iOffset = -iRadius; iOffset <= iRadius; iOffset++)
+		{
+			WeightType tWeight = static_cast<WeightType>(std::exp(-(iOffset * iOffset) / (2.0f * fStandardDeviation * fStandardDeviation)));
+			vecWeights[iOffset + iRadius] = tWeight;
+			tSum += tWeight;
+		}
+		for (auto& tWeight : vecWeights)
+		{
+			tWeight /= tSum;
+		}
+
+		return SeparableKernel<WeightType>(vecWeights, vecWeights, vecWeights);
+	}
+
+	template <typename WeightType>
+	DenseKernel<WeightType> createSharpenKernel(WeightType tAmount)
+	{
+		std::vector<WeightType> vecWeights(27, WeightType(0));
+		vecWeights[13] = WeightType(1) + tAmount * WeightType(6); // Centre
+		vecWeights[12] = vecWeights[14] = -tAmount; // -x, +x
+		vecWeights[10] = vecWeights[16] = -tAmount; // -y, +y
+		vecWeights[4] = vecWeights[22] = -tAmount; // -z, +z
+		return DenseKernel<WeightType>(3, 3, 3, vecWeights);
+	}
+
+	/**
+	 * \param pVolSrc
+	 * \param regSrc
+	 * \param[out] pVolDst
+	 * \param regDst
+	 * \param uBlockSideLength The size of the blocks which the source region is processed in.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::ConvolutionFilter(SrcVolumeType* pVolSrc, Region regSrc, DstVolumeType* pVolDst, Region regDst, uint32_t uBlockSideLength)
+		:m_pVolSrc(pVolSrc)
+		, m_regSrc(regSrc)
+		, m_pVolDst(pVolDst)
+		, m_regDst(regDst)
+		, m_uBlockSideLength(uBlockSideLength)
+	{
+		POLYVOX_THROW_IF(m_regSrc.getDimensionsInVoxels() != m_regDst.getDimensionsInVoxels(), std::invalid_argument, "Source and destination regions must be the same size");
+		POLYVOX_THROW_IF(m_uBlockSideLength == 0, std::invalid_argument, "Block side length must be greater than zero");
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::execute(const SeparableKernel<AccumulationType>& kernel)
+	{
+		forEachBlock(kernel.getRadius(), [&](const Region& regSrcBlock, const Vector3DInt32& v3dDstLowerCorner)
+		{
+			convolveBlock(kernel, regSrcBlock.getDimensionsInVoxels());
+			writeBlock(regSrcBlock.getDimensionsInVoxels(), v3dDstLowerCorner, kernel.getDivisor());
+		});
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::execute(const DenseKernel<AccumulationType>& kernel)
+	{
+		forEachBlock(kernel.getRadius(), [&](const Region& regSrcBlock, const Vector3DInt32& v3dDstLowerCorner)
+		{
+			convolveBlock(kernel, regSrcBlock.getDimensionsInVoxels());
+			writeBlock(regSrcBlock.getDimensionsInVoxels(), v3dDstLowerCorner, kernel.getDivisor());
+		});
+	}
+
+	/**
+	 * Each component of the gradient is a central difference along one axis, smoothed with weights of 1-2-1 along the
+	 * other two axes (the 3D Sobel operator). \a AccumulationType must be signed.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::executeGradientMagnitude()
+	{
+		static_assert(std::is_signed<AccumulationType>::value, "Gradients need a signed accumulation type");
+
+		std::vector<AccumulationType> vecDifference = { AccumulationType(-1), AccumulationType(0), AccumulationType(1) };
+		std::vector<AccumulationType> vecSmooth = { AccumulationType(1), AccumulationType(2), AccumulationType(1) };
+		const AccumulationType tDivisor(32);
+		const SeparableKernel<AccumulationType> kernels[3] =
+		{
+			SeparableKernel<AccumulationType>(vecDifference, vecSmooth, vecSmooth, tDivisor),
+			SeparableKernel<AccumulationType>(vecSmooth, vecDifference, vecSmooth, tDivisor),
+			SeparableKernel<AccumulationType>(vecSmooth, vecSmooth, vecDifference, tDivisor)
+		};
+
+		std::vector<AccumulationType> vecSumOfSquares;
+		forEachBlock(Vector3DInt32(1, 1, 1), [&](const Region& regSrcBlock, const Vector3DInt32& v3dDstLowerCorner)
+		{
+			const Vector3DInt32 v3dBlockSize = regSrcBlock.getDimensionsInVoxels();
+			const uint32_t uBlockVolume = v3dBlockSize.getX() * v3dBlockSize.getY() * v3dBlockSize.getZ();
+			vecSumOfSquares.assign(uBlockVolume, AccumulationType(0));
+
+			for (const auto& kernel : kernels)
+			{
+				convolveBlock(kernel, v3dBlockSize);
+				for (uint32_t ct = 0; ct < uBlockVolume; ct++)
+				{
+					AccumulationType tComponent = m_vecResult[ct] / tDivisor;
+					vecSumOfSquares[ct] += tComponent * tComponent;
+				}
+			}
+
+			for (uint32_t ct = 0; ct < uBlockVolume; ct++)
+			{
+				m_vecResult[ct] = static_cast<AccumulationType>(std::sqrt(static_cast<double>(vecSumOfSquares[ct])));
+			}
+			writeBlock(v3dBlockSize, v3dDstLowerCorner, AccumulationType(1));
+		});
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	template <typename BlockFunction>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::forEachBlock(const Vector3DInt32& v3dRadius, BlockFunction function)
+	{
+		const int32_t iBlockSideLength = static_cast<int32_t>(m_uBlockSideLength);
+		const Vector3DInt32 v3dSrcToDst = m_regDst.getLowerCorner() - m_regSrc.getLowerCorner();
+
+		typename SrcVolumeType::Sampler srcSampler(m_pVolSrc);
+
+		for (int32_t iBlockZ = m_regSrc.getLowerZ(); iBlockZ <= m_regSrc.getUpperZ(); iBlockZ += iBlockSideLength)
+		{
+			for (int32_t iBlockY = m_regSrc.getLowerY(); iBlockY <= m_regSrc.getUpperY(); iBlockY += iBlockSideLength)
+			{
+				for (int32_t iBlockX = m_regSrc.getLowerX(); iBlockX <= m_regSrc.getUpperX(); iBlockX += iBlockSideLength)
+				{
+					Region regSrcBlock(iBlockX, iBlockY, iBlockZ, iBlockX + iBlockSideLength - 1, iBlockY + iBlockSideLength - 1, iBlockZ + iBlockSideLength - 1);
+					regSrcBlock.cropTo(m_regSrc);
+
+					Region regPadded = regSrcBlock;
+					regPadded.grow(v3dRadius);
+					m_v3dPaddedSize = regPadded.getDimensionsInVoxels();
+					m_vecPadded.resize(m_v3dPaddedSize.getX() * m_v3dPaddedSize.getY() * m_v3dPaddedSize.getZ());
+
+					AccumulationType* pPadded = &m_vecPadded[0];
+					for (int32_t iZ = regPadded.getLowerZ(); iZ <= regPadded.getUpperZ(); iZ++)
+					{
+						for (int32_t iY = regPadded.getLowerY(); iY <= regPadded.getUpperY(); iY++)
+						{
+							srcSampler.setPosition(regPadded.getLowerX(), iY, iZ);
+							for (int32_t iX = regPadded.getLowerX(); iX <= regPadded.getUpperX(); iX++)
+							{
+								*pPadded++ = static_cast<AccumulationType>(ConvolutionVoxelTraits<typename SrcVolumeType::VoxelType>::toValue(srcSampler.getVoxel()));
+								srcSampler.movePositiveX();
+							}
+						}
+					}
+
+					function(regSrcBlock, regSrcBlock.getLowerCorner() + v3dSrcToDst);
+				}
+			}
+		}
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::convolveBlock(const SeparableKernel<AccumulationType>& kernel, const Vector3DInt32& v3dBlockSize)
+	{
+		const uint32_t uWidth = v3dBlockSize.getX();
+		const uint32_t uHeight = v3dBlockSize.getY();
+		const uint32_t uDepth = v3dBlockSize.getZ();
+		const uint32_t uPaddedWidth = m_v3dPaddedSize.getX();
+		const uint32_t uPaddedHeight = m_v3dPaddedSize.getY();
+		const uint32_t uPaddedDepth = m_v3dPaddedSize.getZ();
+
+		// Along x, from padded rows into rows of the final width.
+		const std::vector<AccumulationType>& vecWeightsX = kernel.getWeightsX();
+		m_vecPassX.assign(uWidth * uPaddedHeight * uPaddedDepth, AccumulationType(0));
+		for (uint32_t uRow = 0; uRow < uPaddedHeight * uPaddedDepth; uRow++)
+		{
+			for (uint32_t uWeight = 0; uWeight < vecWeightsX.size(); uWeight++)
+			{
+				if (vecWeightsX[uWeight] != AccumulationType(0))
+				{
+					multiplyAdd(&m_vecPassX[uRow * uWidth], &m_vecPadded[uRow * uPaddedWidth + uWeight], vecWeightsX[uWeight], uWidth);
+				}
+			}
+		}
+
+		// Along y. For a given weight the rows needed by a whole slice are contiguous, so each slice is one long run.
+		const std::vector<AccumulationType>& vecWeightsY = kernel.getWeightsY();
+		m_vecPassY.assign(uWidth * uHeight * uPaddedDepth, AccumulationType(0));
+		for (uint32_t uZ = 0; uZ < uPaddedDepth; uZ++)
+		{
+			for (uint32_t uWeight = 0; uWeight < vecWeightsY.size(); uWeight++)
+			{
+				if (vecWeightsY[uWeight] != AccumulationType(0))
+				{
+					multiplyAdd(&m_vecPassY[uZ * uWidth * uHeight], &m_vecPassX[(uZ * uPaddedHeight + uWeight) * uWidth], vecWeightsY[uWeight], uWidth * uHeight);
+				}
+			}
+		}
+
+		// Along z, one slice at a time.
+		const std::vector<AccumulationType>& vecWeightsZ = kernel.getWeightsZ();
+		const uint32_t uSliceSize = uWidth * uHeight;
+		m_vecResult.assign(uSliceSize * uDepth, AccumulationType(0));
+		for (uint32_t uZ = 0; uZ < uDepth; uZ++)
+		{
+			for (uint32_t uWeight = 0; uWeight < vecWeightsZ.size(); uWeight++)
+			{
+				if (vecWeightsZ[uWeight] != AccumulationType(0))
+				{
+					multiplyAdd(&m_vecResult[uZ * uSliceSize], &m_vecPassY[(uZ + uWeight) * uSliceSize], vecWeightsZ[uWeight], uSliceSize);
+				}
+			}
+		}
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::convolveBlock(const DenseKernel<AccumulationType>& kernel, const Vector3DInt32& v3dBlockSize)
+	{
+		const uint32_t uWidth = v3dBlockSize.getX();
+		const uint32_t uHeight = v3dBlockSize.getY();
+		const uint32_t uDepth = v3dBlockSize.getZ();
+		const uint32_t uPaddedWidth = m_v3dPaddedSize.getX();
+		const uint32_t uPaddedHeight = m_v3dPaddedSize.getY();
+		const Vector3DInt32 v3dRadius = kernel.getRadius();
+
+		m_vecResult.assign(uWidth * uHeight * uDepth, AccumulationType(0));
+		for (int32_t iOffsetZ = -v3dRadius.getZ(); iOffsetZ <= v3dRadius.getZ(); iOffsetZ++)
+		{
+			for (int32_t iOffsetY = -v3dRadius.getY(); iOffsetY <= v3dRadius.getY(); iOffsetY++)
+			{
+				for (int32_t iOffsetX = -v3dRadius.getX(); iOffsetX <= v3dRadius.getX(); iOffsetX++)
+				{
+					const AccumulationType tWeight = kernel.getWeight(iOffsetX, iOffsetY, iOffsetZ);
+					if (tWeight == AccumulationType(0))
+					{
+						continue;
+					}
+
+					for (uint32_t uZ = 0; uZ < uDepth; uZ++)
+					{
+						for (uint32_t uY = 0; uY < uHeight; uY++)
+						{
+							const uint32_t uPaddedX = iOffsetX + v3dRadius.getX();
+							const uint32_t uPaddedY = uY + iOffsetY + v3dRadius.getY();
+							const uint32_t uPaddedZ = uZ + iOffsetZ + v3dRadius.getZ();
+							multiplyAdd(&m_vecResult[(uZ * uHeight + uY) * uWidth], &m_vecPadded[(uPaddedZ * uPaddedHeight + uPaddedY) * uPaddedWidth + uPaddedX], tWeight, uWidth);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void ConvolutionFilter<SrcVolumeType, DstVolumeType, AccumulationType>::writeBlock(const Vector3DInt32& v3dBlockSize, const Vector3DInt32& v3dDstLowerCorner, AccumulationType tDivisor)
+	{
+		const uint32_t uWidth = v3dBlockSize.getX();
+		std::vector<DstValueType> vecValues(uWidth);
+
+		const AccumulationType* pResult = &m_vecResult[0];
+		for (int32_t iZ = 0; iZ < v3dBlockSize.getZ(); iZ++)
+		{
+			for (int32_t iY = 0; iY < v3dBlockSize.getY(); iY++)
+			{
+				convertAccumulatedRow(pResult, &vecValues[0], uWidth, tDivisor);
+				pResult += uWidth;
+
+				for (uint32_t uX = 0; uX < uWidth; uX++)
+				{
+					m_pVolDst->setVoxel(v3dDstLowerCorner.getX() + static_cast<int32_t>(uX), v3dDstLowerCorner.getY() + iY, v3dDstLowerCorner.getZ() + iZ,
+						ConvolutionVoxelTraits<typename DstVolumeType::VoxelType>::fromValue(vecValues[uX]));
+				}
+			}
+		}
+	}
+}
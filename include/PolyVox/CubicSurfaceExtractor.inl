@@ -276,28 +276,10 @@ namespace PolyVox
 		return result;
 	}
 
-	/// This version of the function performs the extraction into a user-provided mesh rather than allocating a mesh automatically.
-	/// There are a few reasons why this might be useful to more advanced users:
-	///
-	///   1. It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
-	///   2. The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
-	///   3. The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
-	///
-	/// We don't provide a default MeshType here. If the user doesn't want to provide a MeshType then it probably makes
-	/// more sense to use the other variant of this function where the mesh is a return value rather than a parameter.
-	///
-	/// Note: This function is called 'extractCubicMeshCustom' rather than 'extractCubicMesh' to avoid ambiguity when only three parameters
-	/// are provided (would the third parameter be a controller or a mesh?). It seems this can be fixed by using enable_if/static_assert to emulate concepts,
-	/// but this is relatively complex and I haven't done it yet. Could always add it later as another overload.
-	template<typename VolumeType, typename MeshType, typename IsQuadNeeded, typename ContributeToAO>
-	void extractCubicMeshCustom(VolumeType* volData, Region region, MeshType* result, IsQuadNeeded isQuadNeeded, ContributeToAO contributeToAO, bool bMergeQuads)
+	// Does the work for extractCubicMeshCustom(), using whichever kind of sampler it has chosen.
+	template<typename SamplerType, typename VolumeType, typename MeshType, typename IsQuadNeeded, typename ContributeToAO>
+	void extractCubicMeshWithSampler(VolumeType* volData, Region region, MeshType* result, IsQuadNeeded isQuadNeeded, ContributeToAO contributeToAO, bool bMergeQuads)
 	{
-		// This extractor has a limit as to how large the extracted region can be, because the vertex positions are encoded with a single byte per component.
-		int32_t maxReionDimensionInVoxels = 255;
-		POLYVOX_THROW_IF(region.getWidthInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
-		POLYVOX_THROW_IF(region.getHeightInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
-		POLYVOX_THROW_IF(region.getDepthInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
-
 		Timer timer;
 		result->clear();
 
@@ -322,7 +304,7 @@ namespace PolyVox
 		m_vecQuads[NegativeZ].resize(region.getUpperZ() - region.getLowerZ() + 2);
 		m_vecQuads[PositiveZ].resize(region.getUpperZ() - region.getLowerZ() + 2);
 
-		typename VolumeType::Sampler volumeSampler(volData);
+		SamplerType volumeSampler(volData);
 
 		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
 		{
@@ -555,4 +537,39 @@ namespace PolyVox
 			"ms (Region size = ", m_regSizeInVoxels.getWidthInVoxels(), "x", m_regSizeInVoxels.getHeightInVoxels(),
 			"x", m_regSizeInVoxels.getDepthInVoxels(), ")");
 	}
+
+	/// This version of the function performs the extraction into a user-provided mesh rather than allocating a mesh automatically.
+	/// There are a few reasons why this might be useful to more advanced users:
+	///
+	///   1. It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
+	///   2. The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
+	///   3. The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
+	///
+	/// We don't provide a default MeshType here. If the user doesn't want to provide a MeshType then it probably makes
+	/// more sense to use the other variant of this function where the mesh is a return value rather than a parameter.
+	///
+	/// Note: This function is called 'extractCubicMeshCustom' rather than 'extractCubicMesh' to avoid ambiguity when only three parameters
+	/// are provided (would the third parameter be a controller or a mesh?). It seems this can be fixed by using enable_if/static_assert to emulate concepts,
+	/// but this is relatively complex and I haven't done it yet. Could always add it later as another overload.
+	template<typename VolumeType, typename MeshType, typename IsQuadNeeded, typename ContributeToAO>
+	void extractCubicMeshCustom(VolumeType* volData, Region region, MeshType* result, IsQuadNeeded isQuadNeeded, ContributeToAO contributeToAO, bool bMergeQuads)
+	{
+		// This extractor has a limit as to how large the extracted region can be, because the vertex positions are encoded with a single byte per component.
+		int32_t maxReionDimensionInVoxels = 255;
+		POLYVOX_THROW_IF(region.getWidthInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
+		POLYVOX_THROW_IF(region.getHeightInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
+		POLYVOX_THROW_IF(region.getDepthInVoxels() > maxReionDimensionInVoxels, std::invalid_argument, "Requested extraction region exceeds maximum dimensions");
+
+		// Faces and ambient occlusion look one voxel beyond the region. If that is all inside the volume then the sampler doesn't need to check its bounds.
+		Region regAccessed(region);
+		regAccessed.grow(1);
+		if (UncheckedSamplerType<VolumeType>::isUsable(volData, regAccessed))
+		{
+			extractCubicMeshWithSampler<typename UncheckedSamplerType<VolumeType>::type>(volData, region, result, isQuadNeeded, contributeToAO, bMergeQuads);
+		}
+		else
+		{
+			extractCubicMeshWithSampler<typename VolumeType::Sampler>(volData, region, result, isQuadNeeded, contributeToAO, bMergeQuads);
+		}
+	}
 }
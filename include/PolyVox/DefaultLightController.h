@@ -0,0 +1,60 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_DefaultLightController_H__
+#define __PolyVox_DefaultLightController_H__
+
+#include "Impl/PlatformDefinitions.h"
+
+#include <cstdint>
+
+namespace PolyVox
+{
+	/// Default implementation of the controller used by the LightPropagator.
+	///
+	/// The controller decides which voxels let light through and which voxels
+	/// emit light of their own. By default a voxel is transparent if it compares
+	/// equal to a default constructed voxel (typically zero, meaning empty space)
+	/// and no voxels emit light, so only sky light will be present. Users will
+	/// normally provide their own controller which knows about their materials.
+	template<typename VoxelType>
+	class DefaultLightController
+	{
+	public:
+		/// Returns true if light can pass through the given voxel.
+		bool isTransparent(VoxelType voxel) const
+		{
+			return voxel == VoxelType();
+		}
+
+		/// Returns the level of block light (from zero to 15) emitted by the given voxel.
+		uint8_t getEmittedLight(VoxelType voxel) const
+		{
+			POLYVOX_UNUSED(voxel);
+			return 0;
+		}
+	};
+}
+
+#endif //__PolyVox_DefaultLightController_H__
@@ -0,0 +1,102 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_DistanceField_H__
+#define __PolyVox_DistanceField_H__
+
+#include "Impl/PlatformDefinitions.h"
+
+#include "Region.h"
+#include "RegionScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace PolyVox
+{
+	/**
+	 * \file
+	 *
+	 * Distance fields
+	 *
+	 * These functions compute, for every voxel in a region, the Euclidean distance (measured in voxels) to the nearest voxel which
+	 * is 'inside' according to a user supplied callback. The callback takes a \a VoxelType and returns a \a bool, so binary
+	 * volumes can test against zero while density volumes can compare against a threshold. The results are written to the same
+	 * positions in a destination volume, which would normally store floats.
+	 *
+	 * The distances are exact. They are computed with a separable distance transform (Felzenszwalb and Huttenlocher, 'Distance
+	 * Transforms of Sampled Functions') which makes one pass along each axis, and each pass is shared between the threads of a
+	 * RegionScheduler slice by slice. Each function can be given an existing scheduler, or a number of threads to create one
+	 * with. The source is locked while each slice is read unless it reports \a SupportsConcurrentReads, and the destination is
+	 * locked while each slice is written unless it reports \a SupportsConcurrentWrites (RawVolume does both).
+	 *
+	 * Distances can be capped at \a fMaxDistance. Beyond being useful in its own right (e.g. for a narrow band around a surface)
+	 * this is what allows the update functions to be cheap: after an edit only voxels within \a fMaxDistance of the change can
+	 * have a different value, and only voxels within twice that distance need to be read in order to compute them.
+	 */
+
+	/// Computes the distance from each voxel in \a region to the nearest inside voxel, which is zero for inside voxels.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance = (std::numeric_limits<float>::max)(), uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, RegionScheduler& scheduler);
+
+	/// Computes a signed distance field for \a region, which is negative inside and positive outside with the surface lying halfway between voxel centres.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance = (std::numeric_limits<float>::max)(), uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, RegionScheduler& scheduler);
+
+	/// Updates a field computed by calculateDistanceField() for \a regBounds after the voxels in \a regChanged have been modified.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, RegionScheduler& scheduler);
+
+	/// Updates a field computed by calculateSignedDistanceField() for \a regBounds after the voxels in \a regChanged have been modified.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside,
+		float fMaxDistance, RegionScheduler& scheduler);
+}
+
+#include "DistanceField.inl"
+
+#endif //__PolyVox_DistanceField_H__
@@ -0,0 +1,359 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	// Computes the squared distance transform of a single row of samples, in place. Samples which are zero are sites and those
+	// which are FLT_MAX are not. The scratch buffers must have space for 'uLength' (pSites, pValues) and 'uLength + 1' (pBoundaries)
+	// elements. This is the lower envelope of parabolas algorithm from Felzenszwalb and Huttenlocher, but it skips samples which
+	// have no distance yet so that they can't cause precision problems.
+	inline void distanceTransformRow(float* pData, uint32_t uLength, uint32_t uStride, int32_t* pSites, float* pValues, float* pBoundaries)
+	{
+		const float fInfinity = (std::numeric_limits<float>::max)();
+
+		int32_t k = -1;
+		for (int32_t q = 0; q < static_cast<int32_t>(uLength); q++)
+		{
+			const float fValue = pData[q * uStride];
+			pValues[q] = fValue;
+			if (fValue == fInfinity)
+			{
+				continue;
+			}
+
+			if (k < 0)
+			{
+				k = 0;
+				pSites[0] = q;
+				pBoundaries[0] = -fInfinity;
+				pBoundaries[1] = fInfinity;
+				continue;
+			}
+
+			// Find where the parabola from this sample overtakes those already in the envelope. The first boundary
+			// is minus infinity so this always stops by the time it reaches the first parabola.
+			float s;
+			for (;;)
+			{
+				const int32_t p = pSites[k];
+				s = ((fValue + static_cast<float>(q * q)) - (pValues[p] + static_cast<float>(p * p))) / static_cast<float>(2 * q - 2 * p);
+				if (s > pBoundaries[k])
+				{
+					break;
+				}
+				k--;
+			}
+
+			k++;
+			pSites[k] = q;
+			pBoundaries[k] = s;
+			pBoundaries[k + 1] = fInfinity;
+		}
+
+		if (k < 0)
+		{
+			// No sites in this row, so there is nothing to do.
+			return;
+		}
+
+		k = 0;
+		for (int32_t q = 0; q < static_cast<int32_t>(uLength); q++)
+		{
+			while (pBoundaries[k + 1] < static_cast<float>(q))
+			{
+				k++;
+			}
+			const int32_t p = pSites[k];
+			pData[q * uStride] = static_cast<float>((q - p) * (q - p)) + pValues[p];
+		}
+	}
+
+	// The scratch buffers used by distanceTransformRow(), which each worker allocates once for all of its rows.
+	struct DistanceTransformScratch
+	{
+		explicit DistanceTransformScratch(uint32_t uMaxLength)
+			:vecSites(uMaxLength)
+			, vecValues(uMaxLength)
+			, vecBoundaries(uMaxLength + 1)
+		{
+		}
+
+		std::vector<int32_t> vecSites;
+		std::vector<float> vecValues;
+		std::vector<float> vecBoundaries;
+	};
+
+	// Applies distanceTransformRow() along each axis of a block of squared distances, sharing the rows between threads.
+	inline void distanceTransformBlock(float* pData, uint32_t uWidth, uint32_t uHeight, uint32_t uDepth, RegionScheduler& scheduler)
+	{
+		const uint32_t uMaxLength = (std::max)(uWidth, (std::max)(uHeight, uDepth));
+		const uint32_t uSliceSize = uWidth * uHeight;
+		WorkerLocal<DistanceTransformScratch> workerScratch(scheduler, uMaxLength);
+
+		// Along x and then y, one slice of constant z per task.
+		scheduler.forEachTask(uDepth, [&](uint32_t uZ, uint32_t uWorker)
+		{
+			DistanceTransformScratch& scratch = workerScratch.get(uWorker);
+			float* pSlice = pData + uZ * uSliceSize;
+			for (uint32_t uY = 0; uY < uHeight; uY++)
+			{
+				distanceTransformRow(pSlice + uY * uWidth, uWidth, 1, scratch.vecSites.data(), scratch.vecValues.data(), scratch.vecBoundaries.data());
+			}
+			for (uint32_t uX = 0; uX < uWidth; uX++)
+			{
+				distanceTransformRow(pSlice + uX, uHeight, uWidth, scratch.vecSites.data(), scratch.vecValues.data(), scratch.vecBoundaries.data());
+			}
+		});
+
+		// Along z, one slice of constant y per task.
+		scheduler.forEachTask(uHeight, [&](uint32_t uY, uint32_t uWorker)
+		{
+			DistanceTransformScratch& scratch = workerScratch.get(uWorker);
+			for (uint32_t uX = 0; uX < uWidth; uX++)
+			{
+				distanceTransformRow(pData + uY * uWidth + uX, uDepth, uSliceSize, scratch.vecSites.data(), scratch.vecValues.data(), scratch.vecBoundaries.data());
+			}
+		});
+	}
+
+	// Does the work for all of the public functions. Sites are read from 'regInput' and distances are written for 'regOutput',
+	// which must be contained in 'regInput'. Voxels outside of 'regInput' are ignored completely.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void computeDistanceField(SrcVolumeType* volSrc, const Region& regInput, DstVolumeType* volDst, const Region& regOutput, IsVoxelInsideCallback isVoxelInside,
+		bool bSigned, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		POLYVOX_THROW_IF(!regInput.containsRegion(regOutput), std::invalid_argument, "The output region must be inside the input region.");
+
+		typedef typename DstVolumeType::VoxelType DstVoxelType;
+
+		const uint32_t uWidth = regInput.getWidthInVoxels();
+		const uint32_t uHeight = regInput.getHeightInVoxels();
+		const uint32_t uDepth = regInput.getDepthInVoxels();
+		const uint32_t uSliceSize = uWidth * uHeight;
+
+		VolumeLocks<SrcVolumeType, DstVolumeType> locks(scheduler, volSrc, volDst);
+
+		// Classify the input voxels once, so the source is only read a single time even for signed fields.
+		std::vector<uint8_t> vecInside(uSliceSize * uDepth);
+		scheduler.forEachTask(uDepth, [&](uint32_t uZ, uint32_t /*uWorker*/)
+		{
+			std::unique_lock<std::mutex> srcLock;
+			if (locks.getSrcMutex())
+			{
+				srcLock = std::unique_lock<std::mutex>(*locks.getSrcMutex());
+			}
+
+			typename SrcVolumeType::Sampler sampler(volSrc);
+			uint8_t* pInside = &vecInside[uZ * uSliceSize];
+			for (uint32_t uY = 0; uY < uHeight; uY++)
+			{
+				sampler.setPosition(regInput.getLowerX(), regInput.getLowerY() + uY, regInput.getLowerZ() + uZ);
+				for (uint32_t uX = 0; uX < uWidth; uX++)
+				{
+					*pInside++ = isVoxelInside(sampler.getVoxel()) ? 1 : 0;
+					sampler.movePositiveX();
+				}
+			}
+		});
+
+		// For a signed field the first pass measures the distance to inside voxels and fills in the outside voxels, while the
+		// second pass measures the distance to outside voxels and fills in the inside voxels. They never write the same voxel.
+		const float fInfinity = (std::numeric_limits<float>::max)();
+		std::vector<float> vecDistances(uSliceSize * uDepth);
+		const uint32_t uNoOfPasses = bSigned ? 2 : 1;
+		for (uint32_t uPass = 0; uPass < uNoOfPasses; uPass++)
+		{
+			const uint8_t uSiteValue = (uPass == 0) ? 1 : 0;
+			for (uint32_t ct = 0; ct < vecDistances.size(); ct++)
+			{
+				vecDistances[ct] = (vecInside[ct] == uSiteValue) ? 0.0f : fInfinity;
+			}
+
+			distanceTransformBlock(vecDistances.data(), uWidth, uHeight, uDepth, scheduler);
+
+			const uint32_t uOutputOffsetX = regOutput.getLowerX() - regInput.getLowerX();
+			const uint32_t uOutputOffsetY = regOutput.getLowerY() - regInput.getLowerY();
+			const uint32_t uOutputOffsetZ = regOutput.getLowerZ() - regInput.getLowerZ();
+			scheduler.forEachTask(regOutput.getDepthInVoxels(), [&](uint32_t uOutputZ, uint32_t /*uWorker*/)
+			{
+				std::unique_lock<std::mutex> dstLock;
+				if (locks.getDstMutex())
+				{
+					dstLock = std::unique_lock<std::mutex>(*locks.getDstMutex());
+				}
+
+				const uint32_t uZ = uOutputOffsetZ + uOutputZ;
+				for (uint32_t uY = uOutputOffsetY; uY < uOutputOffsetY + regOutput.getHeightInVoxels(); uY++)
+				{
+					uint32_t uIndex = uOutputOffsetX + uY * uWidth + uZ * uSliceSize;
+					for (int32_t iX = regOutput.getLowerX(); iX <= regOutput.getUpperX(); iX++, uIndex++)
+					{
+						if (bSigned && (vecInside[uIndex] == uSiteValue))
+						{
+							continue;
+						}
+
+						float fDistance = std::sqrt(vecDistances[uIndex]);
+						if (bSigned)
+						{
+							// Move the surface from the centres of the voxels to the faces between them.
+							fDistance -= 0.5f;
+						}
+						fDistance = (std::min)(fDistance, fMaxDistance);
+						if (uPass == 1)
+						{
+							fDistance = -fDistance;
+						}
+
+						volDst->setVoxel(iX, regInput.getLowerY() + uY, regInput.getLowerZ() + uZ, static_cast<DstVoxelType>(fDistance));
+					}
+				}
+			});
+		}
+	}
+
+	// Works out what needs recomputing after an edit, as described at the top of DistanceField.h.
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateDistanceFieldImpl(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside,
+		bool bSigned, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		if (!(fMaxDistance < static_cast<float>(regBounds.getWidthInVoxels() + regBounds.getHeightInVoxels() + regBounds.getDepthInVoxels())))
+		{
+			// The maximum distance doesn't bound anything, so the whole field has to be recomputed.
+			computeDistanceField(volSrc, regBounds, volDst, regBounds, isVoxelInside, bSigned, fMaxDistance, scheduler);
+			return;
+		}
+
+		// The extra voxel accounts for signed distances being measured to the faces rather than the centres of voxels.
+		const int32_t iRadius = static_cast<int32_t>(std::ceil(fMaxDistance)) + 1;
+
+		Region regOutput = regChanged;
+		regOutput.grow(iRadius);
+		if (!intersects(regOutput, regBounds))
+		{
+			return;
+		}
+		regOutput.cropTo(regBounds);
+
+		Region regInput = regOutput;
+		regInput.grow(iRadius);
+		regInput.cropTo(regBounds);
+
+		computeDistanceField(volSrc, regInput, volDst, regOutput, isVoxelInside, bSigned, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * \param volSrc The volume containing the voxels to measure the distance to
+	 * \param[out] volDst The volume to write the distances into. It must contain \a region.
+	 * \param region The region to compute distances for. Voxels outside this region are ignored.
+	 * \param isVoxelInside A callback which takes a \a VoxelType and returns a \a bool indicating whether the voxel is inside
+	 * \param fMaxDistance Distances greater than this are replaced by it
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		calculateDistanceField(volSrc, volDst, region, isVoxelInside, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * As above, but sharing the work between the threads of an existing scheduler.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		computeDistanceField(volSrc, region, volDst, region, isVoxelInside, false, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * Inside voxels receive the (negative) distance to the nearest outside voxel, and outside voxels receive the distance to
+	 * the nearest inside voxel. In both cases half a voxel is subtracted, so that voxels either side of the surface have
+	 * values of -0.5 and +0.5 and the zero crossing matches the faces generated by the CubicSurfaceExtractor.
+	 *
+	 * \param volSrc The volume containing the voxels to measure the distance to
+	 * \param[out] volDst The volume to write the distances into. It must contain \a region.
+	 * \param region The region to compute distances for. Voxels outside this region are ignored.
+	 * \param isVoxelInside A callback which takes a \a VoxelType and returns a \a bool indicating whether the voxel is inside
+	 * \param fMaxDistance Distances greater than this (in either direction) are replaced by it
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		calculateSignedDistanceField(volSrc, volDst, region, isVoxelInside, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * As above, but sharing the work between the threads of an existing scheduler.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void calculateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& region, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		computeDistanceField(volSrc, region, volDst, region, isVoxelInside, true, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * The result is the same as calling calculateDistanceField() for the whole of \a regBounds again, but only the
+	 * voxels within \a fMaxDistance of \a regChanged are recomputed. The same \a fMaxDistance must be used as when the
+	 * field was first calculated.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		updateDistanceField(volSrc, volDst, regBounds, regChanged, isVoxelInside, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * As above, but sharing the work between the threads of an existing scheduler.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		updateDistanceFieldImpl(volSrc, volDst, regBounds, regChanged, isVoxelInside, false, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * The result is the same as calling calculateSignedDistanceField() for the whole of \a regBounds again, but only the
+	 * voxels within \a fMaxDistance of \a regChanged are recomputed. The same \a fMaxDistance must be used as when the
+	 * field was first calculated.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		updateSignedDistanceField(volSrc, volDst, regBounds, regChanged, isVoxelInside, fMaxDistance, scheduler);
+	}
+
+	/**
+	 * As above, but sharing the work between the threads of an existing scheduler.
+	 */
+	template<typename SrcVolumeType, typename DstVolumeType, typename IsVoxelInsideCallback>
+	void updateSignedDistanceField(SrcVolumeType* volSrc, DstVolumeType* volDst, const Region& regBounds, const Region& regChanged, IsVoxelInsideCallback isVoxelInside, float fMaxDistance, RegionScheduler& scheduler)
+	{
+		updateDistanceFieldImpl(volSrc, volDst, regBounds, regChanged, isVoxelInside, true, fMaxDistance, scheduler);
+	}
+}
@@ -30,9 +30,12 @@
 #include "PagedVolume.h"
 #include "Region.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <cstring>
 #include <fstream>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -46,15 +49,20 @@ namespace PolyVox
 	 * Note that no compression is performed (mostly to avoid dependancies) so for large
 	 * volumes you may want to consider this class as an example and create a custom version
 	 * with compression.
+	 *
+	 * Alternatively, chunks can be deduplicated so that identical chunks (such as those which
+	 * are entirely empty) are only stored once. In this case the file for each chunk just holds
+	 * the name of a second file containing its voxels, which is shared with identical chunks.
 	 */
 	template <typename VoxelType>
 	class FilePager : public PagedVolume<VoxelType>::Pager
 	{
 	public:
 		/// Constructor
-		FilePager(const std::string& strFolderName = ".")
+		FilePager(const std::string& strFolderName = ".", bool bDeduplicateChunks = false)
 			:PagedVolume<VoxelType>::Pager()
 			, m_strFolderName(strFolderName)
+			, m_bDeduplicateChunks(bDeduplicateChunks)
 		{
 				// Add the trailing slash, assuming the user dind't already do it.
 				if ((m_strFolderName.back() != '/') && (m_strFolderName.back() != '\\'))
@@ -86,13 +94,7 @@ namespace PolyVox
 			POLYVOX_ASSERT(pChunk, "Attempting to page in NULL chunk");
 			POLYVOX_ASSERT(pChunk->getData(), "Chunk must have valid data");
 
-			std::stringstream ssFilename;
-			ssFilename << m_strFolderName << "/"
-				<< region.getLowerX() << "_" << region.getLowerY() << "_" << region.getLowerZ() << "_"
-				<< region.getUpperX() << "_" << region.getUpperY() << "_" << region.getUpperZ()
-				<< "--" << m_strPostfix;
-
-			std::string filename = ssFilename.str();
+			std::string filename = getFilename(region, "");
 
 			// FIXME - This should be replaced by C++ style IO, but currently this causes problems with
 			// the gameplay-cubiquity integration. See: https://github.com/blackberry/GamePlay/issues/919
@@ -111,6 +113,18 @@ namespace PolyVox
 				pChunk->setData(buffer, fileSizeInBytes);
 				delete[] buffer;*/
 
+				if (m_bDeduplicateChunks)
+				{
+					// The file just names the one holding the voxels.
+					fclose(pFile);
+					filename = readDataFileName(filename);
+					pFile = fopen(filename.c_str(), "rb");
+					if (!pFile)
+					{
+						POLYVOX_THROW(std::runtime_error, "Unable to open file containing deduplicated chunk data.");
+					}
+				}
+
 				fread(pChunk->getData(), sizeof(uint8_t), pChunk->getDataSizeInBytes(), pFile);
 
 				if (ferror(pFile))
@@ -138,14 +152,165 @@ namespace PolyVox
 
 			POLYVOX_LOG_TRACE("Paging out data for ", region);
 
-			std::stringstream ssFilename;
-			ssFilename << m_strFolderName << "/"
-				<< region.getLowerX() << "_" << region.getLowerY() << "_" << region.getLowerZ() << "_"
-				<< region.getUpperX() << "_" << region.getUpperY() << "_" << region.getUpperZ()
-				<< "--" << m_strPostfix;
+			std::string filename = getFilename(region, "");
+
+			if (m_bDeduplicateChunks)
+			{
+				pageOutDeduplicated(filename, pChunk->getData(), pChunk->getDataSizeInBytes());
+			}
+			else
+			{
+				writeFile(filename, pChunk->getData(), pChunk->getDataSizeInBytes());
+			}
+		}
+
+		virtual bool pageInLod(const Region& region, VoxelType* pData, uint32_t uDataSizeInBytes)
+		{
+			std::string filename = getFilename(region, "-lod");
+
+			FILE* pFile = fopen(filename.c_str(), "rb");
+			if (!pFile)
+			{
+				return false;
+			}
+
+			// Data written with a different number of LOD levels is ignored, and will be rebuilt.
+			fseek(pFile, 0L, SEEK_END);
+			bool bSizeMatches = (ftell(pFile) == static_cast<long>(uDataSizeInBytes));
+			fseek(pFile, 0L, SEEK_SET);
+			if (bSizeMatches)
+			{
+				POLYVOX_LOG_TRACE("Paging in LOD data for ", region);
+				fread(pData, sizeof(uint8_t), uDataSizeInBytes, pFile);
+				if (ferror(pFile))
+				{
+					POLYVOX_THROW(std::runtime_error, "Error reading in LOD data, even though a file exists.");
+				}
+			}
+
+			fclose(pFile);
+			return bSizeMatches;
+		}
+
+		virtual void pageOutLod(const Region& region, const VoxelType* pData, uint32_t uDataSizeInBytes)
+		{
+			POLYVOX_LOG_TRACE("Paging out LOD data for ", region);
+
+			std::string filename = getFilename(region, "-lod");
+
+			FILE* pFile = fopen(filename.c_str(), "wb");
+			if (!pFile)
+			{
+				POLYVOX_THROW(std::runtime_error, "Unable to open file to write out LOD data.");
+			}
+
+			if (std::find(m_vecCreatedFiles.begin(), m_vecCreatedFiles.end(), filename) == m_vecCreatedFiles.end())
+			{
+				m_vecCreatedFiles.push_back(filename);
+			}
+
+			fwrite(pData, sizeof(uint8_t), uDataSizeInBytes, pFile);
+
+			if (ferror(pFile))
+			{
+				POLYVOX_THROW(std::runtime_error, "Error writing out LOD data.");
+			}
 
-			std::string filename = ssFilename.str();
+			fclose(pFile);
+		}
+
+	protected:
+		// Writes the voxels to the file which holds them for all identical chunks, creating it if there is not one yet, and then
+		// writes the name of that file to the file for the chunk.
+		void pageOutDeduplicated(const std::string& filename, const VoxelType* pData, uint32_t uDataSizeInBytes)
+		{
+			const uint64_t uHash = hashBytes(pData, uDataSizeInBytes);
+
+			// Files with the same hash are compared in full, as different data can have the same hash.
+			std::string strDataFileName;
+			std::vector<std::string>& vecCandidates = m_mapDataFilesByHash[uHash];
+			std::vector<uint8_t> vecExistingData(uDataSizeInBytes);
+			for (const std::string& strCandidate : vecCandidates)
+			{
+				FILE* pFile = fopen(strCandidate.c_str(), "rb");
+				if (pFile)
+				{
+					const size_t uBytesRead = fread(vecExistingData.data(), sizeof(uint8_t), uDataSizeInBytes, pFile);
+					fclose(pFile);
+					if ((uBytesRead == uDataSizeInBytes) && (std::memcmp(vecExistingData.data(), pData, uDataSizeInBytes) == 0))
+					{
+						strDataFileName = strCandidate;
+						break;
+					}
+				}
+			}
+
+			if (strDataFileName.empty())
+			{
+				std::stringstream ssDataFileName;
+				ssDataFileName << m_strFolderName << "/data-" << m_uNoOfDataFilesCreated++ << "--" << m_strPostfix;
+				strDataFileName = ssDataFileName.str();
+				writeFile(strDataFileName, pData, uDataSizeInBytes);
+				vecCandidates.push_back(strDataFileName);
+				m_mapDataFiles[strDataFileName].m_uHash = uHash;
+			}
+			m_mapDataFiles[strDataFileName].m_uRefCount++;
+
+			// The data which the chunk was previously stored as might not be needed any more.
+			auto iterChunkDataFile = m_mapChunkDataFiles.find(filename);
+			if (iterChunkDataFile != m_mapChunkDataFiles.end())
+			{
+				releaseDataFile(iterChunkDataFile->second);
+			}
+			m_mapChunkDataFiles[filename] = strDataFileName;
+
+			writeFile(filename, strDataFileName.c_str(), static_cast<uint32_t>(strDataFileName.size()));
+		}
+
+		std::string readDataFileName(const std::string& filename) const
+		{
+			FILE* pFile = fopen(filename.c_str(), "rb");
+			if (!pFile)
+			{
+				POLYVOX_THROW(std::runtime_error, "Unable to open file naming deduplicated chunk data.");
+			}
+
+			fseek(pFile, 0L, SEEK_END);
+			std::string strDataFileName(static_cast<size_t>(ftell(pFile)), '\0');
+			fseek(pFile, 0L, SEEK_SET);
+			const size_t uBytesRead = fread(&strDataFileName[0], sizeof(char), strDataFileName.size(), pFile);
+			fclose(pFile);
 
+			if (strDataFileName.empty() || (uBytesRead != strDataFileName.size()))
+			{
+				POLYVOX_THROW(std::runtime_error, "Error reading in the name of the file containing deduplicated chunk data.");
+			}
+			return strDataFileName;
+		}
+
+		void releaseDataFile(const std::string& strDataFileName)
+		{
+			auto iterDataFile = m_mapDataFiles.find(strDataFileName);
+			POLYVOX_ASSERT(iterDataFile != m_mapDataFiles.end(), "Unknown data file");
+			if (--iterDataFile->second.m_uRefCount > 0)
+			{
+				return;
+			}
+
+			POLYVOX_LOG_WARNING_IF(std::remove(strDataFileName.c_str()) != 0, "Failed to delete '", strDataFileName, "' after it was no longer used");
+			m_vecCreatedFiles.erase(std::remove(m_vecCreatedFiles.begin(), m_vecCreatedFiles.end(), strDataFileName), m_vecCreatedFiles.end());
+
+			std::vector<std::string>& vecCandidates = m_mapDataFilesByHash[iterDataFile->second.m_uHash];
+			vecCandidates.erase(std::remove(vecCandidates.begin(), vecCandidates.end(), strDataFileName), vecCandidates.end());
+			if (vecCandidates.empty())
+			{
+				m_mapDataFilesByHash.erase(iterDataFile->second.m_uHash);
+			}
+			m_mapDataFiles.erase(iterDataFile);
+		}
+
+		void writeFile(const std::string& filename, const void* pData, uint32_t uDataSizeInBytes)
+		{
 			// FIXME - This should be replaced by C++ style IO, but currently this causes problems with
 			// the gameplay-cubiquity integration. See: https://github.com/blackberry/GamePlay/issues/919
 
@@ -155,10 +320,13 @@ namespace PolyVox
 				POLYVOX_THROW(std::runtime_error, "Unable to open file to write out chunk data.");
 			}
 
-			//The file has been created, so add it to the list to delete on shutdown.
-			m_vecCreatedFiles.push_back(filename);
+			//The file has been created, so add it to the list to delete on shutdown (unless it was already written before).
+			if (std::find(m_vecCreatedFiles.begin(), m_vecCreatedFiles.end(), filename) == m_vecCreatedFiles.end())
+			{
+				m_vecCreatedFiles.push_back(filename);
+			}
 
-			fwrite(pChunk->getData(), sizeof(uint8_t), pChunk->getDataSizeInBytes(), pFile);
+			fwrite(pData, sizeof(uint8_t), uDataSizeInBytes, pFile);
 
 			if (ferror(pFile))
 			{
@@ -168,11 +336,32 @@ namespace PolyVox
 			fclose(pFile);
 		}
 
-	protected:
+		std::string getFilename(const Region& region, const std::string& strSuffix) const
+		{
+			std::stringstream ssFilename;
+			ssFilename << m_strFolderName << "/"
+				<< region.getLowerX() << "_" << region.getLowerY() << "_" << region.getLowerZ() << "_"
+				<< region.getUpperX() << "_" << region.getUpperY() << "_" << region.getUpperZ()
+				<< "--" << m_strPostfix << strSuffix;
+			return ssFilename.str();
+		}
+
 		std::string m_strFolderName;
 		std::string m_strPostfix;
 
 		std::vector<std::string> m_vecCreatedFiles;
+
+		// Used when deduplicating chunks, to find the files containing each distinct chunk and to know when they are no longer used.
+		struct DataFile
+		{
+			uint64_t m_uHash = 0;
+			uint32_t m_uRefCount = 0;
+		};
+		bool m_bDeduplicateChunks;
+		uint32_t m_uNoOfDataFilesCreated = 0;
+		std::map<uint64_t, std::vector<std::string> > m_mapDataFilesByHash;
+		std::map<std::string, DataFile> m_mapDataFiles;
+		std::map<std::string, std::string> m_mapChunkDataFiles;
 	};
 }
 
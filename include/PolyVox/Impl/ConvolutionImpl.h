@@ -0,0 +1,186 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_ConvolutionImpl_H__
+#define __PolyVox_ConvolutionImpl_H__
+
+#include "ConvolutionVoxelTraits.h"
+#include "PlatformDefinitions.h"
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(POLYVOX_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+#if defined(POLYVOX_SIMD_AVX2)
+	#include <immintrin.h>
+#endif
+
+namespace PolyVox
+{
+	// Integer results are rounded to the nearest value (halfway cases away from zero) and clamped to the range of the type,
+	// so that e.g. a sharpening filter on 8-bit data doesn't wrap around.
+	template <typename ValueType, typename AccumulationType>
+	inline ValueType convertAccumulatedValue(AccumulationType tValue, std::true_type /*bRoundAndClamp*/)
+	{
+		const AccumulationType tLowest = static_cast<AccumulationType>((std::numeric_limits<ValueType>::min)());
+		const AccumulationType tHighest = static_cast<AccumulationType>((std::numeric_limits<ValueType>::max)());
+		if (!(tValue > tLowest))
+		{
+			return (std::numeric_limits<ValueType>::min)();
+		}
+		if (!(tValue < tHighest))
+		{
+			return (std::numeric_limits<ValueType>::max)();
+		}
+		return static_cast<ValueType>((tValue >= AccumulationType(0)) ? (tValue + AccumulationType(0.5)) : (tValue - AccumulationType(0.5)));
+	}
+
+	template <typename ValueType, typename AccumulationType>
+	inline ValueType convertAccumulatedValue(AccumulationType tValue, std::false_type /*bRoundAndClamp*/)
+	{
+		return static_cast<ValueType>(tValue);
+	}
+
+	template <typename ValueType, typename AccumulationType>
+	inline void convertAccumulatedRow(const AccumulationType* pSrc, ValueType* pDst, uint32_t uCount, AccumulationType tDivisor)
+	{
+		// Clamping is only needed (and only safe) when the accumulation type can represent the whole range of the value type.
+		typedef std::integral_constant<bool, std::is_integral<ValueType>::value &&
+			(std::is_floating_point<AccumulationType>::value || (std::is_integral<AccumulationType>::value && (sizeof(ValueType) < sizeof(AccumulationType))))> RoundAndClamp;
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			pDst[ct] = convertAccumulatedValue<ValueType>(pSrc[ct] / tDivisor, RoundAndClamp());
+		}
+	}
+
+#if defined(POLYVOX_SIMD_SSE2)
+	// Converts four floats to integers in [0, tHighest], rounding and clamping in the same way as convertAccumulatedValue().
+	inline __m128i convertAccumulatedFloats(const float* pSrc, __m128 vDivisor, float fHighest)
+	{
+		__m128 vValue = _mm_div_ps(_mm_loadu_ps(pSrc), vDivisor);
+		// The zero is the second operand so that NaNs become zero too.
+		vValue = _mm_max_ps(vValue, _mm_setzero_ps());
+		vValue = _mm_min_ps(vValue, _mm_set1_ps(fHighest));
+		return _mm_cvttps_epi32(_mm_add_ps(vValue, _mm_set1_ps(0.5f)));
+	}
+
+	inline void convertAccumulatedRow(const float* pSrc, uint8_t* pDst, uint32_t uCount, float fDivisor)
+	{
+		const __m128 vDivisor = _mm_set1_ps(fDivisor);
+		uint32_t ct = 0;
+		for (; ct + 8 <= uCount; ct += 8)
+		{
+			__m128i vLow = convertAccumulatedFloats(pSrc + ct, vDivisor, 255.0f);
+			__m128i vHigh = convertAccumulatedFloats(pSrc + ct + 4, vDivisor, 255.0f);
+			__m128i vPacked = _mm_packus_epi16(_mm_packs_epi32(vLow, vHigh), _mm_setzero_si128());
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + ct), vPacked);
+		}
+		for (; ct < uCount; ct++)
+		{
+			pDst[ct] = convertAccumulatedValue<uint8_t>(pSrc[ct] / fDivisor, std::true_type());
+		}
+	}
+
+	inline void convertAccumulatedRow(const float* pSrc, uint16_t* pDst, uint32_t uCount, float fDivisor)
+	{
+		// SSE2 can only pack to signed 16-bit values, so the range is shifted down and then back up again.
+		const __m128 vDivisor = _mm_set1_ps(fDivisor);
+		const __m128i vBias32 = _mm_set1_epi32(32768);
+		const __m128i vBias16 = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+		uint32_t ct = 0;
+		for (; ct + 8 <= uCount; ct += 8)
+		{
+			__m128i vLow = _mm_sub_epi32(convertAccumulatedFloats(pSrc + ct, vDivisor, 65535.0f), vBias32);
+			__m128i vHigh = _mm_sub_epi32(convertAccumulatedFloats(pSrc + ct + 4, vDivisor, 65535.0f), vBias32);
+			__m128i vPacked = _mm_xor_si128(_mm_packs_epi32(vLow, vHigh), vBias16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + ct), vPacked);
+		}
+		for (; ct < uCount; ct++)
+		{
+			pDst[ct] = convertAccumulatedValue<uint16_t>(pSrc[ct] / fDivisor, std::true_type());
+		}
+	}
+#endif
+
+	// Performs 'pDst[i] += tWeight * pSrc[i]' for each of the 'uCount' elements. This is the inner loop of all the convolutions.
+	template <typename AccumulationType>
+	inline void multiplyAdd(AccumulationType* pDst, const AccumulationType* pSrc, AccumulationType tWeight, uint32_t uCount)
+	{
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			pDst[ct] += tWeight * pSrc[ct];
+		}
+	}
+
+#if defined(POLYVOX_SIMD_SSE2) || defined(POLYVOX_SIMD_AVX2)
+	inline void multiplyAdd(float* pDst, const float* pSrc, float fWeight, uint32_t uCount)
+	{
+		uint32_t ct = 0;
+#if defined(POLYVOX_SIMD_AVX2)
+		const __m256 vWeight256 = _mm256_set1_ps(fWeight);
+		for (; ct + 8 <= uCount; ct += 8)
+		{
+			__m256 vProduct = _mm256_mul_ps(vWeight256, _mm256_loadu_ps(pSrc + ct));
+			_mm256_storeu_ps(pDst + ct, _mm256_add_ps(_mm256_loadu_ps(pDst + ct), vProduct));
+		}
+#endif
+#if defined(POLYVOX_SIMD_SSE2)
+		const __m128 vWeight128 = _mm_set1_ps(fWeight);
+		for (; ct + 4 <= uCount; ct += 4)
+		{
+			__m128 vProduct = _mm_mul_ps(vWeight128, _mm_loadu_ps(pSrc + ct));
+			_mm_storeu_ps(pDst + ct, _mm_add_ps(_mm_loadu_ps(pDst + ct), vProduct));
+		}
+#endif
+		for (; ct < uCount; ct++)
+		{
+			pDst[ct] += fWeight * pSrc[ct];
+		}
+	}
+#endif
+
+#if defined(POLYVOX_SIMD_AVX2)
+	// SSE2 has no 32-bit multiply, so integer accumulation is only vectorised explicitly with AVX2.
+	inline void multiplyAdd(int32_t* pDst, const int32_t* pSrc, int32_t iWeight, uint32_t uCount)
+	{
+		const __m256i vWeight = _mm256_set1_epi32(iWeight);
+		uint32_t ct = 0;
+		for (; ct + 8 <= uCount; ct += 8)
+		{
+			__m256i vProduct = _mm256_mullo_epi32(vWeight, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + ct)));
+			__m256i vSum = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pDst + ct)), vProduct);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + ct), vSum);
+		}
+		for (; ct < uCount; ct++)
+		{
+			pDst[ct] += iWeight * pSrc[ct];
+		}
+	}
+#endif
+}
+
+#endif //__PolyVox_ConvolutionImpl_H__
@@ -0,0 +1,51 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_ConvolutionVoxelTraits_H__
+#define __PolyVox_ConvolutionVoxelTraits_H__
+
+#include "../Density.h"
+
+namespace PolyVox
+{
+	// Describes how the convolution code gets a number out of a voxel and back again. Voxels which are already
+	// numbers are used directly, and specialisations can be provided for other voxel types.
+	template <typename VoxelType>
+	struct ConvolutionVoxelTraits
+	{
+		typedef VoxelType ValueType;
+		static ValueType toValue(const VoxelType& voxel) { return voxel; }
+		static VoxelType fromValue(ValueType value) { return value; }
+	};
+
+	template <typename Type>
+	struct ConvolutionVoxelTraits< Density<Type> >
+	{
+		typedef Type ValueType;
+		static ValueType toValue(const Density<Type>& voxel) { return voxel.getDensity(); }
+		static Density<Type> fromValue(ValueType value) { return Density<Type>(value); }
+	};
+}
+
+#endif //__PolyVox_ConvolutionVoxelTraits_H__
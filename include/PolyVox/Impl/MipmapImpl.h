@@ -0,0 +1,299 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_MipmapImpl_H__
+#define __PolyVox_MipmapImpl_H__
+
+#include "ConvolutionVoxelTraits.h"
+#include "ErrorHandling.h"
+#include "PlatformDefinitions.h"
+
+#include <cstdint>
+#include <stdexcept> //For invalid_argument
+#include <type_traits>
+
+#if defined(POLYVOX_SIMD_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace PolyVox
+{
+	// The reduction of 2x2x2 blocks is shared by the functions in Mipmap.h and the LOD levels of PagedVolume. It lives
+	// here so that PagedVolume.h doesn't need the threading code used by the former.
+	namespace MipmapModes
+	{
+		/**
+		 * How a 2x2x2 block of voxels is reduced to one
+		 */
+		enum MipmapMode
+		{
+			Average, ///< The mean, rounded to the nearest value for integer voxels. Suitable for densities.
+			Minimum, ///< The smallest value
+			Maximum, ///< The largest value
+			Majority ///< The most common voxel, with ties going to the first in x-y-z order. Suitable for materials.
+		};
+	}
+	typedef MipmapModes::MipmapMode MipmapMode;
+
+	template <typename ValueType>
+	ValueType averageMipmapValues(const ValueType* pValues, uint32_t uCount, std::true_type /*bIsIntegral*/)
+	{
+		int64_t iSum = 0;
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			iSum += pValues[ct];
+		}
+		const int64_t iHalf = uCount / 2;
+		return static_cast<ValueType>((iSum >= 0) ? ((iSum + iHalf) / uCount) : -((iHalf - iSum) / uCount));
+	}
+
+	template <typename ValueType>
+	ValueType averageMipmapValues(const ValueType* pValues, uint32_t uCount, std::false_type /*bIsIntegral*/)
+	{
+		double dSum = 0.0;
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			dSum += pValues[ct];
+		}
+		return static_cast<ValueType>(dSum / uCount);
+	}
+
+	template <typename ValueType>
+	ValueType reduceMipmapValues(const ValueType* pValues, uint32_t uCount, MipmapMode eMode, std::true_type /*bIsArithmetic*/)
+	{
+		ValueType result = pValues[0];
+		switch (eMode)
+		{
+		case MipmapModes::Average:
+			result = averageMipmapValues(pValues, uCount, std::integral_constant<bool, std::is_integral<ValueType>::value>());
+			break;
+		case MipmapModes::Minimum:
+			for (uint32_t ct = 1; ct < uCount; ct++)
+			{
+				result = (pValues[ct] < result) ? pValues[ct] : result;
+			}
+			break;
+		case MipmapModes::Maximum:
+			for (uint32_t ct = 1; ct < uCount; ct++)
+			{
+				result = (result < pValues[ct]) ? pValues[ct] : result;
+			}
+			break;
+		default:
+			POLYVOX_THROW(std::invalid_argument, "Unknown mipmap mode");
+		}
+		return result;
+	}
+
+	template <typename ValueType>
+	ValueType reduceMipmapValues(const ValueType* pValues, uint32_t /*uCount*/, MipmapMode /*eMode*/, std::false_type /*bIsArithmetic*/)
+	{
+		POLYVOX_THROW(std::invalid_argument, "Only the majority mode can be used with voxels which are not numbers");
+		return pValues[0];
+	}
+
+	// Reduces the voxels from (part of) a 2x2x2 block to a single voxel. There are between one and eight of them.
+	template <typename VoxelType>
+	VoxelType reduceMipmapBlock(const VoxelType* pVoxels, uint32_t uCount, MipmapMode eMode)
+	{
+		typedef ConvolutionVoxelTraits<VoxelType> Traits;
+		typedef typename Traits::ValueType ValueType;
+
+		if (eMode == MipmapModes::Majority)
+		{
+			// Only equality is needed, so this works for any voxel type.
+			uint32_t uBestCount = 0;
+			uint32_t uBestIndex = 0;
+			for (uint32_t uCandidate = 0; uCandidate < uCount; uCandidate++)
+			{
+				uint32_t uMatches = 0;
+				for (uint32_t ct = 0; ct < uCount; ct++)
+				{
+					if (pVoxels[ct] == pVoxels[uCandidate])
+					{
+						uMatches++;
+					}
+				}
+				if (uMatches > uBestCount)
+				{
+					uBestCount = uMatches;
+					uBestIndex = uCandidate;
+				}
+			}
+			return pVoxels[uBestIndex];
+		}
+
+		POLYVOX_ASSERT((uCount > 0) && (uCount <= 8), "A mipmap block holds between one and eight voxels");
+
+		// Value-initialised so the compiler can see that every element read by the reduction has been written.
+		ValueType values[8] = {};
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			values[ct] = Traits::toValue(pVoxels[ct]);
+		}
+		return Traits::fromValue(reduceMipmapValues(values, uCount, eMode, std::integral_constant<bool, std::is_arithmetic<ValueType>::value>()));
+	}
+
+	// Reduces complete 2x2x2 blocks taken from four rows of the source, which are ordered (y, z), (y + 1, z), (y, z + 1)
+	// and (y + 1, z + 1). Each row holds '2 * uDstWidth' voxels.
+	template <typename VoxelType>
+	void reduceMipmapRows(const VoxelType* const* ppRows, VoxelType* pDst, uint32_t uDstWidth, MipmapMode eMode)
+	{
+		VoxelType block[8];
+		for (uint32_t uX = 0; uX < uDstWidth; uX++)
+		{
+			for (uint32_t uRow = 0; uRow < 4; uRow++)
+			{
+				block[uRow * 2] = ppRows[uRow][uX * 2];
+				block[uRow * 2 + 1] = ppRows[uRow][uX * 2 + 1];
+			}
+			pDst[uX] = reduceMipmapBlock(block, 8, eMode);
+		}
+	}
+
+#if defined(POLYVOX_SIMD_SSE2)
+	inline void reduceMipmapRows(const uint8_t* const* ppRows, uint8_t* pDst, uint32_t uDstWidth, MipmapMode eMode)
+	{
+		if (eMode == MipmapModes::Majority)
+		{
+			reduceMipmapRows<uint8_t>(ppRows, pDst, uDstWidth, eMode);
+			return;
+		}
+
+		const __m128i vZero = _mm_setzero_si128();
+		const __m128i vLowWords = _mm_set1_epi32(0x0000FFFF);
+		const __m128i vLowBytes = _mm_set1_epi16(0x00FF);
+		const __m128i vFour = _mm_set1_epi32(4);
+
+		// Eight destination voxels (sixteen bytes of each source row) at a time.
+		uint32_t uX = 0;
+		for (; uX + 8 <= uDstWidth; uX += 8)
+		{
+			__m128i vRows[4];
+			for (uint32_t uRow = 0; uRow < 4; uRow++)
+			{
+				vRows[uRow] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ppRows[uRow] + uX * 2));
+			}
+
+			__m128i vResult;
+			if (eMode == MipmapModes::Average)
+			{
+				// Widen to 16 bits and sum vertically, then add neighbouring pairs into 32-bit lanes.
+				__m128i vSumLow = vZero;
+				__m128i vSumHigh = vZero;
+				for (uint32_t uRow = 0; uRow < 4; uRow++)
+				{
+					vSumLow = _mm_add_epi16(vSumLow, _mm_unpacklo_epi8(vRows[uRow], vZero));
+					vSumHigh = _mm_add_epi16(vSumHigh, _mm_unpackhi_epi8(vRows[uRow], vZero));
+				}
+				__m128i vPairsLow = _mm_add_epi32(_mm_and_si128(vSumLow, vLowWords), _mm_srli_epi32(vSumLow, 16));
+				__m128i vPairsHigh = _mm_add_epi32(_mm_and_si128(vSumHigh, vLowWords), _mm_srli_epi32(vSumHigh, 16));
+				vPairsLow = _mm_srli_epi32(_mm_add_epi32(vPairsLow, vFour), 3);
+				vPairsHigh = _mm_srli_epi32(_mm_add_epi32(vPairsHigh, vFour), 3);
+				vResult = _mm_packs_epi32(vPairsLow, vPairsHigh);
+			}
+			else
+			{
+				// Combine vertically, then combine the even and odd bytes as 16-bit values.
+				const bool bMinimum = (eMode == MipmapModes::Minimum);
+				__m128i vCombined = bMinimum ? _mm_min_epu8(_mm_min_epu8(vRows[0], vRows[1]), _mm_min_epu8(vRows[2], vRows[3])) :
+					_mm_max_epu8(_mm_max_epu8(vRows[0], vRows[1]), _mm_max_epu8(vRows[2], vRows[3]));
+				__m128i vEven = _mm_and_si128(vCombined, vLowBytes);
+				__m128i vOdd = _mm_srli_epi16(vCombined, 8);
+				vResult = bMinimum ? _mm_min_epi16(vEven, vOdd) : _mm_max_epi16(vEven, vOdd);
+			}
+
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + uX), _mm_packus_epi16(vResult, vZero));
+		}
+
+		if (uX < uDstWidth)
+		{
+			const uint8_t* ppRemainingRows[4] = { ppRows[0] + uX * 2, ppRows[1] + uX * 2, ppRows[2] + uX * 2, ppRows[3] + uX * 2 };
+			reduceMipmapRows<uint8_t>(ppRemainingRows, pDst + uX, uDstWidth - uX, eMode);
+		}
+	}
+
+	inline void reduceMipmapRows(const float* const* ppRows, float* pDst, uint32_t uDstWidth, MipmapMode eMode)
+	{
+		if (eMode == MipmapModes::Majority)
+		{
+			reduceMipmapRows<float>(ppRows, pDst, uDstWidth, eMode);
+			return;
+		}
+
+		// Four destination voxels (eight floats of each source row) at a time.
+		uint32_t uX = 0;
+		for (; uX + 4 <= uDstWidth; uX += 4)
+		{
+			__m128 vFirst = _mm_loadu_ps(ppRows[0] + uX * 2);
+			__m128 vSecond = _mm_loadu_ps(ppRows[0] + uX * 2 + 4);
+			for (uint32_t uRow = 1; uRow < 4; uRow++)
+			{
+				__m128 vRowFirst = _mm_loadu_ps(ppRows[uRow] + uX * 2);
+				__m128 vRowSecond = _mm_loadu_ps(ppRows[uRow] + uX * 2 + 4);
+				switch (eMode)
+				{
+				case MipmapModes::Average:
+					vFirst = _mm_add_ps(vFirst, vRowFirst);
+					vSecond = _mm_add_ps(vSecond, vRowSecond);
+					break;
+				case MipmapModes::Minimum:
+					vFirst = _mm_min_ps(vFirst, vRowFirst);
+					vSecond = _mm_min_ps(vSecond, vRowSecond);
+					break;
+				default:
+					vFirst = _mm_max_ps(vFirst, vRowFirst);
+					vSecond = _mm_max_ps(vSecond, vRowSecond);
+					break;
+				}
+			}
+
+			__m128 vEven = _mm_shuffle_ps(vFirst, vSecond, _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 vOdd = _mm_shuffle_ps(vFirst, vSecond, _MM_SHUFFLE(3, 1, 3, 1));
+			__m128 vResult;
+			switch (eMode)
+			{
+			case MipmapModes::Average:
+				vResult = _mm_mul_ps(_mm_add_ps(vEven, vOdd), _mm_set1_ps(0.125f));
+				break;
+			case MipmapModes::Minimum:
+				vResult = _mm_min_ps(vEven, vOdd);
+				break;
+			default:
+				vResult = _mm_max_ps(vEven, vOdd);
+				break;
+			}
+			_mm_storeu_ps(pDst + uX, vResult);
+		}
+
+		if (uX < uDstWidth)
+		{
+			const float* ppRemainingRows[4] = { ppRows[0] + uX * 2, ppRows[1] + uX * 2, ppRows[2] + uX * 2, ppRows[3] + uX * 2 };
+			reduceMipmapRows<float>(ppRemainingRows, pDst + uX, uDstWidth - uX, eMode);
+		}
+	}
+#endif
+}
+
+#endif //__PolyVox_MipmapImpl_H__
@@ -0,0 +1,153 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_MorphologyImpl_H__
+#define __PolyVox_MorphologyImpl_H__
+
+#include "PlatformDefinitions.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace PolyVox
+{
+	// The operations which dilation and erosion combine neighbouring values with. Dilation of densities takes the
+	// maximum and erosion the minimum, while for rows of bits (where each bit is a voxel) they are 'or' and 'and'.
+	struct MorphologyMaximum
+	{
+		template <typename ValueType>
+		ValueType operator()(const ValueType& a, const ValueType& b) const
+		{
+			return (a < b) ? b : a;
+		}
+	};
+
+	struct MorphologyMinimum
+	{
+		template <typename ValueType>
+		ValueType operator()(const ValueType& a, const ValueType& b) const
+		{
+			return (b < a) ? b : a;
+		}
+	};
+
+	struct MorphologyBitwiseOr
+	{
+		uint64_t operator()(uint64_t a, uint64_t b) const
+		{
+			return a | b;
+		}
+	};
+
+	struct MorphologyBitwiseAnd
+	{
+		uint64_t operator()(uint64_t a, uint64_t b) const
+		{
+			return a & b;
+		}
+	};
+
+	// Combines 'uCount' values of two arrays into a third.
+	template <typename ValueType, typename Operator>
+	inline void combineValues(const ValueType* pFirst, const ValueType* pSecond, ValueType* pDst, uint32_t uCount, Operator op)
+	{
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			pDst[ct] = op(pFirst[ct], pSecond[ct]);
+		}
+	}
+
+	// Sets each of 'uNoOfOutputs' elements of pDst to the combination of the '2 * uRadius + 1' elements of pSrc starting at the
+	// same index. Each element is a run of 'uElementSize' neighbouring values (e.g. a whole row when filtering along y), so
+	// that the inner loops are over contiguous memory.
+	//
+	// Small windows are combined directly. Larger ones use the van Herk/Gil-Werman algorithm, which splits the source into
+	// blocks of the window size and takes running combinations forwards and backwards within each block. Every window then
+	// spans at most two blocks, so it is the combination of one backward and one forward value, and the cost per output
+	// doesn't depend on the radius.
+	template <typename ValueType, typename Operator>
+	void filterLine(const ValueType* pSrc, ValueType* pDst, uint32_t uNoOfOutputs, uint32_t uRadius, uint32_t uElementSize, Operator op,
+		std::vector<ValueType>& vecForwards, std::vector<ValueType>& vecBackwards)
+	{
+		const uint32_t uWindowSize = uRadius * 2 + 1;
+		if (uRadius <= 1)
+		{
+			for (uint32_t uOutput = 0; uOutput < uNoOfOutputs; uOutput++)
+			{
+				ValueType* pOutput = pDst + uOutput * uElementSize;
+				const ValueType* pInput = pSrc + uOutput * uElementSize;
+				if (uRadius == 0)
+				{
+					std::copy(pInput, pInput + uElementSize, pOutput);
+				}
+				else
+				{
+					combineValues(pInput, pInput + uElementSize, pOutput, uElementSize, op);
+					combineValues(pOutput, pInput + uElementSize * 2, pOutput, uElementSize, op);
+				}
+			}
+			return;
+		}
+
+		const uint32_t uNoOfInputs = uNoOfOutputs + uWindowSize - 1;
+		vecForwards.resize(uNoOfInputs * uElementSize);
+		vecBackwards.resize(uNoOfInputs * uElementSize);
+
+		for (uint32_t uInput = 0; uInput < uNoOfInputs; uInput++)
+		{
+			const ValueType* pInput = pSrc + uInput * uElementSize;
+			ValueType* pForwards = &vecForwards[uInput * uElementSize];
+			if (uInput % uWindowSize == 0)
+			{
+				std::copy(pInput, pInput + uElementSize, pForwards);
+			}
+			else
+			{
+				combineValues(pForwards - uElementSize, pInput, pForwards, uElementSize, op);
+			}
+		}
+
+		for (uint32_t uInput = uNoOfInputs; uInput-- > 0;)
+		{
+			const ValueType* pInput = pSrc + uInput * uElementSize;
+			ValueType* pBackwards = &vecBackwards[uInput * uElementSize];
+			if ((uInput + 1 == uNoOfInputs) || ((uInput + 1) % uWindowSize == 0))
+			{
+				std::copy(pInput, pInput + uElementSize, pBackwards);
+			}
+			else
+			{
+				combineValues(pBackwards + uElementSize, pInput, pBackwards, uElementSize, op);
+			}
+		}
+
+		for (uint32_t uOutput = 0; uOutput < uNoOfOutputs; uOutput++)
+		{
+			combineValues(&vecBackwards[uOutput * uElementSize], &vecForwards[(uOutput + uWindowSize - 1) * uElementSize], pDst + uOutput * uElementSize, uElementSize, op);
+		}
+	}
+}
+
+#endif //__PolyVox_MorphologyImpl_H__
@@ -75,6 +75,17 @@
 	#endif
 #endif
 
+// The SIMD instruction sets which inner loops may use. These follow the flags the compiler was invoked with (e.g. '-mavx2'
+// with GCC or '/arch:AVX2' with Visual Studio), and they can all be turned off by defining POLYVOX_DISABLE_SIMD.
+#if !defined(POLYVOX_DISABLE_SIMD)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+		#define POLYVOX_SIMD_SSE2
+	#endif
+	#if defined(__AVX2__)
+		#define POLYVOX_SIMD_AVX2
+	#endif
+#endif
+
 // Used to prevent the compiler complaining about unused varuables, particularly useful when
 // e.g. asserts are disabled and the parameter it was checking isn't used anywhere else.
 // Note that this implementation doesn't seem to work everywhere, for some reason I have
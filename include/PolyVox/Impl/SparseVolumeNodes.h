@@ -0,0 +1,320 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_SparseVolumeNodes_H__
+#define __PolyVox_SparseVolumeNodes_H__
+
+#include "PlatformDefinitions.h"
+#include "Utility.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace PolyVox
+{
+	// A fixed number of slots of which only the occupied ones take up memory. A bitmask records which slots are occupied, and
+	// their elements are packed in slot order. An element is found by counting the occupied slots before it, which is quick
+	// because the count up to the start of each word of the mask is kept alongside it.
+	template <typename ElementType, uint32_t NoOfSlots>
+	class SparseArray
+	{
+	public:
+		static_assert((NoOfSlots % 64) == 0, "The number of slots must be a multiple of 64");
+
+		SparseArray()
+		{
+			std::fill(m_uMask, m_uMask + uNoOfWords, uint64_t(0));
+			std::fill(m_uCountBeforeWord, m_uCountBeforeWord + uNoOfWords, uint16_t(0));
+		}
+
+		bool isOccupied(uint32_t uSlot) const
+		{
+			return ((m_uMask[uSlot >> 6] >> (uSlot & 63)) & 1) != 0;
+		}
+
+		// Returns null if the slot is empty. The pointer is only valid until the next insert() or erase().
+		const ElementType* find(uint32_t uSlot) const
+		{
+			return isOccupied(uSlot) ? &m_vecElements[getRank(uSlot)] : nullptr;
+		}
+
+		ElementType* find(uint32_t uSlot)
+		{
+			return isOccupied(uSlot) ? &m_vecElements[getRank(uSlot)] : nullptr;
+		}
+
+		// Fills the slot (replacing any element already in it) and returns the stored element.
+		ElementType& insert(uint32_t uSlot, ElementType element)
+		{
+			const uint32_t uRank = getRank(uSlot);
+			if (isOccupied(uSlot))
+			{
+				m_vecElements[uRank] = std::move(element);
+			}
+			else
+			{
+				m_vecElements.insert(m_vecElements.begin() + uRank, std::move(element));
+				m_uMask[uSlot >> 6] |= uint64_t(1) << (uSlot & 63);
+				for (uint32_t uWord = (uSlot >> 6) + 1; uWord < uNoOfWords; uWord++)
+				{
+					m_uCountBeforeWord[uWord]++;
+				}
+			}
+			return m_vecElements[uRank];
+		}
+
+		// Empties the slot and returns whether it was occupied.
+		bool erase(uint32_t uSlot)
+		{
+			if (!isOccupied(uSlot))
+			{
+				return false;
+			}
+
+			m_vecElements.erase(m_vecElements.begin() + getRank(uSlot));
+			m_uMask[uSlot >> 6] &= ~(uint64_t(1) << (uSlot & 63));
+			for (uint32_t uWord = (uSlot >> 6) + 1; uWord < uNoOfWords; uWord++)
+			{
+				m_uCountBeforeWord[uWord]--;
+			}
+			return true;
+		}
+
+		bool isEmpty(void) const
+		{
+			return m_vecElements.empty();
+		}
+
+		uint32_t getNoOfElements(void) const
+		{
+			return static_cast<uint32_t>(m_vecElements.size());
+		}
+
+		// Calls 'function(uSlot, element)' for each occupied slot, in slot order.
+		template <typename Function>
+		void forEach(Function function) const
+		{
+			uint32_t uRank = 0;
+			for (uint32_t uWord = 0; uWord < uNoOfWords; uWord++)
+			{
+				for (uint64_t uBits = m_uMask[uWord]; uBits != 0; uBits &= uBits - 1)
+				{
+					const uint32_t uBit = findLowestSetBit(uBits);
+					function((uWord << 6) + uBit, m_vecElements[uRank++]);
+				}
+			}
+		}
+
+		uint32_t calculateSizeInBytes(void) const
+		{
+			return static_cast<uint32_t>(sizeof(*this) + m_vecElements.capacity() * sizeof(ElementType));
+		}
+
+	private:
+		static const uint32_t uNoOfWords = NoOfSlots / 64;
+
+		uint32_t getRank(uint32_t uSlot) const
+		{
+			const uint64_t uBitsBefore = m_uMask[uSlot >> 6] & ((uint64_t(1) << (uSlot & 63)) - 1);
+			return m_uCountBeforeWord[uSlot >> 6] + countBits(uBitsBefore);
+		}
+
+		uint64_t m_uMask[uNoOfWords];
+		uint16_t m_uCountBeforeWord[uNoOfWords];
+		std::vector<ElementType> m_vecElements;
+	};
+
+	// The bottom level of a SparseVolume. It covers a cube of (1 << Log2Dim) voxels per side and stores only its active voxels.
+	template <typename VoxelType, uint32_t Log2Dim>
+	class SparseLeafNode
+	{
+	public:
+		typedef SparseLeafNode<VoxelType, Log2Dim> LeafType;
+
+		// The log of the side length of the cube of voxels covered by this node.
+		static const uint32_t uLog2SideLength = Log2Dim;
+
+		static uint32_t getSlot(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+		{
+			const int32_t iMask = (1 << Log2Dim) - 1;
+			return static_cast<uint32_t>((iXPos & iMask) | ((iYPos & iMask) << Log2Dim) | ((iZPos & iMask) << (2 * Log2Dim)));
+		}
+
+		const VoxelType* findVoxel(uint32_t uSlot) const
+		{
+			return m_voxels.find(uSlot);
+		}
+
+		const LeafType* findLeaf(int32_t /*iXPos*/, int32_t /*iYPos*/, int32_t /*iZPos*/) const
+		{
+			return this;
+		}
+
+		LeafType* touchLeaf(int32_t /*iXPos*/, int32_t /*iYPos*/, int32_t /*iZPos*/, bool& /*bCreated*/)
+		{
+			return this;
+		}
+
+		void setVoxel(int32_t iXPos, int32_t iYPos, int32_t iZPos, const VoxelType& tValue)
+		{
+			m_voxels.insert(getSlot(iXPos, iYPos, iZPos), tValue);
+		}
+
+		bool eraseVoxel(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+		{
+			return m_voxels.erase(getSlot(iXPos, iYPos, iZPos));
+		}
+
+		bool isEmpty(void) const
+		{
+			return m_voxels.isEmpty();
+		}
+
+		uint64_t getNoOfActiveVoxels(void) const
+		{
+			return m_voxels.getNoOfElements();
+		}
+
+		// Calls 'function(iXPos, iYPos, iZPos, tValue)' for each active voxel, where the lower corner of this node is at the given position.
+		template <typename Function>
+		void forEachActiveVoxel(int32_t iLowerX, int32_t iLowerY, int32_t iLowerZ, Function& function) const
+		{
+			const uint32_t uMask = (1 << Log2Dim) - 1;
+			m_voxels.forEach([&](uint32_t uSlot, const VoxelType& tValue)
+			{
+				function(iLowerX + static_cast<int32_t>(uSlot & uMask),
+					iLowerY + static_cast<int32_t>((uSlot >> Log2Dim) & uMask),
+					iLowerZ + static_cast<int32_t>(uSlot >> (2 * Log2Dim)), tValue);
+			});
+		}
+
+		uint32_t calculateSizeInBytes(void) const
+		{
+			return m_voxels.calculateSizeInBytes();
+		}
+
+	private:
+		SparseArray<VoxelType, 1 << (3 * Log2Dim)> m_voxels;
+	};
+
+	// An upper level of a SparseVolume. It splits its cube into (1 << Log2Dim) children per side, and only stores the children
+	// which contain active voxels.
+	template <typename ChildType, uint32_t Log2Dim>
+	class SparseInternalNode
+	{
+	public:
+		typedef typename ChildType::LeafType LeafType;
+
+		static const uint32_t uLog2SideLength = Log2Dim + ChildType::uLog2SideLength;
+
+		static uint32_t getSlot(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+		{
+			const int32_t iMask = (1 << Log2Dim) - 1;
+			const uint32_t uShift = ChildType::uLog2SideLength;
+			return static_cast<uint32_t>(((iXPos >> uShift) & iMask) | (((iYPos >> uShift) & iMask) << Log2Dim) | (((iZPos >> uShift) & iMask) << (2 * Log2Dim)));
+		}
+
+		// Returns null if there is no leaf (and so no active voxels) at the given position.
+		const LeafType* findLeaf(int32_t iXPos, int32_t iYPos, int32_t iZPos) const
+		{
+			const std::unique_ptr<ChildType>* pChild = m_children.find(getSlot(iXPos, iYPos, iZPos));
+			return pChild ? (*pChild)->findLeaf(iXPos, iYPos, iZPos) : nullptr;
+		}
+
+		// Returns the leaf at the given position, creating it (and any missing nodes above it) if necessary.
+		LeafType* touchLeaf(int32_t iXPos, int32_t iYPos, int32_t iZPos, bool& bCreated)
+		{
+			const uint32_t uSlot = getSlot(iXPos, iYPos, iZPos);
+			std::unique_ptr<ChildType>* pChild = m_children.find(uSlot);
+			if (!pChild)
+			{
+				pChild = &m_children.insert(uSlot, std::unique_ptr<ChildType>(new ChildType));
+				bCreated = true;
+			}
+			return (*pChild)->touchLeaf(iXPos, iYPos, iZPos, bCreated);
+		}
+
+		// Deactivates the voxel at the given position, and deletes any child which is left empty. Returns whether the voxel was active.
+		bool eraseVoxel(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+		{
+			const uint32_t uSlot = getSlot(iXPos, iYPos, iZPos);
+			std::unique_ptr<ChildType>* pChild = m_children.find(uSlot);
+			if (!pChild || !(*pChild)->eraseVoxel(iXPos, iYPos, iZPos))
+			{
+				return false;
+			}
+
+			if ((*pChild)->isEmpty())
+			{
+				m_children.erase(uSlot);
+			}
+			return true;
+		}
+
+		bool isEmpty(void) const
+		{
+			return m_children.isEmpty();
+		}
+
+		uint64_t getNoOfActiveVoxels(void) const
+		{
+			uint64_t uNoOfActiveVoxels = 0;
+			m_children.forEach([&](uint32_t /*uSlot*/, const std::unique_ptr<ChildType>& pChild)
+			{
+				uNoOfActiveVoxels += pChild->getNoOfActiveVoxels();
+			});
+			return uNoOfActiveVoxels;
+		}
+
+		template <typename Function>
+		void forEachActiveVoxel(int32_t iLowerX, int32_t iLowerY, int32_t iLowerZ, Function& function) const
+		{
+			const uint32_t uMask = (1 << Log2Dim) - 1;
+			const uint32_t uShift = ChildType::uLog2SideLength;
+			m_children.forEach([&](uint32_t uSlot, const std::unique_ptr<ChildType>& pChild)
+			{
+				pChild->forEachActiveVoxel(iLowerX + static_cast<int32_t>((uSlot & uMask) << uShift),
+					iLowerY + static_cast<int32_t>(((uSlot >> Log2Dim) & uMask) << uShift),
+					iLowerZ + static_cast<int32_t>((uSlot >> (2 * Log2Dim)) << uShift), function);
+			});
+		}
+
+		uint32_t calculateSizeInBytes(void) const
+		{
+			uint32_t uSizeInBytes = m_children.calculateSizeInBytes();
+			m_children.forEach([&](uint32_t /*uSlot*/, const std::unique_ptr<ChildType>& pChild)
+			{
+				uSizeInBytes += pChild->calculateSizeInBytes();
+			});
+			return uSizeInBytes;
+		}
+
+	private:
+		SparseArray<std::unique_ptr<ChildType>, 1 << (3 * Log2Dim)> m_children;
+	};
+}
+
+#endif //__PolyVox_SparseVolumeNodes_H__
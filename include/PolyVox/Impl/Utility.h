@@ -25,9 +25,14 @@
 #ifndef __PolyVox_Utility_H__
 #define __PolyVox_Utility_H__
 
+#include "ErrorHandling.h"
 #include "PlatformDefinitions.h"
 
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept> //For invalid_argument
 
 namespace PolyVox
 {
@@ -61,6 +66,17 @@ namespace PolyVox
 		return static_cast<uint8_t>(uResult - 1);
 	}
 
+	// Versions of the above which can be evaluated at compile time, but which don't validate their input.
+	constexpr bool isPowerOf2Static(uint32_t uInput)
+	{
+		return (uInput != 0) && ((uInput & (uInput - 1)) == 0);
+	}
+
+	constexpr uint8_t logBase2Static(uint32_t uInput)
+	{
+		return (uInput <= 1) ? 0 : static_cast<uint8_t>(1 + logBase2Static(uInput >> 1));
+	}
+
 	// http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
 	inline uint32_t upperPowerOfTwo(uint32_t v)
 	{
@@ -74,6 +90,61 @@ namespace PolyVox
 		return v;
 	}
 
+	// The number of bits which are set in the word.
+	inline uint32_t countBits(uint64_t uWord)
+	{
+#if defined(__GNUC__)
+		return static_cast<uint32_t>(__builtin_popcountll(uWord));
+#else
+		return static_cast<uint32_t>(std::bitset<64>(uWord).count());
+#endif
+	}
+
+	// The positions of the lowest and highest set bits in the word, which must not be zero.
+	inline uint32_t findLowestSetBit(uint64_t uWord)
+	{
+#if defined(__GNUC__)
+		return static_cast<uint32_t>(__builtin_ctzll(uWord));
+#else
+		return countBits((uWord & (~uWord + 1)) - 1);
+#endif
+	}
+
+	inline uint32_t findHighestSetBit(uint64_t uWord)
+	{
+#if defined(__GNUC__)
+		return 63 - static_cast<uint32_t>(__builtin_clzll(uWord));
+#else
+		uint32_t uResult = 0;
+		while ((uWord >>= 1) != 0)
+		{
+			uResult++;
+		}
+		return uResult;
+#endif
+	}
+
+	// A 64-bit hash of a block of memory. It is used to find blocks which might be identical, so different blocks can still have
+	// the same hash and must be compared before being treated as equal.
+	inline uint64_t hashBytes(const void* pData, size_t uSizeInBytes)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		uint64_t uHash = 0xcbf29ce484222325ULL ^ uSizeInBytes;
+		size_t uIndex = 0;
+		for (; uIndex + sizeof(uint64_t) <= uSizeInBytes; uIndex += sizeof(uint64_t))
+		{
+			uint64_t uWord;
+			std::memcpy(&uWord, pBytes + uIndex, sizeof(uint64_t));
+			uHash = (uHash ^ uWord) * 0x100000001b3ULL;
+			uHash ^= uHash >> 29;
+		}
+		for (; uIndex < uSizeInBytes; uIndex++)
+		{
+			uHash = (uHash ^ pBytes[uIndex]) * 0x100000001b3ULL;
+		}
+		return uHash;
+	}
+
 	inline int32_t roundTowardsNegInf(float r)
 	{
 		return (r >= 0.0) ? static_cast<int32_t>(r) : static_cast<int32_t>(r - 1.0f);
@@ -84,6 +155,12 @@ namespace PolyVox
 		return (r >= 0.0) ? static_cast<int32_t>(r + 0.5f) : static_cast<int32_t>(r - 0.5f);
 	}
 
+	// Integer division which rounds towards negative infinity rather than towards zero. The divisor must be positive.
+	inline int32_t floorDivide(int32_t iDividend, int32_t iDivisor)
+	{
+		return (iDividend >= 0) ? (iDividend / iDivisor) : -((iDivisor - 1 - iDividend) / iDivisor);
+	}
+
 	template <typename Type>
 	inline Type clamp(const Type& value, const Type& low, const Type& high)
 	{
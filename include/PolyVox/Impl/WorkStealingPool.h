@@ -0,0 +1,302 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_WorkStealingPool_H__
+#define __PolyVox_WorkStealingPool_H__
+
+#include "PlatformDefinitions.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace PolyVox
+{
+	// The number of threads which algorithms use when they are asked for 'zero' threads.
+	inline uint32_t getDefaultThreadCount(void)
+	{
+		uint32_t uHardwareThreads = std::thread::hardware_concurrency();
+		return (uHardwareThreads > 0) ? uHardwareThreads : 1;
+	}
+
+	// A set of threads which run batches of tasks. Each thread starts with its own contiguous block of the task
+	// indices, so neighbouring tasks (e.g. tiles which share source chunks) tend to run on the same thread. A thread
+	// which runs out of work steals tasks from the far end of another thread's block, so that uneven tasks still
+	// balance. The threads are created once and reused for every call to execute().
+	class WorkStealingPool
+	{
+	public:
+		// The calling thread counts as one of the threads, so a pool with one thread runs everything inline.
+		explicit WorkStealingPool(uint32_t uNoOfThreads = 0)
+			:m_uGeneration(0)
+			, m_uBusyWorkers(0)
+			, m_bStopping(false)
+		{
+			if (uNoOfThreads == 0)
+			{
+				uNoOfThreads = getDefaultThreadCount();
+			}
+
+			for (uint32_t ct = 0; ct < uNoOfThreads; ct++)
+			{
+				m_vecQueues.emplace_back(new TaskQueue);
+			}
+
+			try
+			{
+				for (uint32_t ct = 1; ct < uNoOfThreads; ct++)
+				{
+					m_vecThreads.emplace_back(&WorkStealingPool::workerMain, this, ct);
+				}
+			}
+			catch (...)
+			{
+				stopWorkers();
+				throw;
+			}
+		}
+
+		~WorkStealingPool()
+		{
+			stopWorkers();
+		}
+
+		uint32_t getNoOfThreads(void) const
+		{
+			return static_cast<uint32_t>(m_vecQueues.size());
+		}
+
+		// Restricts thread 'uThread' to the CPU with index 'uCpu'. Thread zero is the calling thread, which is left alone, so
+		// this fails for it. It also fails if the operating system refuses or if it isn't supported on this platform.
+		bool setThreadAffinity(uint32_t uThread, uint32_t uCpu)
+		{
+			if ((uThread == 0) || (uThread >= getNoOfThreads()))
+			{
+				return false;
+			}
+
+#if defined(__linux__)
+			if (uCpu >= CPU_SETSIZE)
+			{
+				return false;
+			}
+
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(uCpu, &cpuSet);
+			return pthread_setaffinity_np(m_vecThreads[uThread - 1].native_handle(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+			(void)uCpu;
+			return false;
+#endif
+		}
+
+		// Calls 'function(uTask, uThread)' once for every task in the range [0, uNoOfTasks) and returns when they are all
+		// complete. 'uThread' is in the range [0, getNoOfThreads()) and can be used to index per-thread scratch data. If a
+		// task throws then the remaining tasks are abandoned and the first exception is rethrown here.
+		template <typename Function>
+		void execute(uint32_t uNoOfTasks, Function function)
+		{
+			const uint32_t uNoOfThreads = getNoOfThreads();
+
+			if ((uNoOfThreads == 1) || (uNoOfTasks <= 1))
+			{
+				for (uint32_t uTask = 0; uTask < uNoOfTasks; uTask++)
+				{
+					function(uTask, 0);
+				}
+				return;
+			}
+
+			for (uint32_t uThread = 0; uThread < uNoOfThreads; uThread++)
+			{
+				TaskQueue& queue = *m_vecQueues[uThread];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				const uint32_t uBegin = static_cast<uint32_t>((static_cast<uint64_t>(uNoOfTasks) * uThread) / uNoOfThreads);
+				const uint32_t uEnd = static_cast<uint32_t>((static_cast<uint64_t>(uNoOfTasks) * (uThread + 1)) / uNoOfThreads);
+				for (uint32_t uTask = uBegin; uTask < uEnd; uTask++)
+				{
+					queue.tasks.push_back(uTask);
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_function = function;
+				m_pException = nullptr;
+				m_uBusyWorkers = uNoOfThreads - 1;
+				m_uGeneration++;
+			}
+			m_cvWorkAvailable.notify_all();
+
+			runTasks(0);
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvWorkComplete.wait(lock, [this]{ return m_uBusyWorkers == 0; });
+			m_function = nullptr;
+
+			if (m_pException)
+			{
+				std::exception_ptr pException = m_pException;
+				m_pException = nullptr;
+				std::rethrow_exception(pException);
+			}
+		}
+
+	private:
+		struct TaskQueue
+		{
+			std::mutex mutex;
+			std::deque<uint32_t> tasks;
+		};
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		void workerMain(uint32_t uThread)
+		{
+			uint64_t uLastGeneration = 0;
+			for (;;)
+			{
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_cvWorkAvailable.wait(lock, [&]{ return m_bStopping || (m_uGeneration != uLastGeneration); });
+					if (m_bStopping)
+					{
+						return;
+					}
+					uLastGeneration = m_uGeneration;
+				}
+
+				runTasks(uThread);
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_uBusyWorkers == 0)
+				{
+					m_cvWorkComplete.notify_all();
+				}
+			}
+		}
+
+		void runTasks(uint32_t uThread)
+		{
+			uint32_t uTask;
+			while (popTask(uThread, uTask))
+			{
+				try
+				{
+					m_function(uTask, uThread);
+				}
+				catch (...)
+				{
+					{
+						std::lock_guard<std::mutex> lock(m_mutex);
+						if (!m_pException)
+						{
+							m_pException = std::current_exception();
+						}
+					}
+
+					// Abandon everything which hasn't started yet.
+					for (auto& pQueue : m_vecQueues)
+					{
+						std::lock_guard<std::mutex> lock(pQueue->mutex);
+						pQueue->tasks.clear();
+					}
+				}
+			}
+		}
+
+		// Takes the next task from this thread's own block, or steals one from the end of another thread's block.
+		// No tasks are added during execution, so once every queue is empty this thread has nothing left to do.
+		bool popTask(uint32_t uThread, uint32_t& uTask)
+		{
+			{
+				TaskQueue& queue = *m_vecQueues[uThread];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				if (!queue.tasks.empty())
+				{
+					uTask = queue.tasks.front();
+					queue.tasks.pop_front();
+					return true;
+				}
+			}
+
+			const uint32_t uNoOfThreads = getNoOfThreads();
+			for (uint32_t ct = 1; ct < uNoOfThreads; ct++)
+			{
+				TaskQueue& victim = *m_vecQueues[(uThread + ct) % uNoOfThreads];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.tasks.empty())
+				{
+					uTask = victim.tasks.back();
+					victim.tasks.pop_back();
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void stopWorkers(void)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_bStopping = true;
+			}
+			m_cvWorkAvailable.notify_all();
+
+			for (auto& thread : m_vecThreads)
+			{
+				thread.join();
+			}
+			m_vecThreads.clear();
+		}
+
+		std::vector< std::unique_ptr<TaskQueue> > m_vecQueues;
+		std::vector<std::thread> m_vecThreads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_cvWorkAvailable;
+		std::condition_variable m_cvWorkComplete;
+		std::function<void(uint32_t, uint32_t)> m_function;
+		std::exception_ptr m_pException;
+		uint64_t m_uGeneration;
+		uint32_t m_uBusyWorkers;
+		bool m_bStopping;
+	};
+}
+
+#endif //__PolyVox_WorkStealingPool_H__
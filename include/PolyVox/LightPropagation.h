@@ -0,0 +1,164 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_LightPropagation_H__
+#define __PolyVox_LightPropagation_H__
+
+#include "Impl/PlatformDefinitions.h"
+
+#include "DefaultLightController.h"
+#include "Region.h"
+#include "RegionScheduler.h"
+#include "Vector.h"
+
+#include <cstdint>
+#include <map>
+#include <type_traits>
+#include <vector>
+
+namespace PolyVox
+{
+	namespace LightChannels
+	{
+		/**
+		 * The two kinds of light which are tracked by the LightPropagator
+		 */
+		enum LightChannel
+		{
+			Block, ///< Light which is emitted by voxels such as torches or lava
+			Sky ///< Light which enters from the top of the region and travels down without fading
+		};
+	}
+	typedef LightChannels::LightChannel LightChannel;
+
+	/// The brightest light level. Light fades by one level for each voxel it travels through.
+	const uint8_t MaxLightLevel = 15;
+
+	/// Light is stored as one byte per voxel, with the block light in the lower four bits and the sky light in the upper four.
+	inline uint8_t getBlockLight(uint8_t uLight)
+	{
+		return uLight & 0x0F;
+	}
+
+	/// Light is stored as one byte per voxel, with the block light in the lower four bits and the sky light in the upper four.
+	inline uint8_t getSkyLight(uint8_t uLight)
+	{
+		return uLight >> 4;
+	}
+
+	/// Computes block light and sky light for a volume by flood filling, and keeps it up to date as the volume is edited.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// The light levels are written into a second 'companion' volume of bytes (see getBlockLight() and getSkyLight()) which covers
+	/// the same \a regBounds as the data. Light never spreads outside these bounds, and sky light enters through the top (highest
+	/// y) layer of them. A user supplied controller (see DefaultLightController) decides which voxels are transparent to light and
+	/// which emit block light.
+	///
+	/// Light is spread by breadth first 'add' passes, and when the volume is edited any light which came from the edited voxels
+	/// is first cleared by 'removal' passes (the approach used by most block based games). Work is bucketed into chunks of
+	/// LightPropagationChunkSideLength voxels. Each chunk's queue is processed to completion before anything which spills into
+	/// neighbouring chunks, which keeps the passes cache friendly, and because processing a chunk only touches the light in that
+	/// chunk all the chunks with pending work can be processed by different threads at once. This requires the data volume to
+	/// support concurrent reads and the light volume to support concurrent reads and writes (as RawVolume does), otherwise a
+	/// single thread is used.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType = DefaultLightController<typename VolumeType::VoxelType> >
+	class LightPropagator
+	{
+		static_assert(std::is_same<typename LightVolumeType::VoxelType, uint8_t>::value, "The light volume must store one byte per voxel.");
+
+	public:
+		/// The side length of the chunks which light propagation works on is two to the power of this.
+		static const int32_t LightPropagationChunkSideLengthPower = 5;
+		/// The side length of the chunks which light propagation works on.
+		static const int32_t LightPropagationChunkSideLength = 1 << LightPropagationChunkSideLengthPower;
+
+		/// Creates a propagator which reads from \a volData and writes light levels to \a volLight. Nothing is computed until calculate() is called.
+		LightPropagator(VolumeType* volData, LightVolumeType* volLight, const Region& regBounds, ControllerType controller = ControllerType(), uint32_t uNoOfThreads = 0);
+
+		/// Computes the light for the whole of the bounds from scratch.
+		void calculate(void);
+
+		/// Brings the light up to date after the voxels in \a regChanged have been modified.
+		void update(const Region& regChanged);
+		/// Brings the light up to date after the voxels in each of \a vecChangedRegions have been modified.
+		void update(const std::vector<Region>& vecChangedRegions);
+
+		/// Gets the region which light is computed for.
+		const Region& getBounds(void) const;
+
+	private:
+		// A single entry in one of the queues. For add passes it offers 'uLevel' to the voxel, or if 'uLevel' is zero it asks for
+		// the voxel's current light to be spread to its neighbours. For removal passes it tells the voxel that a neighbour which
+		// had light 'uLevel' has gone dark, and 'bFromAbove' records whether that neighbour was directly above it.
+		struct LightNode
+		{
+			LightNode(int32_t iX, int32_t iY, int32_t iZ, uint8_t uLevelIn, bool bFromAboveIn = false)
+				:x(iX), y(iY), z(iZ), uLevel(uLevelIn), bFromAbove(bFromAboveIn)
+			{
+			}
+
+			int32_t x, y, z;
+			uint8_t uLevel;
+			bool bFromAbove;
+		};
+
+		// Pending nodes, bucketed by the chunk which contains them.
+		typedef std::map< uint64_t, std::vector<LightNode> > LightNodeBuckets;
+
+		// The volumes are read and written through samplers which each task keeps while it works on a chunk, so that moving
+		// from a voxel to its neighbours doesn't look them up in the volume again.
+		typedef typename VolumeType::Sampler DataSampler;
+		typedef typename LightVolumeType::Sampler LightSampler;
+
+		static uint8_t getLevel(uint8_t uLight, LightChannel eChannel);
+		static uint8_t setLevel(uint8_t uLight, LightChannel eChannel, uint8_t uLevel);
+		static uint8_t peekNeighbourLight(const LightSampler& lightSampler, uint32_t uNeighbour);
+		uint8_t getSeedLight(const typename VolumeType::VoxelType& voxel, int32_t iY, LightChannel eChannel) const;
+
+		// Sets every voxel in 'region' back to the light it generates itself, calling 'function(x, y, z, uOldLevel, uSeed)' for each.
+		template <typename Function>
+		void resetLight(const Region& region, LightChannel eChannel, Function function);
+
+		uint64_t getChunkKey(int32_t iX, int32_t iY, int32_t iZ) const;
+		void pushNode(LightNodeBuckets& buckets, const LightNode& node) const;
+
+		void runPasses(LightChannel eChannel, LightNodeBuckets& removalBuckets, LightNodeBuckets& addBuckets);
+		void processRemovalChunk(LightChannel eChannel, uint64_t uChunkKey, std::vector<LightNode>& vecQueue, LightNodeBuckets& removalOutbox, LightNodeBuckets& addOutbox);
+		void processAddChunk(LightChannel eChannel, uint64_t uChunkKey, std::vector<LightNode>& vecQueue, LightNodeBuckets& addOutbox);
+
+		static uint32_t getNoOfThreads(uint32_t uNoOfThreads);
+
+		VolumeType* m_volData;
+		LightVolumeType* m_volLight;
+		Region m_regBounds;
+		ControllerType m_controller;
+
+		// Its tiles are the parts of the chunks which overlap the bounds, and it also runs the tasks of each round of the passes.
+		RegionScheduler m_scheduler;
+	};
+}
+
+#include "LightPropagation.inl"
+
+#endif //__PolyVox_LightPropagation_H__
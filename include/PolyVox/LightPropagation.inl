@@ -0,0 +1,424 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	// The six face neighbours of a voxel. The one at index 3 is directly below.
+	const int32_t LightNeighbourOffsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	const uint32_t LightNeighbourBelow = 3;
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	LightPropagator<VolumeType, LightVolumeType, ControllerType>::LightPropagator(VolumeType* volData, LightVolumeType* volLight, const Region& regBounds, ControllerType controller, uint32_t uNoOfThreads)
+		:m_volData(volData)
+		, m_volLight(volLight)
+		, m_regBounds(regBounds)
+		, m_controller(controller)
+		, m_scheduler(getNoOfThreads(uNoOfThreads), LightPropagationChunkSideLength)
+	{
+		POLYVOX_THROW_IF(!m_regBounds.isValid(), std::invalid_argument, "Light propagation bounds are not valid.");
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::calculate(void)
+	{
+		const uint32_t uNoOfChunks = m_scheduler.getNoOfTiles(m_regBounds);
+
+		const LightChannel channels[] = { LightChannels::Block, LightChannels::Sky };
+		for (LightChannel eChannel : channels)
+		{
+			// Reset every voxel to the light it generates itself. Each chunk is only written by one task so this can be done in parallel.
+			std::vector< std::vector<LightNode> > vecSeeds(uNoOfChunks);
+			m_scheduler.forEachTile(m_regBounds, [&](const Region& regChunk, uint32_t uChunk, uint32_t /*uWorker*/)
+			{
+				resetLight(regChunk, eChannel, [&](int32_t iX, int32_t iY, int32_t iZ, uint8_t /*uOldLevel*/, uint8_t uSeed)
+				{
+					if (uSeed > 0)
+					{
+						vecSeeds[uChunk].push_back(LightNode(iX, iY, iZ, 0));
+					}
+				});
+			});
+
+			LightNodeBuckets removalBuckets;
+			LightNodeBuckets addBuckets;
+			for (uint32_t uChunk = 0; uChunk < uNoOfChunks; uChunk++)
+			{
+				if (!vecSeeds[uChunk].empty())
+				{
+					const Vector3DInt32 v3dLower = m_scheduler.getTile(m_regBounds, uChunk).getLowerCorner();
+					addBuckets[getChunkKey(v3dLower.getX(), v3dLower.getY(), v3dLower.getZ())].swap(vecSeeds[uChunk]);
+				}
+			}
+
+			runPasses(eChannel, removalBuckets, addBuckets);
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::update(const Region& regChanged)
+	{
+		update(std::vector<Region>(1, regChanged));
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::update(const std::vector<Region>& vecChangedRegions)
+	{
+		const LightChannel channels[] = { LightChannels::Block, LightChannels::Sky };
+		for (LightChannel eChannel : channels)
+		{
+			LightNodeBuckets removalBuckets;
+			LightNodeBuckets addBuckets;
+
+			for (auto regChanged : vecChangedRegions)
+			{
+				if (!intersects(regChanged, m_regBounds))
+				{
+					continue;
+				}
+				regChanged.cropTo(m_regBounds);
+
+				// The changed voxels start again from whatever light they generate themselves. Any light they had must be
+				// removed from the voxels around them, and those voxels must then spread their light back in if they can.
+				resetLight(regChanged, eChannel, [&](int32_t iX, int32_t iY, int32_t iZ, uint8_t uOldLevel, uint8_t uSeed)
+				{
+					if (uSeed > 0)
+					{
+						pushNode(addBuckets, LightNode(iX, iY, iZ, 0));
+					}
+
+					for (uint32_t uNeighbour = 0; uNeighbour < 6; uNeighbour++)
+					{
+						const int32_t iNeighbourX = iX + LightNeighbourOffsets[uNeighbour][0];
+						const int32_t iNeighbourY = iY + LightNeighbourOffsets[uNeighbour][1];
+						const int32_t iNeighbourZ = iZ + LightNeighbourOffsets[uNeighbour][2];
+
+						// Neighbours inside the changed region are being reset anyway.
+						if (!m_regBounds.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ) || regChanged.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ))
+						{
+							continue;
+						}
+
+						if (uOldLevel > 0)
+						{
+							pushNode(removalBuckets, LightNode(iNeighbourX, iNeighbourY, iNeighbourZ, uOldLevel, uNeighbour == LightNeighbourBelow));
+						}
+						pushNode(addBuckets, LightNode(iNeighbourX, iNeighbourY, iNeighbourZ, 0));
+					}
+				});
+			}
+
+			runPasses(eChannel, removalBuckets, addBuckets);
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	const Region& LightPropagator<VolumeType, LightVolumeType, ControllerType>::getBounds(void) const
+	{
+		return m_regBounds;
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint8_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::getLevel(uint8_t uLight, LightChannel eChannel)
+	{
+		return (eChannel == LightChannels::Block) ? getBlockLight(uLight) : getSkyLight(uLight);
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint8_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::setLevel(uint8_t uLight, LightChannel eChannel, uint8_t uLevel)
+	{
+		return (eChannel == LightChannels::Block) ? static_cast<uint8_t>((uLight & 0xF0) | uLevel) : static_cast<uint8_t>((uLight & 0x0F) | (uLevel << 4));
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint8_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::peekNeighbourLight(const LightSampler& lightSampler, uint32_t uNeighbour)
+	{
+		// In the same order as LightNeighbourOffsets.
+		switch (uNeighbour)
+		{
+		case 0:
+			return lightSampler.peekVoxel1nx0py0pz();
+		case 1:
+			return lightSampler.peekVoxel1px0py0pz();
+		case 2:
+			return lightSampler.peekVoxel0px1py0pz();
+		case 3:
+			return lightSampler.peekVoxel0px1ny0pz();
+		case 4:
+			return lightSampler.peekVoxel0px0py1nz();
+		default:
+			return lightSampler.peekVoxel0px0py1pz();
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint8_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::getSeedLight(const typename VolumeType::VoxelType& voxel, int32_t iY, LightChannel eChannel) const
+	{
+		if (eChannel == LightChannels::Block)
+		{
+			return (std::min)(m_controller.getEmittedLight(voxel), MaxLightLevel);
+		}
+		else
+		{
+			return ((iY == m_regBounds.getUpperY()) && m_controller.isTransparent(voxel)) ? MaxLightLevel : 0;
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	template <typename Function>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::resetLight(const Region& region, LightChannel eChannel, Function function)
+	{
+		DataSampler dataSampler(m_volData);
+		LightSampler lightSampler(m_volLight);
+		for (int32_t iZ = region.getLowerZ(); iZ <= region.getUpperZ(); iZ++)
+		{
+			for (int32_t iY = region.getLowerY(); iY <= region.getUpperY(); iY++)
+			{
+				dataSampler.setPosition(region.getLowerX(), iY, iZ);
+				lightSampler.setPosition(region.getLowerX(), iY, iZ);
+				for (int32_t iX = region.getLowerX(); iX <= region.getUpperX(); iX++)
+				{
+					const uint8_t uLight = lightSampler.getVoxel();
+					const uint8_t uSeed = getSeedLight(dataSampler.getVoxel(), iY, eChannel);
+					lightSampler.setVoxel(setLevel(uLight, eChannel, uSeed));
+					function(iX, iY, iZ, getLevel(uLight, eChannel), uSeed);
+
+					dataSampler.movePositiveX();
+					lightSampler.movePositiveX();
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint64_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::getChunkKey(int32_t iX, int32_t iY, int32_t iZ) const
+	{
+		// The shifts round towards negative infinity, and the offsets make the chunk positions positive.
+		const uint64_t uChunkX = static_cast<uint32_t>((iX >> LightPropagationChunkSideLengthPower) + (1 << 20));
+		const uint64_t uChunkY = static_cast<uint32_t>((iY >> LightPropagationChunkSideLengthPower) + (1 << 20));
+		const uint64_t uChunkZ = static_cast<uint32_t>((iZ >> LightPropagationChunkSideLengthPower) + (1 << 20));
+		return (uChunkZ << 42) | (uChunkY << 21) | uChunkX;
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::pushNode(LightNodeBuckets& buckets, const LightNode& node) const
+	{
+		buckets[getChunkKey(node.x, node.y, node.z)].push_back(node);
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::runPasses(LightChannel eChannel, LightNodeBuckets& removalBuckets, LightNodeBuckets& addBuckets)
+	{
+		// Each round processes every chunk which has pending work. Whatever spills over into other chunks gets
+		// collected separately for each task, and then merged to form the work for the next round.
+		while (!removalBuckets.empty())
+		{
+			std::vector< std::pair< uint64_t, std::vector<LightNode> > > vecTasks;
+			for (auto& bucket : removalBuckets)
+			{
+				vecTasks.push_back(std::make_pair(bucket.first, std::vector<LightNode>()));
+				vecTasks.back().second.swap(bucket.second);
+			}
+			removalBuckets.clear();
+
+			std::vector<LightNodeBuckets> vecRemovalOutboxes(vecTasks.size());
+			std::vector<LightNodeBuckets> vecAddOutboxes(vecTasks.size());
+			m_scheduler.forEachTask(static_cast<uint32_t>(vecTasks.size()), [&](uint32_t uTask, uint32_t /*uWorker*/)
+			{
+				processRemovalChunk(eChannel, vecTasks[uTask].first, vecTasks[uTask].second, vecRemovalOutboxes[uTask], vecAddOutboxes[uTask]);
+			});
+
+			for (uint32_t uTask = 0; uTask < vecTasks.size(); uTask++)
+			{
+				for (auto& bucket : vecRemovalOutboxes[uTask])
+				{
+					std::vector<LightNode>& vecNodes = removalBuckets[bucket.first];
+					vecNodes.insert(vecNodes.end(), bucket.second.begin(), bucket.second.end());
+				}
+				for (auto& bucket : vecAddOutboxes[uTask])
+				{
+					std::vector<LightNode>& vecNodes = addBuckets[bucket.first];
+					vecNodes.insert(vecNodes.end(), bucket.second.begin(), bucket.second.end());
+				}
+			}
+		}
+
+		while (!addBuckets.empty())
+		{
+			std::vector< std::pair< uint64_t, std::vector<LightNode> > > vecTasks;
+			for (auto& bucket : addBuckets)
+			{
+				vecTasks.push_back(std::make_pair(bucket.first, std::vector<LightNode>()));
+				vecTasks.back().second.swap(bucket.second);
+			}
+			addBuckets.clear();
+
+			std::vector<LightNodeBuckets> vecAddOutboxes(vecTasks.size());
+			m_scheduler.forEachTask(static_cast<uint32_t>(vecTasks.size()), [&](uint32_t uTask, uint32_t /*uWorker*/)
+			{
+				processAddChunk(eChannel, vecTasks[uTask].first, vecTasks[uTask].second, vecAddOutboxes[uTask]);
+			});
+
+			for (uint32_t uTask = 0; uTask < vecTasks.size(); uTask++)
+			{
+				for (auto& bucket : vecAddOutboxes[uTask])
+				{
+					std::vector<LightNode>& vecNodes = addBuckets[bucket.first];
+					vecNodes.insert(vecNodes.end(), bucket.second.begin(), bucket.second.end());
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::processRemovalChunk(LightChannel eChannel, uint64_t uChunkKey, std::vector<LightNode>& vecQueue, LightNodeBuckets& removalOutbox, LightNodeBuckets& addOutbox)
+	{
+		DataSampler dataSampler(m_volData);
+		LightSampler lightSampler(m_volLight);
+
+		// The queue grows as we go, so it is indexed rather than iterated.
+		for (uint32_t uNode = 0; uNode < vecQueue.size(); uNode++)
+		{
+			const LightNode node = vecQueue[uNode];
+			lightSampler.setPosition(node.x, node.y, node.z);
+			const uint8_t uLight = lightSampler.getVoxel();
+			const uint8_t uCurrentLevel = getLevel(uLight, eChannel);
+			if (uCurrentLevel == 0)
+			{
+				continue;
+			}
+
+			// If our light is dimmer than the neighbour which went dark then it probably came from that neighbour, so it must go
+			// too. Full strength sky light which came from directly above is the same strength as its source, but must also go.
+			const bool bRemove = (uCurrentLevel < node.uLevel) ||
+				((eChannel == LightChannels::Sky) && node.bFromAbove && (node.uLevel == MaxLightLevel) && (uCurrentLevel == MaxLightLevel));
+			if (!bRemove)
+			{
+				// Our light has some other source, so we can use it to refill the area which went dark.
+				pushNode(addOutbox, LightNode(node.x, node.y, node.z, 0));
+				continue;
+			}
+
+			dataSampler.setPosition(node.x, node.y, node.z);
+			const uint8_t uSeed = getSeedLight(dataSampler.getVoxel(), node.y, eChannel);
+			lightSampler.setVoxel(setLevel(uLight, eChannel, uSeed));
+			if (uSeed > 0)
+			{
+				pushNode(addOutbox, LightNode(node.x, node.y, node.z, 0));
+			}
+
+			for (uint32_t uNeighbour = 0; uNeighbour < 6; uNeighbour++)
+			{
+				const int32_t iNeighbourX = node.x + LightNeighbourOffsets[uNeighbour][0];
+				const int32_t iNeighbourY = node.y + LightNeighbourOffsets[uNeighbour][1];
+				const int32_t iNeighbourZ = node.z + LightNeighbourOffsets[uNeighbour][2];
+				if (!m_regBounds.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ))
+				{
+					continue;
+				}
+
+				const LightNode neighbourNode(iNeighbourX, iNeighbourY, iNeighbourZ, uCurrentLevel, uNeighbour == LightNeighbourBelow);
+				if (getChunkKey(iNeighbourX, iNeighbourY, iNeighbourZ) == uChunkKey)
+				{
+					vecQueue.push_back(neighbourNode);
+				}
+				else
+				{
+					pushNode(removalOutbox, neighbourNode);
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	void LightPropagator<VolumeType, LightVolumeType, ControllerType>::processAddChunk(LightChannel eChannel, uint64_t uChunkKey, std::vector<LightNode>& vecQueue, LightNodeBuckets& addOutbox)
+	{
+		DataSampler dataSampler(m_volData);
+		LightSampler lightSampler(m_volLight);
+
+		// The queue grows as we go, so it is indexed rather than iterated.
+		for (uint32_t uNode = 0; uNode < vecQueue.size(); uNode++)
+		{
+			const LightNode node = vecQueue[uNode];
+			lightSampler.setPosition(node.x, node.y, node.z);
+			const uint8_t uLight = lightSampler.getVoxel();
+			uint8_t uCurrentLevel = getLevel(uLight, eChannel);
+
+			// Nodes with a level are offering light to the voxel, which only accepts it if it is an improvement.
+			if (node.uLevel > 0)
+			{
+				if (node.uLevel <= uCurrentLevel)
+				{
+					continue;
+				}
+				dataSampler.setPosition(node.x, node.y, node.z);
+				if (!m_controller.isTransparent(dataSampler.getVoxel()))
+				{
+					continue;
+				}
+				lightSampler.setVoxel(setLevel(uLight, eChannel, node.uLevel));
+				uCurrentLevel = node.uLevel;
+			}
+
+			if (uCurrentLevel <= 1)
+			{
+				continue;
+			}
+
+			for (uint32_t uNeighbour = 0; uNeighbour < 6; uNeighbour++)
+			{
+				const int32_t iNeighbourX = node.x + LightNeighbourOffsets[uNeighbour][0];
+				const int32_t iNeighbourY = node.y + LightNeighbourOffsets[uNeighbour][1];
+				const int32_t iNeighbourZ = node.z + LightNeighbourOffsets[uNeighbour][2];
+				if (!m_regBounds.containsPoint(iNeighbourX, iNeighbourY, iNeighbourZ))
+				{
+					continue;
+				}
+
+				// Light fades as it travels, except for full strength sky light travelling straight down.
+				const bool bSkyLightFalling = (eChannel == LightChannels::Sky) && (uNeighbour == LightNeighbourBelow) && (uCurrentLevel == MaxLightLevel);
+				const uint8_t uOfferedLevel = bSkyLightFalling ? MaxLightLevel : uCurrentLevel - 1;
+
+				if (getChunkKey(iNeighbourX, iNeighbourY, iNeighbourZ) == uChunkKey)
+				{
+					// We own this voxel, so we can avoid queuing offers which it won't accept.
+					if (getLevel(peekNeighbourLight(lightSampler, uNeighbour), eChannel) < uOfferedLevel)
+					{
+						vecQueue.push_back(LightNode(iNeighbourX, iNeighbourY, iNeighbourZ, uOfferedLevel));
+					}
+				}
+				else
+				{
+					pushNode(addOutbox, LightNode(iNeighbourX, iNeighbourY, iNeighbourZ, uOfferedLevel));
+				}
+			}
+		}
+	}
+
+	template<typename VolumeType, typename LightVolumeType, typename ControllerType>
+	uint32_t LightPropagator<VolumeType, LightVolumeType, ControllerType>::getNoOfThreads(uint32_t uNoOfThreads)
+	{
+		const bool bCanRunInParallel = VolumeType::SupportsConcurrentReads && LightVolumeType::SupportsConcurrentReads && LightVolumeType::SupportsConcurrentWrites;
+		return bCanRunInParallel ? uNoOfThreads : 1;
+	}
+}
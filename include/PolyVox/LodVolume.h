@@ -0,0 +1,96 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_LodVolume_H__
+#define __PolyVox_LodVolume_H__
+
+#include "BaseVolume.h"
+#include "PagedVolume.h"
+#include "Vector.h"
+
+#include <stdexcept> //For invalid_argument
+
+namespace PolyVox
+{
+	/**
+	 * A read-only view of one of the reduced resolution levels of a PagedVolume (see PagedVolume::setNoOfLodLevels()).
+	 *
+	 * It can be given to the surface extractors and other algorithms in place of the PagedVolume, so that distant parts of the
+	 * volume are processed at a lower level of detail from its small reduced resolution chunks. Positions are in the coordinates
+	 * of the level, so the region to process is usually found with getMipmapRegion(). The PagedVolume must outlive the view.
+	 */
+	template <typename VoxelType>
+	class LodVolume : public BaseVolume<VoxelType>
+	{
+	public:
+#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< LodVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< LodVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			Sampler(LodVolume<VoxelType>* volume)
+				:BaseVolume<VoxelType>::template Sampler< LodVolume<VoxelType> >(volume)
+			{
+			}
+		};
+#endif // SWIG
+
+		/// Constructor for a view of the given level, which must be between one and the number of levels kept by the volume.
+		LodVolume(PagedVolume<VoxelType>* pVolume, uint32_t uLevel)
+			:BaseVolume<VoxelType>()
+			, m_pVolume(pVolume)
+			, m_uLevel(uLevel)
+		{
+			POLYVOX_THROW_IF(!pVolume, std::invalid_argument, "You must provide a valid volume");
+			POLYVOX_THROW_IF((uLevel == 0) || (uLevel > pVolume->getNoOfLodLevels()), std::invalid_argument, "The volume does not keep the requested LOD level");
+		}
+
+		/// Gets the level of the volume which this is a view of.
+		uint32_t getLevel(void) const
+		{
+			return m_uLevel;
+		}
+
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+		{
+			return m_pVolume->getLodVoxel(m_uLevel, uXPos, uYPos, uZPos);
+		}
+
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxel(const Vector3DInt32& v3dPos) const
+		{
+			return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+		}
+
+	private:
+		PagedVolume<VoxelType>* m_pVolume;
+		uint32_t m_uLevel;
+	};
+}
+
+#endif //__PolyVox_LodVolume_H__
@@ -25,9 +25,16 @@
 #ifndef __PolyVox_LowPassFilter_H__
 #define __PolyVox_LowPassFilter_H__
 
-#include "Impl/IteratorController.h"
+#include "Impl/Utility.h"
 
+#include "ChunkView.h"
+#include "RawVolume.h"
 #include "Region.h"
+#include "RegionScheduler.h"
+#include "VolumeCopy.h"
+
+#include <mutex>
+#include <vector>
 
 namespace PolyVox
 {
@@ -38,12 +45,22 @@ namespace PolyVox
 	public:
 		LowPassFilter(SrcVolumeType* pVolSrc, Region regSrc, DstVolumeType* pVolDst, Region regDst, uint32_t uKernelSize);
 
-		/// Execute a standard approach to filtering which performs a number of neighbourhood look-ups per voxel.
+		/// Execute the filter using running sums, which take the same time per voxel for any kernel size.
 		void execute();
-		/// Execute a version with 'Summed Area Tables'. This should be faster for large kernel sizes but this hasn't really been confirmed yet.
+		/// Kept for compatibility, this now gives the same results as execute() and takes the same time.
 		void executeSAT();
+		/// Execute the filter on several threads by splitting the destination into tiles.
+		void executeParallel(uint32_t uNoOfThreads = 0, uint32_t uTileSideLength = 32);
+		/// Execute the filter on the threads of an existing scheduler, using its tiles.
+		void executeParallel(RegionScheduler& scheduler);
 
 	private:
+		// Sums each run of 'uKernelSize' consecutive values, writing 'uDstLength' results.
+		static void sumWindows(const AccumulationType* pSrc, AccumulationType* pDst, uint32_t uDstLength, uint32_t uKernelSize);
+		// Filters the voxels in 'regSrcBlock' and writes them to the destination starting at 'v3dDstLowerCorner'.
+		// If the mutexes are given then they are held while reading (or writing) each slice.
+		void filterBlock(const Region& regSrcBlock, const Vector3DInt32& v3dDstLowerCorner, std::mutex* pSrcMutex = nullptr, std::mutex* pDstMutex = nullptr);
+
 		//Source data
 		SrcVolumeType* m_pVolSrc;
 		Region m_regSrc;
@@ -22,8 +22,6 @@
 * SOFTWARE.
 *******************************************************************************/
 
-#include "PolyVox/RawVolume.h" // Currently used by exectureSAT() method - should be replaced by PagedVolume or a template parameter?
-
 namespace PolyVox
 {
 	/**
@@ -54,204 +52,218 @@ namespace PolyVox
 		}
 	}
 
+	/**
+	 * Each destination voxel is set to the average of the source voxels in a cube of side \a uKernelSize around the
+	 * corresponding source voxel. Voxels outside of the source region are read from the source volume as normal.
+	 *
+	 * The cube is summed separably with running sums along x, y and z, so the cost per voxel does not depend on the
+	 * kernel size.
+	 */
 	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
 	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::execute()
 	{
-		int32_t iSrcMinX = m_regSrc.getLowerX();
-		int32_t iSrcMinY = m_regSrc.getLowerY();
-		int32_t iSrcMinZ = m_regSrc.getLowerZ();
-
-		int32_t iSrcMaxX = m_regSrc.getUpperX();
-		int32_t iSrcMaxY = m_regSrc.getUpperY();
-		int32_t iSrcMaxZ = m_regSrc.getUpperZ();
+		filterBlock(m_regSrc, m_regDst.getLowerCorner());
+	}
 
-		int32_t iDstMinX = m_regDst.getLowerX();
-		int32_t iDstMinY = m_regDst.getLowerY();
-		int32_t iDstMinZ = m_regDst.getLowerZ();
+	/**
+	 * This used to build a summed area table covering the whole source region. The running sums used by execute() have
+	 * the same cost per voxel while only needing memory for a few slices, so this now gives identical results to it.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::executeSAT()
+	{
+		filterBlock(m_regSrc, m_regDst.getLowerCorner());
+	}
 
-		//int32_t iDstMaxX = m_regDst.getUpperX();
-		//int32_t iDstMaxY = m_regDst.getUpperY();
-		//int32_t iDstMaxZ = m_regDst.getUpperZ();
+	/**
+	 * The destination region is split into tiles on a grid of \a uTileSideLength, measured from the origin of the destination
+	 * volume. If this matches the chunk size of a PagedVolume then each tile covers whole chunks and different threads don't
+	 * work on the same chunk. Each tile reads its own halo from the source, so the results match execute() (exactly for integer
+	 * accumulation types, and to within rounding for floating point ones).
+	 *
+	 * Volumes which report \a SupportsConcurrentReads or \a SupportsConcurrentWrites (such as RawVolume) are accessed
+	 * freely from all threads. Other volumes (such as PagedVolume) are accessed by one thread at a time, with a lock taken
+	 * once per slice of a tile rather than once per voxel, and the filtering itself still runs in parallel.
+	 *
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 * \param uTileSideLength The side length of the tiles, which should normally match the chunk size of the destination
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::executeParallel(uint32_t uNoOfThreads, uint32_t uTileSideLength)
+	{
+		RegionScheduler scheduler(uNoOfThreads, uTileSideLength);
+		executeParallel(scheduler);
+	}
 
-		typename SrcVolumeType::Sampler srcSampler(m_pVolSrc);
+	/**
+	 * As above, with the destination split into the tiles of \a scheduler. Code which filters repeatedly can create the
+	 * scheduler once and reuse its threads, rather than having them created for every call.
+	 *
+	 * \param scheduler The scheduler whose threads the tiles are shared between
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::executeParallel(RegionScheduler& scheduler)
+	{
+		VolumeLocks<SrcVolumeType, DstVolumeType> locks(scheduler, m_pVolSrc, m_pVolDst);
 
-		for (int32_t iSrcZ = iSrcMinZ, iDstZ = iDstMinZ; iSrcZ <= iSrcMaxZ; iSrcZ++, iDstZ++)
+		const Vector3DInt32 v3dDstToSrc = m_regSrc.getLowerCorner() - m_regDst.getLowerCorner();
+		scheduler.forEachTile(m_regDst, [&](const Region& regDstTile, uint32_t /*uTile*/, uint32_t /*uWorker*/)
 		{
-			for (int32_t iSrcY = iSrcMinY, iDstY = iDstMinY; iSrcY <= iSrcMaxY; iSrcY++, iDstY++)
-			{
-				for (int32_t iSrcX = iSrcMinX, iDstX = iDstMinX; iSrcX <= iSrcMaxX; iSrcX++, iDstX++)
-				{
-					AccumulationType tSrcVoxel(0);
-					srcSampler.setPosition(iSrcX, iSrcY, iSrcZ);
-
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1ny1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1ny0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1ny1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx0py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx0py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx0py1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1nx1py1pz());
-
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1ny1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1ny0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1ny1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px0py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px0py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px0py1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel0px1py1pz());
-
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1ny1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1ny0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1ny1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px0py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px0py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px0py1pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1py1nz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1py0pz());
-					tSrcVoxel += static_cast<AccumulationType>(srcSampler.peekVoxel1px1py1pz());
+			Region regSrcTile = regDstTile;
+			regSrcTile.shift(v3dDstToSrc);
 
-					tSrcVoxel /= 27;
-
-					//tSrcVoxel.setDensity(uDensity);
-					m_pVolDst->setVoxel(iSrcX, iSrcY, iSrcZ, static_cast<typename DstVolumeType::VoxelType>(tSrcVoxel));
-				}
-			}
-		}
+			filterBlock(regSrcTile, regDstTile.getLowerCorner(), locks.getSrcMutex(), locks.getDstMutex());
+		});
 	}
 
 	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
-	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::executeSAT()
+	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::sumWindows(const AccumulationType* pSrc, AccumulationType* pDst, uint32_t uDstLength, uint32_t uKernelSize)
 	{
-		const uint32_t border = (m_uKernelSize - 1) / 2;
-
-		Vector3DInt32 satLowerCorner = m_regSrc.getLowerCorner() - Vector3DInt32(border, border, border);
-		Vector3DInt32 satUpperCorner = m_regSrc.getUpperCorner() + Vector3DInt32(border, border, border);
-
-		//Use floats for the SAT volume to ensure it works with negative
-		//densities and with both integral and floating point input volumes.
-		RawVolume<AccumulationType> satVolume(Region(satLowerCorner, satUpperCorner));
-
-		//Clear to zeros (necessary?)
-		//FIXME - use Volume::fill() method. Implemented in base class as below
-		//but with optimised implementations in subclasses?
-		for (int32_t z = satLowerCorner.getZ(); z <= satUpperCorner.getZ(); z++)
+		AccumulationType tSum(0);
+		for (uint32_t ct = 0; ct < uKernelSize; ct++)
 		{
-			for (int32_t y = satLowerCorner.getY(); y <= satUpperCorner.getY(); y++)
-			{
-				for (int32_t x = satLowerCorner.getX(); x <= satUpperCorner.getX(); x++)
-				{
-					satVolume.setVoxel(x, y, z, 0);
-				}
-			}
+			tSum += pSrc[ct];
 		}
+		pDst[0] = tSum;
 
-		typename RawVolume<AccumulationType>::Sampler satVolumeIter(&satVolume);
-
-		IteratorController<typename RawVolume<AccumulationType>::Sampler> satIterCont;
-		satIterCont.m_regValid = Region(satLowerCorner, satUpperCorner);
-		satIterCont.m_Iter = &satVolumeIter;
-		satIterCont.reset();
-
-		typename SrcVolumeType::Sampler srcVolumeIter(m_pVolSrc);
-
-		IteratorController<typename SrcVolumeType::Sampler> srcIterCont;
-		srcIterCont.m_regValid = Region(satLowerCorner, satUpperCorner);
-		srcIterCont.m_Iter = &srcVolumeIter;
-		srcIterCont.reset();
-
-		do
+		for (uint32_t ct = 1; ct < uDstLength; ct++)
 		{
-			AccumulationType previousSum = static_cast<AccumulationType>(satVolumeIter.peekVoxel1nx0py0pz());
-			AccumulationType currentVal = static_cast<AccumulationType>(srcVolumeIter.getVoxel());
-
-			satVolumeIter.setVoxel(previousSum + currentVal);
-
-			srcIterCont.moveForward();
-
-		} while (satIterCont.moveForward());
+			tSum += pSrc[ct + uKernelSize - 1];
+			tSum -= pSrc[ct - 1];
+			pDst[ct] = tSum;
+		}
+	}
 
-		//Build SAT in three passes
-		/*for(int32_t z = satLowerCorner.getZ(); z <= satUpperCorner.getZ(); z++)
-		{
-		for(int32_t y = satLowerCorner.getY(); y <= satUpperCorner.getY(); y++)
-		{
-		for(int32_t x = satLowerCorner.getX(); x <= satUpperCorner.getX(); x++)
+	template< typename SrcVolumeType, typename DstVolumeType, typename AccumulationType>
+	void LowPassFilter<SrcVolumeType, DstVolumeType, AccumulationType>::filterBlock(const Region& regSrcBlock, const Vector3DInt32& v3dDstLowerCorner, std::mutex* pSrcMutex, std::mutex* pDstMutex)
+	{
+		typedef typename DstVolumeType::VoxelType DstVoxelType;
+
+		const int32_t iBorder = static_cast<int32_t>((m_uKernelSize - 1) / 2);
+		// Signed, so that negative sums of integers are divided correctly.
+		const int32_t iKernelVolume = static_cast<int32_t>(m_uKernelSize * m_uKernelSize * m_uKernelSize);
+
+		const uint32_t uWidth = regSrcBlock.getWidthInVoxels();
+		const uint32_t uHeight = regSrcBlock.getHeightInVoxels();
+		const uint32_t uDepth = regSrcBlock.getDepthInVoxels();
+		const uint32_t uSliceSize = uWidth * uHeight;
+
+		// The source has to be read one border's width beyond the block on every side.
+		const uint32_t uPaddedWidth = uWidth + m_uKernelSize - 1;
+		const uint32_t uPaddedHeight = uHeight + m_uKernelSize - 1;
+		const uint32_t uPaddedDepth = uDepth + m_uKernelSize - 1;
+
+		std::vector<AccumulationType> vecSrcRow(uPaddedWidth);
+		// Sums along x for every row of the current padded slice.
+		std::vector<AccumulationType> vecRowSums(uWidth * uPaddedHeight);
+		// Sums along x and y for the last 'kernel size' slices, used as a ring buffer.
+		std::vector<AccumulationType> vecSliceSums(uSliceSize * m_uKernelSize);
+		// Sums along x, y and z for the slice currently being written.
+		std::vector<AccumulationType> vecCubeSums(uSliceSize, AccumulationType(0));
+
+		// Each slice of results is built in a small RawVolume, so that copyVolume() can write it straight into the storage
+		// of the destination rather than setting one voxel at a time.
+		const Region regDstSlice(0, 0, 0, static_cast<int32_t>(uWidth) - 1, static_cast<int32_t>(uHeight) - 1, 0);
+		RawVolume<DstVoxelType> volDstSlice(regDstSlice);
+		DstVoxelType* pDstSlice = nullptr;
+		int32_t iDstSliceYStride = 0;
+		volDstSlice.forEachChunk(regDstSlice, [&](ChunkView<DstVoxelType>& view)
 		{
-		AccumulationType previousSum = static_cast<AccumulationType>(satVolume.getVoxel(x-1,y,z));
-		AccumulationType currentVal = static_cast<AccumulationType>(m_pVolSrc->getVoxel(x,y,z));
+			pDstSlice = view.getWritableData();
+			iDstSliceYStride = view.getYStride();
+		});
 
-		satVolume.setVoxel(x,y,z,previousSum + currentVal);
-		}
-		}
-		}*/
-
-		for (int32_t z = satLowerCorner.getZ(); z <= satUpperCorner.getZ(); z++)
+		for (uint32_t uPaddedZ = 0; uPaddedZ < uPaddedDepth; uPaddedZ++)
 		{
-			for (int32_t y = satLowerCorner.getY(); y <= satUpperCorner.getY(); y++)
+			const int32_t iSrcZ = regSrcBlock.getLowerZ() - iBorder + static_cast<int32_t>(uPaddedZ);
+
 			{
-				for (int32_t x = satLowerCorner.getX(); x <= satUpperCorner.getX(); x++)
+				std::unique_lock<std::mutex> srcLock;
+				if (pSrcMutex)
 				{
-					AccumulationType previousSum = static_cast<AccumulationType>(satVolume.getVoxel(x, y - 1, z));
-					AccumulationType currentSum = static_cast<AccumulationType>(satVolume.getVoxel(x, y, z));
+					srcLock = std::unique_lock<std::mutex>(*pSrcMutex);
+				}
 
-					satVolume.setVoxel(x, y, z, previousSum + currentSum);
+				// The sampler pins the chunks it visits, so it must not outlive the lock.
+				typename SrcVolumeType::Sampler srcSampler(m_pVolSrc);
+				for (uint32_t uPaddedY = 0; uPaddedY < uPaddedHeight; uPaddedY++)
+				{
+					srcSampler.setPosition(regSrcBlock.getLowerX() - iBorder, regSrcBlock.getLowerY() - iBorder + static_cast<int32_t>(uPaddedY), iSrcZ);
+					for (uint32_t uPaddedX = 0; uPaddedX < uPaddedWidth; uPaddedX++)
+					{
+						vecSrcRow[uPaddedX] = static_cast<AccumulationType>(srcSampler.getVoxel());
+						srcSampler.movePositiveX();
+					}
+
+					sumWindows(&vecSrcRow[0], &vecRowSums[uPaddedY * uWidth], uWidth, m_uKernelSize);
 				}
 			}
-		}
 
-		for (int32_t z = satLowerCorner.getZ(); z <= satUpperCorner.getZ(); z++)
-		{
-			for (int32_t y = satLowerCorner.getY(); y <= satUpperCorner.getY(); y++)
+			// Along y the window slides over whole rows at a time, which keeps the memory accesses contiguous.
+			AccumulationType* pSliceSums = &vecSliceSums[(uPaddedZ % m_uKernelSize) * uSliceSize];
+			for (uint32_t uX = 0; uX < uWidth; uX++)
+			{
+				pSliceSums[uX] = AccumulationType(0);
+			}
+			for (uint32_t uPaddedY = 0; uPaddedY < m_uKernelSize; uPaddedY++)
 			{
-				for (int32_t x = satLowerCorner.getX(); x <= satUpperCorner.getX(); x++)
+				const AccumulationType* pRow = &vecRowSums[uPaddedY * uWidth];
+				for (uint32_t uX = 0; uX < uWidth; uX++)
 				{
-					AccumulationType previousSum = static_cast<AccumulationType>(satVolume.getVoxel(x, y, z - 1));
-					AccumulationType currentSum = static_cast<AccumulationType>(satVolume.getVoxel(x, y, z));
-
-					satVolume.setVoxel(x, y, z, previousSum + currentSum);
+					pSliceSums[uX] += pRow[uX];
+				}
+			}
+			for (uint32_t uY = 1; uY < uHeight; uY++)
+			{
+				const AccumulationType* pPrevious = &pSliceSums[(uY - 1) * uWidth];
+				const AccumulationType* pEntering = &vecRowSums[(uY + m_uKernelSize - 1) * uWidth];
+				const AccumulationType* pLeaving = &vecRowSums[(uY - 1) * uWidth];
+				AccumulationType* pCurrent = &pSliceSums[uY * uWidth];
+				for (uint32_t uX = 0; uX < uWidth; uX++)
+				{
+					pCurrent[uX] = pPrevious[uX];
+					pCurrent[uX] += pEntering[uX];
+					pCurrent[uX] -= pLeaving[uX];
 				}
 			}
-		}
 
-		//Now compute the average
-		const Vector3DInt32& v3dDstLowerCorner = m_regDst.getLowerCorner();
-		const Vector3DInt32& v3dDstUpperCorner = m_regDst.getUpperCorner();
+			for (uint32_t ct = 0; ct < uSliceSize; ct++)
+			{
+				vecCubeSums[ct] += pSliceSums[ct];
+			}
 
-		const Vector3DInt32& v3dSrcLowerCorner = m_regSrc.getLowerCorner();
+			if (uPaddedZ + 1 < m_uKernelSize)
+			{
+				// The window along z is not full yet.
+				continue;
+			}
 
-		for (int32_t iDstZ = v3dDstLowerCorner.getZ(), iSrcZ = v3dSrcLowerCorner.getZ(); iDstZ <= v3dDstUpperCorner.getZ(); iDstZ++, iSrcZ++)
-		{
-			for (int32_t iDstY = v3dDstLowerCorner.getY(), iSrcY = v3dSrcLowerCorner.getY(); iDstY <= v3dDstUpperCorner.getY(); iDstY++, iSrcY++)
+			const int32_t iDstZ = v3dDstLowerCorner.getZ() + static_cast<int32_t>(uPaddedZ + 1 - m_uKernelSize);
+			for (uint32_t uY = 0; uY < uHeight; uY++)
 			{
-				for (int32_t iDstX = v3dDstLowerCorner.getX(), iSrcX = v3dSrcLowerCorner.getX(); iDstX <= v3dDstUpperCorner.getX(); iDstX++, iSrcX++)
+				const AccumulationType* pCubeSums = &vecCubeSums[uY * uWidth];
+				DstVoxelType* pDstRow = pDstSlice + uY * iDstSliceYStride;
+				for (uint32_t uX = 0; uX < uWidth; uX++)
 				{
-					int32_t satLowerX = iSrcX - border - 1;
-					int32_t satLowerY = iSrcY - border - 1;
-					int32_t satLowerZ = iSrcZ - border - 1;
-
-					int32_t satUpperX = iSrcX + border;
-					int32_t satUpperY = iSrcY + border;
-					int32_t satUpperZ = iSrcZ + border;
+					pDstRow[uX] = static_cast<DstVoxelType>(pCubeSums[uX] / iKernelVolume);
+				}
+			}
 
-					AccumulationType a = satVolume.getVoxel(satLowerX, satLowerY, satLowerZ);
-					AccumulationType b = satVolume.getVoxel(satUpperX, satLowerY, satLowerZ);
-					AccumulationType c = satVolume.getVoxel(satLowerX, satUpperY, satLowerZ);
-					AccumulationType d = satVolume.getVoxel(satUpperX, satUpperY, satLowerZ);
-					AccumulationType e = satVolume.getVoxel(satLowerX, satLowerY, satUpperZ);
-					AccumulationType f = satVolume.getVoxel(satUpperX, satLowerY, satUpperZ);
-					AccumulationType g = satVolume.getVoxel(satLowerX, satUpperY, satUpperZ);
-					AccumulationType h = satVolume.getVoxel(satUpperX, satUpperY, satUpperZ);
+			{
+				std::unique_lock<std::mutex> dstLock;
+				if (pDstMutex)
+				{
+					dstLock = std::unique_lock<std::mutex>(*pDstMutex);
+				}
 
-					AccumulationType sum = h + c - d - g - f - a + b + e;
-					uint32_t sideLength = border * 2 + 1;
-					AccumulationType average = sum / (sideLength*sideLength*sideLength);
+				copyVolume(&volDstSlice, regDstSlice, m_pVolDst, Vector3DInt32(v3dDstLowerCorner.getX(), v3dDstLowerCorner.getY(), iDstZ));
+			}
 
-					m_pVolDst->setVoxel(iDstX, iDstY, iDstZ, static_cast<typename DstVolumeType::VoxelType>(average));
-				}
+			// Remove the oldest slice, ready for the next one to be added.
+			const AccumulationType* pOldestSliceSums = &vecSliceSums[((uPaddedZ + 1) % m_uKernelSize) * uSliceSize];
+			for (uint32_t ct = 0; ct < uSliceSize; ct++)
+			{
+				vecCubeSums[ct] -= pOldestSliceSums[ct];
 			}
 		}
 	}
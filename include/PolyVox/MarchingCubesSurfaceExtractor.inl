@@ -252,26 +252,10 @@ namespace PolyVox
 		return result;
 	}
 
-	/// This version of the function performs the extraction into a user-provided mesh rather than allocating a mesh automatically.
-	/// There are a few reasons why this might be useful to more advanced users:
-	///
-	///   1. It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
-	///   2. The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
-	///   3. The user could provide a custom mesh class, e.g a thin wrapper around an OpenGL VBO to allow direct writing into this structure.
-	///
-	/// We don't provide a default MeshType here. If the user doesn't want to provide a MeshType then it probably makes
-	/// more sense to use the other variant of this function where the mesh is a return value rather than a parameter.
-	///
-	/// Note: This function is called 'extractMarchingCubesMeshCustom' rather than 'extractMarchingCubesMesh' to avoid ambiguity when only three parameters
-	/// are provided (would the third parameter be a controller or a mesh?). It seems this can be fixed by using enable_if/static_assert to emulate concepts,
-	/// but this is relatively complex and I haven't done it yet. Could always add it later as another overload.
-	template< typename VolumeType, typename MeshType, typename ControllerType >
-	void extractMarchingCubesMeshCustom(VolumeType* volData, Region region, MeshType* result, ControllerType controller)
+	// Does the work for extractMarchingCubesMeshCustom(), using whichever kind of sampler it has chosen.
+	template< typename SamplerType, typename VolumeType, typename MeshType, typename ControllerType >
+	void extractMarchingCubesMeshWithSampler(VolumeType* volData, Region region, MeshType* result, ControllerType controller)
 	{
-		// Validate parameters
-		POLYVOX_THROW_IF(volData == nullptr, std::invalid_argument, "Provided volume cannot be null");
-		POLYVOX_THROW_IF(result == nullptr, std::invalid_argument, "Provided mesh cannot be null");
-
 		// For profiling this function
 		Timer timer;
 
@@ -302,19 +286,19 @@ namespace PolyVox
 		Array<2, Vector3DInt32> pPreviousIndices(uRegionWidthInVoxels, uRegionHeightInVoxels);
 
 		// A sampler pointing at the beginning of the region, which gets incremented to always point at the beginning of a slice.
-		typename VolumeType::Sampler startOfSlice(volData);
+		SamplerType startOfSlice(volData);
 		startOfSlice.setPosition(region.getLowerX(), region.getLowerY(), region.getLowerZ());
 
 		for (uint32_t uZRegSpace = 0; uZRegSpace < uRegionDepthInVoxels; uZRegSpace++)
 		{
 			// A sampler pointing at the beginning of the slice, which gets incremented to always point at the beginning of a row.
-			typename VolumeType::Sampler startOfRow = startOfSlice;
+			SamplerType startOfRow = startOfSlice;
 
 			for (uint32_t uYRegSpace = 0; uYRegSpace < uRegionHeightInVoxels; uYRegSpace++)
 			{
 				// Copying a sampler which is already pointing at the correct location seems (slightly) faster than
 				// calling setPosition(). Therefore we make use of 'startOfRow' and 'startOfSlice' to reset the sampler.
-				typename VolumeType::Sampler sampler = startOfRow;
+				SamplerType sampler = startOfRow;
 
 				for (uint32_t uXRegSpace = 0; uXRegSpace < uRegionWidthInVoxels; uXRegSpace++)
 				{
@@ -582,4 +566,37 @@ namespace PolyVox
 			"ms (Region size = ", region.getWidthInVoxels(), "x", region.getHeightInVoxels(),
 			"x", region.getDepthInVoxels(), ")");
 	}
+
+	/// This version of the function performs the extraction into a user-provided mesh rather than allocating a mesh automatically.
+	/// There are a few reasons why this might be useful to more advanced users:
+	///
+	///   1. It leaves the user in control of memory allocation and would allow them to implement e.g. a mesh pooling system.
+	///   2. The user-provided mesh could have a different index type (e.g. 16-bit indices) to reduce memory usage.
+	///   3. The user could provide a custom mesh class, e.g a thin wrapper around an OpenGL VBO to allow direct writing into this structure.
+	///
+	/// We don't provide a default MeshType here. If the user doesn't want to provide a MeshType then it probably makes
+	/// more sense to use the other variant of this function where the mesh is a return value rather than a parameter.
+	///
+	/// Note: This function is called 'extractMarchingCubesMeshCustom' rather than 'extractMarchingCubesMesh' to avoid ambiguity when only three parameters
+	/// are provided (would the third parameter be a controller or a mesh?). It seems this can be fixed by using enable_if/static_assert to emulate concepts,
+	/// but this is relatively complex and I haven't done it yet. Could always add it later as another overload.
+	template< typename VolumeType, typename MeshType, typename ControllerType >
+	void extractMarchingCubesMeshCustom(VolumeType* volData, Region region, MeshType* result, ControllerType controller)
+	{
+		// Validate parameters
+		POLYVOX_THROW_IF(volData == nullptr, std::invalid_argument, "Provided volume cannot be null");
+		POLYVOX_THROW_IF(result == nullptr, std::invalid_argument, "Provided mesh cannot be null");
+
+		// The gradient calculations look one voxel beyond the region. If that is all inside the volume then the sampler doesn't need to check its bounds.
+		Region regAccessed(region);
+		regAccessed.grow(1);
+		if (UncheckedSamplerType<VolumeType>::isUsable(volData, regAccessed))
+		{
+			extractMarchingCubesMeshWithSampler<typename UncheckedSamplerType<VolumeType>::type>(volData, region, result, controller);
+		}
+		else
+		{
+			extractMarchingCubesMeshWithSampler<typename VolumeType::Sampler>(volData, region, result, controller);
+		}
+	}
 }
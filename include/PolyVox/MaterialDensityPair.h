@@ -27,6 +27,7 @@
 
 #include "DefaultIsQuadNeeded.h" //we'll specialise this function for this voxel type
 #include "DefaultMarchingCubesController.h" //We'll specialise the controller contained in here
+#include "VoxelChannels.h" //So that MultiChannelVolume can store the material and density separately
 
 #include "Impl/PlatformDefinitions.h"
 
@@ -161,6 +162,29 @@ namespace PolyVox
 		DensityType m_tThreshold;
 	};
 
+	template <typename Type, uint8_t NoOfMaterialBits, uint8_t NoOfDensityBits>
+	class VoxelChannels< MaterialDensityPair<Type, NoOfMaterialBits, NoOfDensityBits> >
+	{
+	public:
+		typedef Type DensityType;
+		typedef Type MaterialType;
+
+		static DensityType getDensity(MaterialDensityPair<Type, NoOfMaterialBits, NoOfDensityBits> voxel)
+		{
+			return voxel.getDensity();
+		}
+
+		static MaterialType getMaterial(MaterialDensityPair<Type, NoOfMaterialBits, NoOfDensityBits> voxel)
+		{
+			return voxel.getMaterial();
+		}
+
+		static MaterialDensityPair<Type, NoOfMaterialBits, NoOfDensityBits> makeVoxel(DensityType tDensity, MaterialType tMaterial)
+		{
+			return MaterialDensityPair<Type, NoOfMaterialBits, NoOfDensityBits>(tMaterial, tDensity);
+		}
+	};
+
 	typedef MaterialDensityPair<uint8_t, 4, 4> MaterialDensityPair44;
 	typedef MaterialDensityPair<uint16_t, 8, 8> MaterialDensityPair88;
 }
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_Mipmap_H__
+#define __PolyVox_Mipmap_H__
+
+#include "Impl/MipmapImpl.h"
+#include "Impl/PlatformDefinitions.h"
+#include "Impl/Utility.h"
+
+#include "Region.h"
+#include "RegionScheduler.h"
+
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace PolyVox
+{
+	/**
+	 * \file
+	 *
+	 * Mipmaps
+	 *
+	 * These functions build reduced resolution copies of a volume, where each voxel in one level is computed from a 2x2x2
+	 * block of voxels in the level above it. Voxel (x,y,z) in a level covers voxels (2x,2y,2z) to (2x+1,2y+1,2z+1) of the
+	 * previous level, so the region of each level is found by halving (and rounding down) the corners of the region above.
+	 * getMipmapRegion() gives the region of any level, and the caller supplies a volume for each level which contains it.
+	 *
+	 * The levels are built from contiguous rows of voxels. The common cases (averaging, minimum and maximum of \a uint8_t and
+	 * \a float voxels) use SSE2 where it is available (see PlatformDefinitions.h). Each level is split into the tiles of a
+	 * RegionScheduler, which are shared between its threads; volumes which don't report \a SupportsConcurrentReads or \a SupportsConcurrentWrites are only
+	 * accessed by one thread at a time, with a lock taken once per slice of a tile.
+	 */
+
+	/// Gets the region covered by the given level of the mipmap chain for a volume covering \a regBase. Level zero is \a regBase itself.
+	Region getMipmapRegion(const Region& regBase, uint32_t uLevel);
+
+	/// Writes a half resolution copy of \a regSrc into \a pVolDst, covering getMipmapRegion(regSrc, 1).
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void downsampleVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, MipmapMode eMode, uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void downsampleVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, MipmapMode eMode, RegionScheduler& scheduler);
+
+	/// Builds each level of the mipmap chain from the previous one, with level one being written to the first volume in \a vecLevels.
+	template< typename VolumeType >
+	void generateMipmaps(VolumeType* pVolBase, const Region& regBase, const std::vector<VolumeType*>& vecLevels, MipmapMode eMode, uint32_t uNoOfThreads = 0);
+	/// As above, but using the threads of an existing scheduler.
+	template< typename VolumeType >
+	void generateMipmaps(VolumeType* pVolBase, const Region& regBase, const std::vector<VolumeType*>& vecLevels, MipmapMode eMode, RegionScheduler& scheduler);
+}
+
+#include "Mipmap.inl"
+
+#endif //__PolyVox_Mipmap_H__
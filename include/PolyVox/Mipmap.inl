@@ -0,0 +1,216 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	inline Region getMipmapRegion(const Region& regBase, uint32_t uLevel)
+	{
+		POLYVOX_THROW_IF(uLevel > 30, std::invalid_argument, "Mipmap level is too large");
+		const int32_t iScale = 1 << uLevel;
+		return Region(floorDivide(regBase.getLowerX(), iScale), floorDivide(regBase.getLowerY(), iScale), floorDivide(regBase.getLowerZ(), iScale),
+			floorDivide(regBase.getUpperX(), iScale), floorDivide(regBase.getUpperY(), iScale), floorDivide(regBase.getUpperZ(), iScale));
+	}
+
+	// Computes the voxels of 'regDstTile', which is part of the level below 'regSrc'.
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void downsampleTile(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Region& regDstTile, MipmapMode eMode, std::mutex* pSrcMutex, std::mutex* pDstMutex)
+	{
+		typedef typename SrcVolumeType::VoxelType SrcVoxelType;
+		typedef typename DstVolumeType::VoxelType DstVoxelType;
+
+		const uint32_t uWidth = regDstTile.getWidthInVoxels();
+		const uint32_t uHeight = regDstTile.getHeightInVoxels();
+		const uint32_t uSrcWidth = uWidth * 2;
+		const uint32_t uSrcHeight = uHeight * 2;
+
+		// Tiles at the edges can have incomplete blocks, which are handled a voxel at a time.
+		const Region regSrcTile(regDstTile.getLowerCorner() * 2, regDstTile.getUpperCorner() * 2 + Vector3DInt32(1, 1, 1));
+		const bool bComplete = regSrc.containsRegion(regSrcTile);
+
+		std::vector<SrcVoxelType> vecSrcSlices(bComplete ? (uSrcWidth * uSrcHeight * 2) : 0);
+		std::vector<SrcVoxelType> vecReduced(uWidth * uHeight);
+
+		for (int32_t iDstZ = regDstTile.getLowerZ(); iDstZ <= regDstTile.getUpperZ(); iDstZ++)
+		{
+			{
+				std::unique_lock<std::mutex> srcLock;
+				if (pSrcMutex)
+				{
+					srcLock = std::unique_lock<std::mutex>(*pSrcMutex);
+				}
+
+				if (bComplete)
+				{
+					// The sampler pins the chunks it visits, so it must not outlive the lock.
+					typename SrcVolumeType::Sampler srcSampler(pVolSrc);
+					SrcVoxelType* pSrcVoxel = &vecSrcSlices[0];
+					for (uint32_t uSlice = 0; uSlice < 2; uSlice++)
+					{
+						for (uint32_t uRow = 0; uRow < uSrcHeight; uRow++)
+						{
+							srcSampler.setPosition(regSrcTile.getLowerX(), regSrcTile.getLowerY() + static_cast<int32_t>(uRow), iDstZ * 2 + static_cast<int32_t>(uSlice));
+							for (uint32_t uX = 0; uX < uSrcWidth; uX++)
+							{
+								*pSrcVoxel++ = srcSampler.getVoxel();
+								srcSampler.movePositiveX();
+							}
+						}
+					}
+				}
+				else
+				{
+					SrcVoxelType block[8];
+					for (uint32_t uY = 0; uY < uHeight; uY++)
+					{
+						for (uint32_t uX = 0; uX < uWidth; uX++)
+						{
+							const Vector3DInt32 v3dBlockLower((regDstTile.getLowerX() + static_cast<int32_t>(uX)) * 2, (regDstTile.getLowerY() + static_cast<int32_t>(uY)) * 2, iDstZ * 2);
+							uint32_t uCount = 0;
+							for (int32_t iZ = v3dBlockLower.getZ(); iZ <= v3dBlockLower.getZ() + 1; iZ++)
+							{
+								for (int32_t iY = v3dBlockLower.getY(); iY <= v3dBlockLower.getY() + 1; iY++)
+								{
+									for (int32_t iX = v3dBlockLower.getX(); iX <= v3dBlockLower.getX() + 1; iX++)
+									{
+										if (regSrc.containsPoint(iX, iY, iZ))
+										{
+											block[uCount++] = pVolSrc->getVoxel(iX, iY, iZ);
+										}
+									}
+								}
+							}
+							vecReduced[uY * uWidth + uX] = reduceMipmapBlock(block, uCount, eMode);
+						}
+					}
+				}
+			}
+
+			if (bComplete)
+			{
+				for (uint32_t uY = 0; uY < uHeight; uY++)
+				{
+					const SrcVoxelType* ppRows[4] =
+					{
+						&vecSrcSlices[(uY * 2) * uSrcWidth],
+						&vecSrcSlices[(uY * 2 + 1) * uSrcWidth],
+						&vecSrcSlices[(uSrcHeight + uY * 2) * uSrcWidth],
+						&vecSrcSlices[(uSrcHeight + uY * 2 + 1) * uSrcWidth]
+					};
+					reduceMipmapRows(ppRows, &vecReduced[uY * uWidth], uWidth, eMode);
+				}
+			}
+
+			std::unique_lock<std::mutex> dstLock;
+			if (pDstMutex)
+			{
+				dstLock = std::unique_lock<std::mutex>(*pDstMutex);
+			}
+
+			for (uint32_t uY = 0; uY < uHeight; uY++)
+			{
+				for (uint32_t uX = 0; uX < uWidth; uX++)
+				{
+					pVolDst->setVoxel(regDstTile.getLowerX() + static_cast<int32_t>(uX), regDstTile.getLowerY() + static_cast<int32_t>(uY), iDstZ,
+						static_cast<DstVoxelType>(vecReduced[uY * uWidth + uX]));
+				}
+			}
+		}
+	}
+
+	/**
+	 * \param pVolSrc The volume to read from
+	 * \param regSrc The region to read. Voxels outside of it are never read, so blocks on its edges may be incomplete.
+	 * \param[out] pVolDst The volume to write to, which must contain getMipmapRegion(regSrc, 1)
+	 * \param eMode How each 2x2x2 block is reduced to a single voxel
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void downsampleVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, MipmapMode eMode, uint32_t uNoOfThreads)
+	{
+		// The default tile size matches the default PagedVolume chunks.
+		RegionScheduler scheduler(uNoOfThreads);
+		downsampleVolume(pVolSrc, regSrc, pVolDst, eMode, scheduler);
+	}
+
+	/**
+	 * \param pVolSrc The volume to read from
+	 * \param regSrc The region to read. Voxels outside of it are never read, so blocks on its edges may be incomplete.
+	 * \param[out] pVolDst The volume to write to, which must contain getMipmapRegion(regSrc, 1)
+	 * \param eMode How each 2x2x2 block is reduced to a single voxel
+	 * \param scheduler The scheduler whose threads share the work. Its tiles are aligned in the destination, so they should match the chunks of \a pVolDst.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void downsampleVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, MipmapMode eMode, RegionScheduler& scheduler)
+	{
+		VolumeLocks<SrcVolumeType, DstVolumeType> locks(scheduler, pVolSrc, pVolDst);
+		scheduler.forEachTile(getMipmapRegion(regSrc, 1), [&](const Region& regDstTile, uint32_t /*uTile*/, uint32_t /*uWorker*/)
+		{
+			downsampleTile(pVolSrc, regSrc, pVolDst, regDstTile, eMode, locks.getSrcMutex(), locks.getDstMutex());
+		});
+	}
+
+	/**
+	 * Level \a n + 1 is built from level \a n rather than from the base volume, so the cost of the whole chain is only a
+	 * little more than building the first level. Building stops early if a level is reduced to a single voxel.
+	 *
+	 * \param pVolBase The full resolution volume
+	 * \param regBase The region of the full resolution volume to build the chain for
+	 * \param[out] vecLevels The volumes to write levels one onwards into. Each must contain the corresponding getMipmapRegion().
+	 * \param eMode How each 2x2x2 block is reduced to a single voxel
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template< typename VolumeType >
+	void generateMipmaps(VolumeType* pVolBase, const Region& regBase, const std::vector<VolumeType*>& vecLevels, MipmapMode eMode, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		generateMipmaps(pVolBase, regBase, vecLevels, eMode, scheduler);
+	}
+
+	/**
+	 * As above, with every level built by the threads of \a scheduler.
+	 *
+	 * \param pVolBase The full resolution volume
+	 * \param regBase The region of the full resolution volume to build the chain for
+	 * \param[out] vecLevels The volumes to write levels one onwards into. Each must contain the corresponding getMipmapRegion().
+	 * \param eMode How each 2x2x2 block is reduced to a single voxel
+	 * \param scheduler The scheduler whose threads share the work
+	 */
+	template< typename VolumeType >
+	void generateMipmaps(VolumeType* pVolBase, const Region& regBase, const std::vector<VolumeType*>& vecLevels, MipmapMode eMode, RegionScheduler& scheduler)
+	{
+		VolumeType* pVolSrc = pVolBase;
+		Region regSrc = regBase;
+		for (VolumeType* pVolDst : vecLevels)
+		{
+			if (regSrc.getDimensionsInVoxels() == Vector3DInt32(1, 1, 1))
+			{
+				break;
+			}
+
+			downsampleVolume(pVolSrc, regSrc, pVolDst, eMode, scheduler);
+			pVolSrc = pVolDst;
+			regSrc = getMipmapRegion(regSrc, 1);
+		}
+	}
+}
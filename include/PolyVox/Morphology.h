@@ -0,0 +1,170 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_Morphology_H__
+#define __PolyVox_Morphology_H__
+
+#include "Impl/ConvolutionImpl.h"
+#include "Impl/ErrorHandling.h"
+#include "Impl/MorphologyImpl.h"
+#include "Impl/PlatformDefinitions.h"
+
+#include "BitVolume.h"
+#include "Region.h"
+#include "RegionScheduler.h"
+#include "Vector.h"
+
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace PolyVox
+{
+	namespace MorphologyOperations
+	{
+		/**
+		 * The operations which a MorphologyFilter can apply.
+		 */
+		enum MorphologyOperation
+		{
+			Dilate, ///< Each voxel takes the largest value under the structuring element, so solid areas grow
+			Erode, ///< Each voxel takes the smallest value under the structuring element, so solid areas shrink
+			Open, ///< An erosion followed by a dilation, which removes thin parts and small pieces but keeps the rest the same size
+			Close ///< A dilation followed by an erosion, which fills small gaps and holes but keeps the rest the same size
+		};
+	}
+	typedef MorphologyOperations::MorphologyOperation MorphologyOperation;
+
+	namespace StructuringElementShapes
+	{
+		/**
+		 * The shapes of the neighbourhood which a StructuringElement covers.
+		 */
+		enum StructuringElementShape
+		{
+			Box, ///< Every voxel within the radius along each axis
+			Diamond ///< Every voxel whose distance along the axes (the number of face steps) is within the radius
+		};
+	}
+	typedef StructuringElementShapes::StructuringElementShape StructuringElementShape;
+
+	/**
+	 * The neighbourhood of each voxel which dilation and erosion look at.
+	 *
+	 * Both shapes are separable, so they never have to be visited voxel by voxel. A box is the same as a line along x, then
+	 * along y, then along z, and each line costs the same per voxel whatever its length. A diamond of radius \a r is the same
+	 * as \a r steps of the 3x3x3 cross (a voxel and its six face neighbours), so it costs seven comparisons per step.
+	 */
+	class StructuringElement
+	{
+	public:
+		/// Constructor
+		StructuringElement(StructuringElementShape eShape, const Vector3DInt32& v3dRadius);
+
+		StructuringElementShape getShape(void) const { return m_eShape; }
+		/// The distance the element extends from its centre along each axis.
+		const Vector3DInt32& getRadius(void) const { return m_v3dRadius; }
+
+	private:
+		StructuringElementShape m_eShape;
+		Vector3DInt32 m_v3dRadius;
+	};
+
+	/// Creates a box which extends \a uRadius voxels from its centre, so a radius of one gives the 3x3x3 neighbourhood.
+	StructuringElement createBoxElement(uint32_t uRadius);
+
+	/// Creates a diamond containing the voxels which are at most \a uRadius face steps from its centre.
+	StructuringElement createDiamondElement(uint32_t uRadius);
+
+	/**
+	 * Applies morphological operations (dilation, erosion, opening and closing) to a region of one volume and writes the
+	 * results to another.
+	 *
+	 * The source and destination regions must have the same size, and the volumes must be different. Voxels outside of the
+	 * source region are read from the source volume as normal, so for example dilation can grow a solid area into the region
+	 * from outside it. The destination region is split into tiles which are shared between threads by a RegionScheduler.
+	 * Each tile is read (along with the border needed by the structuring element) into a dense buffer, filtered with one pass
+	 * per axis over contiguous rows, and written out. Opening and closing do both of their steps within the tile, reading a
+	 * border twice as wide, so they don't need a temporary volume.
+	 *
+	 * Dilation takes the maximum of the values under the structuring element and erosion takes the minimum, so voxels must
+	 * be numbers (or specialise ConvolutionVoxelTraits, as Density does). Occupancy data can be stored as 0 and 1, or the
+	 * source and destination can both be BitVolumes. In that case rows of up to 64 voxels are processed as single words, with
+	 * the x pass done by shifting and the y and z passes combining whole words with 'or' and 'and'. This requires the radius
+	 * along x to be less than 32, or less than 16 for opening and closing.
+	 *
+	 * Reading and writing the volumes from several threads at once requires them to report \a SupportsConcurrentReads and
+	 * \a SupportsConcurrentWrites (as RawVolume does). Otherwise they are locked while each tile is read or written, such as
+	 * for a PagedVolume, but the filtering itself still runs in parallel.
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType>
+	class MorphologyFilter
+	{
+	public:
+		MorphologyFilter(SrcVolumeType* pVolSrc, Region regSrc, DstVolumeType* pVolDst, Region regDst);
+
+		/// Applies the operation with the given structuring element.
+		void execute(MorphologyOperation eOperation, const StructuringElement& element, uint32_t uNoOfThreads = 0);
+		/// Applies the operation with the given structuring element, using the threads of an existing scheduler.
+		void execute(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler);
+
+	private:
+		typedef typename ConvolutionVoxelTraits<typename SrcVolumeType::VoxelType>::ValueType ValueType;
+		typedef typename ConvolutionVoxelTraits<typename DstVolumeType::VoxelType>::ValueType DstValueType;
+
+		// Working storage which each worker reuses for every tile. Voxel values for the general case, and words for BitVolumes.
+		template <typename Type>
+		struct TileScratch
+		{
+			std::vector<Type> vecBlock;
+			std::vector<Type> vecPass;
+			std::vector<Type> vecForwards;
+			std::vector<Type> vecBackwards;
+		};
+
+		// Runs every tile, choosing between the general code and the BitVolume code.
+		void executeTiles(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler, std::false_type /*bBitVolumes*/);
+		void executeTiles(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler, std::true_type /*bBitVolumes*/);
+
+		// Dilates or erodes a block of 'v3dSize' values (x varying fastest), which shrinks by the radius on every side.
+		template <typename Operator>
+		static void filterBlock(const StructuringElement& element, Operator op, Vector3DInt32& v3dSize, TileScratch<ValueType>& scratch);
+		// Dilates or erodes a block of rows of voxels, one word per row, where 'iWidth' bits of each word are in use.
+		template <typename Operator>
+		static void filterBitBlock(const StructuringElement& element, Operator op, int32_t& iWidth, Vector3DInt32& v3dSize, TileScratch<uint64_t>& scratch);
+
+		//Source data
+		SrcVolumeType* m_pVolSrc;
+		Region m_regSrc;
+
+		//Destination data
+		DstVolumeType* m_pVolDst;
+		Region m_regDst;
+	};
+}
+
+#include "Morphology.inl"
+
+#endif //__PolyVox_Morphology_H__
@@ -0,0 +1,416 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	inline StructuringElement::StructuringElement(StructuringElementShape eShape, const Vector3DInt32& v3dRadius)
+		:m_eShape(eShape)
+		, m_v3dRadius(v3dRadius)
+	{
+		POLYVOX_THROW_IF((v3dRadius.getX() < 0) || (v3dRadius.getY() < 0) || (v3dRadius.getZ() < 0), std::invalid_argument, "Structuring element radius must not be negative");
+		POLYVOX_THROW_IF((eShape == StructuringElementShapes::Diamond) && ((v3dRadius.getX() != v3dRadius.getY()) || (v3dRadius.getX() != v3dRadius.getZ())),
+			std::invalid_argument, "A diamond must have the same radius along each axis");
+	}
+
+	inline StructuringElement createBoxElement(uint32_t uRadius)
+	{
+		const int32_t iRadius = static_cast<int32_t>(uRadius);
+		return StructuringElement(StructuringElementShapes::Box, Vector3DInt32(iRadius, iRadius, iRadius));
+	}
+
+	/**
+	 * A diamond of radius one is the six face neighbours of a voxel, so dilating by it is the same as dilating with six
+	 * connectivity. Larger diamonds are the closest that separable elements get to a sphere without becoming a box.
+	 */
+	inline StructuringElement createDiamondElement(uint32_t uRadius)
+	{
+		const int32_t iRadius = static_cast<int32_t>(uRadius);
+		return StructuringElement(StructuringElementShapes::Diamond, Vector3DInt32(iRadius, iRadius, iRadius));
+	}
+
+	/**
+	 * \param pVolSrc
+	 * \param regSrc
+	 * \param[out] pVolDst
+	 * \param regDst
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType>
+	MorphologyFilter<SrcVolumeType, DstVolumeType>::MorphologyFilter(SrcVolumeType* pVolSrc, Region regSrc, DstVolumeType* pVolDst, Region regDst)
+		:m_pVolSrc(pVolSrc)
+		, m_regSrc(regSrc)
+		, m_pVolDst(pVolDst)
+		, m_regDst(regDst)
+	{
+		POLYVOX_THROW_IF(m_regSrc.getDimensionsInVoxels() != m_regDst.getDimensionsInVoxels(), std::invalid_argument, "Source and destination regions must be the same size");
+		POLYVOX_THROW_IF(static_cast<const void*>(m_pVolSrc) == static_cast<const void*>(m_pVolDst), std::invalid_argument, "Source and destination volumes must be different");
+	}
+
+	/**
+	 * \param eOperation The operation to apply
+	 * \param element The neighbourhood of each voxel which the operation looks at
+	 * \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::execute(MorphologyOperation eOperation, const StructuringElement& element, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		execute(eOperation, element, scheduler);
+	}
+
+	/**
+	 * The general case uses the tile size of the scheduler, which should normally match the chunk size of the volumes. For
+	 * BitVolumes the tiles are sized so that each row and its border fill a word, whatever the scheduler was created with.
+	 *
+	 * \param eOperation The operation to apply
+	 * \param element The neighbourhood of each voxel which the operation looks at
+	 * \param scheduler The scheduler whose threads the tiles are shared between
+	 */
+	template< typename SrcVolumeType, typename DstVolumeType>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::execute(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler)
+	{
+		typedef std::integral_constant<bool, std::is_same<SrcVolumeType, BitVolume>::value && std::is_same<DstVolumeType, BitVolume>::value> BitVolumes;
+		executeTiles(eOperation, element, scheduler, BitVolumes());
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::executeTiles(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler, std::false_type /*bBitVolumes*/)
+	{
+		// Opening and closing filter twice, so they need twice the border.
+		const int32_t iNoOfSteps = ((eOperation == MorphologyOperations::Open) || (eOperation == MorphologyOperations::Close)) ? 2 : 1;
+		const Vector3DInt32 v3dBorder = element.getRadius() * iNoOfSteps;
+		const Vector3DInt32 v3dDstToSrc = m_regSrc.getLowerCorner() - m_regDst.getLowerCorner();
+
+		VolumeLocks<SrcVolumeType, DstVolumeType> locks(scheduler, m_pVolSrc, m_pVolDst);
+		WorkerLocal< TileScratch<ValueType> > workerScratch(scheduler);
+
+		scheduler.forEachTile(m_regDst, [&](const Region& regDstTile, uint32_t /*uTile*/, uint32_t uWorker)
+		{
+			TileScratch<ValueType>& scratch = workerScratch.get(uWorker);
+
+			Region regPadded = regDstTile;
+			regPadded.shift(v3dDstToSrc);
+			regPadded.grow(v3dBorder);
+			Vector3DInt32 v3dSize = regPadded.getDimensionsInVoxels();
+			scratch.vecBlock.resize(v3dSize.getX() * v3dSize.getY() * v3dSize.getZ());
+
+			{
+				std::unique_lock<std::mutex> srcLock;
+				if (locks.getSrcMutex())
+				{
+					srcLock = std::unique_lock<std::mutex>(*locks.getSrcMutex());
+				}
+
+				typename SrcVolumeType::Sampler srcSampler(m_pVolSrc);
+				ValueType* pBlock = &scratch.vecBlock[0];
+				for (int32_t iZ = regPadded.getLowerZ(); iZ <= regPadded.getUpperZ(); iZ++)
+				{
+					for (int32_t iY = regPadded.getLowerY(); iY <= regPadded.getUpperY(); iY++)
+					{
+						srcSampler.setPosition(regPadded.getLowerX(), iY, iZ);
+						for (int32_t iX = regPadded.getLowerX(); iX <= regPadded.getUpperX(); iX++)
+						{
+							*pBlock++ = ConvolutionVoxelTraits<typename SrcVolumeType::VoxelType>::toValue(srcSampler.getVoxel());
+							srcSampler.movePositiveX();
+						}
+					}
+				}
+			}
+
+			switch (eOperation)
+			{
+			case MorphologyOperations::Dilate:
+				filterBlock(element, MorphologyMaximum(), v3dSize, scratch);
+				break;
+			case MorphologyOperations::Erode:
+				filterBlock(element, MorphologyMinimum(), v3dSize, scratch);
+				break;
+			case MorphologyOperations::Open:
+				filterBlock(element, MorphologyMinimum(), v3dSize, scratch);
+				filterBlock(element, MorphologyMaximum(), v3dSize, scratch);
+				break;
+			case MorphologyOperations::Close:
+				filterBlock(element, MorphologyMaximum(), v3dSize, scratch);
+				filterBlock(element, MorphologyMinimum(), v3dSize, scratch);
+				break;
+			}
+			POLYVOX_ASSERT(v3dSize == regDstTile.getDimensionsInVoxels(), "Filtered block is the wrong size");
+
+			std::unique_lock<std::mutex> dstLock;
+			if (locks.getDstMutex())
+			{
+				dstLock = std::unique_lock<std::mutex>(*locks.getDstMutex());
+			}
+
+			const ValueType* pResult = &scratch.vecBlock[0];
+			for (int32_t iZ = regDstTile.getLowerZ(); iZ <= regDstTile.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regDstTile.getLowerY(); iY <= regDstTile.getUpperY(); iY++)
+				{
+					for (int32_t iX = regDstTile.getLowerX(); iX <= regDstTile.getUpperX(); iX++)
+					{
+						m_pVolDst->setVoxel(iX, iY, iZ, ConvolutionVoxelTraits<typename DstVolumeType::VoxelType>::fromValue(static_cast<DstValueType>(*pResult++)));
+					}
+				}
+			}
+		});
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::executeTiles(MorphologyOperation eOperation, const StructuringElement& element, RegionScheduler& scheduler, std::true_type /*bBitVolumes*/)
+	{
+		const int32_t iNoOfSteps = ((eOperation == MorphologyOperations::Open) || (eOperation == MorphologyOperations::Close)) ? 2 : 1;
+		const Vector3DInt32 v3dBorder = element.getRadius() * iNoOfSteps;
+		const Vector3DInt32 v3dDstToSrc = m_regSrc.getLowerCorner() - m_regDst.getLowerCorner();
+
+		// Each row of a tile, along with its border, has to fit in a single word.
+		POLYVOX_THROW_IF(v3dBorder.getX() >= 32, std::invalid_argument, "Structuring element is too wide for the rows of a BitVolume");
+		const uint32_t uTileSideLength = static_cast<uint32_t>(64 - v3dBorder.getX() * 2);
+
+		VolumeLocks<SrcVolumeType, DstVolumeType> locks(scheduler, m_pVolSrc, m_pVolDst);
+		WorkerLocal< TileScratch<uint64_t> > workerScratch(scheduler);
+
+		scheduler.forEachTile(m_regDst, uTileSideLength, [&](const Region& regDstTile, uint32_t /*uTile*/, uint32_t uWorker)
+		{
+			TileScratch<uint64_t>& scratch = workerScratch.get(uWorker);
+
+			Region regPadded = regDstTile;
+			regPadded.shift(v3dDstToSrc);
+			regPadded.grow(v3dBorder);
+			int32_t iWidth = regPadded.getWidthInVoxels();
+			Vector3DInt32 v3dSize(1, regPadded.getHeightInVoxels(), regPadded.getDepthInVoxels());
+			scratch.vecBlock.resize(v3dSize.getY() * v3dSize.getZ());
+
+			{
+				std::unique_lock<std::mutex> srcLock;
+				if (locks.getSrcMutex())
+				{
+					srcLock = std::unique_lock<std::mutex>(*locks.getSrcMutex());
+				}
+
+				uint64_t* pBlock = &scratch.vecBlock[0];
+				for (int32_t iZ = regPadded.getLowerZ(); iZ <= regPadded.getUpperZ(); iZ++)
+				{
+					for (int32_t iY = regPadded.getLowerY(); iY <= regPadded.getUpperY(); iY++)
+					{
+						*pBlock++ = m_pVolSrc->getRow(regPadded.getLowerX(), iY, iZ);
+					}
+				}
+			}
+
+			switch (eOperation)
+			{
+			case MorphologyOperations::Dilate:
+				filterBitBlock(element, MorphologyBitwiseOr(), iWidth, v3dSize, scratch);
+				break;
+			case MorphologyOperations::Erode:
+				filterBitBlock(element, MorphologyBitwiseAnd(), iWidth, v3dSize, scratch);
+				break;
+			case MorphologyOperations::Open:
+				filterBitBlock(element, MorphologyBitwiseAnd(), iWidth, v3dSize, scratch);
+				filterBitBlock(element, MorphologyBitwiseOr(), iWidth, v3dSize, scratch);
+				break;
+			case MorphologyOperations::Close:
+				filterBitBlock(element, MorphologyBitwiseOr(), iWidth, v3dSize, scratch);
+				filterBitBlock(element, MorphologyBitwiseAnd(), iWidth, v3dSize, scratch);
+				break;
+			}
+			POLYVOX_ASSERT(iWidth == regDstTile.getWidthInVoxels(), "Filtered block is the wrong size");
+
+			// Neighbouring tiles can share words of the destination, so it has to be locked unless there is only one thread.
+			std::unique_lock<std::mutex> dstLock;
+			if (locks.getDstMutex())
+			{
+				dstLock = std::unique_lock<std::mutex>(*locks.getDstMutex());
+			}
+
+			const uint64_t* pResult = &scratch.vecBlock[0];
+			for (int32_t iZ = regDstTile.getLowerZ(); iZ <= regDstTile.getUpperZ(); iZ++)
+			{
+				for (int32_t iY = regDstTile.getLowerY(); iY <= regDstTile.getUpperY(); iY++)
+				{
+					m_pVolDst->setRow(regDstTile.getLowerX(), iY, iZ, *pResult++, static_cast<uint32_t>(iWidth));
+				}
+			}
+		});
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType>
+	template <typename Operator>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::filterBlock(const StructuringElement& element, Operator op, Vector3DInt32& v3dSize, TileScratch<ValueType>& scratch)
+	{
+		const Vector3DInt32& v3dRadius = element.getRadius();
+		int32_t iWidth = v3dSize.getX();
+		int32_t iHeight = v3dSize.getY();
+		int32_t iDepth = v3dSize.getZ();
+
+		if (element.getShape() == StructuringElementShapes::Box)
+		{
+			// Along x, one row at a time.
+			if (v3dRadius.getX() > 0)
+			{
+				const int32_t iNewWidth = iWidth - v3dRadius.getX() * 2;
+				scratch.vecPass.resize(iNewWidth * iHeight * iDepth);
+				for (int32_t iRow = 0; iRow < iHeight * iDepth; iRow++)
+				{
+					filterLine(&scratch.vecBlock[iRow * iWidth], &scratch.vecPass[iRow * iNewWidth], iNewWidth, v3dRadius.getX(), 1, op, scratch.vecForwards, scratch.vecBackwards);
+				}
+				scratch.vecBlock.swap(scratch.vecPass);
+				iWidth = iNewWidth;
+			}
+
+			// Along y, combining whole rows of each slice.
+			if (v3dRadius.getY() > 0)
+			{
+				const int32_t iNewHeight = iHeight - v3dRadius.getY() * 2;
+				scratch.vecPass.resize(iWidth * iNewHeight * iDepth);
+				for (int32_t iSlice = 0; iSlice < iDepth; iSlice++)
+				{
+					filterLine(&scratch.vecBlock[iSlice * iWidth * iHeight], &scratch.vecPass[iSlice * iWidth * iNewHeight], iNewHeight, v3dRadius.getY(), iWidth, op,
+						scratch.vecForwards, scratch.vecBackwards);
+				}
+				scratch.vecBlock.swap(scratch.vecPass);
+				iHeight = iNewHeight;
+			}
+
+			// Along z, combining whole slices.
+			if (v3dRadius.getZ() > 0)
+			{
+				const int32_t iNewDepth = iDepth - v3dRadius.getZ() * 2;
+				scratch.vecPass.resize(iWidth * iHeight * iNewDepth);
+				filterLine(&scratch.vecBlock[0], &scratch.vecPass[0], iNewDepth, v3dRadius.getZ(), iWidth * iHeight, op, scratch.vecForwards, scratch.vecBackwards);
+				scratch.vecBlock.swap(scratch.vecPass);
+				iDepth = iNewDepth;
+			}
+		}
+		else
+		{
+			// Each step combines every voxel with its six face neighbours, and shrinks the block by one on every side.
+			for (int32_t iStep = 0; iStep < v3dRadius.getX(); iStep++)
+			{
+				const int32_t iNewWidth = iWidth - 2;
+				const int32_t iNewHeight = iHeight - 2;
+				const int32_t iNewDepth = iDepth - 2;
+				const int32_t iSliceSize = iWidth * iHeight;
+				scratch.vecPass.resize(iNewWidth * iNewHeight * iNewDepth);
+				for (int32_t iZ = 0; iZ < iNewDepth; iZ++)
+				{
+					for (int32_t iY = 0; iY < iNewHeight; iY++)
+					{
+						const ValueType* pCentre = &scratch.vecBlock[(iZ + 1) * iSliceSize + (iY + 1) * iWidth + 1];
+						ValueType* pDst = &scratch.vecPass[(iZ * iNewHeight + iY) * iNewWidth];
+						combineValues(pCentre - 1, pCentre, pDst, iNewWidth, op);
+						combineValues(pDst, pCentre + 1, pDst, iNewWidth, op);
+						combineValues(pDst, pCentre - iWidth, pDst, iNewWidth, op);
+						combineValues(pDst, pCentre + iWidth, pDst, iNewWidth, op);
+						combineValues(pDst, pCentre - iSliceSize, pDst, iNewWidth, op);
+						combineValues(pDst, pCentre + iSliceSize, pDst, iNewWidth, op);
+					}
+				}
+				scratch.vecBlock.swap(scratch.vecPass);
+				iWidth = iNewWidth;
+				iHeight = iNewHeight;
+				iDepth = iNewDepth;
+			}
+		}
+
+		v3dSize = Vector3DInt32(iWidth, iHeight, iDepth);
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType>
+	template <typename Operator>
+	void MorphologyFilter<SrcVolumeType, DstVolumeType>::filterBitBlock(const StructuringElement& element, Operator op, int32_t& iWidth, Vector3DInt32& v3dSize, TileScratch<uint64_t>& scratch)
+	{
+		// Bit 'i' of each word is the voxel 'i' places along the row. Shifting a word right by one moves every voxel's right hand
+		// neighbour onto it, and the bits which are shifted in from the top are beyond the part of the row which is still in use.
+		const Vector3DInt32& v3dRadius = element.getRadius();
+		int32_t iHeight = v3dSize.getY();
+		int32_t iDepth = v3dSize.getZ();
+
+		if (element.getShape() == StructuringElementShapes::Box)
+		{
+			if (v3dRadius.getX() > 0)
+			{
+				for (auto& uRow : scratch.vecBlock)
+				{
+					uint64_t uResult = uRow;
+					for (int32_t iShift = 1; iShift <= v3dRadius.getX() * 2; iShift++)
+					{
+						uResult = op(uResult, uRow >> iShift);
+					}
+					uRow = uResult;
+				}
+				iWidth -= v3dRadius.getX() * 2;
+			}
+
+			if (v3dRadius.getY() > 0)
+			{
+				const int32_t iNewHeight = iHeight - v3dRadius.getY() * 2;
+				scratch.vecPass.resize(iNewHeight * iDepth);
+				for (int32_t iSlice = 0; iSlice < iDepth; iSlice++)
+				{
+					filterLine(&scratch.vecBlock[iSlice * iHeight], &scratch.vecPass[iSlice * iNewHeight], iNewHeight, v3dRadius.getY(), 1, op, scratch.vecForwards, scratch.vecBackwards);
+				}
+				scratch.vecBlock.swap(scratch.vecPass);
+				iHeight = iNewHeight;
+			}
+
+			if (v3dRadius.getZ() > 0)
+			{
+				const int32_t iNewDepth = iDepth - v3dRadius.getZ() * 2;
+				scratch.vecPass.resize(iHeight * iNewDepth);
+				filterLine(&scratch.vecBlock[0], &scratch.vecPass[0], iNewDepth, v3dRadius.getZ(), iHeight, op, scratch.vecForwards, scratch.vecBackwards);
+				scratch.vecBlock.swap(scratch.vecPass);
+				iDepth = iNewDepth;
+			}
+		}
+		else
+		{
+			for (int32_t iStep = 0; iStep < v3dRadius.getX(); iStep++)
+			{
+				const int32_t iNewHeight = iHeight - 2;
+				const int32_t iNewDepth = iDepth - 2;
+				scratch.vecPass.resize(iNewHeight * iNewDepth);
+				for (int32_t iZ = 0; iZ < iNewDepth; iZ++)
+				{
+					for (int32_t iY = 0; iY < iNewHeight; iY++)
+					{
+						const uint64_t* pCentre = &scratch.vecBlock[(iZ + 1) * iHeight + iY + 1];
+						uint64_t uResult = op(op(*pCentre, *pCentre >> 1), *pCentre >> 2);
+						uResult = op(uResult, pCentre[-1] >> 1);
+						uResult = op(uResult, pCentre[1] >> 1);
+						uResult = op(uResult, pCentre[-iHeight] >> 1);
+						uResult = op(uResult, pCentre[iHeight] >> 1);
+						scratch.vecPass[iZ * iNewHeight + iY] = uResult;
+					}
+				}
+				scratch.vecBlock.swap(scratch.vecPass);
+				iWidth -= 2;
+				iHeight = iNewHeight;
+				iDepth = iNewDepth;
+			}
+		}
+
+		v3dSize = Vector3DInt32(1, iHeight, iDepth);
+	}
+}
@@ -0,0 +1,178 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_MultiChannelVolume_H__
+#define __PolyVox_MultiChannelVolume_H__
+
+#include "BaseVolume.h"
+#include "RawVolume.h"
+#include "Region.h"
+#include "Vector.h"
+#include "VoxelChannels.h"
+
+#include <cstdint>
+
+namespace PolyVox
+{
+	/// The MultiChannelVolume is a fixed size volume which splits each voxel into a density channel and a material channel
+	/// (as described by VoxelChannels) and stores each channel in its own array.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	///
+	/// A voxel type such as MaterialDensityPair packs its channels together, so an algorithm which only needs the densities still
+	/// has to load the materials and unpack both. With a MultiChannelVolume the same algorithm can instead be given the density
+	/// channel on its own (see getDensityChannel()), which is an ordinary RawVolume and so touches only the density bytes. This suits
+	/// passes such as surface extraction, filtering and distance fields.
+	///
+	/// The MultiChannelVolume itself still presents complete voxels, which are assembled from the channels as they are read. It can
+	/// therefore be used anywhere a RawVolume of the same voxel type could, for example when the extractor needs the materials as well.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class MultiChannelVolume : public BaseVolume<VoxelType>
+	{
+	public:
+		typedef typename VoxelChannels<VoxelType>::DensityType DensityType;
+		typedef typename VoxelChannels<VoxelType>::MaterialType MaterialType;
+
+#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< MultiChannelVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			Sampler(MultiChannelVolume<VoxelType>* volume);
+			~Sampler();
+
+			inline VoxelType getVoxel(void) const;
+
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			inline bool setVoxel(VoxelType tValue);
+
+			void movePositiveX(void);
+			void movePositiveY(void);
+			void movePositiveZ(void);
+
+			void moveNegativeX(void);
+			void moveNegativeY(void);
+			void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			// One sampler for each channel, kept at the same position.
+			typename RawVolume<DensityType>::Sampler m_densitySampler;
+			typename RawVolume<MaterialType>::Sampler m_materialSampler;
+		};
+#endif // SWIG
+
+	public:
+		/// Constructor for creating a fixed size volume.
+		MultiChannelVolume(const Region& regValid);
+
+		/// Destructor
+		~MultiChannelVolume();
+
+		/// Gets the value used for voxels which are outside the volume
+		VoxelType getBorderValue(void) const;
+		/// Gets a Region representing the extents of the Volume.
+		const Region& getEnclosingRegion(void) const;
+
+		/// Gets the width of the volume in voxels.
+		int32_t getWidth(void) const;
+		/// Gets the height of the volume in voxels.
+		int32_t getHeight(void) const;
+		/// Gets the depth of the volume in voxels.
+		int32_t getDepth(void) const;
+
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxel(const Vector3DInt32& v3dPos) const;
+
+		/// Sets the value used for voxels which are outside the volume
+		void setBorderValue(const VoxelType& tBorder);
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		void setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		void setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue);
+
+		/// Gets the density channel as a volume in its own right
+		RawVolume<DensityType>& getDensityChannel(void);
+		/// Gets the density channel as a volume in its own right
+		const RawVolume<DensityType>& getDensityChannel(void) const;
+		/// Gets the material channel as a volume in its own right
+		RawVolume<MaterialType>& getMaterialChannel(void);
+		/// Gets the material channel as a volume in its own right
+		const RawVolume<MaterialType>& getMaterialChannel(void) const;
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		MultiChannelVolume(const MultiChannelVolume& rhs);
+
+		/// Assignment operator
+		MultiChannelVolume& operator=(const MultiChannelVolume& rhs);
+
+	private:
+		RawVolume<DensityType> m_densityChannel;
+		RawVolume<MaterialType> m_materialChannel;
+	};
+}
+
+#include "MultiChannelVolume.inl"
+#include "MultiChannelVolumeSampler.inl"
+
+#endif //__PolyVox_MultiChannelVolume_H__
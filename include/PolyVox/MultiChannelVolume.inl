@@ -0,0 +1,226 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates a volume with a fixed size which is specified as a parameter.
+	/// \param regValid Specifies the minimum and maximum valid voxel positions.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>::MultiChannelVolume(const Region& regValid)
+		:BaseVolume<VoxelType>()
+		, m_densityChannel(regValid)
+		, m_materialChannel(regValid)
+	{
+		setBorderValue(VoxelType());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>::MultiChannelVolume(const MultiChannelVolume<VoxelType>& /*rhs*/)
+	{
+		POLYVOX_THROW(not_implemented, "Volume copy constructor not implemented for performance reasons.");
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>::~MultiChannelVolume()
+	{
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>& MultiChannelVolume<VoxelType>::operator=(const MultiChannelVolume<VoxelType>& /*rhs*/)
+	{
+		POLYVOX_THROW(not_implemented, "Volume assignment operator not implemented for performance reasons.");
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The border value is returned whenever an attempt is made to read a voxel which
+	/// is outside the extents of the volume.
+	/// \return The value used for voxels outside of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::getBorderValue(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densityChannel.getBorderValue(), m_materialChannel.getBorderValue());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return A Region representing the extent of the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	const Region& MultiChannelVolume<VoxelType>::getEnclosingRegion(void) const
+	{
+		return m_densityChannel.getEnclosingRegion();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The width of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the width is 64.
+	/// \sa getHeight(), getDepth()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	int32_t MultiChannelVolume<VoxelType>::getWidth(void) const
+	{
+		return m_densityChannel.getWidth();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The height of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the height is 64.
+	/// \sa getWidth(), getDepth()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	int32_t MultiChannelVolume<VoxelType>::getHeight(void) const
+	{
+		return m_densityChannel.getHeight();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The depth of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the depth is 64.
+	/// \sa getWidth(), getHeight()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	int32_t MultiChannelVolume<VoxelType>::getDepth(void) const
+	{
+		return m_densityChannel.getDepth();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densityChannel.getVoxel(uXPos, uYPos, uZPos), m_materialChannel.getVoxel(uXPos, uYPos, uZPos));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::getVoxel(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param tBorder The value to use for voxels outside the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::setBorderValue(const VoxelType& tBorder)
+	{
+		m_densityChannel.setBorderValue(VoxelChannels<VoxelType>::getDensity(tBorder));
+		m_materialChannel.setBorderValue(VoxelChannels<VoxelType>::getMaterial(tBorder));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		m_densityChannel.setVoxel(uXPos, uYPos, uZPos, VoxelChannels<VoxelType>::getDensity(tValue));
+		m_materialChannel.setVoxel(uXPos, uYPos, uZPos, VoxelChannels<VoxelType>::getMaterial(tValue));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The channel has the same extents as this volume, and writing to it changes the densities of this volume's voxels. Note
+	/// that it has its own border value, which is only kept in step with this volume's if it is set through setBorderValue().
+	/// \return The volume holding the density of each voxel
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	RawVolume<typename MultiChannelVolume<VoxelType>::DensityType>& MultiChannelVolume<VoxelType>::getDensityChannel(void)
+	{
+		return m_densityChannel;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The volume holding the density of each voxel
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	const RawVolume<typename MultiChannelVolume<VoxelType>::DensityType>& MultiChannelVolume<VoxelType>::getDensityChannel(void) const
+	{
+		return m_densityChannel;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The volume holding the material of each voxel
+	/// \sa getDensityChannel()
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	RawVolume<typename MultiChannelVolume<VoxelType>::MaterialType>& MultiChannelVolume<VoxelType>::getMaterialChannel(void)
+	{
+		return m_materialChannel;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The volume holding the material of each voxel
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	const RawVolume<typename MultiChannelVolume<VoxelType>::MaterialType>& MultiChannelVolume<VoxelType>::getMaterialChannel(void) const
+	{
+		return m_materialChannel;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Calculate the memory usage of the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t MultiChannelVolume<VoxelType>::calculateSizeInBytes(void)
+	{
+		return m_densityChannel.calculateSizeInBytes() + m_materialChannel.calculateSizeInBytes();
+	}
+}
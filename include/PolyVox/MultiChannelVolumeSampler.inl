@@ -0,0 +1,291 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>::Sampler::Sampler(MultiChannelVolume<VoxelType>* volume)
+		:BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >(volume)
+		, m_densitySampler(&volume->m_densityChannel)
+		, m_materialSampler(&volume->m_materialChannel)
+	{
+	}
+
+	template <typename VoxelType>
+	MultiChannelVolume<VoxelType>::Sampler::~Sampler()
+	{
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::getVoxel(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.getVoxel(), m_materialSampler.getVoxel());
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	{
+		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::setPosition(xPos, yPos, zPos);
+
+		m_densitySampler.setPosition(xPos, yPos, zPos);
+		m_materialSampler.setPosition(xPos, yPos, zPos);
+	}
+
+	template <typename VoxelType>
+	bool MultiChannelVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
+	{
+		// Both channels have the same extents, so either both writes succeed or neither does.
+		m_materialSampler.setVoxel(VoxelChannels<VoxelType>::getMaterial(tValue));
+		return m_densitySampler.setVoxel(VoxelChannels<VoxelType>::getDensity(tValue));
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::movePositiveX(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::movePositiveX();
+
+		m_densitySampler.movePositiveX();
+		m_materialSampler.movePositiveX();
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::movePositiveY(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::movePositiveY();
+
+		m_densitySampler.movePositiveY();
+		m_materialSampler.movePositiveY();
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::movePositiveZ(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::movePositiveZ();
+
+		m_densitySampler.movePositiveZ();
+		m_materialSampler.movePositiveZ();
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::moveNegativeX(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::moveNegativeX();
+
+		m_densitySampler.moveNegativeX();
+		m_materialSampler.moveNegativeX();
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::moveNegativeY(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::moveNegativeY();
+
+		m_densitySampler.moveNegativeY();
+		m_materialSampler.moveNegativeY();
+	}
+
+	template <typename VoxelType>
+	void MultiChannelVolume<VoxelType>::Sampler::moveNegativeZ(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< MultiChannelVolume<VoxelType> >::moveNegativeZ();
+
+		m_densitySampler.moveNegativeZ();
+		m_materialSampler.moveNegativeZ();
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1ny1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1ny1nz(), m_materialSampler.peekVoxel1nx1ny1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1ny0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1ny0pz(), m_materialSampler.peekVoxel1nx1ny0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1ny1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1ny1pz(), m_materialSampler.peekVoxel1nx1ny1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx0py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx0py1nz(), m_materialSampler.peekVoxel1nx0py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx0py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx0py0pz(), m_materialSampler.peekVoxel1nx0py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx0py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx0py1pz(), m_materialSampler.peekVoxel1nx0py1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1py1nz(), m_materialSampler.peekVoxel1nx1py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1py0pz(), m_materialSampler.peekVoxel1nx1py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1nx1py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1nx1py1pz(), m_materialSampler.peekVoxel1nx1py1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1ny1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1ny1nz(), m_materialSampler.peekVoxel0px1ny1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1ny0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1ny0pz(), m_materialSampler.peekVoxel0px1ny0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1ny1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1ny1pz(), m_materialSampler.peekVoxel0px1ny1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px0py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px0py1nz(), m_materialSampler.peekVoxel0px0py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px0py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px0py0pz(), m_materialSampler.peekVoxel0px0py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px0py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px0py1pz(), m_materialSampler.peekVoxel0px0py1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1py1nz(), m_materialSampler.peekVoxel0px1py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1py0pz(), m_materialSampler.peekVoxel0px1py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel0px1py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel0px1py1pz(), m_materialSampler.peekVoxel0px1py1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1ny1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1ny1nz(), m_materialSampler.peekVoxel1px1ny1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1ny0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1ny0pz(), m_materialSampler.peekVoxel1px1ny0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1ny1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1ny1pz(), m_materialSampler.peekVoxel1px1ny1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px0py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px0py1nz(), m_materialSampler.peekVoxel1px0py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px0py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px0py0pz(), m_materialSampler.peekVoxel1px0py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px0py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px0py1pz(), m_materialSampler.peekVoxel1px0py1pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1py1nz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1py1nz(), m_materialSampler.peekVoxel1px1py1nz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1py0pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1py0pz(), m_materialSampler.peekVoxel1px1py0pz());
+	}
+
+	template <typename VoxelType>
+	VoxelType MultiChannelVolume<VoxelType>::Sampler::peekVoxel1px1py1pz(void) const
+	{
+		return VoxelChannels<VoxelType>::makeVoxel(m_densitySampler.peekVoxel1px1py1pz(), m_materialSampler.peekVoxel1px1py1pz());
+	}
+}
@@ -26,7 +26,12 @@
 #define __PolyVox_PagedVolume_H__
 
 #include "BaseVolume.h"
+#include "ChunkView.h"
+#include "Impl/MipmapImpl.h"
+#include "Impl/Morton.h"
+#include "Impl/Utility.h"
 #include "Region.h"
+#include "RegionScheduler.h"
 #include "Vector.h"
 
 #include <limits>
@@ -41,6 +46,11 @@
 
 namespace PolyVox
 {
+	/// The chunk side length of a PagedVolume can be fixed at compile time by giving it as the second template parameter, for example
+	/// PagedVolume<VoxelType, 32>. The default of zero means that it is passed to the constructor instead.
+	template <typename VoxelType, uint16_t ChunkSideLength = 0>
+	class PagedVolume;
+
 	/// This class provide a volume implementation which avoids storing all the data in memory at all times. Instead it breaks the volume
 	/// down into a set of chunks and moves these into and out of memory on demand. This means it is much more memory efficient than the
 	/// RawVolume, but may also be slower and is more complicated We encourage uses to work with RawVolume initially, and then switch to
@@ -53,9 +63,17 @@ namespace PolyVox
 	///
 	/// A consequence of this paging approach is that (unlike the RawVolume) the PagedVolume does not need to have a predefined size. After
 	/// the volume has been created you can begin acessing voxels anywhere in space and the required data will be created automatically.
+	///
+	/// The PagedVolume can also keep reduced resolution copies of each chunk (see setNoOfLodLevels()). These are much smaller than the
+	/// chunks and can also be stored by the Pager, so distant parts of the volume can be read at a lower level of detail (for example
+	/// through a LodVolume) without paging in all of their voxels.
+	///
+	/// Volumes often contain many identical chunks, such as those which are entirely empty or entirely solid. If chunk deduplication is
+	/// enabled (see setChunkDeduplicationEnabled()) these share a single copy of their data while they are in memory, and a chunk only
+	/// gets its own copy again when it is modified.
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
-	class PagedVolume : public BaseVolume<VoxelType>
+	class PagedVolume<VoxelType, 0> : public BaseVolume<VoxelType>
 	{
 	public:
 		/// The PagedVolume stores it data as a set of Chunk instances which can be loaded and unloaded as memory requirements dictate.
@@ -63,9 +81,17 @@ namespace PolyVox
 		/// The Pager class is responsible for the loading and unloading of Chunks, and can be subclassed by the user.
 		class Pager;
 
+	private:
+		// Chunks with identical contents can share one copy of their data (see setChunkDeduplicationEnabled()).
+		struct SharedChunkData;
+		class ChunkDataStore;
+
+	public:
 		class Chunk
 		{
-			friend class PagedVolume;
+			template <typename, uint16_t> friend class PagedVolume;
+			friend class VolumeCopier;
+			friend class BrushApplier;
 
 		public:
 			Chunk(Vector3DInt32 v3dPosition, uint16_t uSideLength, Pager* pPager = nullptr);
@@ -90,21 +116,47 @@ namespace PolyVox
 			/// Private assignment operator to prevent accisdental copying
 			Chunk& operator=(const Chunk& /*rhs*/) {};
 
+			// Must be called before the data is modified, in case it is shared with other chunks.
+			void makeDataWritable(void);
+
+			// Must be called before the voxels are changed through m_tData. Makes the data writable and records that
+			// it has to be paged out and that the LOD levels have to be rebuilt.
+			void markDataModified(void);
+
+			// Used by samplers, rather than changing m_uPinCount directly, as pinning a chunk can affect how its data is shared.
+			void pin(void);
+			void unpin(void);
+
 			// This is updated by the PagedVolume and used to discard the least recently used chunks.
 			uint32_t m_uChunkLastAccessed;
 
+			// The number of samplers which currently point into this chunk. The PagedVolume will not delete a chunk while it is pinned.
+			uint32_t m_uPinCount;
+
 			// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
 			// a compressed chunk has to be paged back to disk, or whether they can just be discarded.
 			bool m_bDataModified;
 
-			uint32_t calculateSizeInBytes(void);
-			static uint32_t calculateSizeInBytes(uint32_t uSideLength);
+			// Reduced resolution copies of this chunk (see PagedVolume::setNoOfLodLevels()). They are built when first
+			// needed, and rebuilt if the voxels have changed since (m_bLodOutOfDate). m_bLodModified is set when they
+			// have been built since the chunk was paged in, so that they are given to the Pager when it is paged out.
+			std::unique_ptr<VoxelType[]> m_pLodData;
+			bool m_bLodOutOfDate;
+			bool m_bLodModified;
+
+			uint64_t calculateSizeInBytes(void);
+			static uint64_t calculateSizeInBytes(uint32_t uSideLength);
 
 			VoxelType* m_tData;
 			uint16_t m_uSideLength;
 			uint8_t m_uSideLengthPower;
 			Pager* m_pPager;
 
+			// Set if m_tData is shared with identical chunks, in which case it belongs to the ChunkDataStore and must not be
+			// modified. m_uSharedDataIndex is the position of this chunk in the list of chunks sharing it.
+			SharedChunkData* m_pSharedData;
+			uint32_t m_uSharedDataIndex;
+
 			// Note: Do we really need to store this position here as well as in the block maps?
 			Vector3DInt32 m_v3dChunkSpacePosition;
 		};
@@ -124,8 +176,54 @@ namespace PolyVox
 
 			virtual void pageIn(const Region& region, Chunk* pChunk) = 0;
 			virtual void pageOut(const Region& region, Chunk* pChunk) = 0;
+
+			/// Called for the reduced resolution levels of a chunk which is not in memory. Returns false if they were not previously
+			/// stored by pageOutLod(), in which case the chunk itself is paged in to build them. The default implementation stores nothing.
+			virtual bool pageInLod(const Region& /*region*/, VoxelType* /*pData*/, uint32_t /*uDataSizeInBytes*/) { return false; }
+			/// Called when a chunk whose reduced resolution levels have been built leaves memory, so that they can be stored with it.
+			virtual void pageOutLod(const Region& /*region*/, const VoxelType* /*pData*/, uint32_t /*uDataSizeInBytes*/) {}
 		};
 
+	private:
+		struct SharedChunkData
+		{
+			std::unique_ptr<VoxelType[]> m_pData;
+			uint64_t m_uHash;
+			// The chunks using the data, and how many of them are pinned (which is never more than one, see ChunkDataStore).
+			std::vector<Chunk*> m_vecChunks;
+			uint32_t m_uNoOfPinnedChunks;
+			ChunkDataStore* m_pStore;
+		};
+
+		// Chunks are added to the store after being paged in, and then share their data with any identical chunk which is already in
+		// it (they are found by a hash of their contents). Shared data is never modified - instead a chunk gets its own copy before it
+		// is written to. The exception is a pinned chunk, as samplers point directly into its data. It keeps the data and the other
+		// chunks move to the copy. This only works if no more than one of the chunks sharing some data is pinned, so a chunk which is
+		// pinned while another one already is gets its own copy at that point.
+		class ChunkDataStore
+		{
+		public:
+			ChunkDataStore(uint32_t uNoOfVoxels);
+
+			void addChunk(Chunk* pChunk);
+			void removeChunk(Chunk* pChunk);
+			void makeChunkDataPrivate(Chunk* pChunk);
+
+			void pinChunk(Chunk* pChunk);
+			void unpinChunk(Chunk* pChunk);
+
+			uint32_t getNoOfSharedData(void) const;
+
+		private:
+			void attachChunk(Chunk* pChunk, SharedChunkData* pSharedData);
+			void detachChunk(Chunk* pChunk);
+
+			uint32_t m_uNoOfVoxels;
+			std::unordered_map<uint64_t, std::vector< std::unique_ptr<SharedChunkData> > > m_mapSharedData;
+		};
+
+	public:
+
 		//There seems to be some descrepency between Visual Studio and GCC about how the following class should be declared.
 		//There is a work around (see also See http://goo.gl/qu1wn) given below which appears to work on VS2010 and GCC, but
 		//which seems to cause internal compiler errors on VS2008 when building with the /Gm 'Enable Minimal Rebuild' compiler
@@ -133,16 +231,26 @@ namespace PolyVox
 		//in the future
 		//typedef Volume<VoxelType> VolumeOfVoxelType; //Workaround for GCC/VS2010 differences.
 		//class Sampler : public VolumeOfVoxelType::template Sampler< PagedVolume<VoxelType> >
+
+		/// Provides fast access to the voxels around a position, and can also write them. The chunk containing the current position
+		/// is pinned so that the volume cannot page it out while the sampler points into it, which means a sampler must always be
+		/// destroyed before the volume it samples.
 #ifndef SWIG
+		// The sampler gets the chunk side length from the volume, unless it is known at compile time and given as
+		// SamplerChunkSideLength (see the PagedVolume with a fixed chunk size). Users should just use PagedVolume::Sampler.
+		template <uint16_t SamplerChunkSideLength>
 #if defined(_MSC_VER)
-		class Sampler : public BaseVolume<VoxelType>::Sampler< PagedVolume<VoxelType> > //This line works on VS2010
+		class SamplerImpl : public BaseVolume<VoxelType>::Sampler< PagedVolume<VoxelType> > //This line works on VS2010
 #else
-		class Sampler : public BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> > //This line works on GCC
+		class SamplerImpl : public BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> > //This line works on GCC
 #endif
 		{
 		public:
-			Sampler(PagedVolume<VoxelType>* volume);
-			~Sampler();
+			SamplerImpl(PagedVolume<VoxelType>* volume);
+			SamplerImpl(const SamplerImpl& rhs);
+			~SamplerImpl();
+
+			SamplerImpl& operator=(const SamplerImpl& rhs);
 
 			inline VoxelType getVoxel(void) const;
 
@@ -189,19 +297,42 @@ namespace PolyVox
 			inline VoxelType peekVoxel1px1py1pz(void) const;
 
 		private:
+			// Chunks are cached in a 3x3x3 block centred on the current chunk, so that moves and peeks which cross
+			// a chunk boundary do not have to look the neighbouring chunk up in the volume each time.
+			uint16_t getChunkSideLengthMinusOne(void) const;
+			uint8_t getChunkSideLengthPower(void) const;
+
+			static uint32_t getNeighbourIndex(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ);
+			Chunk* getNeighbourChunk(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ) const;
+			void discardNeighbourChunks(void) const;
+			void moveToChunk(int32_t iChunkX, int32_t iChunkY, int32_t iChunkZ);
+			void setCurrentChunk(Chunk* pChunk);
+			VoxelType peekAcrossChunkBoundary(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ) const;
+
 			//Other current position information
 			VoxelType* mCurrentVoxel;
 
+			// The chunk containing mCurrentVoxel. It is pinned so that the volume cannot delete it while we point into it.
+			Chunk* m_pCurrentChunk;
+
 			uint16_t m_uXPosInChunk;
 			uint16_t m_uYPosInChunk;
 			uint16_t m_uZPosInChunk;
 
-			// This should ideally be const, but that prevent automatic generation of an assignment operator (https://goo.gl/Sn7KpZ).
-			// We could provide one manually, but it's currently unused so there is no real test for if it works. I'm putting
-			// together a new release at the moment so I'd rathern not make 'risky' changes.
+			// This should ideally be const, but then it could not be copied by the assignment operator.
 			uint16_t m_uChunkSideLengthMinusOne;
+
+			// The current chunk and its neighbours, which are null until they are first needed. The neighbours are discarded if
+			// the volume has deleted any chunks since they were looked up (see m_uNoOfChunksDeleted), as they might be gone.
+			mutable Chunk* m_arrayNeighbourChunks[27];
+			mutable uint32_t m_uNoOfChunksDeleted;
+			int32_t m_iXChunk;
+			int32_t m_iYChunk;
+			int32_t m_iZChunk;
 		};
 
+		typedef SamplerImpl<0> Sampler;
+
 #endif // SWIG
 
 	public:
@@ -220,6 +351,33 @@ namespace PolyVox
 		/// Sets the voxel at the position given by a 3D vector
 		void setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue);
 
+		/// Gets the voxels at many scattered positions, looking up each chunk only once
+		void getVoxels(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, VoxelType* pResults, uint32_t uNoOfThreads = 1) const;
+		/// Gets the voxels at many scattered positions, sharing the chunks between the threads of a scheduler
+		void getVoxels(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, VoxelType* pResults, RegionScheduler& scheduler) const;
+		/// Sets the voxels at many scattered positions, looking up each chunk only once
+		void setVoxels(const Vector3DInt32* pPositions, const VoxelType* pValues, uint32_t uNoOfPositions, uint32_t uNoOfThreads = 1);
+		/// Sets the voxels at many scattered positions, sharing the chunks between the threads of a scheduler
+		void setVoxels(const Vector3DInt32* pPositions, const VoxelType* pValues, uint32_t uNoOfPositions, RegionScheduler& scheduler);
+
+		/// Keeps reduced resolution copies of each chunk, so that distant parts of the volume can be read without paging in all their voxels.
+		void setNoOfLodLevels(uint32_t uNoOfLodLevels, MipmapMode eLodMode = MipmapModes::Average);
+		/// Gets the number of reduced resolution levels kept for each chunk.
+		uint32_t getNoOfLodLevels(void) const;
+		/// Gets a voxel from one of the reduced resolution levels, where level zero is the volume itself.
+		VoxelType getLodVoxel(uint32_t uLevel, int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel from one of the reduced resolution levels, where level zero is the volume itself.
+		VoxelType getLodVoxel(uint32_t uLevel, const Vector3DInt32& v3dPos) const;
+
+		/// Lets chunks with identical contents share one copy of their data while they are in memory.
+		void setChunkDeduplicationEnabled(bool bEnabled);
+		/// Whether chunks with identical contents share their data.
+		bool isChunkDeduplicationEnabled(void) const;
+
+		/// Calls a function with direct access to the voxels of each chunk which overlaps a region (see ChunkView).
+		template <typename Function>
+		void forEachChunk(const Region& region, Function function);
+
 		/// Tries to ensure that the voxels within the specified Region are loaded into memory.
 		void prefetch(Region regPrefetch);
 		/// Removes all voxels from memory
@@ -236,8 +394,35 @@ namespace PolyVox
 		PagedVolume& operator=(const PagedVolume& rhs);
 
 	private:
+		// Volumes with a fixed chunk size reuse the chunk management of this class.
+		template <typename, uint16_t> friend class PagedVolume;
+
+		// Copies between volumes and brush edits work directly on the chunks.
+		friend class VolumeCopier;
+		friend class BrushApplier;
+
 		bool canReuseLastAccessedChunk(int32_t iChunkX, int32_t iChunkY, int32_t iChunkZ) const;
+		static uint32_t getChunkArrayHash(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ);
+		Chunk* findChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
 		Chunk* getChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
+		void deleteChunk(uint32_t uIndex) const;
+
+		// Used by the ChunkViews passed out by forEachChunk() when a chunk is about to be written.
+		static VoxelType* modifyChunkData(void* pChunk);
+
+		// Used by getVoxels() and setVoxels() to visit the positions grouped by chunk.
+		struct BatchEntry
+		{
+			uint32_t m_uIndexInChunk;
+			uint32_t m_uPosition;
+		};
+		template <typename Function>
+		void forEachBatchedVoxel(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, RegionScheduler& scheduler, bool bWriting, Function function) const;
+
+		const VoxelType* getLodData(int32_t iChunkX, int32_t iChunkY, int32_t iChunkZ) const;
+		void updateLodData(Chunk* pChunk) const;
+		void limitLodDataCount(void) const;
+		Region getChunkRegion(const Vector3DInt32& v3dChunkPos) const;
 
 		// Storing these properties individually has proved to be faster than keeping
 		// them in a Vector3DInt32 as it avoids constructions and comparison overheads.
@@ -250,8 +435,14 @@ namespace PolyVox
 
 		mutable uint32_t m_uTimestamper = 0;
 
+		// Incremented whenever a chunk is removed from memory, so that samplers know when their cached chunk pointers have to be refreshed.
+		mutable uint32_t m_uNoOfChunksDeleted = 0;
+
 		uint32_t m_uChunkCountLimit = 0;
 
+		// Only present if chunk deduplication is enabled. It is declared before the chunks as they use it when they are destroyed.
+		std::unique_ptr<ChunkDataStore> m_pChunkDataStore;
+
 		// Chunks are stored in the following array which is used as a hash-table. Conventional wisdom is that such a hash-table
 		// should not be more than half full to avoid conflicts, and a practical chunk size seems to be 64^3. With this configuration
 		// there can be up to 32768*64^3 = 8 gigavoxels (with each voxel perhaps being many bytes). This should effectively make use 
@@ -268,11 +459,69 @@ namespace PolyVox
 		int32_t m_iChunkMask;
 
 		Pager* m_pPager = nullptr;
+
+		// Reduced resolution data for chunks which are not in memory. While a chunk is in memory it owns its own data instead,
+		// so anything found here is up to date. The data is kept for more chunks than the chunks themselves, as it is smaller.
+		struct LodData
+		{
+			std::unique_ptr<VoxelType[]> m_pData;
+			uint32_t m_uLastAccessed;
+		};
+		mutable std::unordered_map<Vector3DInt32, LodData> m_mapLodData;
+		uint32_t m_uLodDataCountLimit = 0;
+
+		uint32_t m_uNoOfLodLevels = 0;
+		MipmapMode m_eLodMode = MipmapModes::Average;
+		// Where each level starts within the reduced resolution data of a chunk. The last entry is the total size.
+		std::vector<uint32_t> m_vecLodOffsets;
+
+		// As with m_pLastAccessedChunk, but for getLodVoxel(). The chunk is null if the data came from m_mapLodData.
+		mutable int32_t m_iLastLodChunkX = 0;
+		mutable int32_t m_iLastLodChunkY = 0;
+		mutable int32_t m_iLastLodChunkZ = 0;
+		mutable const VoxelType* m_pLastLodData = nullptr;
+		mutable Chunk* m_pLastLodChunk = nullptr;
+	};
+
+	/// A PagedVolume whose chunk side length is a compile time constant. It behaves exactly like a PagedVolume with chunks of that size
+	/// (and can be used anywhere one is expected), but getVoxel(), setVoxel() and the Sampler do not have to read the chunk size from
+	/// the volume, so the shifts and masks which locate a voxel within its chunk are constants. Any power of two up to 1024 can be used.
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	class PagedVolume : public PagedVolume<VoxelType>
+	{
+		static_assert(isPowerOf2Static(ChunkSideLength), "Chunk side length must be a power of two.");
+		static_assert(ChunkSideLength <= uMaxMortonSideLength, "Chunk side length is too large to be addressed with 32-bit Morton indices.");
+
+	public:
+#ifndef SWIG
+		typedef typename PagedVolume<VoxelType>::template SamplerImpl<ChunkSideLength> Sampler;
+#endif // SWIG
+
+		/// Constructor for creating a volume with chunks of size ChunkSideLength.
+		PagedVolume(typename PagedVolume<VoxelType>::Pager* pPager, uint32_t uTargetMemoryUsageInBytes = 256 * 1024 * 1024);
+
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxel(const Vector3DInt32& v3dPos) const;
+
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		void setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		void setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue);
+
+	private:
+		typename PagedVolume<VoxelType>::Chunk* getChunkContaining(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		static uint32_t getIndexInChunk(int32_t uXPos, int32_t uYPos, int32_t uZPos);
+
+		static const uint8_t uChunkSideLengthPower = logBase2Static(ChunkSideLength);
+		static const int32_t iChunkMask = ChunkSideLength - 1;
 	};
 }
 
 #include "PagedVolume.inl"
 #include "PagedVolumeChunk.inl"
+#include "PagedVolumeChunkDataStore.inl"
 #include "PagedVolumeSampler.inl"
 
 #endif //__PolyVox_PagedVolume_H__
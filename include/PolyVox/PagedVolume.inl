@@ -23,6 +23,7 @@
 *******************************************************************************/
 
 #include "Impl/ErrorHandling.h"
+#include "Impl/Morton.h"
 
 #include <algorithm>
 #include <limits>
@@ -45,7 +46,7 @@ namespace PolyVox
 			POLYVOX_THROW_IF(!pPager, std::invalid_argument, "You must provide a valid pager when constructing a PagedVolume");
 			POLYVOX_THROW_IF(uTargetMemoryUsageInBytes < 1 * 1024 * 1024, std::invalid_argument, "Target memory usage is too small to be practical");
 			POLYVOX_THROW_IF(m_uChunkSideLength == 0, std::invalid_argument, "Chunk side length cannot be zero.");
-			POLYVOX_THROW_IF(m_uChunkSideLength > 256, std::invalid_argument, "Chunk size is too large to be practical.");
+			POLYVOX_THROW_IF(m_uChunkSideLength > uMaxMortonSideLength, std::invalid_argument, "Chunk size is too large to be practical.");
 			POLYVOX_THROW_IF(!isPowerOf2(m_uChunkSideLength), std::invalid_argument, "Chunk side length must be a power of two.");
 
 			// Used to perform multiplications and divisions by bit shifting.
@@ -54,8 +55,9 @@ namespace PolyVox
 			m_iChunkMask = m_uChunkSideLength - 1;
 
 			// Calculate the number of chunks based on the memory limit and the size of each chunk.
-			uint32_t uChunkSizeInBytes = PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(m_uChunkSideLength);
-			m_uChunkCountLimit = uTargetMemoryUsageInBytes / uChunkSizeInBytes;
+			const uint64_t uChunkSizeInBytes = PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(m_uChunkSideLength);
+			POLYVOX_THROW_IF(uChunkSizeInBytes > uTargetMemoryUsageInBytes, std::invalid_argument, "A single chunk is larger than the target memory usage.");
+			m_uChunkCountLimit = static_cast<uint32_t>(uTargetMemoryUsageInBytes / uChunkSizeInBytes);
 
 			// Enforce sensible limits on the number of chunks.
 			const uint32_t uMinPracticalNoOfChunks = 32; // Enough to make sure a chunks and it's neighbours can be loaded, with a few to spare.
@@ -85,10 +87,16 @@ namespace PolyVox
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// Destroys the volume The destructor will call flushAll() to ensure that a paging volume has the chance to save it's data via the dataOverflowHandler() if desired.
+	/// Any samplers of the volume must have been destroyed first, as they still point into the chunk they are positioned in.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	PagedVolume<VoxelType>::~PagedVolume()
 	{
+		for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
+		{
+			POLYVOX_ASSERT(!m_arrayChunks[uIndex] || (m_arrayChunks[uIndex]->m_uPinCount == 0), "A sampler of this volume still exists. Samplers must be destroyed before their volume.");
+		}
+
 		flushAll();
 	}
 
@@ -172,6 +180,260 @@ namespace PolyVox
 		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+	/// Calling getVoxel() for positions which are scattered around the volume means looking up a different chunk almost every time,
+	/// and reading from memory in no particular order. Instead, this groups the positions by chunk so that each chunk is looked
+	/// up once and all of the voxels which are needed from it are read together.
+	///
+	/// Large batches can be split between several threads. The chunks are still looked up (and paged in) by the calling thread, so
+	/// this only helps when there are many positions in each chunk. Code which does this repeatedly should create a RegionScheduler
+	/// once and pass it to the other overload, rather than having threads created for every call.
+	/// \param pPositions The positions to read
+	/// \param uNoOfPositions The number of positions
+	/// \param pResults Receives the voxel at each position, in the same order as the positions
+	/// \param uNoOfThreads The number of threads to use, where zero means one per hardware thread
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::getVoxels(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, VoxelType* pResults, uint32_t uNoOfThreads) const
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		getVoxels(pPositions, uNoOfPositions, pResults, scheduler);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pPositions The positions to read
+	/// \param uNoOfPositions The number of positions
+	/// \param pResults Receives the voxel at each position, in the same order as the positions
+	/// \param scheduler The scheduler whose threads the chunks are shared between
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::getVoxels(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, VoxelType* pResults, RegionScheduler& scheduler) const
+	{
+		forEachBatchedVoxel(pPositions, uNoOfPositions, scheduler, false, [=](Chunk* pChunk, const BatchEntry& entry)
+		{
+			pResults[entry.m_uPosition] = pChunk->m_tData[entry.m_uIndexInChunk];
+		});
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// As getVoxels(), but for writing. If a position is given more than once then the last of its values is the one which is kept.
+	/// \param pPositions The positions to write
+	/// \param pValues The value to write at each position
+	/// \param uNoOfPositions The number of positions
+	/// \param uNoOfThreads The number of threads to use, where zero means one per hardware thread
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::setVoxels(const Vector3DInt32* pPositions, const VoxelType* pValues, uint32_t uNoOfPositions, uint32_t uNoOfThreads)
+	{
+		RegionScheduler scheduler(uNoOfThreads);
+		setVoxels(pPositions, pValues, uNoOfPositions, scheduler);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pPositions The positions to write
+	/// \param pValues The value to write at each position
+	/// \param uNoOfPositions The number of positions
+	/// \param scheduler The scheduler whose threads the chunks are shared between
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::setVoxels(const Vector3DInt32* pPositions, const VoxelType* pValues, uint32_t uNoOfPositions, RegionScheduler& scheduler)
+	{
+		forEachBatchedVoxel(pPositions, uNoOfPositions, scheduler, true, [=](Chunk* pChunk, const BatchEntry& entry)
+		{
+			pChunk->m_tData[entry.m_uIndexInChunk] = pValues[entry.m_uPosition];
+		});
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The function is called as 'function(view)' with a ChunkView<VoxelType>& for each chunk which overlaps \a region, in order
+	/// of increasing z, then y, then x. Each chunk is stored in Morton order and is pinned while the function runs, so the function
+	/// can still use the volume without the chunk being paged out. Chunks which are written through ChunkView::getWritableData()
+	/// are marked as modified so that they are passed back to the Pager.
+	/// \param region The region to visit
+	/// \param function The function to call for each chunk
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	template <typename Function>
+	void PagedVolume<VoxelType>::forEachChunk(const Region& region, Function function)
+	{
+		for (int32_t iChunkZ = region.getLowerZ() >> m_uChunkSideLengthPower; iChunkZ <= (region.getUpperZ() >> m_uChunkSideLengthPower); iChunkZ++)
+		{
+			for (int32_t iChunkY = region.getLowerY() >> m_uChunkSideLengthPower; iChunkY <= (region.getUpperY() >> m_uChunkSideLengthPower); iChunkY++)
+			{
+				for (int32_t iChunkX = region.getLowerX() >> m_uChunkSideLengthPower; iChunkX <= (region.getUpperX() >> m_uChunkSideLengthPower); iChunkX++)
+				{
+					const Region regChunk = getChunkRegion(Vector3DInt32(iChunkX, iChunkY, iChunkZ));
+					Region regView(regChunk);
+					regView.cropTo(region);
+
+					Chunk* pChunk = getChunk(iChunkX, iChunkY, iChunkZ);
+					pChunk->pin();
+					try
+					{
+						ChunkView<VoxelType> view(pChunk->m_tData, ChunkLayouts::Morton, regChunk, regView, 0, 0, &PagedVolume<VoxelType>::modifyChunkData, pChunk);
+						function(view);
+					}
+					catch (...)
+					{
+						pChunk->unpin();
+						throw;
+					}
+					pChunk->unpin();
+				}
+			}
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Level \a n holds one voxel for every 2^n x 2^n x 2^n block of the volume, so voxel (x,y,z) of it covers voxels (x,y,z) * 2^n
+	/// to (x,y,z) * 2^n + 2^n - 1. Each level is built from the one above by reducing 2x2x2 blocks in the same way as downsampleVolume(),
+	/// but chunk by chunk. Building a chunk's levels needs the chunk itself, but afterwards they are kept for longer than the chunk (they
+	/// are smaller) and can be stored by the Pager (see Pager::pageOutLod()), so reading distant parts of the volume at a low level of
+	/// detail does not need to page in their voxels. When a chunk is modified its levels are rebuilt when they are next read, or when
+	/// it is paged out.
+	///
+	/// Changing the levels discards any existing reduced resolution data. Data which the Pager stored with different settings should be
+	/// removed by the application, though a different number of levels is detected through the size of the data.
+	///
+	/// \param uNoOfLodLevels The number of levels to keep (in addition to the volume itself), which can be no more than log2 of the chunk side length. Zero disables them.
+	/// \param eLodMode How each 2x2x2 block is reduced to a single voxel
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::setNoOfLodLevels(uint32_t uNoOfLodLevels, MipmapMode eLodMode)
+	{
+		POLYVOX_THROW_IF(uNoOfLodLevels > m_uChunkSideLengthPower, std::invalid_argument, "The chunks are too small for the requested number of LOD levels");
+
+		m_mapLodData.clear();
+		m_pLastLodData = nullptr;
+		for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
+		{
+			if (m_arrayChunks[uIndex])
+			{
+				m_arrayChunks[uIndex]->m_pLodData = nullptr;
+				m_arrayChunks[uIndex]->m_bLodOutOfDate = true;
+				m_arrayChunks[uIndex]->m_bLodModified = false;
+			}
+		}
+
+		m_uNoOfLodLevels = uNoOfLodLevels;
+		m_eLodMode = eLodMode;
+
+		// Level one starts at the beginning of the data, and each level is followed by the next.
+		m_vecLodOffsets.assign(uNoOfLodLevels + 2, 0);
+		for (uint32_t uLevel = 1; uLevel <= uNoOfLodLevels; uLevel++)
+		{
+			const uint32_t uLevelSideLength = m_uChunkSideLength >> uLevel;
+			m_vecLodOffsets[uLevel + 1] = m_vecLodOffsets[uLevel] + uLevelSideLength * uLevelSideLength * uLevelSideLength;
+		}
+
+		// Allow the kept data to use up to half as much memory as the chunks themselves.
+		if (uNoOfLodLevels > 0)
+		{
+			const uint64_t uChunkSizeInBytes = Chunk::calculateSizeInBytes(m_uChunkSideLength);
+			const uint64_t uLodSizeInBytes = m_vecLodOffsets.back() * sizeof(VoxelType);
+			m_uLodDataCountLimit = static_cast<uint32_t>((std::max)((m_uChunkCountLimit * uChunkSizeInBytes) / (uLodSizeInBytes * 2), static_cast<uint64_t>(m_uChunkCountLimit)));
+		}
+	}
+
+	template <typename VoxelType>
+	uint32_t PagedVolume<VoxelType>::getNoOfLodLevels(void) const
+	{
+		return m_uNoOfLodLevels;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uLevel The level to read from, which must be no more than getNoOfLodLevels()
+	/// \param uXPos The \c x position of the voxel within the level
+	/// \param uYPos The \c y position of the voxel within the level
+	/// \param uZPos The \c z position of the voxel within the level
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType PagedVolume<VoxelType>::getLodVoxel(uint32_t uLevel, int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		if (uLevel == 0)
+		{
+			return getVoxel(uXPos, uYPos, uZPos);
+		}
+
+		POLYVOX_THROW_IF(uLevel > m_uNoOfLodLevels, std::out_of_range, "The requested LOD level is not being kept");
+
+		// Chunks shrink along with the voxels, so at this level they have a side length of 2^uLevelPower.
+		const uint8_t uLevelPower = m_uChunkSideLengthPower - static_cast<uint8_t>(uLevel);
+		const int32_t chunkX = uXPos >> uLevelPower;
+		const int32_t chunkY = uYPos >> uLevelPower;
+		const int32_t chunkZ = uZPos >> uLevelPower;
+
+		const bool bCanReuseLastLodData = m_pLastLodData && (chunkX == m_iLastLodChunkX) && (chunkY == m_iLastLodChunkY) && (chunkZ == m_iLastLodChunkZ) &&
+			((m_pLastLodChunk == nullptr) || (!m_pLastLodChunk->m_bLodOutOfDate));
+		if (!bCanReuseLastLodData)
+		{
+			m_pLastLodData = getLodData(chunkX, chunkY, chunkZ);
+			m_iLastLodChunkX = chunkX;
+			m_iLastLodChunkY = chunkY;
+			m_iLastLodChunkZ = chunkZ;
+		}
+
+		const int32_t iLevelMask = (1 << uLevelPower) - 1;
+		const uint32_t xOffset = static_cast<uint32_t>(uXPos & iLevelMask);
+		const uint32_t yOffset = static_cast<uint32_t>(uYPos & iLevelMask);
+		const uint32_t zOffset = static_cast<uint32_t>(uZPos & iLevelMask);
+		return m_pLastLodData[m_vecLodOffsets[uLevel] + xOffset + ((yOffset + (zOffset << uLevelPower)) << uLevelPower)];
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uLevel The level to read from, which must be no more than getNoOfLodLevels()
+	/// \param v3dPos The 3D position of the voxel within the level
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType PagedVolume<VoxelType>::getLodVoxel(uint32_t uLevel, const Vector3DInt32& v3dPos) const
+	{
+		return getLodVoxel(uLevel, v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// When enabled, each chunk is compared with the chunks already in memory after it has been paged in (using a hash of its contents),
+	/// and shares their data if it is identical. Shared data is copied when one of the chunks using it is modified, so this is not
+	/// visible to the user apart from the reduced memory usage (see calculateSizeInBytes()). Chunks which are already in memory are
+	/// deduplicated when it is enabled, and all chunks get their own copy of their data again when it is disabled.
+	///
+	/// Note that a Pager must not write to the data of a chunk outside of Pager::pageIn(), as it might be shared.
+	/// \param bEnabled Whether identical chunks should share their data
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::setChunkDeduplicationEnabled(bool bEnabled)
+	{
+		if (bEnabled && !m_pChunkDataStore)
+		{
+			m_pChunkDataStore.reset(new ChunkDataStore(m_uChunkSideLength * m_uChunkSideLength * m_uChunkSideLength));
+			for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
+			{
+				if (m_arrayChunks[uIndex])
+				{
+					m_pChunkDataStore->addChunk(m_arrayChunks[uIndex].get());
+				}
+			}
+		}
+		else if (!bEnabled && m_pChunkDataStore)
+		{
+			for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
+			{
+				if (m_arrayChunks[uIndex])
+				{
+					m_arrayChunks[uIndex]->makeDataWritable();
+				}
+			}
+			m_pChunkDataStore = nullptr;
+		}
+	}
+
+	template <typename VoxelType>
+	bool PagedVolume<VoxelType>::isChunkDeduplicationEnabled(void) const
+	{
+		return m_pChunkDataStore != nullptr;
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
 	/// Note that if the memory usage limit is not large enough to support the region this function will only load part of the region. In this case it is undefined which parts will actually be loaded. If all the voxels in the given region are already loaded, this function will not do anything. Other voxels might be unloaded to make space for the new voxels.
 	/// \param regPrefetch The Region of voxels to prefetch into memory.
@@ -213,6 +475,7 @@ namespace PolyVox
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// Removes all voxels from memory, and calls dataOverflowHandler() to ensure the application has a chance to store the data.
+	/// Chunks which existing samplers are positioned in are kept, as the samplers point into them.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	void PagedVolume<VoxelType>::flushAll()
@@ -223,8 +486,23 @@ namespace PolyVox
 		// Erase all the most recently used chunks.
 		for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
 		{
-			m_arrayChunks[uIndex] = nullptr;
+			if (m_arrayChunks[uIndex] && (m_arrayChunks[uIndex]->m_uPinCount == 0))
+			{
+				deleteChunk(uIndex);
+			}
 		}
+
+		// Any reduced resolution data has been given to the pager by now.
+		m_mapLodData.clear();
+		m_pLastLodData = nullptr;
+	}
+
+	template <typename VoxelType>
+	VoxelType* PagedVolume<VoxelType>::modifyChunkData(void* pChunk)
+	{
+		Chunk* pModifiedChunk = static_cast<Chunk*>(pChunk);
+		pModifiedChunk->markDataModified();
+		return pModifiedChunk->m_tData;
 	}
 
 	template <typename VoxelType>
@@ -237,10 +515,8 @@ namespace PolyVox
 	}
 
 	template <typename VoxelType>
-	typename PagedVolume<VoxelType>::Chunk* PagedVolume<VoxelType>::getChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const
+	uint32_t PagedVolume<VoxelType>::getChunkArrayHash(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ)
 	{
-		Chunk* pChunk = nullptr;
-
 		// We generate a 16-bit hash here and assume this matches the range available in the chunk
 		// array. The assert here is just to make sure we take care if change this in the future.
 		static_assert(uChunkArraySize == 65536, "Chunk array size has changed, check if the hash calculation needs updating.");
@@ -249,7 +525,15 @@ namespace PolyVox
 		const uint32_t uChunkYLowerBits = static_cast<uint32_t>(uChunkY & 0x1F);
 		const uint32_t uChunkZLowerBits = static_cast<uint32_t>(uChunkZ & 0x1F);
 		// Combine then to form a 15-bit hash of the position. Also shift by one to spread the values out in the whole 16-bit space.
-		const uint32_t iPosisionHash = (((uChunkXLowerBits)) | ((uChunkYLowerBits) << 5) | ((uChunkZLowerBits) << 10) << 1);
+		return (((uChunkXLowerBits)) | ((uChunkYLowerBits) << 5) | ((uChunkZLowerBits) << 10) << 1);
+	}
+
+	template <typename VoxelType>
+	typename PagedVolume<VoxelType>::Chunk* PagedVolume<VoxelType>::findChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const
+	{
+		Chunk* pChunk = nullptr;
+
+		const uint32_t iPosisionHash = getChunkArrayHash(uChunkX, uChunkY, uChunkZ);
 
 		// Starting at the position indicated by the hash, and then search through the whole array looking for a chunk with the correct
 		// position. In most cases we expect to find it in the first place we look. Note that this algorithm is slow in the case that
@@ -273,6 +557,14 @@ namespace PolyVox
 			iIndex %= uChunkArraySize;
 		} while (iIndex != iPosisionHash); // Keep searching until we get back to our start position.
 
+		return pChunk;
+	}
+
+	template <typename VoxelType>
+	typename PagedVolume<VoxelType>::Chunk* PagedVolume<VoxelType>::getChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const
+	{
+		Chunk* pChunk = findChunk(uChunkX, uChunkY, uChunkZ);
+
 		// If we still haven't found the chunk then it's time to create a new one and page it in from disk.
 		if (!pChunk)
 		{
@@ -281,9 +573,28 @@ namespace PolyVox
 			pChunk = new PagedVolume<VoxelType>::Chunk(v3dChunkPos, m_uChunkSideLength, m_pPager);
 			pChunk->m_uChunkLastAccessed = ++m_uTimestamper; // Important, as we may soon delete the oldest chunk
 
+			if (m_pChunkDataStore)
+			{
+				m_pChunkDataStore->addChunk(pChunk);
+			}
+
+			// Reduced resolution data which was kept while the chunk was out of memory now belongs to it again.
+			if (m_uNoOfLodLevels > 0)
+			{
+				auto iterLodData = m_mapLodData.find(v3dChunkPos);
+				if (iterLodData != m_mapLodData.end())
+				{
+					pChunk->m_pLodData = std::move(iterLodData->second.m_pData);
+					pChunk->m_bLodOutOfDate = false;
+					m_mapLodData.erase(iterLodData);
+					m_pLastLodData = nullptr;
+				}
+			}
+
 			// Store the chunk at the appropriate place in out chunk array. Ideally this place is
 			// given by the hash, otherwise we do a linear search for the next available location
 			// We always expect to find a free place because we aim to keep the array only half full.
+			const uint32_t iPosisionHash = getChunkArrayHash(uChunkX, uChunkY, uChunkZ);
 			uint32_t iIndex = iPosisionHash;
 			bool bInsertedSucessfully = false;
 			do
@@ -308,15 +619,16 @@ namespace PolyVox
 			// wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
 			// just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
 			// the data in is probably more expensive.
+			// Chunks which are pinned by samplers cannot be deleted, so if they are all pinned we will temporarily have too many.
 			uint32_t uChunkCount = 0;
-			uint32_t uOldestChunkIndex = 0;
+			uint32_t uOldestChunkIndex = uChunkArraySize;
 			uint32_t uOldestChunkTimestamp = std::numeric_limits<uint32_t>::max();
 			for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
 			{
 				if (m_arrayChunks[uIndex])
 				{
 					uChunkCount++;
-					if (m_arrayChunks[uIndex]->m_uChunkLastAccessed < uOldestChunkTimestamp)
+					if ((m_arrayChunks[uIndex]->m_uChunkLastAccessed < uOldestChunkTimestamp) && (m_arrayChunks[uIndex]->m_uPinCount == 0))
 					{
 						uOldestChunkTimestamp = m_arrayChunks[uIndex]->m_uChunkLastAccessed;
 						uOldestChunkIndex = uIndex;
@@ -325,9 +637,9 @@ namespace PolyVox
 			}
 
 			// Check if we have too many chunks, and delete the oldest if so.
-			if (uChunkCount > m_uChunkCountLimit)
+			if ((uChunkCount > m_uChunkCountLimit) && (uOldestChunkIndex < uChunkArraySize))
 			{
-				m_arrayChunks[uOldestChunkIndex] = nullptr;
+				deleteChunk(uOldestChunkIndex);
 			}
 		}
 
@@ -339,24 +651,360 @@ namespace PolyVox
 		return pChunk;
 	}
 
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::deleteChunk(uint32_t uIndex) const
+	{
+		Chunk* pChunk = m_arrayChunks[uIndex].get();
+		if (!pChunk)
+		{
+			return;
+		}
+
+		if (pChunk == m_pLastLodChunk)
+		{
+			m_pLastLodData = nullptr;
+			m_pLastLodChunk = nullptr;
+		}
+
+		if (m_uNoOfLodLevels > 0)
+		{
+			// The reduced resolution data should match the voxels which are about to be paged out.
+			if (pChunk->m_bDataModified && pChunk->m_bLodOutOfDate)
+			{
+				updateLodData(pChunk);
+			}
+
+			if (pChunk->m_pLodData && !pChunk->m_bLodOutOfDate)
+			{
+				if (pChunk->m_bLodModified)
+				{
+					m_pPager->pageOutLod(getChunkRegion(pChunk->m_v3dChunkSpacePosition), pChunk->m_pLodData.get(), m_vecLodOffsets.back() * sizeof(VoxelType));
+				}
+
+				LodData& lodData = m_mapLodData[pChunk->m_v3dChunkSpacePosition];
+				lodData.m_pData = std::move(pChunk->m_pLodData);
+				lodData.m_uLastAccessed = ++m_uTimestamper;
+				limitLodDataCount();
+			}
+		}
+
+		m_arrayChunks[uIndex] = nullptr;
+		m_uNoOfChunksDeleted++;
+	}
+
+	template <typename VoxelType>
+	template <typename Function>
+	void PagedVolume<VoxelType>::forEachBatchedVoxel(const Vector3DInt32* pPositions, uint32_t uNoOfPositions, RegionScheduler& scheduler, bool bWriting, Function function) const
+	{
+		// Number the chunks in the order they are first seen, using a small hash table. A counting sort on these numbers then groups
+		// the positions by chunk, which is much cheaper than a comparison sort and keeps repeated positions in their original order.
+		struct ChunkSlot
+		{
+			Vector3DInt32 m_v3dChunkPos;
+			uint32_t m_uChunkNumber;
+		};
+		std::vector<ChunkSlot> vecSlots;
+		std::vector<Vector3DInt32> vecChunkPositions;
+		std::vector<uint32_t> vecChunkNumbers(uNoOfPositions);
+
+		auto findSlot = [&](const Vector3DInt32& v3dChunkPos) -> ChunkSlot&
+		{
+			const uint32_t uSlotMask = static_cast<uint32_t>(vecSlots.size()) - 1;
+			uint32_t uSlot = (static_cast<uint32_t>(v3dChunkPos.getX()) * 73856093u ^ static_cast<uint32_t>(v3dChunkPos.getY()) * 19349663u ^
+				static_cast<uint32_t>(v3dChunkPos.getZ()) * 83492791u) & uSlotMask;
+			while ((vecSlots[uSlot].m_uChunkNumber != std::numeric_limits<uint32_t>::max()) && (vecSlots[uSlot].m_v3dChunkPos != v3dChunkPos))
+			{
+				uSlot = (uSlot + 1) & uSlotMask;
+			}
+			return vecSlots[uSlot];
+		};
+
+		for (uint32_t uPosition = 0; uPosition < uNoOfPositions; uPosition++)
+		{
+			const Vector3DInt32& v3dPos = pPositions[uPosition];
+			const Vector3DInt32 v3dChunkPos(v3dPos.getX() >> m_uChunkSideLengthPower, v3dPos.getY() >> m_uChunkSideLengthPower, v3dPos.getZ() >> m_uChunkSideLengthPower);
+
+			// The table is kept no more than half full, and is rebuilt at twice the size when it gets fuller.
+			if (vecSlots.size() < (vecChunkPositions.size() + 1) * 2)
+			{
+				ChunkSlot emptySlot;
+				emptySlot.m_uChunkNumber = std::numeric_limits<uint32_t>::max();
+				vecSlots.assign((std::max)(vecSlots.size() * 2, static_cast<size_t>(256)), emptySlot);
+				for (uint32_t uChunk = 0; uChunk < vecChunkPositions.size(); uChunk++)
+				{
+					ChunkSlot& slot = findSlot(vecChunkPositions[uChunk]);
+					slot.m_v3dChunkPos = vecChunkPositions[uChunk];
+					slot.m_uChunkNumber = uChunk;
+				}
+			}
+
+			ChunkSlot& slot = findSlot(v3dChunkPos);
+			if (slot.m_uChunkNumber == std::numeric_limits<uint32_t>::max())
+			{
+				slot.m_v3dChunkPos = v3dChunkPos;
+				slot.m_uChunkNumber = static_cast<uint32_t>(vecChunkPositions.size());
+				vecChunkPositions.push_back(v3dChunkPos);
+			}
+			vecChunkNumbers[uPosition] = slot.m_uChunkNumber;
+		}
+
+		// Each chunk's entries start where the previous chunk's end.
+		const uint32_t uNoOfChunks = static_cast<uint32_t>(vecChunkPositions.size());
+		std::vector<uint32_t> vecChunkStarts(uNoOfChunks + 1, 0);
+		for (uint32_t uChunkNumber : vecChunkNumbers)
+		{
+			vecChunkStarts[uChunkNumber + 1]++;
+		}
+		for (uint32_t uChunk = 0; uChunk < uNoOfChunks; uChunk++)
+		{
+			vecChunkStarts[uChunk + 1] += vecChunkStarts[uChunk];
+		}
+
+		std::vector<BatchEntry> vecEntries(uNoOfPositions);
+		std::vector<uint32_t> vecNextEntry(vecChunkStarts.begin(), vecChunkStarts.end() - 1);
+		for (uint32_t uPosition = 0; uPosition < uNoOfPositions; uPosition++)
+		{
+			const Vector3DInt32& v3dPos = pPositions[uPosition];
+			BatchEntry& entry = vecEntries[vecNextEntry[vecChunkNumbers[uPosition]]++];
+			entry.m_uIndexInChunk = MortonTables::x[v3dPos.getX() & m_iChunkMask] | MortonTables::y[v3dPos.getY() & m_iChunkMask] | MortonTables::z[v3dPos.getZ() & m_iChunkMask];
+			entry.m_uPosition = uPosition;
+		}
+
+		// The chunks are looked up here (which is not thread safe) and pinned so that looking up the later ones cannot delete them.
+		// Pinning too many would defeat the memory limit, so large batches are done in several rounds. The pin count is changed
+		// directly rather than through Chunk::pin(), as nothing which would need a shared chunk to keep its data happens meanwhile.
+		const uint32_t uMaxPinnedChunks = (std::max)(m_uChunkCountLimit / 2, 1u);
+		std::vector<Chunk*> vecChunks;
+		for (uint32_t uFirstChunk = 0; uFirstChunk < uNoOfChunks; uFirstChunk += uMaxPinnedChunks)
+		{
+			const uint32_t uNoOfChunksInRound = (std::min)(uNoOfChunks - uFirstChunk, uMaxPinnedChunks);
+			vecChunks.resize(uNoOfChunksInRound);
+			for (uint32_t uChunk = 0; uChunk < uNoOfChunksInRound; uChunk++)
+			{
+				const Vector3DInt32& v3dChunkPos = vecChunkPositions[uFirstChunk + uChunk];
+				Chunk* pChunk = getChunk(v3dChunkPos.getX(), v3dChunkPos.getY(), v3dChunkPos.getZ());
+				if (bWriting)
+				{
+					pChunk->markDataModified();
+				}
+				pChunk->m_uPinCount++;
+				vecChunks[uChunk] = pChunk;
+			}
+
+			scheduler.forEachTask(uNoOfChunksInRound, [&](uint32_t uChunk, uint32_t /*uWorker*/)
+			{
+				Chunk* pChunk = vecChunks[uChunk];
+				const uint32_t uEnd = vecChunkStarts[uFirstChunk + uChunk + 1];
+				for (uint32_t uEntry = vecChunkStarts[uFirstChunk + uChunk]; uEntry < uEnd; uEntry++)
+				{
+					function(pChunk, vecEntries[uEntry]);
+				}
+			});
+
+			for (Chunk* pChunk : vecChunks)
+			{
+				pChunk->m_uPinCount--;
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	const VoxelType* PagedVolume<VoxelType>::getLodData(int32_t iChunkX, int32_t iChunkY, int32_t iChunkZ) const
+	{
+		const Vector3DInt32 v3dChunkPos(iChunkX, iChunkY, iChunkZ);
+		m_pLastLodChunk = nullptr;
+
+		auto iterLodData = m_mapLodData.find(v3dChunkPos);
+		if (iterLodData != m_mapLodData.end())
+		{
+			iterLodData->second.m_uLastAccessed = ++m_uTimestamper;
+			return iterLodData->second.m_pData.get();
+		}
+
+		Chunk* pChunk = findChunk(iChunkX, iChunkY, iChunkZ);
+		if (!pChunk)
+		{
+			// Paging in the reduced resolution data is much cheaper than paging in the chunk to build it.
+			const uint32_t uLodSize = m_vecLodOffsets.back();
+			std::unique_ptr<VoxelType[]> pData(new VoxelType[uLodSize]);
+			if (m_pPager->pageInLod(getChunkRegion(v3dChunkPos), pData.get(), uLodSize * sizeof(VoxelType)))
+			{
+				LodData& lodData = m_mapLodData[v3dChunkPos];
+				lodData.m_pData = std::move(pData);
+				lodData.m_uLastAccessed = ++m_uTimestamper;
+				const VoxelType* pResult = lodData.m_pData.get();
+				limitLodDataCount(); // Removes older data, so pResult is still valid.
+				return pResult;
+			}
+
+			pChunk = getChunk(iChunkX, iChunkY, iChunkZ);
+		}
+
+		if (pChunk->m_bLodOutOfDate)
+		{
+			updateLodData(pChunk);
+		}
+
+		m_pLastLodChunk = pChunk;
+		return pChunk->m_pLodData.get();
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::updateLodData(Chunk* pChunk) const
+	{
+		const uint32_t uSideLength = m_uChunkSideLength;
+		if (!pChunk->m_pLodData)
+		{
+			pChunk->m_pLodData.reset(new VoxelType[m_vecLodOffsets.back()]);
+		}
+
+		// The chunk is stored in Morton order, but the reduction works on rows.
+		std::unique_ptr<VoxelType[]> pLinearData(new VoxelType[uSideLength * uSideLength * uSideLength]);
+		VoxelType* pLinearVoxel = pLinearData.get();
+		for (uint32_t z = 0; z < uSideLength; z++)
+		{
+			for (uint32_t y = 0; y < uSideLength; y++)
+			{
+				const uint32_t uRowIndex = MortonTables::y[y] | MortonTables::z[z];
+				for (uint32_t x = 0; x < uSideLength; x++)
+				{
+					*pLinearVoxel++ = pChunk->m_tData[uRowIndex | MortonTables::x[x]];
+				}
+			}
+		}
+
+		const VoxelType* pPreviousLevel = pLinearData.get();
+		uint32_t uPreviousSideLength = uSideLength;
+		for (uint32_t uLevel = 1; uLevel <= m_uNoOfLodLevels; uLevel++)
+		{
+			VoxelType* pLevel = pChunk->m_pLodData.get() + m_vecLodOffsets[uLevel];
+			const uint32_t uLevelSideLength = uPreviousSideLength / 2;
+			for (uint32_t z = 0; z < uLevelSideLength; z++)
+			{
+				for (uint32_t y = 0; y < uLevelSideLength; y++)
+				{
+					const VoxelType* ppRows[4] =
+					{
+						pPreviousLevel + ((z * 2) * uPreviousSideLength + y * 2) * uPreviousSideLength,
+						pPreviousLevel + ((z * 2) * uPreviousSideLength + y * 2 + 1) * uPreviousSideLength,
+						pPreviousLevel + ((z * 2 + 1) * uPreviousSideLength + y * 2) * uPreviousSideLength,
+						pPreviousLevel + ((z * 2 + 1) * uPreviousSideLength + y * 2 + 1) * uPreviousSideLength
+					};
+					reduceMipmapRows(ppRows, pLevel + (z * uLevelSideLength + y) * uLevelSideLength, uLevelSideLength, m_eLodMode);
+				}
+			}
+			pPreviousLevel = pLevel;
+			uPreviousSideLength = uLevelSideLength;
+		}
+
+		pChunk->m_bLodOutOfDate = false;
+		pChunk->m_bLodModified = true;
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::limitLodDataCount(void) const
+	{
+		while (m_mapLodData.size() > m_uLodDataCountLimit)
+		{
+			// Everything in the map has already been given to the pager, so the oldest can simply be discarded.
+			auto iterOldest = m_mapLodData.begin();
+			for (auto iter = m_mapLodData.begin(); iter != m_mapLodData.end(); iter++)
+			{
+				if (iter->second.m_uLastAccessed < iterOldest->second.m_uLastAccessed)
+				{
+					iterOldest = iter;
+				}
+			}
+
+			if (iterOldest->second.m_pData.get() == m_pLastLodData)
+			{
+				m_pLastLodData = nullptr;
+			}
+			m_mapLodData.erase(iterOldest);
+		}
+	}
+
+	template <typename VoxelType>
+	Region PagedVolume<VoxelType>::getChunkRegion(const Vector3DInt32& v3dChunkPos) const
+	{
+		const Vector3DInt32 v3dLower = v3dChunkPos * static_cast<int32_t>(m_uChunkSideLength);
+		return Region(v3dLower, v3dLower + Vector3DInt32(m_uChunkSideLength - 1, m_uChunkSideLength - 1, m_uChunkSideLength - 1));
+	}
+
 	////////////////////////////////////////////////////////////////////////////////
-	/// Calculate the memory usage of the volume.
+	/// Calculate the memory usage of the volume. Data which is shared by identical chunks (see setChunkDeduplicationEnabled()) is only counted once.
 	////////////////////////////////////////////////////////////////////////////////
 	template <typename VoxelType>
 	uint32_t PagedVolume<VoxelType>::calculateSizeInBytes(void)
 	{
-		uint32_t uChunkCount = 0;
+		uint32_t uChunkDataCount = 0;
 		for (uint32_t uIndex = 0; uIndex < uChunkArraySize; uIndex++)
 		{
-			if (m_arrayChunks[uIndex])
+			if (m_arrayChunks[uIndex] && !m_arrayChunks[uIndex]->m_pSharedData)
 			{
-				uChunkCount++;
+				uChunkDataCount++;
 			}
 		}
 
+		if (m_pChunkDataStore)
+		{
+			uChunkDataCount += m_pChunkDataStore->getNoOfSharedData();
+		}
+
 		// Note: We disregard the size of the other class members as they are likely to be very small compared to the size of the
 		// allocated voxel data. This also keeps the reported size as a power of two, which makes other memory calculations easier.
-		return PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(m_uChunkSideLength) * uChunkCount;
+		return static_cast<uint32_t>(PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(m_uChunkSideLength) * uChunkDataCount);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param pPager Called by PolyVox to load and unload data on demand.
+	/// \param uTargetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	PagedVolume<VoxelType, ChunkSideLength>::PagedVolume(typename PagedVolume<VoxelType>::Pager* pPager, uint32_t uTargetMemoryUsageInBytes)
+		:PagedVolume<VoxelType>(pPager, uTargetMemoryUsageInBytes, ChunkSideLength)
+	{
+	}
+
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	VoxelType PagedVolume<VoxelType, ChunkSideLength>::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		return getChunkContaining(uXPos, uYPos, uZPos)->m_tData[getIndexInChunk(uXPos, uYPos, uZPos)];
+	}
+
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	VoxelType PagedVolume<VoxelType, ChunkSideLength>::getVoxel(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
 	}
-}
 
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	void PagedVolume<VoxelType, ChunkSideLength>::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		auto pChunk = getChunkContaining(uXPos, uYPos, uZPos);
+		pChunk->markDataModified();
+		pChunk->m_tData[getIndexInChunk(uXPos, uYPos, uZPos)] = tValue;
+	}
+
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	void PagedVolume<VoxelType, ChunkSideLength>::setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	typename PagedVolume<VoxelType>::Chunk* PagedVolume<VoxelType, ChunkSideLength>::getChunkContaining(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		const int32_t chunkX = uXPos >> uChunkSideLengthPower;
+		const int32_t chunkY = uYPos >> uChunkSideLengthPower;
+		const int32_t chunkZ = uZPos >> uChunkSideLengthPower;
+
+		return this->canReuseLastAccessedChunk(chunkX, chunkY, chunkZ) ? this->m_pLastAccessedChunk : this->getChunk(chunkX, chunkY, chunkZ);
+	}
+
+	template <typename VoxelType, uint16_t ChunkSideLength>
+	uint32_t PagedVolume<VoxelType, ChunkSideLength>::getIndexInChunk(int32_t uXPos, int32_t uYPos, int32_t uZPos)
+	{
+		return MortonTables::x[uXPos & iChunkMask] | MortonTables::y[uYPos & iChunkMask] | MortonTables::z[uZPos & iChunkMask];
+	}
+}
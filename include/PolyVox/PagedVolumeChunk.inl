@@ -30,15 +30,20 @@ namespace PolyVox
 	template <typename VoxelType>
 	PagedVolume<VoxelType>::Chunk::Chunk(Vector3DInt32 v3dPosition, uint16_t uSideLength, Pager* pPager)
 		:m_uChunkLastAccessed(0)
+		, m_uPinCount(0)
 		, m_bDataModified(true)
+		, m_bLodOutOfDate(true)
+		, m_bLodModified(false)
 		, m_tData(0)
 		, m_uSideLength(0)
 		, m_uSideLengthPower(0)
 		, m_pPager(pPager)
+		, m_pSharedData(nullptr)
+		, m_uSharedDataIndex(0)
 		, m_v3dChunkSpacePosition(v3dPosition)
 	{
 		POLYVOX_ASSERT(m_pPager, "No valid pager supplied to chunk constructor.");
-		POLYVOX_ASSERT(uSideLength <= 256, "Chunk side length cannot be greater than 256.");
+		POLYVOX_ASSERT(uSideLength <= uMaxMortonSideLength, "Chunk side length is too large for the Morton tables.");
 
 		// Compute the side length               
 		m_uSideLength = uSideLength;
@@ -78,7 +83,14 @@ namespace PolyVox
 			m_pPager->pageOut(Region(v3dLower, v3dUpper), this);
 		}
 
-		delete[] m_tData;
+		if (m_pSharedData)
+		{
+			m_pSharedData->m_pStore->removeChunk(this);
+		}
+		else
+		{
+			delete[] m_tData;
+		}
 		m_tData = 0;
 	}
 
@@ -104,7 +116,7 @@ namespace PolyVox
 		POLYVOX_ASSERT(uZPos < m_uSideLength, "Supplied position is outside of the chunk");
 		POLYVOX_ASSERT(m_tData, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
-		uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
+		uint32_t index = MortonTables::x[uXPos] | MortonTables::y[uYPos] | MortonTables::z[uZPos];
 
 		return m_tData[index];
 	}
@@ -125,11 +137,10 @@ namespace PolyVox
 		POLYVOX_ASSERT(uZPos < m_uSideLength, "Supplied position is outside of the chunk");
 		POLYVOX_ASSERT(m_tData, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
-		uint32_t index = morton256_x[uXPos] | morton256_y[uYPos] | morton256_z[uZPos];
+		uint32_t index = MortonTables::x[uXPos] | MortonTables::y[uYPos] | MortonTables::z[uZPos];
 
+		markDataModified();
 		m_tData[index] = tValue;
-
-		this->m_bDataModified = true;
 	}
 
 	template <typename VoxelType>
@@ -139,18 +150,57 @@ namespace PolyVox
 	}
 
 	template <typename VoxelType>
-	uint32_t PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(void)
+	void PagedVolume<VoxelType>::Chunk::makeDataWritable(void)
+	{
+		if (m_pSharedData)
+		{
+			m_pSharedData->m_pStore->makeChunkDataPrivate(this);
+		}
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::Chunk::markDataModified(void)
+	{
+		makeDataWritable();
+		m_bDataModified = true;
+		m_bLodOutOfDate = true;
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::Chunk::pin(void)
+	{
+		if ((m_uPinCount == 0) && m_pSharedData)
+		{
+			m_pSharedData->m_pStore->pinChunk(this);
+		}
+		m_uPinCount++;
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::Chunk::unpin(void)
+	{
+		POLYVOX_ASSERT(m_uPinCount > 0, "Chunk is not pinned");
+		m_uPinCount--;
+		if ((m_uPinCount == 0) && m_pSharedData)
+		{
+			m_pSharedData->m_pStore->unpinChunk(this);
+		}
+	}
+
+	template <typename VoxelType>
+	uint64_t PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(void)
 	{
 		// Call through to the static version
 		return calculateSizeInBytes(m_uSideLength);
 	}
 
 	template <typename VoxelType>
-	uint32_t PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(uint32_t uSideLength)
+	uint64_t PagedVolume<VoxelType>::Chunk::calculateSizeInBytes(uint32_t uSideLength)
 	{
 		// Note: We disregard the size of the other class members as they are likely to be very small compared to the size of the
 		// allocated voxel data. This also keeps the reported size as a power of two, which makes other memory calculations easier.
-		uint32_t uSizeInBytes = uSideLength * uSideLength * uSideLength * sizeof(VoxelType);
+		// The largest chunks of the larger voxel types don't fit in 32 bits.
+		uint64_t uSizeInBytes = static_cast<uint64_t>(uSideLength) * uSideLength * uSideLength * sizeof(VoxelType);
 		return  uSizeInBytes;
 	}
 
@@ -161,6 +211,7 @@ namespace PolyVox
 	template <typename VoxelType>
 	void PagedVolume<VoxelType>::Chunk::changeLinearOrderingToMorton(void)
 	{
+		makeDataWritable();
 		VoxelType* pTempBuffer = new VoxelType[m_uSideLength * m_uSideLength * m_uSideLength];
 
 		// We should prehaps restructure this loop. From: https://fgiesen.wordpress.com/2011/01/17/texture-tiling-and-swizzling/
@@ -180,7 +231,7 @@ namespace PolyVox
 				for (uint16_t x = 0; x < m_uSideLength; x++)
 				{
 					uint32_t uLinearIndex = x + y * m_uSideLength + z * m_uSideLength * m_uSideLength;
-					uint32_t uMortonIndex = morton256_x[x] | morton256_y[y] | morton256_z[z];
+					uint32_t uMortonIndex = MortonTables::x[x] | MortonTables::y[y] | MortonTables::z[z];
 					pTempBuffer[uMortonIndex] = m_tData[uLinearIndex];
 				}
 			}
@@ -196,6 +247,7 @@ namespace PolyVox
 	template <typename VoxelType>
 	void PagedVolume<VoxelType>::Chunk::changeMortonOrderingToLinear(void)
 	{
+		makeDataWritable();
 		VoxelType* pTempBuffer = new VoxelType[m_uSideLength * m_uSideLength * m_uSideLength];
 		for (uint16_t z = 0; z < m_uSideLength; z++)
 		{
@@ -204,7 +256,7 @@ namespace PolyVox
 				for (uint16_t x = 0; x < m_uSideLength; x++)
 				{
 					uint32_t uLinearIndex = x + y * m_uSideLength + z * m_uSideLength * m_uSideLength;
-					uint32_t uMortonIndex = morton256_x[x] | morton256_y[y] | morton256_z[z];
+					uint32_t uMortonIndex = MortonTables::x[x] | MortonTables::y[y] | MortonTables::z[z];
 					pTempBuffer[uLinearIndex] = m_tData[uMortonIndex];
 				}
 			}
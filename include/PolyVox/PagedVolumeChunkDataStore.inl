@@ -0,0 +1,195 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include <cstring>
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	PagedVolume<VoxelType>::ChunkDataStore::ChunkDataStore(uint32_t uNoOfVoxels)
+		:m_uNoOfVoxels(uNoOfVoxels)
+	{
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::addChunk(Chunk* pChunk)
+	{
+		POLYVOX_ASSERT(!pChunk->m_pSharedData, "Chunk is already in the store");
+
+		const uint32_t uSizeInBytes = m_uNoOfVoxels * sizeof(VoxelType);
+		const uint64_t uHash = hashBytes(pChunk->m_tData, uSizeInBytes);
+
+		auto& vecSharedData = m_mapSharedData[uHash];
+		for (auto& pSharedData : vecSharedData)
+		{
+			if (std::memcmp(pSharedData->m_pData.get(), pChunk->m_tData, uSizeInBytes) == 0)
+			{
+				// Samplers point into the data of a pinned chunk, so it cannot switch to the shared copy.
+				if (pChunk->m_uPinCount > 0)
+				{
+					return;
+				}
+
+				delete[] pChunk->m_tData;
+				pChunk->m_tData = pSharedData->m_pData.get();
+				attachChunk(pChunk, pSharedData.get());
+				return;
+			}
+		}
+
+		// There is nothing identical, so the data of this chunk becomes shared in case something identical is added later.
+		std::unique_ptr<SharedChunkData> pSharedData(new SharedChunkData);
+		pSharedData->m_pData.reset(pChunk->m_tData);
+		pSharedData->m_uHash = uHash;
+		pSharedData->m_uNoOfPinnedChunks = 0;
+		pSharedData->m_pStore = this;
+		attachChunk(pChunk, pSharedData.get());
+		vecSharedData.push_back(std::move(pSharedData));
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::removeChunk(Chunk* pChunk)
+	{
+		POLYVOX_ASSERT(pChunk->m_pSharedData, "Chunk is not in the store");
+
+		pChunk->m_tData = nullptr;
+		detachChunk(pChunk);
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::makeChunkDataPrivate(Chunk* pChunk)
+	{
+		SharedChunkData* pSharedData = pChunk->m_pSharedData;
+		POLYVOX_ASSERT(pSharedData, "Chunk is not in the store");
+
+		if (pSharedData->m_vecChunks.size() == 1)
+		{
+			// Nothing else is using the data, so the chunk can simply take it over.
+			pSharedData->m_pData.release();
+		}
+		else if (pChunk->m_uPinCount > 0)
+		{
+			// Samplers point into the data, so the chunk keeps it and the other chunks move to a copy (none of them are pinned).
+			VoxelType* pCopy = new VoxelType[m_uNoOfVoxels];
+			std::memcpy(pCopy, pChunk->m_tData, m_uNoOfVoxels * sizeof(VoxelType));
+			pSharedData->m_pData.release();
+			pSharedData->m_pData.reset(pCopy);
+			for (Chunk* pOtherChunk : pSharedData->m_vecChunks)
+			{
+				if (pOtherChunk != pChunk)
+				{
+					pOtherChunk->m_tData = pCopy;
+				}
+			}
+		}
+		else
+		{
+			pChunk->m_tData = new VoxelType[m_uNoOfVoxels];
+			std::memcpy(pChunk->m_tData, pSharedData->m_pData.get(), m_uNoOfVoxels * sizeof(VoxelType));
+		}
+
+		detachChunk(pChunk);
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::pinChunk(Chunk* pChunk)
+	{
+		POLYVOX_ASSERT(pChunk->m_uPinCount == 0, "Chunk should only be added to the pinned chunks once");
+
+		if (pChunk->m_pSharedData->m_uNoOfPinnedChunks > 0)
+		{
+			makeChunkDataPrivate(pChunk);
+		}
+		else
+		{
+			pChunk->m_pSharedData->m_uNoOfPinnedChunks++;
+		}
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::unpinChunk(Chunk* pChunk)
+	{
+		POLYVOX_ASSERT(pChunk->m_pSharedData->m_uNoOfPinnedChunks > 0, "Chunk is not pinned");
+		pChunk->m_pSharedData->m_uNoOfPinnedChunks--;
+	}
+
+	template <typename VoxelType>
+	uint32_t PagedVolume<VoxelType>::ChunkDataStore::getNoOfSharedData(void) const
+	{
+		uint32_t uNoOfSharedData = 0;
+		for (const auto& entry : m_mapSharedData)
+		{
+			uNoOfSharedData += static_cast<uint32_t>(entry.second.size());
+		}
+		return uNoOfSharedData;
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::attachChunk(Chunk* pChunk, SharedChunkData* pSharedData)
+	{
+		pChunk->m_pSharedData = pSharedData;
+		pChunk->m_uSharedDataIndex = static_cast<uint32_t>(pSharedData->m_vecChunks.size());
+		pSharedData->m_vecChunks.push_back(pChunk);
+		if (pChunk->m_uPinCount > 0)
+		{
+			pSharedData->m_uNoOfPinnedChunks++;
+		}
+	}
+
+	template <typename VoxelType>
+	void PagedVolume<VoxelType>::ChunkDataStore::detachChunk(Chunk* pChunk)
+	{
+		SharedChunkData* pSharedData = pChunk->m_pSharedData;
+		pChunk->m_pSharedData = nullptr;
+		if (pChunk->m_uPinCount > 0)
+		{
+			pSharedData->m_uNoOfPinnedChunks--;
+		}
+
+		// Move the last chunk into the place of this one, so the list does not have to be searched.
+		std::vector<Chunk*>& vecChunks = pSharedData->m_vecChunks;
+		vecChunks[pChunk->m_uSharedDataIndex] = vecChunks.back();
+		vecChunks[pChunk->m_uSharedDataIndex]->m_uSharedDataIndex = pChunk->m_uSharedDataIndex;
+		vecChunks.pop_back();
+
+		if (vecChunks.empty())
+		{
+			auto iterSharedData = m_mapSharedData.find(pSharedData->m_uHash);
+			POLYVOX_ASSERT(iterSharedData != m_mapSharedData.end(), "Shared data is missing from the store");
+			auto& vecSharedData = iterSharedData->second;
+			for (auto iter = vecSharedData.begin(); iter != vecSharedData.end(); iter++)
+			{
+				if (iter->get() == pSharedData)
+				{
+					vecSharedData.erase(iter);
+					break;
+				}
+			}
+			if (vecSharedData.empty())
+			{
+				m_mapSharedData.erase(iterSharedData);
+			}
+		}
+	}
+}
@@ -22,86 +22,148 @@
 * SOFTWARE.
 *******************************************************************************/
 
-#include <array>
+#include "Impl/Morton.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
 
 #define CAN_GO_NEG_X(val) (val > 0)
-#define CAN_GO_POS_X(val)  (val < this->m_uChunkSideLengthMinusOne)
+#define CAN_GO_POS_X(val)  (val < this->getChunkSideLengthMinusOne())
 #define CAN_GO_NEG_Y(val) (val > 0)
-#define CAN_GO_POS_Y(val)  (val < this->m_uChunkSideLengthMinusOne)
+#define CAN_GO_POS_Y(val)  (val < this->getChunkSideLengthMinusOne())
 #define CAN_GO_NEG_Z(val) (val > 0)
-#define CAN_GO_POS_Z(val)  (val < this->m_uChunkSideLengthMinusOne)
+#define CAN_GO_POS_Z(val)  (val < this->getChunkSideLengthMinusOne())
 
-#define NEG_X_DELTA (-(deltaX[this->m_uXPosInChunk-1]))
-#define POS_X_DELTA (deltaX[this->m_uXPosInChunk])
-#define NEG_Y_DELTA (-(deltaY[this->m_uYPosInChunk-1]))
-#define POS_Y_DELTA (deltaY[this->m_uYPosInChunk])
-#define NEG_Z_DELTA (-(deltaZ[this->m_uZPosInChunk-1]))
-#define POS_Z_DELTA (deltaZ[this->m_uZPosInChunk])
+#define NEG_X_DELTA (-(MortonTables::deltaX[this->m_uXPosInChunk-1]))
+#define POS_X_DELTA (MortonTables::deltaX[this->m_uXPosInChunk])
+#define NEG_Y_DELTA (-(MortonTables::deltaY[this->m_uYPosInChunk-1]))
+#define POS_Y_DELTA (MortonTables::deltaY[this->m_uYPosInChunk])
+#define NEG_Z_DELTA (-(MortonTables::deltaZ[this->m_uZPosInChunk-1]))
+#define POS_Z_DELTA (MortonTables::deltaZ[this->m_uZPosInChunk])
 
 namespace PolyVox
 {
-	// These precomputed offset are used to determine how much we move our pointer by to move a single voxel in the x, y, or z direction given an x, y, or z starting position inside a chunk.
-	// More information in this discussion: https://bitbucket.org/volumesoffun/polyvox/issue/61/experiment-with-morton-ordering-of-voxel
-	static const std::array<int32_t, 256> deltaX = { 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 28087, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 224695, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 28087, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 1797559, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 28087, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 224695, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 28087, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1, 3511, 1, 7, 1, 55, 1, 7, 1, 439, 1, 7, 1, 55, 1, 7, 1 };
-	static const std::array<int32_t, 256> deltaY = { 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 56174, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 449390, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 56174, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 3595118, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 56174, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 449390, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 56174, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2, 7022, 2, 14, 2, 110, 2, 14, 2, 878, 2, 14, 2, 110, 2, 14, 2 };
-	static const std::array<int32_t, 256> deltaZ = { 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 112348, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 898780, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 112348, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 7190236, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 112348, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 898780, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 112348, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4, 14044, 4, 28, 4, 220, 4, 28, 4, 1756, 4, 28, 4, 220, 4, 28, 4 };
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::SamplerImpl(PagedVolume<VoxelType>* volume)
+		:BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >(volume)
+		, mCurrentVoxel(nullptr)
+		, m_pCurrentChunk(nullptr)
+		, m_uChunkSideLengthMinusOne(volume->m_uChunkSideLength - 1)
+		, m_uNoOfChunksDeleted(volume->m_uNoOfChunksDeleted)
+		, m_iXChunk(0)
+		, m_iYChunk(0)
+		, m_iZChunk(0)
+	{
+		std::fill(std::begin(m_arrayNeighbourChunks), std::end(m_arrayNeighbourChunks), nullptr);
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::SamplerImpl(const SamplerImpl& rhs)
+		:BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >(rhs)
+		, mCurrentVoxel(rhs.mCurrentVoxel)
+		, m_pCurrentChunk(rhs.m_pCurrentChunk)
+		, m_uXPosInChunk(rhs.m_uXPosInChunk)
+		, m_uYPosInChunk(rhs.m_uYPosInChunk)
+		, m_uZPosInChunk(rhs.m_uZPosInChunk)
+		, m_uChunkSideLengthMinusOne(rhs.m_uChunkSideLengthMinusOne)
+		, m_uNoOfChunksDeleted(rhs.m_uNoOfChunksDeleted)
+		, m_iXChunk(rhs.m_iXChunk)
+		, m_iYChunk(rhs.m_iYChunk)
+		, m_iZChunk(rhs.m_iZChunk)
+	{
+		std::copy(std::begin(rhs.m_arrayNeighbourChunks), std::end(rhs.m_arrayNeighbourChunks), std::begin(m_arrayNeighbourChunks));
+
+		// Both samplers now point into the current chunk.
+		if (m_pCurrentChunk)
+		{
+			m_pCurrentChunk->pin();
+		}
+	}
 
 	template <typename VoxelType>
-	PagedVolume<VoxelType>::Sampler::Sampler(PagedVolume<VoxelType>* volume)
-		:BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >(volume), m_uChunkSideLengthMinusOne(volume->m_uChunkSideLength - 1)
+	template <uint16_t SamplerChunkSideLength>
+	PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::~SamplerImpl()
 	{
+		setCurrentChunk(nullptr);
 	}
 
 	template <typename VoxelType>
-	PagedVolume<VoxelType>::Sampler::~Sampler()
+	template <uint16_t SamplerChunkSideLength>
+	typename PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>& PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::operator=(const SamplerImpl& rhs)
 	{
+		if (this != &rhs)
+		{
+			BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::operator=(rhs);
+			setCurrentChunk(rhs.m_pCurrentChunk);
+			mCurrentVoxel = rhs.mCurrentVoxel;
+			m_uXPosInChunk = rhs.m_uXPosInChunk;
+			m_uYPosInChunk = rhs.m_uYPosInChunk;
+			m_uZPosInChunk = rhs.m_uZPosInChunk;
+			m_uChunkSideLengthMinusOne = rhs.m_uChunkSideLengthMinusOne;
+			std::copy(std::begin(rhs.m_arrayNeighbourChunks), std::end(rhs.m_arrayNeighbourChunks), std::begin(m_arrayNeighbourChunks));
+			m_uNoOfChunksDeleted = rhs.m_uNoOfChunksDeleted;
+			m_iXChunk = rhs.m_iXChunk;
+			m_iYChunk = rhs.m_iYChunk;
+			m_iZChunk = rhs.m_iZChunk;
+		}
+		return *this;
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::getVoxel(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::getVoxel(void) const
 	{
 		return *mCurrentVoxel;
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::setPosition(const Vector3DInt32& v3dNewPos)
 	{
 		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::setPosition(xPos, yPos, zPos);
 
 		// Then we update the voxel pointer
-		const int32_t uXChunk = this->mXPosInVolume >> this->mVolume->m_uChunkSideLengthPower;
-		const int32_t uYChunk = this->mYPosInVolume >> this->mVolume->m_uChunkSideLengthPower;
-		const int32_t uZChunk = this->mZPosInVolume >> this->mVolume->m_uChunkSideLengthPower;
+		const int32_t uXChunk = this->mXPosInVolume >> getChunkSideLengthPower();
+		const int32_t uYChunk = this->mYPosInVolume >> getChunkSideLengthPower();
+		const int32_t uZChunk = this->mZPosInVolume >> getChunkSideLengthPower();
 
-		m_uXPosInChunk = static_cast<uint16_t>(this->mXPosInVolume - (uXChunk << this->mVolume->m_uChunkSideLengthPower));
-		m_uYPosInChunk = static_cast<uint16_t>(this->mYPosInVolume - (uYChunk << this->mVolume->m_uChunkSideLengthPower));
-		m_uZPosInChunk = static_cast<uint16_t>(this->mZPosInVolume - (uZChunk << this->mVolume->m_uChunkSideLengthPower));
+		m_uXPosInChunk = static_cast<uint16_t>(this->mXPosInVolume & getChunkSideLengthMinusOne());
+		m_uYPosInChunk = static_cast<uint16_t>(this->mYPosInVolume & getChunkSideLengthMinusOne());
+		m_uZPosInChunk = static_cast<uint16_t>(this->mZPosInVolume & getChunkSideLengthMinusOne());
 
-		uint32_t uVoxelIndexInChunk = morton256_x[m_uXPosInChunk] | morton256_y[m_uYPosInChunk] | morton256_z[m_uZPosInChunk];
+		uint32_t uVoxelIndexInChunk = MortonTables::x[m_uXPosInChunk] | MortonTables::y[m_uYPosInChunk] | MortonTables::z[m_uZPosInChunk];
 
-		auto pCurrentChunk = this->mVolume->canReuseLastAccessedChunk(uXChunk, uYChunk, uZChunk) ?
-			this->mVolume->m_pLastAccessedChunk : this->mVolume->getChunk(uXChunk, uYChunk, uZChunk);
+		moveToChunk(uXChunk, uYChunk, uZChunk);
+		setCurrentChunk(getNeighbourChunk(0, 0, 0));
 
-		mCurrentVoxel = pCurrentChunk->m_tData + uVoxelIndexInChunk;
+		mCurrentVoxel = m_pCurrentChunk->m_tData + uVoxelIndexInChunk;
 	}
 
 	template <typename VoxelType>
-	bool PagedVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
+	template <uint16_t SamplerChunkSideLength>
+	bool PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::setVoxel(VoxelType tValue)
 	{
-		//Need to think what effect this has on any existing iterators.
-		POLYVOX_THROW(not_implemented, "This function cannot be used on PagedVolume samplers.");
-		return false;
+		// The current chunk is pinned, so mCurrentVoxel is still valid even if other chunks have been paged out since we moved here.
+		// A pinned chunk also keeps its data if it has to stop sharing it with identical chunks (see ChunkDataStore).
+		m_pCurrentChunk->markDataModified();
+		*mCurrentVoxel = tValue;
+		return true;
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::movePositiveX(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::movePositiveX(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::movePositiveX();
@@ -115,13 +177,14 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::movePositiveY(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::movePositiveY(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::movePositiveY();
@@ -135,13 +198,14 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::movePositiveZ(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::movePositiveZ(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::movePositiveZ();
@@ -155,13 +219,14 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::moveNegativeX(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::moveNegativeX(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::moveNegativeX();
@@ -175,13 +240,14 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::moveNegativeY(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::moveNegativeY(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::moveNegativeY();
@@ -195,13 +261,14 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	void PagedVolume<VoxelType>::Sampler::moveNegativeZ(void)
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::moveNegativeZ(void)
 	{
 		// Base version updates position and validity flags.
 		BaseVolume<VoxelType>::template Sampler< PagedVolume<VoxelType> >::moveNegativeZ();
@@ -215,279 +282,454 @@ namespace PolyVox
 		}
 		else
 		{
-			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this.
+			//We've hit the chunk boundary. Just calling setPosition() is the easiest way to resolve this, and the new chunk is normally already cached.
 			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 		}
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1ny1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1ny1nz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(-1, -1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1ny0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1ny0pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + NEG_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(-1, -1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1ny1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1ny1pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(-1, -1, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx0py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx0py1nz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(-1, 0, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx0py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx0py0pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(-1, 0, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx0py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx0py1pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(-1, 0, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1py1nz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(-1, 1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1py0pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + POS_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(-1, 1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1nx1py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1nx1py1pz(void) const
 	{
 		if (CAN_GO_NEG_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(-1, 1, 1);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1ny1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1ny1nz(void) const
 	{
 		if (CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(0, -1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1ny0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1ny0pz(void) const
 	{
 		if (CAN_GO_NEG_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(0, -1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1ny1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1ny1pz(void) const
 	{
 		if (CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(0, -1, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px0py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px0py1nz(void) const
 	{
 		if (CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(0, 0, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px0py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px0py0pz(void) const
 	{
 		return *mCurrentVoxel;
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px0py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px0py1pz(void) const
 	{
 		if (CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(0, 0, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1py1nz(void) const
 	{
 		if (CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(0, 1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1py0pz(void) const
 	{
 		if (CAN_GO_POS_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(0, 1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel0px1py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel0px1py1pz(void) const
 	{
 		if (CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(0, 1, 1);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1ny1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1ny1nz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + NEG_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(1, -1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1ny0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1ny0pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + NEG_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(1, -1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1ny1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1ny1pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_NEG_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + NEG_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(1, -1, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px0py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px0py1nz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(1, 0, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px0py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px0py0pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(1, 0, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px0py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px0py1pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(1, 0, 1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1py1nz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1py1nz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_NEG_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + POS_Y_DELTA + NEG_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
+		return peekAcrossChunkBoundary(1, 1, -1);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1py0pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1py0pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + POS_Y_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume);
+		return peekAcrossChunkBoundary(1, 1, 0);
 	}
 
 	template <typename VoxelType>
-	VoxelType PagedVolume<VoxelType>::Sampler::peekVoxel1px1py1pz(void) const
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekVoxel1px1py1pz(void) const
 	{
 		if (CAN_GO_POS_X(this->m_uXPosInChunk) && CAN_GO_POS_Y(this->m_uYPosInChunk) && CAN_GO_POS_Z(this->m_uZPosInChunk))
 		{
 			return *(mCurrentVoxel + POS_X_DELTA + POS_Y_DELTA + POS_Z_DELTA);
 		}
-		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
+		return peekAcrossChunkBoundary(1, 1, 1);
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	uint16_t PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::getChunkSideLengthMinusOne(void) const
+	{
+		// This is a constant if the chunk size was given as a template parameter.
+		return (SamplerChunkSideLength != 0) ? static_cast<uint16_t>(SamplerChunkSideLength - 1) : m_uChunkSideLengthMinusOne;
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	uint8_t PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::getChunkSideLengthPower(void) const
+	{
+		return (SamplerChunkSideLength != 0) ? logBase2Static(SamplerChunkSideLength) : this->mVolume->m_uChunkSideLengthPower;
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	uint32_t PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::getNeighbourIndex(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ)
+	{
+		return static_cast<uint32_t>((iOffsetX + 1) + (iOffsetY + 1) * 3 + (iOffsetZ + 1) * 9);
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	typename PagedVolume<VoxelType>::Chunk* PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::getNeighbourChunk(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ) const
+	{
+		// Any of the cached chunks might have been deleted since they were looked up.
+		if (m_uNoOfChunksDeleted != this->mVolume->m_uNoOfChunksDeleted)
+		{
+			discardNeighbourChunks();
+		}
+
+		const uint32_t uIndex = getNeighbourIndex(iOffsetX, iOffsetY, iOffsetZ);
+		Chunk* pChunk = m_arrayNeighbourChunks[uIndex];
+		if (!pChunk)
+		{
+			const int32_t iChunkX = m_iXChunk + iOffsetX;
+			const int32_t iChunkY = m_iYChunk + iOffsetY;
+			const int32_t iChunkZ = m_iZChunk + iOffsetZ;
+			pChunk = this->mVolume->canReuseLastAccessedChunk(iChunkX, iChunkY, iChunkZ) ?
+				this->mVolume->m_pLastAccessedChunk : this->mVolume->getChunk(iChunkX, iChunkY, iChunkZ);
+
+			// Paging the chunk in may have deleted another one. That is never the chunk we just got, as it is the most recently used.
+			if (m_uNoOfChunksDeleted != this->mVolume->m_uNoOfChunksDeleted)
+			{
+				discardNeighbourChunks();
+			}
+
+			m_arrayNeighbourChunks[uIndex] = pChunk;
+		}
+
+		return pChunk;
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::discardNeighbourChunks(void) const
+	{
+		std::fill(std::begin(m_arrayNeighbourChunks), std::end(m_arrayNeighbourChunks), nullptr);
+		m_uNoOfChunksDeleted = this->mVolume->m_uNoOfChunksDeleted;
+
+		// The current chunk is pinned, so it cannot have been deleted.
+		if (m_pCurrentChunk && (m_pCurrentChunk->m_v3dChunkSpacePosition == Vector3DInt32(m_iXChunk, m_iYChunk, m_iZChunk)))
+		{
+			m_arrayNeighbourChunks[getNeighbourIndex(0, 0, 0)] = m_pCurrentChunk;
+		}
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::setCurrentChunk(Chunk* pChunk)
+	{
+		if (pChunk != m_pCurrentChunk)
+		{
+			if (pChunk)
+			{
+				pChunk->pin();
+			}
+			if (m_pCurrentChunk)
+			{
+				m_pCurrentChunk->unpin();
+			}
+			m_pCurrentChunk = pChunk;
+		}
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	void PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::moveToChunk(int32_t iChunkX, int32_t iChunkY, int32_t iChunkZ)
+	{
+		const int32_t iDeltaX = iChunkX - m_iXChunk;
+		const int32_t iDeltaY = iChunkY - m_iYChunk;
+		const int32_t iDeltaZ = iChunkZ - m_iZChunk;
+
+		if ((iDeltaX == 0) && (iDeltaY == 0) && (iDeltaZ == 0))
+		{
+			return;
+		}
+
+		m_iXChunk = iChunkX;
+		m_iYChunk = iChunkY;
+		m_iZChunk = iChunkZ;
+
+		if ((std::abs(iDeltaX) > 1) || (std::abs(iDeltaY) > 1) || (std::abs(iDeltaZ) > 1))
+		{
+			std::fill(std::begin(m_arrayNeighbourChunks), std::end(m_arrayNeighbourChunks), nullptr);
+			return;
+		}
+
+		// We have moved into one of the neighbouring chunks, so some of the cached chunks are still neighbours of the new one.
+		Chunk* arrayOldChunks[27];
+		std::copy(std::begin(m_arrayNeighbourChunks), std::end(m_arrayNeighbourChunks), std::begin(arrayOldChunks));
+		for (int32_t z = -1; z <= 1; z++)
+		{
+			for (int32_t y = -1; y <= 1; y++)
+			{
+				for (int32_t x = -1; x <= 1; x++)
+				{
+					const int32_t iOldX = x + iDeltaX;
+					const int32_t iOldY = y + iDeltaY;
+					const int32_t iOldZ = z + iDeltaZ;
+					const bool bWasCached = (iOldX >= -1) && (iOldX <= 1) && (iOldY >= -1) && (iOldY <= 1) && (iOldZ >= -1) && (iOldZ <= 1);
+					m_arrayNeighbourChunks[getNeighbourIndex(x, y, z)] = bWasCached ? arrayOldChunks[getNeighbourIndex(iOldX, iOldY, iOldZ)] : nullptr;
+				}
+			}
+		}
+	}
+
+	template <typename VoxelType>
+	template <uint16_t SamplerChunkSideLength>
+	VoxelType PagedVolume<VoxelType>::SamplerImpl<SamplerChunkSideLength>::peekAcrossChunkBoundary(int32_t iOffsetX, int32_t iOffsetY, int32_t iOffsetZ) const
+	{
+		// Find which chunk the voxel is in, and its position within that chunk.
+		int32_t iXPos = m_uXPosInChunk + iOffsetX;
+		int32_t iYPos = m_uYPosInChunk + iOffsetY;
+		int32_t iZPos = m_uZPosInChunk + iOffsetZ;
+		const int32_t iSideLengthMinusOne = getChunkSideLengthMinusOne();
+		const int32_t iChunkOffsetX = (iXPos < 0) ? -1 : ((iXPos > iSideLengthMinusOne) ? 1 : 0);
+		const int32_t iChunkOffsetY = (iYPos < 0) ? -1 : ((iYPos > iSideLengthMinusOne) ? 1 : 0);
+		const int32_t iChunkOffsetZ = (iZPos < 0) ? -1 : ((iZPos > iSideLengthMinusOne) ? 1 : 0);
+		iXPos -= iChunkOffsetX * (iSideLengthMinusOne + 1);
+		iYPos -= iChunkOffsetY * (iSideLengthMinusOne + 1);
+		iZPos -= iChunkOffsetZ * (iSideLengthMinusOne + 1);
+
+		const Chunk* pChunk = getNeighbourChunk(iChunkOffsetX, iChunkOffsetY, iChunkOffsetZ);
+		return pChunk->m_tData[MortonTables::x[iXPos] | MortonTables::y[iYPos] | MortonTables::z[iZPos]];
 	}
 }
 
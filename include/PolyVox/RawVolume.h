@@ -26,7 +26,9 @@
 #define __PolyVox_RawVolume_H__
 
 #include "BaseVolume.h"
+#include "ChunkView.h"
 #include "Region.h"
+#include "Impl/Morton.h"
 #include "Vector.h"
 
 #include <cstdlib> //For abort()
@@ -36,13 +38,45 @@
 
 namespace PolyVox
 {
+	namespace BoundsChecks
+	{
+		/**
+		 * Whether a RawVolume sampler checks that it is inside the volume
+		 */
+		enum BoundsCheck
+		{
+			Enabled, ///< Positions outside the volume are handled by falling back to RawVolume::getVoxel(), which returns the border value.
+			Disabled ///< The caller guarantees that the sampler and the voxels it peeks at are always inside the volume.
+		};
+	}
+	typedef BoundsChecks::BoundsCheck BoundsCheck;
+
+	namespace RawVolumeLayouts
+	{
+		/**
+		 * How the voxels of a RawVolume are arranged in memory
+		 */
+		enum RawVolumeLayout
+		{
+			Linear, ///< Rows of voxels along x, which are stacked into slices along y and then along z.
+			Bricked ///< 8x8x8 bricks stored in linear order, with the voxels inside each brick in Morton order (as in PagedVolume::Chunk).
+		};
+	}
+	typedef RawVolumeLayouts::RawVolumeLayout RawVolumeLayout;
+
 	/**
 	 * Simple volume implementation which stores data in a single large 3D array.
 	 *
 	 * This class is less memory-efficient than the PagedVolume, but it is the simplest possible
 	 * volume implementation which makes it useful for debugging and getting started with PolyVox.
+	 *
+	 * By default the voxels are stored in a linear order, so that neighbours in y and z are a whole row or slice apart.
+	 * This is simple and ideal for code which runs along x, but algorithms which look at the neighbourhood of each voxel
+	 * (or sweep along z) on a large volume keep missing the cache. Giving RawVolumeLayouts::Bricked as the second template
+	 * parameter keeps such neighbours close together in memory, at the cost of rounding each dimension up to a multiple of
+	 * eight voxels and slightly more work to locate each voxel.
 	 */
-	template <typename VoxelType>
+	template <typename VoxelType, RawVolumeLayout eLayout = RawVolumeLayouts::Linear>
 	class RawVolume : public BaseVolume<VoxelType>
 	{
 	public:
@@ -54,15 +88,19 @@ namespace PolyVox
 		//in the future
 		//typedef Volume<VoxelType> VolumeOfVoxelType; //Workaround for GCC/VS2010 differences.
 		//class Sampler : public VolumeOfVoxelType::template Sampler< RawVolume<VoxelType> >
+		//
+		//The bounds checking is a template parameter so that the unchecked version compiles down to plain pointer
+		//arithmetic. Use the 'Sampler' and 'UncheckedSampler' typedefs below rather than naming this class directly.
+		template <BoundsCheck eBoundsCheck>
 #if defined(_MSC_VER)
-		class Sampler : public BaseVolume<VoxelType>::Sampler< RawVolume<VoxelType> > //This line works on VS2010
+		class SamplerImpl : public BaseVolume<VoxelType>::Sampler< RawVolume<VoxelType, eLayout> > //This line works on VS2010
 #else
-		class Sampler : public BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> > //This line works on GCC
+		class SamplerImpl : public BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> > //This line works on GCC
 #endif
 		{
 		public:
-			Sampler(RawVolume<VoxelType>* volume);
-			~Sampler();
+			SamplerImpl(RawVolume<VoxelType, eLayout>* volume);
+			~SamplerImpl();
 
 			inline VoxelType getVoxel(void) const;
 
@@ -111,19 +149,42 @@ namespace PolyVox
 			inline VoxelType peekVoxel1px1py1pz(void) const;
 
 		private:
+			//The distance in memory from the current voxel to its neighbour iOffset (-1, 0 or 1) voxels away along each axis.
+			int32_t getOffsetX(int32_t iOffset) const;
+			int32_t getOffsetY(int32_t iOffset) const;
+			int32_t getOffsetZ(int32_t iOffset) const;
 
 			//Other current position information
 			VoxelType* mCurrentVoxel;
 
+			//Copies of the volume's strides and lower corner, so that the volume's region isn't read on every move
+			int32_t m_iYStride;
+			int32_t m_iZStride;
+			int32_t m_iLowerX;
+			int32_t m_iLowerY;
+			int32_t m_iLowerZ;
+
 			//Whether the current position is inside the volume
 			//FIXME - Replace these with flags
 			bool m_bIsCurrentPositionValidInX;
 			bool m_bIsCurrentPositionValidInY;
 			bool m_bIsCurrentPositionValidInZ;
 		};
+
+		/// The normal sampler, which can be used anywhere and returns the border value outside the volume.
+		typedef SamplerImpl<BoundsChecks::Enabled> Sampler;
+		/// A faster sampler which does no bounds checking. It may only be used when the sampler and every voxel it peeks
+		/// at stay inside the volume, for example when an algorithm has checked that its region plus a one voxel border
+		/// lies within getEnclosingRegion(). See also UncheckedSamplerType.
+		typedef SamplerImpl<BoundsChecks::Disabled> UncheckedSampler;
 #endif // SWIG
 
 	public:
+		/// Reading from a RawVolume does not modify it, so it is safe to do from several threads at once.
+		static const bool SupportsConcurrentReads = true;
+		/// Voxels are stored separately in a RawVolume, so different voxels can also be written from different threads at once.
+		static const bool SupportsConcurrentWrites = true;
+
 		/// Constructor for creating a fixed size volume.
 		RawVolume(const Region& regValid);
 
@@ -154,6 +215,10 @@ namespace PolyVox
 		/// Sets the voxel at the position given by a 3D vector
 		void setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue);
 
+		/// Calls a function with direct access to the voxels which overlap a region (see ChunkView).
+		template <typename Function>
+		void forEachChunk(const Region& region, Function function);
+
 		/// Calculates approximatly how many bytes of memory the volume is currently using.
 		uint32_t calculateSizeInBytes(void);
 
@@ -165,17 +230,52 @@ namespace PolyVox
 		RawVolume& operator=(const RawVolume& rhs);
 
 	private:
+		// Copies between volumes and brush edits work directly on the voxel data.
+		friend class VolumeCopier;
+		friend class BrushApplier;
+
 		void initialise(const Region& regValidRegion);
 
+		//The position of a voxel in m_pData, given its position relative to the lower corner of the volume.
+		uint32_t getIndex(int32_t iLocalXPos, int32_t iLocalYPos, int32_t iLocalZPos) const;
+		//For the bricked layout, the distance in m_pData between the voxel at iLocalPos along some axis and the voxel
+		//iOffset (-1, 0 or 1) further along, given the Morton table and the distance between bricks for that axis.
+		static int32_t getBrickedOffset(const uint32_t* pMortonTable, int32_t iLocalPos, int32_t iOffset, int32_t iBrickStride);
+
+		static const int32_t iBrickSideLengthPower = 3;
+		static const int32_t iBrickSideLength = 1 << iBrickSideLengthPower;
+		static const int32_t iVoxelsPerBrick = iBrickSideLength * iBrickSideLength * iBrickSideLength;
+
 		//The size of the volume
 		Region m_regValidRegion;
 
+		//The number of elements in m_pData, which is larger than the number of voxels if bricks have been padded.
+		uint32_t m_uNoOfStoredVoxels;
+
+		//The distances in m_pData between neighbouring voxels in y and z (for the linear layout) or
+		//between neighbouring bricks in y and z (for the bricked layout, where bricks in x are iVoxelsPerBrick apart).
+		int32_t m_iYStride;
+		int32_t m_iZStride;
+
 		//The border value
 		VoxelType m_tBorderValue;
 
 		//The voxel data
 		VoxelType* m_pData;
 	};
+
+#ifndef SWIG
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	struct UncheckedSamplerType< RawVolume<VoxelType, eLayout> >
+	{
+		typedef typename RawVolume<VoxelType, eLayout>::UncheckedSampler type;
+
+		static bool isUsable(const RawVolume<VoxelType, eLayout>* volume, const Region& regAccessed)
+		{
+			return volume->getEnclosingRegion().containsRegion(regAccessed);
+		}
+	};
+#endif // SWIG
 }
 
 #include "RawVolume.inl"
@@ -28,8 +28,8 @@ namespace PolyVox
 	/// This constructor creates a volume with a fixed size which is specified as a parameter.
 	/// \param regValid Specifies the minimum and maximum valid voxel positions.
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	RawVolume<VoxelType>::RawVolume(const Region& regValid)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	RawVolume<VoxelType, eLayout>::RawVolume(const Region& regValid)
 		:BaseVolume<VoxelType>()
 		, m_regValidRegion(regValid)
 		, m_tBorderValue()
@@ -47,8 +47,8 @@ namespace PolyVox
 	///
 	/// \sa VolumeResampler
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	RawVolume<VoxelType>::RawVolume(const RawVolume<VoxelType>& /*rhs*/)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	RawVolume<VoxelType, eLayout>::RawVolume(const RawVolume<VoxelType, eLayout>& /*rhs*/)
 	{
 		POLYVOX_THROW(not_implemented, "Volume copy constructor not implemented for performance reasons.");
 	}
@@ -56,8 +56,8 @@ namespace PolyVox
 	////////////////////////////////////////////////////////////////////////////////
 	/// Destroys the volume
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	RawVolume<VoxelType>::~RawVolume()
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	RawVolume<VoxelType, eLayout>::~RawVolume()
 	{
 		delete[] m_pData;
 		m_pData = 0;
@@ -70,8 +70,8 @@ namespace PolyVox
 	///
 	/// \sa VolumeResampler
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	RawVolume<VoxelType>& RawVolume<VoxelType>::operator=(const RawVolume<VoxelType>& /*rhs*/)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	RawVolume<VoxelType, eLayout>& RawVolume<VoxelType, eLayout>::operator=(const RawVolume<VoxelType, eLayout>& /*rhs*/)
 	{
 		POLYVOX_THROW(not_implemented, "Volume assignment operator not implemented for performance reasons.");
 	}
@@ -81,8 +81,8 @@ namespace PolyVox
 	/// is outside the extents of the volume.
 	/// \return The value used for voxels outside of the volume
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::getBorderValue(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	VoxelType RawVolume<VoxelType, eLayout>::getBorderValue(void) const
 	{
 		return m_tBorderValue;
 	}
@@ -90,8 +90,8 @@ namespace PolyVox
 	////////////////////////////////////////////////////////////////////////////////
 	/// \return A Region representing the extent of the volume.
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	const Region& RawVolume<VoxelType>::getEnclosingRegion(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	const Region& RawVolume<VoxelType, eLayout>::getEnclosingRegion(void) const
 	{
 		return m_regValidRegion;
 	}
@@ -100,8 +100,8 @@ namespace PolyVox
 	/// \return The width of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the width is 64.
 	/// \sa getHeight(), getDepth()
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	int32_t RawVolume<VoxelType>::getWidth(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	int32_t RawVolume<VoxelType, eLayout>::getWidth(void) const
 	{
 		return m_regValidRegion.getUpperX() - m_regValidRegion.getLowerX() + 1;
 	}
@@ -110,8 +110,8 @@ namespace PolyVox
 	/// \return The height of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the height is 64.
 	/// \sa getWidth(), getDepth()
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	int32_t RawVolume<VoxelType>::getHeight(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	int32_t RawVolume<VoxelType, eLayout>::getHeight(void) const
 	{
 		return m_regValidRegion.getUpperY() - m_regValidRegion.getLowerY() + 1;
 	}
@@ -120,8 +120,8 @@ namespace PolyVox
 	/// \return The depth of the volume in voxels. Note that this value is inclusive, so that if the valid range is e.g. 0 to 63 then the depth is 64.
 	/// \sa getWidth(), getHeight()
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	int32_t RawVolume<VoxelType>::getDepth(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	int32_t RawVolume<VoxelType, eLayout>::getDepth(void) const
 	{
 		return m_regValidRegion.getUpperZ() - m_regValidRegion.getLowerZ() + 1;
 	}
@@ -134,8 +134,8 @@ namespace PolyVox
 	/// \param uZPos The \c z position of the voxel
 	/// \return The voxel value
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	VoxelType RawVolume<VoxelType, eLayout>::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
 	{
 		if (this->m_regValidRegion.containsPoint(uXPos, uYPos, uZPos))
 		{
@@ -144,12 +144,7 @@ namespace PolyVox
 			int32_t iLocalYPos = uYPos - regValidRegion.getLowerY();
 			int32_t iLocalZPos = uZPos - regValidRegion.getLowerZ();
 
-			return m_pData
-				[
-					iLocalXPos +
-					iLocalYPos * this->getWidth() +
-					iLocalZPos * this->getWidth() * this->getHeight()
-				];
+			return m_pData[getIndex(iLocalXPos, iLocalYPos, iLocalZPos)];
 		}
 		else
 		{
@@ -163,8 +158,8 @@ namespace PolyVox
 	/// \param v3dPos The 3D position of the voxel
 	/// \return The voxel value
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::getVoxel(const Vector3DInt32& v3dPos) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	VoxelType RawVolume<VoxelType, eLayout>::getVoxel(const Vector3DInt32& v3dPos) const
 	{
 		return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
 	}
@@ -172,8 +167,8 @@ namespace PolyVox
 	////////////////////////////////////////////////////////////////////////////////
 	/// \param tBorder The value to use for voxels outside the volume.
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::setBorderValue(const VoxelType& tBorder)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	void RawVolume<VoxelType, eLayout>::setBorderValue(const VoxelType& tBorder)
 	{
 		m_tBorderValue = tBorder;
 	}
@@ -184,8 +179,8 @@ namespace PolyVox
 	/// \param uZPos the \c z position of the voxel
 	/// \param tValue the value to which the voxel will be set
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	void RawVolume<VoxelType, eLayout>::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
 	{
 		if (this->m_regValidRegion.containsPoint(Vector3DInt32(uXPos, uYPos, uZPos)) == false)
 		{
@@ -197,20 +192,15 @@ namespace PolyVox
 		int32_t iLocalYPos = uYPos - v3dLowerCorner.getY();
 		int32_t iLocalZPos = uZPos - v3dLowerCorner.getZ();
 
-		m_pData
-			[
-				iLocalXPos +
-				iLocalYPos * this->getWidth() +
-				iLocalZPos * this->getWidth() * this->getHeight()
-			] = tValue;
+		m_pData[getIndex(iLocalXPos, iLocalYPos, iLocalZPos)] = tValue;
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// \param v3dPos the 3D position of the voxel
 	/// \param tValue the value to which the voxel will be set
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	void RawVolume<VoxelType, eLayout>::setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue)
 	{
 		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
 	}
@@ -218,8 +208,8 @@ namespace PolyVox
 	////////////////////////////////////////////////////////////////////////////////
 	/// This function should probably be made internal...
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::initialise(const Region& regValidRegion)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	void RawVolume<VoxelType, eLayout>::initialise(const Region& regValidRegion)
 	{
 		this->m_regValidRegion = regValidRegion;
 
@@ -236,20 +226,125 @@ namespace PolyVox
 			POLYVOX_THROW(std::invalid_argument, "Volume depth must be greater than zero.");
 		}
 
+		if (eLayout == RawVolumeLayouts::Linear)
+		{
+			m_iYStride = this->getWidth();
+			m_iZStride = this->getWidth() * this->getHeight();
+			m_uNoOfStoredVoxels = this->getWidth() * this->getHeight() * this->getDepth();
+		}
+		else
+		{
+			// Partial bricks at the upper edges are stored in full.
+			const int32_t iWidthInBricks = (this->getWidth() + iBrickSideLength - 1) >> iBrickSideLengthPower;
+			const int32_t iHeightInBricks = (this->getHeight() + iBrickSideLength - 1) >> iBrickSideLengthPower;
+			const int32_t iDepthInBricks = (this->getDepth() + iBrickSideLength - 1) >> iBrickSideLengthPower;
+			m_iYStride = iWidthInBricks * iVoxelsPerBrick;
+			m_iZStride = iWidthInBricks * iHeightInBricks * iVoxelsPerBrick;
+			m_uNoOfStoredVoxels = iWidthInBricks * iHeightInBricks * iDepthInBricks * iVoxelsPerBrick;
+		}
+
 		//Create the data
-		m_pData = new VoxelType[this->getWidth() * this->getHeight()* this->getDepth()];
+		m_pData = new VoxelType[m_uNoOfStoredVoxels];
 
 		// Clear to zeros
-		std::fill(m_pData, m_pData + this->getWidth() * this->getHeight()* this->getDepth(), VoxelType());
+		std::fill(m_pData, m_pData + m_uNoOfStoredVoxels, VoxelType());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The function is called as 'function(view)' with a ChunkView<VoxelType>&. With the linear layout the whole volume is a
+	/// single chunk, while with the bricked layout each brick is a chunk in Morton order, visited in order of increasing z, then
+	/// y, then x. The chunk region of a brick at the upper edges can extend past the volume, as such bricks are stored in full.
+	/// Parts of \a region which are outside the volume are skipped.
+	/// \param region The region to visit
+	/// \param function The function to call for each chunk
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <typename Function>
+	void RawVolume<VoxelType, eLayout>::forEachChunk(const Region& region, Function function)
+	{
+		if (!intersects(region, this->m_regValidRegion))
+		{
+			return;
+		}
+
+		Region regClipped(region);
+		regClipped.cropTo(this->m_regValidRegion);
+
+		if (eLayout == RawVolumeLayouts::Linear)
+		{
+			ChunkView<VoxelType> view(m_pData, ChunkLayouts::Linear, this->m_regValidRegion, regClipped, m_iYStride, m_iZStride);
+			function(view);
+			return;
+		}
+
+		const Vector3DInt32& v3dLowerCorner = this->m_regValidRegion.getLowerCorner();
+		Region regLocal(regClipped);
+		regLocal.shift(-v3dLowerCorner.getX(), -v3dLowerCorner.getY(), -v3dLowerCorner.getZ());
+		for (int32_t iBrickZ = regLocal.getLowerZ() >> iBrickSideLengthPower; iBrickZ <= (regLocal.getUpperZ() >> iBrickSideLengthPower); iBrickZ++)
+		{
+			for (int32_t iBrickY = regLocal.getLowerY() >> iBrickSideLengthPower; iBrickY <= (regLocal.getUpperY() >> iBrickSideLengthPower); iBrickY++)
+			{
+				for (int32_t iBrickX = regLocal.getLowerX() >> iBrickSideLengthPower; iBrickX <= (regLocal.getUpperX() >> iBrickSideLengthPower); iBrickX++)
+				{
+					const Vector3DInt32 v3dBrickLocal(iBrickX << iBrickSideLengthPower, iBrickY << iBrickSideLengthPower, iBrickZ << iBrickSideLengthPower);
+					const Region regBrick(v3dLowerCorner + v3dBrickLocal, v3dLowerCorner + v3dBrickLocal + Vector3DInt32(iBrickSideLength - 1, iBrickSideLength - 1, iBrickSideLength - 1));
+					Region regView(regBrick);
+					regView.cropTo(regClipped);
+
+					ChunkView<VoxelType> view(m_pData + getIndex(v3dBrickLocal.getX(), v3dBrickLocal.getY(), v3dBrickLocal.getZ()), ChunkLayouts::Morton, regBrick, regView, 0, 0);
+					function(view);
+				}
+			}
+		}
 	}
 
 	////////////////////////////////////////////////////////////////////////////////
 	/// Note: This function needs reviewing for accuracy...
 	////////////////////////////////////////////////////////////////////////////////
-	template <typename VoxelType>
-	uint32_t RawVolume<VoxelType>::calculateSizeInBytes(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	uint32_t RawVolume<VoxelType, eLayout>::calculateSizeInBytes(void)
+	{
+		return m_uNoOfStoredVoxels * sizeof(VoxelType);
+	}
+
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	uint32_t RawVolume<VoxelType, eLayout>::getIndex(int32_t iLocalXPos, int32_t iLocalYPos, int32_t iLocalZPos) const
 	{
-		return this->getWidth() * this->getHeight() * this->getDepth() * sizeof(VoxelType);
+		if (eLayout == RawVolumeLayouts::Linear)
+		{
+			return iLocalXPos + iLocalYPos * m_iYStride + iLocalZPos * m_iZStride;
+		}
+		else
+		{
+			const int32_t iBrickOffset =
+				(iLocalXPos >> iBrickSideLengthPower) * iVoxelsPerBrick +
+				(iLocalYPos >> iBrickSideLengthPower) * m_iYStride +
+				(iLocalZPos >> iBrickSideLengthPower) * m_iZStride;
+
+			return iBrickOffset +
+				(MortonTables::x[iLocalXPos & (iBrickSideLength - 1)] |
+				MortonTables::y[iLocalYPos & (iBrickSideLength - 1)] |
+				MortonTables::z[iLocalZPos & (iBrickSideLength - 1)]);
+		}
+	}
+
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	int32_t RawVolume<VoxelType, eLayout>::getBrickedOffset(const uint32_t* pMortonTable, int32_t iLocalPos, int32_t iOffset, int32_t iBrickStride)
+	{
+		const int32_t iPosInBrick = iLocalPos & (iBrickSideLength - 1);
+		const int32_t iNewPosInBrick = iPosInBrick + iOffset;
+
+		// Moving off either end of the brick takes us to the opposite end of the neighbouring one.
+		int32_t iResult = static_cast<int32_t>(pMortonTable[iNewPosInBrick & (iBrickSideLength - 1)]) - static_cast<int32_t>(pMortonTable[iPosInBrick]);
+		if (iNewPosInBrick < 0)
+		{
+			iResult -= iBrickStride;
+		}
+		else if (iNewPosInBrick >= iBrickSideLength)
+		{
+			iResult += iBrickStride;
+		}
+		return iResult;
 	}
 }
 
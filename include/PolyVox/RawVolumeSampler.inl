@@ -22,32 +22,40 @@
 * SOFTWARE.
 *******************************************************************************/
 
-#define CAN_GO_NEG_X(val) (val > this->mVolume->getEnclosingRegion().getLowerX())
-#define CAN_GO_POS_X(val) (val < this->mVolume->getEnclosingRegion().getUpperX())
-#define CAN_GO_NEG_Y(val) (val > this->mVolume->getEnclosingRegion().getLowerY())
-#define CAN_GO_POS_Y(val) (val < this->mVolume->getEnclosingRegion().getUpperY())
-#define CAN_GO_NEG_Z(val) (val > this->mVolume->getEnclosingRegion().getLowerZ())
-#define CAN_GO_POS_Z(val) (val < this->mVolume->getEnclosingRegion().getUpperZ())
+#define CAN_GO_NEG_X(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val > this->mVolume->getEnclosingRegion().getLowerX()))
+#define CAN_GO_POS_X(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val < this->mVolume->getEnclosingRegion().getUpperX()))
+#define CAN_GO_NEG_Y(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val > this->mVolume->getEnclosingRegion().getLowerY()))
+#define CAN_GO_POS_Y(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val < this->mVolume->getEnclosingRegion().getUpperY()))
+#define CAN_GO_NEG_Z(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val > this->mVolume->getEnclosingRegion().getLowerZ()))
+#define CAN_GO_POS_Z(val) ((eBoundsCheck == BoundsChecks::Disabled) || (val < this->mVolume->getEnclosingRegion().getUpperZ()))
 
 namespace PolyVox
 {
-	template <typename VoxelType>
-	RawVolume<VoxelType>::Sampler::Sampler(RawVolume<VoxelType>* volume)
-		:BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >(volume)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::SamplerImpl(RawVolume<VoxelType, eLayout>* volume)
+		:BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >(volume)
 		, mCurrentVoxel(0)
+		, m_iYStride(volume->m_iYStride)
+		, m_iZStride(volume->m_iZStride)
+		, m_iLowerX(volume->getEnclosingRegion().getLowerX())
+		, m_iLowerY(volume->getEnclosingRegion().getLowerY())
+		, m_iLowerZ(volume->getEnclosingRegion().getLowerZ())
 		, m_bIsCurrentPositionValidInX(false)
 		, m_bIsCurrentPositionValidInY(false)
 		, m_bIsCurrentPositionValidInZ(false)
 	{
 	}
 
-	template <typename VoxelType>
-	RawVolume<VoxelType>::Sampler::~Sampler()
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::~SamplerImpl()
 	{
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::getVoxel(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::getVoxel(void) const
 	{
 		if (this->isCurrentPositionValid())
 		{
@@ -59,41 +67,43 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	bool inline RawVolume<VoxelType>::Sampler::isCurrentPositionValid(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	bool inline RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::isCurrentPositionValid(void) const
 	{
-		return m_bIsCurrentPositionValidInX && m_bIsCurrentPositionValidInY && m_bIsCurrentPositionValidInZ;
+		// Without bounds checks the caller has promised that the sampler stays inside the volume.
+		return (eBoundsCheck == BoundsChecks::Disabled) || (m_bIsCurrentPositionValidInX && m_bIsCurrentPositionValidInY && m_bIsCurrentPositionValidInZ);
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::setPosition(const Vector3DInt32& v3dNewPos)
 	{
 		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 	{
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::setPosition(xPos, yPos, zPos);
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::setPosition(xPos, yPos, zPos);
 
-		m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(xPos);
-		m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(yPos);
-		m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(zPos);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(xPos);
+			m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(yPos);
+			m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(zPos);
+		}
+		else
+		{
+			POLYVOX_ASSERT(this->mVolume->getEnclosingRegion().containsPoint(xPos, yPos, zPos), "Unchecked sampler was moved outside the volume.");
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid())
 		{
-			const Vector3DInt32& v3dLowerCorner = this->mVolume->m_regValidRegion.getLowerCorner();
-			int32_t iLocalXPos = xPos - v3dLowerCorner.getX();
-			int32_t iLocalYPos = yPos - v3dLowerCorner.getY();
-			int32_t iLocalZPos = zPos - v3dLowerCorner.getZ();
-
-			const int32_t uVoxelIndex = iLocalXPos +
-				iLocalYPos * this->mVolume->getWidth() +
-				iLocalZPos * this->mVolume->getWidth() * this->mVolume->getHeight();
-
-			mCurrentVoxel = this->mVolume->m_pData + uVoxelIndex;
+			mCurrentVoxel = this->mVolume->m_pData + this->mVolume->getIndex(xPos - m_iLowerX, yPos - m_iLowerY, zPos - m_iLowerZ);
 		}
 		else
 		{
@@ -101,11 +111,12 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	bool RawVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	bool RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::setVoxel(VoxelType tValue)
 	{
 		//return m_bIsCurrentPositionValid ? *mCurrentVoxel : this->mVolume->getBorderValue();
-		if (this->m_bIsCurrentPositionValidInX && this->m_bIsCurrentPositionValidInY && this->m_bIsCurrentPositionValidInZ)
+		if (this->isCurrentPositionValid())
 		{
 			*mCurrentVoxel = tValue;
 			return true;
@@ -116,21 +127,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::movePositiveX(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::movePositiveX(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetX(1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::movePositiveX();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::movePositiveX();
 
-		m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(this->mXPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(this->mXPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			++mCurrentVoxel;
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -138,21 +154,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::movePositiveY(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::movePositiveY(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetY(1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::movePositiveY();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::movePositiveY();
 
-		m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(this->mYPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(this->mYPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			mCurrentVoxel += this->mVolume->getWidth();
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -160,21 +181,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::movePositiveZ(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::movePositiveZ(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetZ(1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::movePositiveZ();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::movePositiveZ();
 
-		m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(this->mZPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(this->mZPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			mCurrentVoxel += this->mVolume->getWidth() * this->mVolume->getHeight();
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -182,21 +208,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::moveNegativeX(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::moveNegativeX(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetX(-1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::moveNegativeX();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::moveNegativeX();
 
-		m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(this->mXPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInX = this->mVolume->getEnclosingRegion().containsPointInX(this->mXPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			--mCurrentVoxel;
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -204,21 +235,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::moveNegativeY(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::moveNegativeY(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetY(-1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::moveNegativeY();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::moveNegativeY();
 
-		m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(this->mYPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInY = this->mVolume->getEnclosingRegion().containsPointInY(this->mYPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			mCurrentVoxel -= this->mVolume->getWidth();
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -226,21 +262,26 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	void RawVolume<VoxelType>::Sampler::moveNegativeZ(void)
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	void RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::moveNegativeZ(void)
 	{
 		// We'll need this in a moment...
 		bool bIsOldPositionValid = this->isCurrentPositionValid();
+		const int32_t iOffset = getOffsetZ(-1);
 
 		// Base version updates position and validity flags.
-		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType> >::moveNegativeZ();
+		BaseVolume<VoxelType>::template Sampler< RawVolume<VoxelType, eLayout> >::moveNegativeZ();
 
-		m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(this->mZPosInVolume);
+		if (eBoundsCheck == BoundsChecks::Enabled)
+		{
+			m_bIsCurrentPositionValidInZ = this->mVolume->getEnclosingRegion().containsPointInZ(this->mZPosInVolume);
+		}
 
 		// Then we update the voxel pointer
 		if (this->isCurrentPositionValid() && bIsOldPositionValid)
 		{
-			mCurrentVoxel -= this->mVolume->getWidth() * this->mVolume->getHeight();
+			mCurrentVoxel += iOffset;
 		}
 		else
 		{
@@ -248,140 +289,154 @@ namespace PolyVox
 		}
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1ny1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1ny1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 - this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(-1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1ny0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1ny0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 - this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1ny1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1ny1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 - this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(-1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx0py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx0py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx0py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx0py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume))
 		{
-			return *(mCurrentVoxel - 1);
+			return *(mCurrentVoxel + getOffsetX(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx0py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx0py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 + this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 + this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1nx1py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1nx1py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - 1 + this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(-1) + getOffsetY(1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume - 1, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1ny1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1ny1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetY(-1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1ny0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1ny0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel - this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetY(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1ny1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1ny1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetY(-1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px0py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px0py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px0py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px0py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()))
 		{
@@ -390,137 +445,174 @@ namespace PolyVox
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px0py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px0py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetY(1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel + this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetY(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel0px1py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel0px1py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetY(1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
 	}
 
 	//////////////////////////////////////////////////////////////////////////
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1ny1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1ny1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 - this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(-1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1ny0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1ny0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 - this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1ny1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1ny1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_NEG_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 - this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(-1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume - 1, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px0py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px0py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px0py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px0py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume))
 		{
-			return *(mCurrentVoxel + 1);
+			return *(mCurrentVoxel + getOffsetX(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px0py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px0py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume, this->mZPosInVolume + 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1py1nz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1py1nz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_NEG_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 + this->mVolume->getWidth() - this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(1) + getOffsetZ(-1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume - 1);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1py0pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1py0pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 + this->mVolume->getWidth());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume);
 	}
 
-	template <typename VoxelType>
-	VoxelType RawVolume<VoxelType>::Sampler::peekVoxel1px1py1pz(void) const
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	VoxelType RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::peekVoxel1px1py1pz(void) const
 	{
 		if ((this->isCurrentPositionValid()) && CAN_GO_POS_X(this->mXPosInVolume) && CAN_GO_POS_Y(this->mYPosInVolume) && CAN_GO_POS_Z(this->mZPosInVolume))
 		{
-			return *(mCurrentVoxel + 1 + this->mVolume->getWidth() + this->mVolume->getWidth() * this->mVolume->getHeight());
+			return *(mCurrentVoxel + getOffsetX(1) + getOffsetY(1) + getOffsetZ(1));
 		}
 		return this->mVolume->getVoxel(this->mXPosInVolume + 1, this->mYPosInVolume + 1, this->mZPosInVolume + 1);
 	}
+
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	int32_t RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::getOffsetX(int32_t iOffset) const
+	{
+		return (eLayout == RawVolumeLayouts::Linear) ? iOffset :
+			RawVolume<VoxelType, eLayout>::getBrickedOffset(MortonTables::x, this->mXPosInVolume - m_iLowerX, iOffset, iVoxelsPerBrick);
+	}
+
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	int32_t RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::getOffsetY(int32_t iOffset) const
+	{
+		return (eLayout == RawVolumeLayouts::Linear) ? iOffset * m_iYStride :
+			RawVolume<VoxelType, eLayout>::getBrickedOffset(MortonTables::y, this->mYPosInVolume - m_iLowerY, iOffset, m_iYStride);
+	}
+
+	template <typename VoxelType, RawVolumeLayout eLayout>
+	template <BoundsCheck eBoundsCheck>
+	int32_t RawVolume<VoxelType, eLayout>::SamplerImpl<eBoundsCheck>::getOffsetZ(int32_t iOffset) const
+	{
+		return (eLayout == RawVolumeLayouts::Linear) ? iOffset * m_iZStride :
+			RawVolume<VoxelType, eLayout>::getBrickedOffset(MortonTables::z, this->mZPosInVolume - m_iLowerZ, iOffset, m_iZStride);
+	}
 }
 
 #undef CAN_GO_NEG_X
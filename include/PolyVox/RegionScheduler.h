@@ -0,0 +1,168 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_RegionScheduler_H__
+#define __PolyVox_RegionScheduler_H__
+
+#include "Impl/ErrorHandling.h"
+#include "Impl/PlatformDefinitions.h"
+#include "Impl/Utility.h"
+#include "Impl/WorkStealingPool.h"
+
+#include "Region.h"
+#include "Vector.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace PolyVox
+{
+	/**
+	 * Runs work over a Region on several threads.
+	 *
+	 * The region is split into tiles on a grid of the given side length, measured from the origin of the volume. If this matches
+	 * the chunk size of a PagedVolume then each tile covers part of a single chunk, so different threads don't work on the same
+	 * chunk, and tiles on the edges of the region are clipped to it. The tiles are shared between a WorkStealingPool of threads
+	 * which is created once and reused by every call to forEachTile(). Each thread starts with a block of neighbouring tiles
+	 * and only takes tiles from other threads when it runs out, so uneven tiles still balance.
+	 *
+	 * Each call to the function is given the index of the worker running it, which is less than getNoOfThreads(). This can be
+	 * used to look up per-worker scratch memory and samplers (see WorkerLocal), and VolumeLocks decides which volumes have
+	 * to be locked while they are accessed. A scheduler with a single thread doesn't create any threads and runs the tiles
+	 * in order on the calling thread, so algorithms can use it unconditionally.
+	 *
+	 * Creating the threads is not free, so a scheduler is best created once and passed to each algorithm which is run. The
+	 * algorithms which need their tiles to be a particular size (such as the ambient occlusion calculator) pass it to
+	 * forEachTile() themselves, and work which isn't split by region (such as the rounds of a flood fill) uses forEachTask().
+	 */
+	class RegionScheduler
+	{
+	public:
+		/// Constructor
+		RegionScheduler(uint32_t uNoOfThreads = 0, uint32_t uTileSideLength = 32);
+
+		/// Gets the number of threads, including the calling thread.
+		uint32_t getNoOfThreads(void) const;
+		/// Gets the side length of the tiles.
+		uint32_t getTileSideLength(void) const;
+
+		/// Restricts a worker thread to a single CPU.
+		bool setThreadAffinity(uint32_t uWorker, uint32_t uCpu);
+
+		/// Gets the number of tiles which a region is split into.
+		uint32_t getNoOfTiles(const Region& region) const;
+		/// Gets the number of tiles which a region is split into, using a different tile size.
+		uint32_t getNoOfTiles(const Region& region, uint32_t uTileSideLength) const;
+		/// Gets one of the tiles which a region is split into.
+		Region getTile(const Region& region, uint32_t uTile) const;
+		/// Gets one of the tiles which a region is split into, using a different tile size.
+		Region getTile(const Region& region, uint32_t uTile, uint32_t uTileSideLength) const;
+
+		/// Calls a function for every tile of a region, on all of the threads.
+		template <typename Function>
+		void forEachTile(const Region& region, Function function);
+		/// Calls a function for every tile of a region, using a different tile size, on all of the threads.
+		template <typename Function>
+		void forEachTile(const Region& region, uint32_t uTileSideLength, Function function);
+
+		/// Calls a function for each of a number of tasks which are not tied to a region, on all of the threads.
+		template <typename Function>
+		void forEachTask(uint32_t uNoOfTasks, Function function);
+
+	private:
+		RegionScheduler(const RegionScheduler&) = delete;
+		RegionScheduler& operator=(const RegionScheduler&) = delete;
+
+		// Finds the first tile of the grid which the region touches, and the number of tiles along each axis.
+		static void getTileGrid(const Region& region, int32_t iTileSideLength, Vector3DInt32& v3dLowerTile, Vector3DInt32& v3dNoOfTiles);
+		static Region getGridTile(const Region& region, int32_t iTileSideLength, const Vector3DInt32& v3dTile);
+
+		uint32_t m_uNoOfThreads;
+		int32_t m_iTileSideLength;
+
+		// Only created when there is more than one thread.
+		std::unique_ptr<WorkStealingPool> m_pPool;
+	};
+
+	/**
+	 * One value of a given type for each worker of a RegionScheduler, such as scratch buffers, partial results or samplers.
+	 *
+	 * Each value is allocated separately so that workers don't share cache lines.
+	 */
+	template <typename Type>
+	class WorkerLocal
+	{
+	public:
+		/// Creates the values, passing \a args to the constructor of each.
+		template <typename... Args>
+		explicit WorkerLocal(const RegionScheduler& scheduler, const Args&... args);
+
+		/// Gets the value of the given worker.
+		Type& get(uint32_t uWorker);
+		/// Gets the value of the given worker.
+		const Type& get(uint32_t uWorker) const;
+
+		/// Gets the number of values, which is the number of workers.
+		uint32_t getNoOfWorkers(void) const;
+
+	private:
+		std::vector< std::unique_ptr<Type> > m_vecValues;
+	};
+
+	/**
+	 * Decides which volumes have to be locked while the workers of a RegionScheduler access them.
+	 *
+	 * Volumes which report \a SupportsConcurrentReads (for the source) or \a SupportsConcurrentWrites (for the destination), such
+	 * as RawVolume, are accessed freely by every worker and their mutex is null. Other volumes (such as PagedVolume) must only be
+	 * accessed while holding their mutex. If the source and destination are the same volume they share a mutex, and neither
+	 * needs one when the scheduler only has a single thread.
+	 */
+	template <typename SrcVolumeType, typename DstVolumeType = SrcVolumeType>
+	class VolumeLocks
+	{
+	public:
+		/// Constructor
+		VolumeLocks(const RegionScheduler& scheduler, const SrcVolumeType* pVolSrc, const DstVolumeType* pVolDst);
+
+		/// Gets the mutex to hold while reading the source, or null if it can be read freely.
+		std::mutex* getSrcMutex(void) const;
+		/// Gets the mutex to hold while writing the destination, or null if it can be written freely.
+		std::mutex* getDstMutex(void) const;
+
+	private:
+		VolumeLocks(const VolumeLocks&) = delete;
+		VolumeLocks& operator=(const VolumeLocks&) = delete;
+
+		std::mutex m_srcMutex;
+		std::mutex m_dstMutex;
+		std::mutex* m_pSrcMutex;
+		std::mutex* m_pDstMutex;
+	};
+}
+
+#include "RegionScheduler.inl"
+
+#endif //__PolyVox_RegionScheduler_H__
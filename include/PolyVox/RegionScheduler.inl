@@ -0,0 +1,282 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uNoOfThreads The number of threads to use, or zero to use one for each hardware thread
+	/// \param uTileSideLength The side length of the tiles, which should normally match the chunk size of the volume
+	////////////////////////////////////////////////////////////////////////////////
+	inline RegionScheduler::RegionScheduler(uint32_t uNoOfThreads, uint32_t uTileSideLength)
+		:m_uNoOfThreads((uNoOfThreads == 0) ? getDefaultThreadCount() : uNoOfThreads)
+		,m_iTileSideLength(static_cast<int32_t>(uTileSideLength))
+	{
+		POLYVOX_THROW_IF(uTileSideLength == 0, std::invalid_argument, "Tile side length must be greater than zero");
+
+		if (m_uNoOfThreads > 1)
+		{
+			m_pPool.reset(new WorkStealingPool(m_uNoOfThreads));
+		}
+	}
+
+	inline uint32_t RegionScheduler::getNoOfThreads(void) const
+	{
+		return m_uNoOfThreads;
+	}
+
+	inline uint32_t RegionScheduler::getTileSideLength(void) const
+	{
+		return static_cast<uint32_t>(m_iTileSideLength);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Keeping each worker on its own CPU can help when the tiles are large enough for their data to stay in that CPU's cache.
+	/// Worker zero is the thread which calls forEachTile() and is left alone.
+	/// \param uWorker The worker to restrict, in the range [1, getNoOfThreads())
+	/// \param uCpu The index of the CPU to run it on
+	/// \return Whether the affinity was set. This is not supported on all platforms.
+	////////////////////////////////////////////////////////////////////////////////
+	inline bool RegionScheduler::setThreadAffinity(uint32_t uWorker, uint32_t uCpu)
+	{
+		return m_pPool ? m_pPool->setThreadAffinity(uWorker, uCpu) : false;
+	}
+
+	inline uint32_t RegionScheduler::getNoOfTiles(const Region& region) const
+	{
+		return getNoOfTiles(region, getTileSideLength());
+	}
+
+	inline uint32_t RegionScheduler::getNoOfTiles(const Region& region, uint32_t uTileSideLength) const
+	{
+		POLYVOX_THROW_IF(uTileSideLength == 0, std::invalid_argument, "Tile side length must be greater than zero");
+
+		Vector3DInt32 v3dLowerTile;
+		Vector3DInt32 v3dNoOfTiles;
+		getTileGrid(region, static_cast<int32_t>(uTileSideLength), v3dLowerTile, v3dNoOfTiles);
+		return static_cast<uint32_t>(v3dNoOfTiles.getX() * v3dNoOfTiles.getY() * v3dNoOfTiles.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Tiles are numbered with x varying fastest, so neighbouring indices are neighbouring tiles.
+	/// \param region The region being split into tiles
+	/// \param uTile The index of the tile, which must be less than getNoOfTiles()
+	////////////////////////////////////////////////////////////////////////////////
+	inline Region RegionScheduler::getTile(const Region& region, uint32_t uTile) const
+	{
+		return getTile(region, uTile, getTileSideLength());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param region The region being split into tiles
+	/// \param uTile The index of the tile, which must be less than getNoOfTiles(region, uTileSideLength)
+	/// \param uTileSideLength The side length of the tiles, which is used instead of getTileSideLength()
+	////////////////////////////////////////////////////////////////////////////////
+	inline Region RegionScheduler::getTile(const Region& region, uint32_t uTile, uint32_t uTileSideLength) const
+	{
+		POLYVOX_THROW_IF(uTileSideLength == 0, std::invalid_argument, "Tile side length must be greater than zero");
+
+		const int32_t iTileSideLength = static_cast<int32_t>(uTileSideLength);
+		Vector3DInt32 v3dLowerTile;
+		Vector3DInt32 v3dNoOfTiles;
+		getTileGrid(region, iTileSideLength, v3dLowerTile, v3dNoOfTiles);
+		POLYVOX_ASSERT(uTile < static_cast<uint32_t>(v3dNoOfTiles.getX() * v3dNoOfTiles.getY() * v3dNoOfTiles.getZ()), "Tile index is out of range");
+
+		const int32_t iTile = static_cast<int32_t>(uTile);
+		return getGridTile(region, iTileSideLength, v3dLowerTile + Vector3DInt32(iTile % v3dNoOfTiles.getX(), (iTile / v3dNoOfTiles.getX()) % v3dNoOfTiles.getY(),
+			iTile / (v3dNoOfTiles.getX() * v3dNoOfTiles.getY())));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The function is called as 'function(regTile, uTile, uWorker)', where \a regTile is the part of \a region covered by the
+	/// tile, \a uTile is its index (as used by getTile()) and \a uWorker identifies the thread. The order in which tiles run is
+	/// undefined when there is more than one thread, so any result which must not depend on the number of threads should only
+	/// depend on the tile. If the function throws then the remaining tiles are abandoned and the first exception is rethrown
+	/// here. This must not be called from inside the function.
+	/// \param region The region to split into tiles
+	/// \param function The function to call for each tile
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Function>
+	void RegionScheduler::forEachTile(const Region& region, Function function)
+	{
+		forEachTile(region, getTileSideLength(), function);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// As forEachTile(region, function), for algorithms whose tiles must be a particular size whatever the scheduler was created with.
+	/// \param region The region to split into tiles
+	/// \param uTileSideLength The side length of the tiles, which is used instead of getTileSideLength()
+	/// \param function The function to call for each tile
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Function>
+	void RegionScheduler::forEachTile(const Region& region, uint32_t uTileSideLength, Function function)
+	{
+		POLYVOX_THROW_IF(uTileSideLength == 0, std::invalid_argument, "Tile side length must be greater than zero");
+
+		const int32_t iTileSideLength = static_cast<int32_t>(uTileSideLength);
+		Vector3DInt32 v3dLowerTile;
+		Vector3DInt32 v3dNoOfTiles;
+		getTileGrid(region, iTileSideLength, v3dLowerTile, v3dNoOfTiles);
+
+		// Without other threads this is just a loop over the tiles.
+		if (!m_pPool)
+		{
+			uint32_t uTile = 0;
+			for (int32_t iTileZ = 0; iTileZ < v3dNoOfTiles.getZ(); iTileZ++)
+			{
+				for (int32_t iTileY = 0; iTileY < v3dNoOfTiles.getY(); iTileY++)
+				{
+					for (int32_t iTileX = 0; iTileX < v3dNoOfTiles.getX(); iTileX++)
+					{
+						function(getGridTile(region, iTileSideLength, v3dLowerTile + Vector3DInt32(iTileX, iTileY, iTileZ)), uTile, 0u);
+						uTile++;
+					}
+				}
+			}
+			return;
+		}
+
+		const uint32_t uNoOfTiles = static_cast<uint32_t>(v3dNoOfTiles.getX() * v3dNoOfTiles.getY() * v3dNoOfTiles.getZ());
+		m_pPool->execute(uNoOfTiles, [&](uint32_t uTile, uint32_t uWorker)
+		{
+			const int32_t iTile = static_cast<int32_t>(uTile);
+			const Vector3DInt32 v3dTile(iTile % v3dNoOfTiles.getX(), (iTile / v3dNoOfTiles.getX()) % v3dNoOfTiles.getY(), iTile / (v3dNoOfTiles.getX() * v3dNoOfTiles.getY()));
+			function(getGridTile(region, iTileSideLength, v3dLowerTile + v3dTile), uTile, uWorker);
+		});
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// The function is called as 'function(uTask, uWorker)' for every task in the range [0, uNoOfTasks), on the same threads as
+	/// forEachTile() and with the same rules about ordering and exceptions. Neighbouring task indices tend to run on the same
+	/// thread, so tasks which share data should be numbered together.
+	/// \param uNoOfTasks The number of tasks
+	/// \param function The function to call for each task
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Function>
+	void RegionScheduler::forEachTask(uint32_t uNoOfTasks, Function function)
+	{
+		if (!m_pPool)
+		{
+			for (uint32_t uTask = 0; uTask < uNoOfTasks; uTask++)
+			{
+				function(uTask, 0u);
+			}
+			return;
+		}
+
+		m_pPool->execute(uNoOfTasks, function);
+	}
+
+	inline void RegionScheduler::getTileGrid(const Region& region, int32_t iTileSideLength, Vector3DInt32& v3dLowerTile, Vector3DInt32& v3dNoOfTiles)
+	{
+		if (!region.isValid())
+		{
+			v3dLowerTile = Vector3DInt32(0, 0, 0);
+			v3dNoOfTiles = Vector3DInt32(0, 0, 0);
+			return;
+		}
+
+		v3dLowerTile = Vector3DInt32(floorDivide(region.getLowerX(), iTileSideLength), floorDivide(region.getLowerY(), iTileSideLength), floorDivide(region.getLowerZ(), iTileSideLength));
+		const Vector3DInt32 v3dUpperTile(floorDivide(region.getUpperX(), iTileSideLength), floorDivide(region.getUpperY(), iTileSideLength), floorDivide(region.getUpperZ(), iTileSideLength));
+		v3dNoOfTiles = v3dUpperTile - v3dLowerTile + Vector3DInt32(1, 1, 1);
+	}
+
+	inline Region RegionScheduler::getGridTile(const Region& region, int32_t iTileSideLength, const Vector3DInt32& v3dTile)
+	{
+		Region regTile(v3dTile.getX() * iTileSideLength, v3dTile.getY() * iTileSideLength, v3dTile.getZ() * iTileSideLength,
+			(v3dTile.getX() + 1) * iTileSideLength - 1, (v3dTile.getY() + 1) * iTileSideLength - 1, (v3dTile.getZ() + 1) * iTileSideLength - 1);
+		regTile.cropTo(region);
+		return regTile;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param scheduler The scheduler whose workers will use the values
+	/// \param args The arguments to construct each value with
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename Type>
+	template <typename... Args>
+	WorkerLocal<Type>::WorkerLocal(const RegionScheduler& scheduler, const Args&... args)
+	{
+		m_vecValues.reserve(scheduler.getNoOfThreads());
+		for (uint32_t ct = 0; ct < scheduler.getNoOfThreads(); ct++)
+		{
+			m_vecValues.emplace_back(new Type(args...));
+		}
+	}
+
+	template <typename Type>
+	Type& WorkerLocal<Type>::get(uint32_t uWorker)
+	{
+		POLYVOX_ASSERT(uWorker < m_vecValues.size(), "Worker index is out of range");
+		return *m_vecValues[uWorker];
+	}
+
+	template <typename Type>
+	const Type& WorkerLocal<Type>::get(uint32_t uWorker) const
+	{
+		POLYVOX_ASSERT(uWorker < m_vecValues.size(), "Worker index is out of range");
+		return *m_vecValues[uWorker];
+	}
+
+	template <typename Type>
+	uint32_t WorkerLocal<Type>::getNoOfWorkers(void) const
+	{
+		return static_cast<uint32_t>(m_vecValues.size());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param scheduler The scheduler whose workers will access the volumes
+	/// \param pVolSrc The volume which is read
+	/// \param pVolDst The volume which is written, which can be the same as \a pVolSrc
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename SrcVolumeType, typename DstVolumeType>
+	VolumeLocks<SrcVolumeType, DstVolumeType>::VolumeLocks(const RegionScheduler& scheduler, const SrcVolumeType* pVolSrc, const DstVolumeType* pVolDst)
+		:m_pSrcMutex(nullptr)
+		,m_pDstMutex(nullptr)
+	{
+		if (scheduler.getNoOfThreads() <= 1)
+		{
+			return;
+		}
+
+		m_pSrcMutex = SrcVolumeType::SupportsConcurrentReads ? nullptr : &m_srcMutex;
+		m_pDstMutex = DstVolumeType::SupportsConcurrentWrites ? nullptr : &m_dstMutex;
+		if ((m_pSrcMutex || m_pDstMutex) && (static_cast<const void*>(pVolSrc) == static_cast<const void*>(pVolDst)))
+		{
+			m_pSrcMutex = &m_srcMutex;
+			m_pDstMutex = &m_srcMutex;
+		}
+	}
+
+	template <typename SrcVolumeType, typename DstVolumeType>
+	std::mutex* VolumeLocks<SrcVolumeType, DstVolumeType>::getSrcMutex(void) const
+	{
+		return m_pSrcMutex;
+	}
+
+	template <typename SrcVolumeType, typename DstVolumeType>
+	std::mutex* VolumeLocks<SrcVolumeType, DstVolumeType>::getDstMutex(void) const
+	{
+		return m_pDstMutex;
+	}
+}
@@ -0,0 +1,195 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_SparseVolume_H__
+#define __PolyVox_SparseVolume_H__
+
+#include "BaseVolume.h"
+#include "Impl/SparseVolumeNodes.h"
+#include "Region.h"
+#include "Vector.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace PolyVox
+{
+	/// The SparseVolume stores only the voxels which differ from a background value, so its memory usage is proportional to the number
+	/// of such 'active' voxels rather than to the size of the region they are spread over. This makes it a good fit for large, mostly
+	/// empty scenes such as scanned objects or narrow bands around a surface.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	///
+	/// The voxels are held in a shallow tree in the style of OpenVDB. Leaves cover 8x8x8 voxels, and are grouped by nodes which cover
+	/// 16x16x16 leaves, which are in turn grouped by nodes which cover 32x32x32 of those. Each leaf or node has a bitmask recording
+	/// which of its voxels or children exist, and stores only those. The top level nodes (each covering 4096 voxels per side) are kept
+	/// in a hash map, so like the PagedVolume the SparseVolume has no predefined size.
+	///
+	/// Reading a voxel which has never been written gives the background value, and writing the background value to a voxel
+	/// deactivates it, releasing any leaf or node which is left empty. Both the volume and its Sampler remember the leaf which they
+	/// last accessed, so accesses which stay close together (as in the surface extractors) rarely need to walk the tree.
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class SparseVolume : public BaseVolume<VoxelType>
+	{
+	private:
+		typedef SparseLeafNode<VoxelType, 3> LeafNode;
+		typedef SparseInternalNode<LeafNode, 4> LowerNode;
+		typedef SparseInternalNode<LowerNode, 5> UpperNode;
+
+	public:
+#ifndef SWIG
+#if defined(_MSC_VER)
+		class Sampler : public BaseVolume<VoxelType>::Sampler< SparseVolume<VoxelType> > //This line works on VS2010
+#else
+		class Sampler : public BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> > //This line works on GCC
+#endif
+		{
+		public:
+			Sampler(SparseVolume<VoxelType>* volume);
+			~Sampler();
+
+			inline VoxelType getVoxel(void) const;
+
+			void setPosition(const Vector3DInt32& v3dNewPos);
+			void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
+			inline bool setVoxel(VoxelType tValue);
+
+			void movePositiveX(void);
+			void movePositiveY(void);
+			void movePositiveZ(void);
+
+			void moveNegativeX(void);
+			void moveNegativeY(void);
+			void moveNegativeZ(void);
+
+			inline VoxelType peekVoxel1nx1ny1nz(void) const;
+			inline VoxelType peekVoxel1nx1ny0pz(void) const;
+			inline VoxelType peekVoxel1nx1ny1pz(void) const;
+			inline VoxelType peekVoxel1nx0py1nz(void) const;
+			inline VoxelType peekVoxel1nx0py0pz(void) const;
+			inline VoxelType peekVoxel1nx0py1pz(void) const;
+			inline VoxelType peekVoxel1nx1py1nz(void) const;
+			inline VoxelType peekVoxel1nx1py0pz(void) const;
+			inline VoxelType peekVoxel1nx1py1pz(void) const;
+
+			inline VoxelType peekVoxel0px1ny1nz(void) const;
+			inline VoxelType peekVoxel0px1ny0pz(void) const;
+			inline VoxelType peekVoxel0px1ny1pz(void) const;
+			inline VoxelType peekVoxel0px0py1nz(void) const;
+			inline VoxelType peekVoxel0px0py0pz(void) const;
+			inline VoxelType peekVoxel0px0py1pz(void) const;
+			inline VoxelType peekVoxel0px1py1nz(void) const;
+			inline VoxelType peekVoxel0px1py0pz(void) const;
+			inline VoxelType peekVoxel0px1py1pz(void) const;
+
+			inline VoxelType peekVoxel1px1ny1nz(void) const;
+			inline VoxelType peekVoxel1px1ny0pz(void) const;
+			inline VoxelType peekVoxel1px1ny1pz(void) const;
+			inline VoxelType peekVoxel1px0py1nz(void) const;
+			inline VoxelType peekVoxel1px0py0pz(void) const;
+			inline VoxelType peekVoxel1px0py1pz(void) const;
+			inline VoxelType peekVoxel1px1py1nz(void) const;
+			inline VoxelType peekVoxel1px1py0pz(void) const;
+			inline VoxelType peekVoxel1px1py1pz(void) const;
+
+		private:
+			// Reads a voxel near the current one, from the current leaf if it lies inside it.
+			VoxelType peekVoxel(int32_t iXOffset, int32_t iYOffset, int32_t iZOffset) const;
+
+			// The leaf containing the current position (null if there is none), looked up again if the
+			// volume has created or deleted leaves since it was last found.
+			const LeafNode* getCurrentLeaf(void) const;
+
+			mutable const LeafNode* m_pCurrentLeaf;
+			mutable uint32_t m_uStructureVersion;
+
+			//The current position within the leaf
+			int32_t m_iXPosInLeaf;
+			int32_t m_iYPosInLeaf;
+			int32_t m_iZPosInLeaf;
+		};
+#endif // SWIG
+
+	public:
+		/// Constructor for creating an empty volume, where every voxel has the given background value.
+		SparseVolume(VoxelType tBackground = VoxelType());
+		/// Destructor
+		~SparseVolume();
+
+		/// Gets the value of voxels which are not active.
+		VoxelType getBackgroundValue(void) const;
+
+		/// Gets a voxel at the position given by <tt>x,y,z</tt> coordinates
+		VoxelType getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const;
+		/// Gets a voxel at the position given by a 3D vector
+		VoxelType getVoxel(const Vector3DInt32& v3dPos) const;
+
+		/// Sets the voxel at the position given by <tt>x,y,z</tt> coordinates
+		void setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue);
+		/// Sets the voxel at the position given by a 3D vector
+		void setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue);
+
+		/// Gets the number of voxels which differ from the background value.
+		uint64_t getNoOfActiveVoxels(void) const;
+		/// Gets the smallest Region which contains all of the active voxels.
+		Region getActiveRegion(void) const;
+
+		/// Calculates approximatly how many bytes of memory the volume is currently using.
+		uint32_t calculateSizeInBytes(void);
+
+	protected:
+		/// Copy constructor
+		SparseVolume(const SparseVolume& rhs);
+
+		/// Assignment operator
+		SparseVolume& operator=(const SparseVolume& rhs);
+
+	private:
+		// The leaf containing the given position, or null if there is none.
+		const LeafNode* findLeaf(int32_t iXPos, int32_t iYPos, int32_t iZPos) const;
+
+		// The key of the top level node containing the given position.
+		static uint64_t getRootKey(int32_t iXPos, int32_t iYPos, int32_t iZPos);
+
+		std::unordered_map<uint64_t, std::unique_ptr<UpperNode> > m_mapRootNodes;
+
+		VoxelType m_tBackground;
+
+		// Incremented whenever a leaf is created or deleted, so that cached leaf pointers can tell if they may be out of date.
+		uint32_t m_uStructureVersion;
+
+		// The most recently accessed leaf (possibly null) and the position of that leaf in leaf-sized units.
+		mutable const LeafNode* m_pLastLeaf;
+		mutable uint32_t m_uLastLeafVersion;
+		mutable int32_t m_iLastLeafX;
+		mutable int32_t m_iLastLeafY;
+		mutable int32_t m_iLastLeafZ;
+	};
+}
+
+#include "SparseVolume.inl"
+#include "SparseVolumeSampler.inl"
+
+#endif //__PolyVox_SparseVolume_H__
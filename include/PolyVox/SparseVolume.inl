@@ -0,0 +1,260 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+namespace PolyVox
+{
+	////////////////////////////////////////////////////////////////////////////////
+	/// This constructor creates an empty volume, in which every voxel has the background value until it is written.
+	/// \param tBackground The value of voxels which are not active.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::SparseVolume(VoxelType tBackground)
+		:BaseVolume<VoxelType>()
+		, m_tBackground(tBackground)
+		, m_uStructureVersion(0)
+		, m_pLastLeaf(nullptr)
+		, m_uLastLeafVersion(0)
+		, m_iLastLeafX(0)
+		, m_iLastLeafY(0)
+		, m_iLastLeafZ(0)
+	{
+		// There are no leaves yet, so the cache correctly records that there is none at the origin.
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::SparseVolume(const SparseVolume<VoxelType>& /*rhs*/)
+	{
+		POLYVOX_THROW(not_implemented, "Volume copy constructor not implemented for performance reasons.");
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Destroys the volume and frees all of its nodes.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::~SparseVolume()
+	{
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This function should never be called. Copying volumes by value would be expensive, and we want to prevent users from doing
+	/// it by accident (such as when passing them as paramenters to functions). That said, there are times when you really do want to
+	/// make a copy of a volume and in this case you should look at the VolumeResampler.
+	///
+	/// \sa VolumeResampler
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	SparseVolume<VoxelType>& SparseVolume<VoxelType>::operator=(const SparseVolume<VoxelType>& /*rhs*/)
+	{
+		POLYVOX_THROW(not_implemented, "Volume assignment operator not implemented for performance reasons.");
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The value of voxels which have never been written, or which have been set back to this value.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getBackgroundValue(void) const
+	{
+		return m_tBackground;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param uXPos The \c x position of the voxel
+	/// \param uYPos The \c y position of the voxel
+	/// \param uZPos The \c z position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const
+	{
+		const LeafNode* pLeaf = findLeaf(uXPos, uYPos, uZPos);
+		if (pLeaf)
+		{
+			const VoxelType* pVoxel = pLeaf->findVoxel(LeafNode::getSlot(uXPos, uYPos, uZPos));
+			if (pVoxel)
+			{
+				return *pVoxel;
+			}
+		}
+		return m_tBackground;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos The 3D position of the voxel
+	/// \return The voxel value
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::getVoxel(const Vector3DInt32& v3dPos) const
+	{
+		return getVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Setting a voxel to the background value deactivates it, and frees any leaf or node which no longer contains active voxels.
+	/// \param uXPos the \c x position of the voxel
+	/// \param uYPos the \c y position of the voxel
+	/// \param uZPos the \c z position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::setVoxel(int32_t uXPos, int32_t uYPos, int32_t uZPos, VoxelType tValue)
+	{
+		const uint64_t uRootKey = getRootKey(uXPos, uYPos, uZPos);
+		auto itRootNode = m_mapRootNodes.find(uRootKey);
+
+		if (tValue == m_tBackground)
+		{
+			if ((itRootNode != m_mapRootNodes.end()) && itRootNode->second->eraseVoxel(uXPos, uYPos, uZPos))
+			{
+				if (itRootNode->second->isEmpty())
+				{
+					m_mapRootNodes.erase(itRootNode);
+				}
+
+				// The leaf may have been deleted. We don't track whether it was, as deactivating voxels is relatively rare.
+				m_uStructureVersion++;
+			}
+			return;
+		}
+
+		bool bCreated = false;
+		if (itRootNode == m_mapRootNodes.end())
+		{
+			itRootNode = m_mapRootNodes.emplace(uRootKey, std::unique_ptr<UpperNode>(new UpperNode)).first;
+			bCreated = true;
+		}
+
+		LeafNode* pLeaf = itRootNode->second->touchLeaf(uXPos, uYPos, uZPos, bCreated);
+		if (bCreated)
+		{
+			m_uStructureVersion++;
+		}
+
+		pLeaf->setVoxel(uXPos, uYPos, uZPos, tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \param v3dPos the 3D position of the voxel
+	/// \param tValue the value to which the voxel will be set
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::setVoxel(const Vector3DInt32& v3dPos, VoxelType tValue)
+	{
+		setVoxel(v3dPos.getX(), v3dPos.getY(), v3dPos.getZ(), tValue);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// \return The number of voxels which differ from the background value.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint64_t SparseVolume<VoxelType>::getNoOfActiveVoxels(void) const
+	{
+		uint64_t uNoOfActiveVoxels = 0;
+		for (const auto& rootNode : m_mapRootNodes)
+		{
+			uNoOfActiveVoxels += rootNode.second->getNoOfActiveVoxels();
+		}
+		return uNoOfActiveVoxels;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// This visits every active voxel, so it should not be called too often on large volumes.
+	/// \return The bounding box of the active voxels, or an invalid Region if there are none.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	Region SparseVolume<VoxelType>::getActiveRegion(void) const
+	{
+		Region regActive = Region::InvertedRegion();
+		auto accumulateVoxel = [&](int32_t iXPos, int32_t iYPos, int32_t iZPos, const VoxelType& /*tValue*/)
+		{
+			regActive.accumulate(iXPos, iYPos, iZPos);
+		};
+
+		for (const auto& rootNode : m_mapRootNodes)
+		{
+			// The root key keeps the position of the node in its low 60 bits, as three 20 bit signed values.
+			const uint64_t uKey = rootNode.first;
+			const int32_t iNodeX = static_cast<int32_t>(static_cast<uint32_t>(uKey << 12) & 0xFFFFF000) >> 12;
+			const int32_t iNodeY = static_cast<int32_t>(static_cast<uint32_t>((uKey >> 20) << 12) & 0xFFFFF000) >> 12;
+			const int32_t iNodeZ = static_cast<int32_t>(static_cast<uint32_t>((uKey >> 40) << 12) & 0xFFFFF000) >> 12;
+
+			const int32_t iNodeSideLength = 1 << UpperNode::uLog2SideLength;
+			rootNode.second->forEachActiveVoxel(iNodeX * iNodeSideLength, iNodeY * iNodeSideLength, iNodeZ * iNodeSideLength, accumulateVoxel);
+		}
+
+		return regActive;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	/// Calculate the memory usage of the volume.
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	uint32_t SparseVolume<VoxelType>::calculateSizeInBytes(void)
+	{
+		uint32_t uSizeInBytes = sizeof(SparseVolume<VoxelType>);
+		uSizeInBytes += static_cast<uint32_t>(m_mapRootNodes.bucket_count() * sizeof(void*));
+		for (const auto& rootNode : m_mapRootNodes)
+		{
+			uSizeInBytes += static_cast<uint32_t>(sizeof(rootNode)) + rootNode.second->calculateSizeInBytes();
+		}
+		return uSizeInBytes;
+	}
+
+	template <typename VoxelType>
+	const typename SparseVolume<VoxelType>::LeafNode* SparseVolume<VoxelType>::findLeaf(int32_t iXPos, int32_t iYPos, int32_t iZPos) const
+	{
+		const int32_t iLeafX = iXPos >> LeafNode::uLog2SideLength;
+		const int32_t iLeafY = iYPos >> LeafNode::uLog2SideLength;
+		const int32_t iLeafZ = iZPos >> LeafNode::uLog2SideLength;
+
+		if ((iLeafX == m_iLastLeafX) && (iLeafY == m_iLastLeafY) && (iLeafZ == m_iLastLeafZ) && (m_uLastLeafVersion == m_uStructureVersion))
+		{
+			return m_pLastLeaf;
+		}
+
+		auto itRootNode = m_mapRootNodes.find(getRootKey(iXPos, iYPos, iZPos));
+		m_pLastLeaf = (itRootNode != m_mapRootNodes.end()) ? itRootNode->second->findLeaf(iXPos, iYPos, iZPos) : nullptr;
+		m_uLastLeafVersion = m_uStructureVersion;
+		m_iLastLeafX = iLeafX;
+		m_iLastLeafY = iLeafY;
+		m_iLastLeafZ = iLeafZ;
+		return m_pLastLeaf;
+	}
+
+	template <typename VoxelType>
+	uint64_t SparseVolume<VoxelType>::getRootKey(int32_t iXPos, int32_t iYPos, int32_t iZPos)
+	{
+		// A 32 bit position gives a 20 bit top level node position, and three of these fit in the key.
+		const uint64_t uNodeX = static_cast<uint32_t>(iXPos >> UpperNode::uLog2SideLength) & 0xFFFFF;
+		const uint64_t uNodeY = static_cast<uint32_t>(iYPos >> UpperNode::uLog2SideLength) & 0xFFFFF;
+		const uint64_t uNodeZ = static_cast<uint32_t>(iZPos >> UpperNode::uLog2SideLength) & 0xFFFFF;
+		return uNodeX | (uNodeY << 20) | (uNodeZ << 40);
+	}
+}
@@ -0,0 +1,393 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#define LEAF_MASK ((1 << LeafNode::uLog2SideLength) - 1)
+
+namespace PolyVox
+{
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Sampler::Sampler(SparseVolume<VoxelType>* volume)
+		:BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >(volume)
+		, m_pCurrentLeaf(volume->findLeaf(0, 0, 0))
+		, m_uStructureVersion(volume->m_uStructureVersion)
+		, m_iXPosInLeaf(0)
+		, m_iYPosInLeaf(0)
+		, m_iZPosInLeaf(0)
+	{
+	}
+
+	template <typename VoxelType>
+	SparseVolume<VoxelType>::Sampler::~Sampler()
+	{
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::getVoxel(void) const
+	{
+		return peekVoxel(0, 0, 0);
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::setPosition(const Vector3DInt32& v3dNewPos)
+	{
+		setPosition(v3dNewPos.getX(), v3dNewPos.getY(), v3dNewPos.getZ());
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::setPosition(xPos, yPos, zPos);
+
+		// Then we find the leaf containing the new position.
+		m_iXPosInLeaf = xPos & LEAF_MASK;
+		m_iYPosInLeaf = yPos & LEAF_MASK;
+		m_iZPosInLeaf = zPos & LEAF_MASK;
+
+		m_pCurrentLeaf = this->mVolume->findLeaf(xPos, yPos, zPos);
+		m_uStructureVersion = this->mVolume->m_uStructureVersion;
+	}
+
+	template <typename VoxelType>
+	bool SparseVolume<VoxelType>::Sampler::setVoxel(VoxelType tValue)
+	{
+		// This may create or delete the current leaf, in which case getCurrentLeaf() will notice the new structure version.
+		this->mVolume->setVoxel(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume, tValue);
+		return true;
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveX(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::movePositiveX();
+
+		// Then we update the position within the leaf
+		if (m_iXPosInLeaf < LEAF_MASK)
+		{
+			//No need to find a new leaf.
+			++m_iXPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeX(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::moveNegativeX();
+
+		// Then we update the position within the leaf
+		if (m_iXPosInLeaf > 0)
+		{
+			//No need to find a new leaf.
+			--m_iXPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveY(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::movePositiveY();
+
+		// Then we update the position within the leaf
+		if (m_iYPosInLeaf < LEAF_MASK)
+		{
+			//No need to find a new leaf.
+			++m_iYPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeY(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::moveNegativeY();
+
+		// Then we update the position within the leaf
+		if (m_iYPosInLeaf > 0)
+		{
+			//No need to find a new leaf.
+			--m_iYPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::movePositiveZ(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::movePositiveZ();
+
+		// Then we update the position within the leaf
+		if (m_iZPosInLeaf < LEAF_MASK)
+		{
+			//No need to find a new leaf.
+			++m_iZPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	void SparseVolume<VoxelType>::Sampler::moveNegativeZ(void)
+	{
+		// Base version updates position.
+		BaseVolume<VoxelType>::template Sampler< SparseVolume<VoxelType> >::moveNegativeZ();
+
+		// Then we update the position within the leaf
+		if (m_iZPosInLeaf > 0)
+		{
+			//No need to find a new leaf.
+			--m_iZPosInLeaf;
+		}
+		else
+		{
+			//We've hit the leaf boundary. Just calling setPosition() is the easiest way to resolve this.
+			setPosition(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+		}
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny1nz(void) const
+	{
+		return peekVoxel(-1, -1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny0pz(void) const
+	{
+		return peekVoxel(-1, -1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1ny1pz(void) const
+	{
+		return peekVoxel(-1, -1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py1nz(void) const
+	{
+		return peekVoxel(-1, 0, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py0pz(void) const
+	{
+		return peekVoxel(-1, 0, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx0py1pz(void) const
+	{
+		return peekVoxel(-1, 0, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py1nz(void) const
+	{
+		return peekVoxel(-1, 1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py0pz(void) const
+	{
+		return peekVoxel(-1, 1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1nx1py1pz(void) const
+	{
+		return peekVoxel(-1, 1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny1nz(void) const
+	{
+		return peekVoxel(0, -1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny0pz(void) const
+	{
+		return peekVoxel(0, -1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1ny1pz(void) const
+	{
+		return peekVoxel(0, -1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py1nz(void) const
+	{
+		return peekVoxel(0, 0, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py0pz(void) const
+	{
+		return peekVoxel(0, 0, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px0py1pz(void) const
+	{
+		return peekVoxel(0, 0, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py1nz(void) const
+	{
+		return peekVoxel(0, 1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py0pz(void) const
+	{
+		return peekVoxel(0, 1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel0px1py1pz(void) const
+	{
+		return peekVoxel(0, 1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny1nz(void) const
+	{
+		return peekVoxel(1, -1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny0pz(void) const
+	{
+		return peekVoxel(1, -1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1ny1pz(void) const
+	{
+		return peekVoxel(1, -1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py1nz(void) const
+	{
+		return peekVoxel(1, 0, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py0pz(void) const
+	{
+		return peekVoxel(1, 0, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px0py1pz(void) const
+	{
+		return peekVoxel(1, 0, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py1nz(void) const
+	{
+		return peekVoxel(1, 1, -1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py0pz(void) const
+	{
+		return peekVoxel(1, 1, 0);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel1px1py1pz(void) const
+	{
+		return peekVoxel(1, 1, 1);
+	}
+
+	template <typename VoxelType>
+	VoxelType SparseVolume<VoxelType>::Sampler::peekVoxel(int32_t iXOffset, int32_t iYOffset, int32_t iZOffset) const
+	{
+		const int32_t iXPosInLeaf = m_iXPosInLeaf + iXOffset;
+		const int32_t iYPosInLeaf = m_iYPosInLeaf + iYOffset;
+		const int32_t iZPosInLeaf = m_iZPosInLeaf + iZOffset;
+
+		// Positions outside the current leaf (including negative ones) have bits set above the mask.
+		if (((iXPosInLeaf | iYPosInLeaf | iZPosInLeaf) & ~LEAF_MASK) == 0)
+		{
+			const LeafNode* pLeaf = getCurrentLeaf();
+			if (pLeaf)
+			{
+				const VoxelType* pVoxel = pLeaf->findVoxel(LeafNode::getSlot(iXPosInLeaf, iYPosInLeaf, iZPosInLeaf));
+				if (pVoxel)
+				{
+					return *pVoxel;
+				}
+			}
+			return this->mVolume->m_tBackground;
+		}
+
+		return this->mVolume->getVoxel(this->mXPosInVolume + iXOffset, this->mYPosInVolume + iYOffset, this->mZPosInVolume + iZOffset);
+	}
+
+	template <typename VoxelType>
+	const typename SparseVolume<VoxelType>::LeafNode* SparseVolume<VoxelType>::Sampler::getCurrentLeaf(void) const
+	{
+		if (m_uStructureVersion != this->mVolume->m_uStructureVersion)
+		{
+			m_pCurrentLeaf = this->mVolume->findLeaf(this->mXPosInVolume, this->mYPosInVolume, this->mZPosInVolume);
+			m_uStructureVersion = this->mVolume->m_uStructureVersion;
+		}
+		return m_pCurrentLeaf;
+	}
+}
+
+#undef LEAF_MASK
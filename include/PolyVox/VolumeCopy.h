@@ -0,0 +1,102 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_VolumeCopy_H__
+#define __PolyVox_VolumeCopy_H__
+
+#include "PagedVolume.h"
+#include "RawVolume.h"
+#include "Region.h"
+#include "Vector.h"
+
+namespace PolyVox
+{
+	/**
+	 * \file
+	 *
+	 * Volume copying
+	 *
+	 * copyVolume() copies a region of one volume into another, converting each voxel with \a static_cast if the voxel
+	 * types differ. Copies between the volume types which PolyVox provides work directly on their storage rather than
+	 * going through getVoxel() and setVoxel() for every voxel:
+	 *
+	 *   - RawVolume to RawVolume copies whole rows, using memcpy() when the voxel types match.
+	 *   - PagedVolume to PagedVolume copies whole chunks when the chunk sizes match and the source and destination are
+	 *     the same distance from a chunk boundary. Both chunks then share a Morton ordering, so chunks which are entirely
+	 *     covered are copied with a single memcpy() and partially covered ones without any per-voxel chunk lookups.
+	 *   - Copies between a RawVolume and a PagedVolume visit one chunk at a time and walk its rows in Morton order.
+	 *
+	 * Anything else (including regions which extend outside a RawVolume, and copies within a single PagedVolume) falls
+	 * back to copying one voxel at a time. The source and destination regions should not overlap if they are in the same
+	 * volume, and neither volume should be accessed from other threads during the copy.
+	 */
+
+	/// Copies \a regSrc from \a pVolSrc into \a pVolDst, with the lower corner of the region placed at \a v3dDstLowerCorner.
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void copyVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+	/// Implements copyVolume(). It is a friend of the volume classes so that it can access their storage directly.
+	class VolumeCopier
+	{
+	public:
+		template< typename SrcVolumeType, typename DstVolumeType >
+		static void copy(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, typename DstVoxelType >
+		static void copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, typename DstVoxelType >
+		static void copy(PagedVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, typename DstVoxelType >
+		static void copy(PagedVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, typename DstVoxelType >
+		static void copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		// The generic overload is a better match for the fixed chunk size volumes than the ones above, so they are forwarded to them explicitly.
+		template< typename SrcVoxelType, uint16_t SrcChunkSideLength, typename DstVoxelType, uint16_t DstChunkSideLength >
+		static void copy(PagedVolume<SrcVoxelType, SrcChunkSideLength>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType, DstChunkSideLength>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, uint16_t SrcChunkSideLength, typename DstVoxelType >
+		static void copy(PagedVolume<SrcVoxelType, SrcChunkSideLength>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename SrcVoxelType, typename DstVoxelType, uint16_t DstChunkSideLength >
+		static void copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType, DstChunkSideLength>* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+	private:
+		template< typename SrcVolumeType, typename DstVolumeType >
+		static void copyVoxelByVoxel(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner);
+
+		template< typename VoxelType >
+		static VoxelType* getRawVolumeRow(RawVolume<VoxelType>* pVolume, int32_t iXPos, int32_t iYPos, int32_t iZPos);
+
+		template< typename VoxelType, typename Function >
+		static void forEachChunk(PagedVolume<VoxelType>* pVolume, const Region& region, Function function);
+	};
+}
+
+#include "VolumeCopy.inl"
+
+#endif //__PolyVox_VolumeCopy_H__
@@ -0,0 +1,267 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "Impl/Morton.h"
+
+#include <cstring>
+
+namespace PolyVox
+{
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void copyVolume(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		VolumeCopier::copy(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+	}
+
+	// Converts a contiguous run of voxels in the same way as VolumeResampler always has, with a static_cast.
+	template< typename SrcVoxelType, typename DstVoxelType >
+	void convertVoxels(const SrcVoxelType* pSrc, DstVoxelType* pDst, uint32_t uCount)
+	{
+		for (uint32_t ct = 0; ct < uCount; ct++)
+		{
+			pDst[ct] = static_cast<DstVoxelType>(pSrc[ct]);
+		}
+	}
+
+	// When no conversion is needed the voxels are just copied. memmove() rather than memcpy() keeps shifts within a row safe.
+	template< typename VoxelType >
+	void convertVoxels(const VoxelType* pSrc, VoxelType* pDst, uint32_t uCount)
+	{
+		std::memmove(pDst, pSrc, uCount * sizeof(VoxelType));
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void VolumeCopier::copy(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		copyVoxelByVoxel(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+	}
+
+	template< typename SrcVoxelType, typename DstVoxelType >
+	void VolumeCopier::copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		Region regDst = regSrc;
+		regDst.shift(v3dDstLowerCorner - regSrc.getLowerCorner());
+
+		// Border values and out of range writes are left to the slow path.
+		if (!pVolSrc->getEnclosingRegion().containsRegion(regSrc) || !pVolDst->getEnclosingRegion().containsRegion(regDst))
+		{
+			copyVoxelByVoxel(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+			return;
+		}
+
+		const uint32_t uWidth = regSrc.getWidthInVoxels();
+		for (int32_t sz = regSrc.getLowerZ(), dz = regDst.getLowerZ(); sz <= regSrc.getUpperZ(); sz++, dz++)
+		{
+			for (int32_t sy = regSrc.getLowerY(), dy = regDst.getLowerY(); sy <= regSrc.getUpperY(); sy++, dy++)
+			{
+				convertVoxels(getRawVolumeRow(pVolSrc, regSrc.getLowerX(), sy, sz), getRawVolumeRow(pVolDst, regDst.getLowerX(), dy, dz), uWidth);
+			}
+		}
+	}
+
+	template< typename SrcVoxelType, typename DstVoxelType >
+	void VolumeCopier::copy(PagedVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		const Vector3DInt32 v3dOffset = v3dDstLowerCorner - regSrc.getLowerCorner();
+		const int32_t iChunkMask = pVolSrc->m_iChunkMask;
+
+		// Chunks can only be copied directly if they line up with each other. Fetching a destination chunk from the same
+		// volume could also page out the source chunk, so copies within a volume take the slow path as well.
+		if ((static_cast<void*>(pVolSrc) == static_cast<void*>(pVolDst)) || (pVolSrc->m_uChunkSideLength != pVolDst->m_uChunkSideLength) ||
+			((v3dOffset.getX() & iChunkMask) != 0) || ((v3dOffset.getY() & iChunkMask) != 0) || ((v3dOffset.getZ() & iChunkMask) != 0))
+		{
+			copyVoxelByVoxel(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+			return;
+		}
+
+		const uint8_t uPower = pVolSrc->m_uChunkSideLengthPower;
+		const int32_t iChunkSideLength = pVolSrc->m_uChunkSideLength;
+		const uint32_t uVoxelsPerChunk = iChunkSideLength * iChunkSideLength * iChunkSideLength;
+
+		forEachChunk(pVolSrc, regSrc, [&](typename PagedVolume<SrcVoxelType>::Chunk* pSrcChunk, const Region& regLocal, const Vector3DInt32& v3dChunkPos)
+		{
+			const Vector3DInt32 v3dDstChunkPos = v3dChunkPos + v3dOffset;
+			typename PagedVolume<DstVoxelType>::Chunk* pDstChunk = pVolDst->getChunk(v3dDstChunkPos.getX() >> uPower, v3dDstChunkPos.getY() >> uPower, v3dDstChunkPos.getZ() >> uPower);
+			pDstChunk->markDataModified();
+
+			const SrcVoxelType* pSrcData = pSrcChunk->getData();
+			DstVoxelType* pDstData = pDstChunk->getData();
+
+			if (regLocal.getWidthInVoxels() == iChunkSideLength && regLocal.getHeightInVoxels() == iChunkSideLength && regLocal.getDepthInVoxels() == iChunkSideLength)
+			{
+				convertVoxels(pSrcData, pDstData, uVoxelsPerChunk);
+				return;
+			}
+
+			// Both chunks use the same Morton ordering, so each voxel has the same index in both.
+			for (int32_t z = regLocal.getLowerZ(); z <= regLocal.getUpperZ(); z++)
+			{
+				for (int32_t y = regLocal.getLowerY(); y <= regLocal.getUpperY(); y++)
+				{
+					const uint32_t uRowIndex = MortonTables::y[y] | MortonTables::z[z];
+					for (int32_t x = regLocal.getLowerX(); x <= regLocal.getUpperX(); x++)
+					{
+						const uint32_t uIndex = uRowIndex | MortonTables::x[x];
+						pDstData[uIndex] = static_cast<DstVoxelType>(pSrcData[uIndex]);
+					}
+				}
+			}
+		});
+	}
+
+	template< typename SrcVoxelType, typename DstVoxelType >
+	void VolumeCopier::copy(PagedVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		Region regDst = regSrc;
+		regDst.shift(v3dDstLowerCorner - regSrc.getLowerCorner());
+		if (!pVolDst->getEnclosingRegion().containsRegion(regDst))
+		{
+			copyVoxelByVoxel(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+			return;
+		}
+
+		const Vector3DInt32 v3dOffset = v3dDstLowerCorner - regSrc.getLowerCorner();
+		forEachChunk(pVolSrc, regSrc, [&](typename PagedVolume<SrcVoxelType>::Chunk* pSrcChunk, const Region& regLocal, const Vector3DInt32& v3dChunkPos)
+		{
+			const SrcVoxelType* pSrcData = pSrcChunk->getData();
+			const Vector3DInt32 v3dDstPos = v3dChunkPos + v3dOffset;
+			for (int32_t z = regLocal.getLowerZ(); z <= regLocal.getUpperZ(); z++)
+			{
+				for (int32_t y = regLocal.getLowerY(); y <= regLocal.getUpperY(); y++)
+				{
+					DstVoxelType* pDstRow = getRawVolumeRow(pVolDst, v3dDstPos.getX() + regLocal.getLowerX(), v3dDstPos.getY() + y, v3dDstPos.getZ() + z);
+					const uint32_t uRowIndex = MortonTables::y[y] | MortonTables::z[z];
+					for (int32_t x = regLocal.getLowerX(); x <= regLocal.getUpperX(); x++)
+					{
+						*pDstRow++ = static_cast<DstVoxelType>(pSrcData[uRowIndex | MortonTables::x[x]]);
+					}
+				}
+			}
+		});
+	}
+
+	template< typename SrcVoxelType, typename DstVoxelType >
+	void VolumeCopier::copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		if (!pVolSrc->getEnclosingRegion().containsRegion(regSrc))
+		{
+			copyVoxelByVoxel(pVolSrc, regSrc, pVolDst, v3dDstLowerCorner);
+			return;
+		}
+
+		Region regDst = regSrc;
+		regDst.shift(v3dDstLowerCorner - regSrc.getLowerCorner());
+
+		const Vector3DInt32 v3dOffset = regSrc.getLowerCorner() - v3dDstLowerCorner;
+		forEachChunk(pVolDst, regDst, [&](typename PagedVolume<DstVoxelType>::Chunk* pDstChunk, const Region& regLocal, const Vector3DInt32& v3dChunkPos)
+		{
+			pDstChunk->markDataModified();
+			DstVoxelType* pDstData = pDstChunk->getData();
+			const Vector3DInt32 v3dSrcPos = v3dChunkPos + v3dOffset;
+			for (int32_t z = regLocal.getLowerZ(); z <= regLocal.getUpperZ(); z++)
+			{
+				for (int32_t y = regLocal.getLowerY(); y <= regLocal.getUpperY(); y++)
+				{
+					const SrcVoxelType* pSrcRow = getRawVolumeRow(pVolSrc, v3dSrcPos.getX() + regLocal.getLowerX(), v3dSrcPos.getY() + y, v3dSrcPos.getZ() + z);
+					const uint32_t uRowIndex = MortonTables::y[y] | MortonTables::z[z];
+					for (int32_t x = regLocal.getLowerX(); x <= regLocal.getUpperX(); x++)
+					{
+						pDstData[uRowIndex | MortonTables::x[x]] = static_cast<DstVoxelType>(*pSrcRow++);
+					}
+				}
+			}
+		});
+	}
+
+	template< typename SrcVoxelType, uint16_t SrcChunkSideLength, typename DstVoxelType, uint16_t DstChunkSideLength >
+	void VolumeCopier::copy(PagedVolume<SrcVoxelType, SrcChunkSideLength>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType, DstChunkSideLength>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		copy(static_cast<PagedVolume<SrcVoxelType>*>(pVolSrc), regSrc, static_cast<PagedVolume<DstVoxelType>*>(pVolDst), v3dDstLowerCorner);
+	}
+
+	template< typename SrcVoxelType, uint16_t SrcChunkSideLength, typename DstVoxelType >
+	void VolumeCopier::copy(PagedVolume<SrcVoxelType, SrcChunkSideLength>* pVolSrc, const Region& regSrc, RawVolume<DstVoxelType>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		copy(static_cast<PagedVolume<SrcVoxelType>*>(pVolSrc), regSrc, pVolDst, v3dDstLowerCorner);
+	}
+
+	template< typename SrcVoxelType, typename DstVoxelType, uint16_t DstChunkSideLength >
+	void VolumeCopier::copy(RawVolume<SrcVoxelType>* pVolSrc, const Region& regSrc, PagedVolume<DstVoxelType, DstChunkSideLength>* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		copy(pVolSrc, regSrc, static_cast<PagedVolume<DstVoxelType>*>(pVolDst), v3dDstLowerCorner);
+	}
+
+	template< typename SrcVolumeType, typename DstVolumeType >
+	void VolumeCopier::copyVoxelByVoxel(SrcVolumeType* pVolSrc, const Region& regSrc, DstVolumeType* pVolDst, const Vector3DInt32& v3dDstLowerCorner)
+	{
+		for (int32_t sz = regSrc.getLowerZ(), dz = v3dDstLowerCorner.getZ(); sz <= regSrc.getUpperZ(); sz++, dz++)
+		{
+			for (int32_t sy = regSrc.getLowerY(), dy = v3dDstLowerCorner.getY(); sy <= regSrc.getUpperY(); sy++, dy++)
+			{
+				for (int32_t sx = regSrc.getLowerX(), dx = v3dDstLowerCorner.getX(); sx <= regSrc.getUpperX(); sx++, dx++)
+				{
+					const typename SrcVolumeType::VoxelType& tSrcVoxel = pVolSrc->getVoxel(sx, sy, sz);
+					const typename DstVolumeType::VoxelType& tDstVoxel = static_cast<typename DstVolumeType::VoxelType>(tSrcVoxel);
+					pVolDst->setVoxel(dx, dy, dz, tDstVoxel);
+				}
+			}
+		}
+	}
+
+	// Gets a pointer to the given voxel, from which the rest of the row can be accessed. The position must be inside the volume.
+	template< typename VoxelType >
+	VoxelType* VolumeCopier::getRawVolumeRow(RawVolume<VoxelType>* pVolume, int32_t iXPos, int32_t iYPos, int32_t iZPos)
+	{
+		const Region& regValid = pVolume->m_regValidRegion;
+		POLYVOX_ASSERT(regValid.containsPoint(iXPos, iYPos, iZPos), "Position is outside the volume");
+		return pVolume->m_pData + (iXPos - regValid.getLowerX()) +
+			(iYPos - regValid.getLowerY()) * regValid.getWidthInVoxels() +
+			(iZPos - regValid.getLowerZ()) * regValid.getWidthInVoxels() * regValid.getHeightInVoxels();
+	}
+
+	// Calls 'function(pChunk, regLocal, v3dChunkPos)' for every chunk which intersects 'region', where 'regLocal' is the part of the
+	// region inside the chunk (in the chunk's own coordinates) and 'v3dChunkPos' is the position of the chunk's lower corner.
+	template< typename VoxelType, typename Function >
+	void VolumeCopier::forEachChunk(PagedVolume<VoxelType>* pVolume, const Region& region, Function function)
+	{
+		const uint8_t uPower = pVolume->m_uChunkSideLengthPower;
+		const int32_t iChunkSideLength = pVolume->m_uChunkSideLength;
+
+		for (int32_t iChunkZ = region.getLowerZ() >> uPower; iChunkZ <= (region.getUpperZ() >> uPower); iChunkZ++)
+		{
+			for (int32_t iChunkY = region.getLowerY() >> uPower; iChunkY <= (region.getUpperY() >> uPower); iChunkY++)
+			{
+				for (int32_t iChunkX = region.getLowerX() >> uPower; iChunkX <= (region.getUpperX() >> uPower); iChunkX++)
+				{
+					const Vector3DInt32 v3dChunkPos(iChunkX * iChunkSideLength, iChunkY * iChunkSideLength, iChunkZ * iChunkSideLength);
+					Region regLocal(v3dChunkPos, v3dChunkPos + Vector3DInt32(iChunkSideLength - 1, iChunkSideLength - 1, iChunkSideLength - 1));
+					regLocal.cropTo(region);
+					regLocal.shift(-v3dChunkPos.getX(), -v3dChunkPos.getY(), -v3dChunkPos.getZ());
+
+					function(pVolume->getChunk(iChunkX, iChunkY, iChunkZ), regLocal, v3dChunkPos);
+				}
+			}
+		}
+	}
+}
@@ -24,6 +24,8 @@
 
 #include "Impl/Interpolation.h"
 
+#include "VolumeCopy.h"
+
 #include <cmath>
 
 namespace PolyVox
@@ -67,18 +69,7 @@ namespace PolyVox
 	template< typename SrcVolumeType, typename DstVolumeType>
 	void VolumeResampler<SrcVolumeType, DstVolumeType>::resampleSameSize()
 	{
-		for (int32_t sz = m_regSrc.getLowerZ(), dz = m_regDst.getLowerZ(); dz <= m_regDst.getUpperZ(); sz++, dz++)
-		{
-			for (int32_t sy = m_regSrc.getLowerY(), dy = m_regDst.getLowerY(); dy <= m_regDst.getUpperY(); sy++, dy++)
-			{
-				for (int32_t sx = m_regSrc.getLowerX(), dx = m_regDst.getLowerX(); dx <= m_regDst.getUpperX(); sx++, dx++)
-				{
-					const typename SrcVolumeType::VoxelType& tSrcVoxel = m_pVolSrc->getVoxel(sx, sy, sz);
-					const typename DstVolumeType::VoxelType& tDstVoxel = static_cast<typename DstVolumeType::VoxelType>(tSrcVoxel);
-					m_pVolDst->setVoxel(dx, dy, dz, tDstVoxel);
-				}
-			}
-		}
+		copyVolume(m_pVolSrc, m_regSrc, m_pVolDst, m_regDst.getLowerCorner());
 	}
 
 	template< typename SrcVolumeType, typename DstVolumeType>
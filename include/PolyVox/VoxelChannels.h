@@ -0,0 +1,45 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 David Williams and Matthew Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_VoxelChannels_H__
+#define __PolyVox_VoxelChannels_H__
+
+namespace PolyVox
+{
+	/// Describes how a voxel type is split into the channels which a MultiChannelVolume stores separately.
+	////////////////////////////////////////////////////////////////////////////////
+	/// There is no default implementation. Voxel types which can be stored in a MultiChannelVolume specialise this class
+	/// (see MaterialDensityPair for an example), providing:
+	///
+	/// - The DensityType and MaterialType typedefs, giving the type of each channel.
+	/// - Static getDensity() and getMaterial() functions which extract the channels from a voxel.
+	/// - A static makeVoxel() function which builds a voxel from the value of each channel.
+	///
+	/// \sa MultiChannelVolume
+	////////////////////////////////////////////////////////////////////////////////
+	template <typename VoxelType>
+	class VoxelChannels;
+}
+
+#endif //__PolyVox_VoxelChannels_H__
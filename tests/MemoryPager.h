@@ -0,0 +1,77 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#ifndef __PolyVox_MemoryPager_H__
+#define __PolyVox_MemoryPager_H__
+
+#include "PolyVox/PagedVolume.h"
+#include "PolyVox/Region.h"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Keeps paged out chunks in memory, so that several volumes can be used at once without their files clashing. Chunks which
+// have never been paged out are filled with zeros, and the number of chunks which have been paged in is counted.
+template <typename VoxelType>
+class MemoryPager : public PolyVox::PagedVolume<VoxelType>::Pager
+{
+public:
+	MemoryPager() : m_uNoOfPageIns(0) {}
+
+	virtual void pageIn(const PolyVox::Region& region, typename PolyVox::PagedVolume<VoxelType>::Chunk* pChunk)
+	{
+		m_uNoOfPageIns++;
+		auto iter = m_mapChunks.find(getKey(region));
+		if (iter != m_mapChunks.end())
+		{
+			std::memcpy(pChunk->getData(), &(iter->second[0]), pChunk->getDataSizeInBytes());
+		}
+		else
+		{
+			std::memset(pChunk->getData(), 0, pChunk->getDataSizeInBytes());
+		}
+	}
+
+	virtual void pageOut(const PolyVox::Region& region, typename PolyVox::PagedVolume<VoxelType>::Chunk* pChunk)
+	{
+		std::vector<uint8_t>& vecData = m_mapChunks[getKey(region)];
+		vecData.resize(pChunk->getDataSizeInBytes());
+		std::memcpy(&vecData[0], pChunk->getData(), pChunk->getDataSizeInBytes());
+	}
+
+	uint32_t m_uNoOfPageIns;
+
+private:
+	static std::tuple<int32_t, int32_t, int32_t> getKey(const PolyVox::Region& region)
+	{
+		return std::make_tuple(region.getLowerX(), region.getLowerY(), region.getLowerZ());
+	}
+
+	std::map<std::tuple<int32_t, int32_t, int32_t>, std::vector<uint8_t> > m_mapChunks;
+};
+
+#endif //__PolyVox_MemoryPager_H__
@@ -99,4 +99,160 @@ void TestAmbientOcclusionGenerator::testExecute()
 	//calculateAmbientOcclusion(&volData, &ambientOcclusionResult, volData.getEnclosingRegion(), 32.0f, 8, [](uint8_t voxel){return voxel == 0;});
 }
 
+void TestAmbientOcclusionGenerator::testRegionLayout()
+{
+	//A region away from the origin, with a different size along each axis.
+	Region region(16, -8, 32, 31, -1, 63);
+	RawVolume<uint8_t> volData(region);
+
+	//Fill the half of the region with the larger x coordinates.
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX() + 8; x <= region.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, 1);
+			}
+		}
+	}
+
+	//The array is indexed by (x, y, z) relative to the lower corner of the region.
+	Array<3, uint8_t> ambientOcclusionResult(8, 4, 16);
+	IsVoxelTransparent isVoxelTransparent;
+	calculateAmbientOcclusion(&volData, &ambientOcclusionResult, region, 32.0f, 64, isVoxelTransparent);
+
+	for (uint32_t z = 0; z < ambientOcclusionResult.getDimension(2); z++)
+	{
+		for (uint32_t y = 0; y < ambientOcclusionResult.getDimension(1); y++)
+		{
+			for (uint32_t x = 0; x < ambientOcclusionResult.getDimension(0); x++)
+			{
+				//Elements inside the solid half are fully occluded, the others are not.
+				if (x < 4)
+				{
+					QVERIFY(ambientOcclusionResult(x, y, z) > 0);
+				}
+				else
+				{
+					QCOMPARE(static_cast<int>(ambientOcclusionResult(x, y, z)), 0);
+				}
+			}
+		}
+	}
+}
+
+void TestAmbientOcclusionGenerator::testExecuteParallel()
+{
+	const int32_t g_uVolumeSideLength = 64;
+	Region region(0, 0, 0, g_uVolumeSideLength - 1, g_uVolumeSideLength - 1, g_uVolumeSideLength - 1);
+
+	//Create empty volume
+	RawVolume<uint8_t> volData(region);
+
+	//Create two solid walls at opposite sides of the volume
+	for (int32_t z = 0; z < g_uVolumeSideLength; z++)
+	{
+		if ((z < 20) || (z > g_uVolumeSideLength - 20))
+		{
+			for (int32_t y = 0; y < g_uVolumeSideLength; y++)
+			{
+				for (int32_t x = 0; x < g_uVolumeSideLength; x++)
+				{
+					volData.setVoxel(x, y, z, 1);
+				}
+			}
+		}
+	}
+
+	const int32_t g_uArraySideLength = g_uVolumeSideLength / 2;
+	Array<3, uint8_t> ambientOcclusionResult(g_uArraySideLength, g_uArraySideLength, g_uArraySideLength);
+
+	IsVoxelTransparent isVoxelTransparent;
+	QBENCHMARK{
+		calculateAmbientOcclusionParallel(&volData, &ambientOcclusionResult, region, 32.0f, 255, isVoxelTransparent);
+	}
+
+	//The rays are drawn differently from calculateAmbientOcclusion(), but the results should show the same shape.
+	QCOMPARE(static_cast<int>(ambientOcclusionResult(16, 0, 16)), 173);
+	QCOMPARE(static_cast<int>(ambientOcclusionResult(16, 8, 16)), 112);
+	QCOMPARE(static_cast<int>(ambientOcclusionResult(16, 16, 16)), 102);
+	QCOMPARE(static_cast<int>(ambientOcclusionResult(16, 24, 16)), 118);
+	QCOMPARE(static_cast<int>(ambientOcclusionResult(16, 31, 16)), 168);
+
+	//The result must not depend on how many threads were used.
+	Array<3, uint8_t> singleThreadedResult(g_uArraySideLength, g_uArraySideLength, g_uArraySideLength);
+	calculateAmbientOcclusionParallel(&volData, &singleThreadedResult, region, 32.0f, 255, isVoxelTransparent, 1);
+	Array<3, uint8_t> multiThreadedResult(g_uArraySideLength, g_uArraySideLength, g_uArraySideLength);
+	calculateAmbientOcclusionParallel(&volData, &multiThreadedResult, region, 32.0f, 255, isVoxelTransparent, 3);
+	for (uint32_t ct = 0; ct < singleThreadedResult.getNoOfElements(); ct++)
+	{
+		QCOMPARE(singleThreadedResult.getRawData()[ct], multiThreadedResult.getRawData()[ct]);
+		QCOMPARE(singleThreadedResult.getRawData()[ct], ambientOcclusionResult.getRawData()[ct]);
+	}
+}
+
+void TestAmbientOcclusionGenerator::testIncrementalUpdate()
+{
+	const int32_t g_uVolumeSideLength = 64;
+	Region region(0, 0, 0, g_uVolumeSideLength - 1, g_uVolumeSideLength - 1, g_uVolumeSideLength - 1);
+	RawVolume<uint8_t> volData(region);
+
+	//A floor for the edits to cast shadows onto
+	for (int32_t z = 0; z < g_uVolumeSideLength; z++)
+	{
+		for (int32_t x = 0; x < g_uVolumeSideLength; x++)
+		{
+			volData.setVoxel(x, 0, z, 1);
+		}
+	}
+
+	const int32_t g_uArraySideLength = g_uVolumeSideLength / 2;
+	IsVoxelTransparent isVoxelTransparent;
+	AmbientOcclusionField<RawVolume<uint8_t>, IsVoxelTransparent> field(&volData, region, g_uArraySideLength, g_uArraySideLength, g_uArraySideLength, 8.0f, 32, isVoxelTransparent);
+	field.calculate();
+
+	//Build a small pillar and update only the part of the field around it.
+	Region regEdit(20, 1, 40, 22, 6, 42);
+	for (int32_t z = regEdit.getLowerZ(); z <= regEdit.getUpperZ(); z++)
+	{
+		for (int32_t y = regEdit.getLowerY(); y <= regEdit.getUpperY(); y++)
+		{
+			for (int32_t x = regEdit.getLowerX(); x <= regEdit.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, 1);
+			}
+		}
+	}
+
+	Region regAffectedElements;
+	QVERIFY(field.getAffectedElements(regEdit, regAffectedElements));
+	QVERIFY(regAffectedElements.getWidthInVoxels() < g_uArraySideLength);
+	QVERIFY(!field.getAffectedElements(Region(100, 100, 100, 101, 101, 101), regAffectedElements));
+
+	const uint8_t uValueBeforeUpdate = field.getResult()(12, 1, 20);
+
+	QBENCHMARK{
+		field.update(regEdit);
+	}
+
+	//The pillar should darken the space next to it.
+	QVERIFY(field.getResult()(12, 1, 20) < uValueBeforeUpdate);
+
+	//The updated field should match one which is computed from scratch.
+	AmbientOcclusionField<RawVolume<uint8_t>, IsVoxelTransparent> referenceField(&volData, region, g_uArraySideLength, g_uArraySideLength, g_uArraySideLength, 8.0f, 32, isVoxelTransparent);
+	referenceField.calculate();
+
+	for (int32_t z = 0; z < g_uArraySideLength; z++)
+	{
+		for (int32_t y = 0; y < g_uArraySideLength; y++)
+		{
+			for (int32_t x = 0; x < g_uArraySideLength; x++)
+			{
+				QCOMPARE(field.getResult()(x, y, z), referenceField.getResult()(x, y, z));
+			}
+		}
+	}
+}
+
 QTEST_MAIN(TestAmbientOcclusionGenerator)
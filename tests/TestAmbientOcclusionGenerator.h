@@ -33,6 +33,9 @@ class TestAmbientOcclusionGenerator: public QObject
 	
 	private slots:
 		void testExecute();
+		void testRegionLayout();
+		void testExecuteParallel();
+		void testIncrementalUpdate();
 };
 
 #endif
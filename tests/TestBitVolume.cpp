@@ -0,0 +1,298 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestBitVolume.h"
+
+#include "PolyVox/BitVolume.h"
+#include "PolyVox/CubicSurfaceExtractor.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <random>
+
+using namespace PolyVox;
+
+// Rows of 150 voxels span three words, and the lower corner is not a multiple of 64.
+const Region regTest(-37, -5, 3, 112, 9, 12);
+
+// Sets roughly one voxel in 'iOneIn' of the test region, in both volumes.
+void fillRandomly(BitVolume& volume, RawVolume<uint8_t>& reference, uint32_t uSeed, int32_t iOneIn)
+{
+	std::mt19937 rng(uSeed);
+	for (int32_t z = regTest.getLowerZ(); z <= regTest.getUpperZ(); z++)
+	{
+		for (int32_t y = regTest.getLowerY(); y <= regTest.getUpperY(); y++)
+		{
+			for (int32_t x = regTest.getLowerX(); x <= regTest.getUpperX(); x++)
+			{
+				const bool bValue = (rng() % iOneIn) == 0;
+				volume.setVoxel(x, y, z, bValue);
+				reference.setVoxel(x, y, z, bValue ? 1 : 0);
+			}
+		}
+	}
+}
+
+void TestBitVolume::testGetAndSet()
+{
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 1234, 2);
+
+	// Clear some of the voxels again, to check that writes only touch their own bit.
+	for (int32_t x = regTest.getLowerX(); x <= regTest.getUpperX(); x += 3)
+	{
+		volume.setVoxel(x, 0, 5, false);
+		reference.setVoxel(x, 0, 5, 0);
+	}
+
+	for (int32_t z = regTest.getLowerZ() - 1; z <= regTest.getUpperZ() + 1; z++)
+	{
+		for (int32_t y = regTest.getLowerY() - 1; y <= regTest.getUpperY() + 1; y++)
+		{
+			for (int32_t x = regTest.getLowerX() - 1; x <= regTest.getUpperX() + 1; x++)
+			{
+				QCOMPARE(volume.getVoxel(x, y, z), reference.getVoxel(x, y, z) != 0);
+			}
+		}
+	}
+
+	volume.setBorderValue(true);
+	QCOMPARE(volume.getVoxel(regTest.getUpperX() + 1, 0, 5), true);
+
+	// Eight voxels per byte, plus the padding at the end of each row.
+	QCOMPARE(volume.calculateSizeInBytes(), static_cast<uint32_t>(3 * 8 * regTest.getHeightInVoxels() * regTest.getDepthInVoxels()));
+}
+
+void TestBitVolume::testGetRow()
+{
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 4321, 3);
+
+	for (int32_t iBorder = 0; iBorder < 2; iBorder++)
+	{
+		volume.setBorderValue(iBorder != 0);
+		for (int32_t y = regTest.getLowerY() - 1; y <= regTest.getUpperY() + 1; y += 4)
+		{
+			for (int32_t x = regTest.getLowerX() - 70; x <= regTest.getUpperX() + 2; x++)
+			{
+				const uint64_t uRow = volume.getRow(x, y, 7);
+				for (int32_t bit = 0; bit < 64; bit++)
+				{
+					const bool bExpected = regTest.containsPoint(x + bit, y, 7) ? (reference.getVoxel(x + bit, y, 7) != 0) : (iBorder != 0);
+					QCOMPARE(((uRow >> bit) & 1) != 0, bExpected);
+				}
+			}
+		}
+	}
+
+	// Rows of every length and alignment can be written back, and only change the voxels they cover.
+	std::mt19937 rng(8765);
+	for (int32_t x = regTest.getLowerX(); x <= regTest.getUpperX(); x++)
+	{
+		const uint32_t uNoOfVoxels = (std::min)(static_cast<uint32_t>(regTest.getUpperX() - x + 1), 1 + static_cast<uint32_t>(rng() % 64));
+		const uint64_t uBits = (static_cast<uint64_t>(rng()) << 32) | rng();
+		volume.setRow(x, 4, 7, uBits, uNoOfVoxels);
+		for (uint32_t bit = 0; bit < uNoOfVoxels; bit++)
+		{
+			reference.setVoxel(x + bit, 4, 7, static_cast<uint8_t>((uBits >> bit) & 1));
+		}
+
+		for (int32_t iX = regTest.getLowerX(); iX <= regTest.getUpperX(); iX++)
+		{
+			QCOMPARE(volume.getVoxel(iX, 4, 7), reference.getVoxel(iX, 4, 7) != 0);
+		}
+		QCOMPARE(volume.getVoxel(x, 3, 7), reference.getVoxel(x, 3, 7) != 0);
+	}
+}
+
+void TestBitVolume::testBulkOperations()
+{
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 1111, 2);
+
+	// The other volume is offset from the first, so that its rows are not aligned with them.
+	Region regOther(regTest);
+	regOther.shift(Vector3DInt32(-29, 2, 1));
+	regOther.grow(4);
+	BitVolume other(regOther);
+	std::mt19937 rng(2222);
+	for (int32_t z = regOther.getLowerZ(); z <= regOther.getUpperZ(); z++)
+	{
+		for (int32_t y = regOther.getLowerY(); y <= regOther.getUpperY(); y++)
+		{
+			for (int32_t x = regOther.getLowerX(); x <= regOther.getUpperX(); x++)
+			{
+				other.setVoxel(x, y, z, (rng() % 2) == 0);
+			}
+		}
+	}
+
+	Region regCommon(regTest);
+	regCommon.cropTo(regOther);
+	Region regAnd(regCommon.getLowerX() + 3, regCommon.getLowerY(), regCommon.getLowerZ(), regCommon.getUpperX() - 5, regCommon.getUpperY() - 2, regCommon.getUpperZ());
+	Region regOr(regCommon.getLowerX() + 70, regCommon.getLowerY() + 1, regCommon.getLowerZ() + 1, regCommon.getLowerX() + 71, regCommon.getUpperY(), regCommon.getUpperZ() - 1);
+	Region regXor(regCommon.getLowerX(), regCommon.getLowerY() + 3, regCommon.getLowerZ() + 2, regCommon.getUpperX(), regCommon.getLowerY() + 6, regCommon.getLowerZ() + 5);
+	Region regFill(-20, -3, 4, 100, 4, 6);
+
+	volume.combine(other, regAnd, BitOperations::And);
+	volume.combine(other, regOr, BitOperations::Or);
+	volume.combine(other, regXor, BitOperations::Xor);
+	volume.fill(regFill, false);
+	volume.fill(Region(-1, 0, 5, 1, 0, 5), true);
+
+	uint64_t uExpectedCount = 0;
+	for (int32_t z = regTest.getLowerZ(); z <= regTest.getUpperZ(); z++)
+	{
+		for (int32_t y = regTest.getLowerY(); y <= regTest.getUpperY(); y++)
+		{
+			for (int32_t x = regTest.getLowerX(); x <= regTest.getUpperX(); x++)
+			{
+				bool bExpected = reference.getVoxel(x, y, z) != 0;
+				const bool bOther = other.getVoxel(x, y, z);
+				bExpected = regAnd.containsPoint(x, y, z) ? (bExpected && bOther) : bExpected;
+				bExpected = regOr.containsPoint(x, y, z) ? (bExpected || bOther) : bExpected;
+				bExpected = regXor.containsPoint(x, y, z) ? (bExpected != bOther) : bExpected;
+				bExpected = regFill.containsPoint(x, y, z) ? false : bExpected;
+				bExpected = Region(-1, 0, 5, 1, 0, 5).containsPoint(x, y, z) ? true : bExpected;
+				QCOMPARE(volume.getVoxel(x, y, z), bExpected);
+				uExpectedCount += bExpected ? 1 : 0;
+			}
+		}
+	}
+
+	QCOMPARE(volume.countSetVoxels(regTest), uExpectedCount);
+	QCOMPARE(volume.countSetVoxels(regFill), static_cast<uint64_t>(3));
+
+	// The padding bits must still be clear, or whole-word operations would see them.
+	QCOMPARE(volume.getRow(regTest.getUpperX(), 0, 5) >> 1, static_cast<uint64_t>(0));
+}
+
+void TestBitVolume::testFindFirstSetVoxel()
+{
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 3333, 200);
+
+	const Vector3DInt32 directions[] = { Vector3DInt32(1, 0, 0), Vector3DInt32(-1, 0, 0), Vector3DInt32(0, 1, 0),
+		Vector3DInt32(0, -1, 0), Vector3DInt32(0, 0, 1), Vector3DInt32(0, 0, -1) };
+
+	std::mt19937 rng(4444);
+	uint32_t uNoFound = 0;
+	for (int ct = 0; ct < 2000; ct++)
+	{
+		const Vector3DInt32 v3dStart(regTest.getLowerX() + static_cast<int32_t>(rng() % regTest.getWidthInVoxels()),
+			regTest.getLowerY() + static_cast<int32_t>(rng() % regTest.getHeightInVoxels()),
+			regTest.getLowerZ() + static_cast<int32_t>(rng() % regTest.getDepthInVoxels()));
+		const Vector3DInt32& v3dDirection = directions[ct % 6];
+
+		bool bExpectedFound = false;
+		Vector3DInt32 v3dExpected;
+		for (Vector3DInt32 v3dPos = v3dStart; regTest.containsPoint(v3dPos); v3dPos += v3dDirection)
+		{
+			if (reference.getVoxel(v3dPos) != 0)
+			{
+				bExpectedFound = true;
+				v3dExpected = v3dPos;
+				break;
+			}
+		}
+
+		Vector3DInt32 v3dResult;
+		const bool bFound = volume.findFirstSetVoxel(v3dStart, v3dDirection, v3dResult);
+		QCOMPARE(bFound, bExpectedFound);
+		if (bFound)
+		{
+			QCOMPARE(v3dResult, v3dExpected);
+		}
+		else
+		{
+			uNoFound++;
+		}
+	}
+
+	// Both outcomes should have been tested.
+	QVERIFY(uNoFound > 0);
+	QVERIFY(uNoFound < 2000);
+}
+
+void TestBitVolume::testSampler()
+{
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 5555, 2);
+	volume.setBorderValue(true);
+	reference.setBorderValue(1);
+
+	BitVolume::Sampler sampler(&volume);
+	RawVolume<uint8_t>::Sampler refSampler(&reference);
+	for (int32_t z = regTest.getLowerZ() - 1; z <= regTest.getUpperZ() + 1; z++)
+	{
+		for (int32_t y = regTest.getLowerY() - 1; y <= regTest.getUpperY() + 1; y++)
+		{
+			sampler.setPosition(regTest.getLowerX() - 1, y, z);
+			refSampler.setPosition(regTest.getLowerX() - 1, y, z);
+			for (int32_t x = regTest.getLowerX() - 1; x <= regTest.getUpperX() + 1; x++)
+			{
+				QCOMPARE(sampler.getVoxel(), refSampler.getVoxel() != 0);
+				QCOMPARE(sampler.peekVoxel1nx1ny1nz(), refSampler.peekVoxel1nx1ny1nz() != 0);
+				QCOMPARE(sampler.peekVoxel1px0py1nz(), refSampler.peekVoxel1px0py1nz() != 0);
+				QCOMPARE(sampler.peekVoxel0px1py0pz(), refSampler.peekVoxel0px1py0pz() != 0);
+				QCOMPARE(sampler.peekVoxel1nx1py1pz(), refSampler.peekVoxel1nx1py1pz() != 0);
+				sampler.movePositiveX();
+				refSampler.movePositiveX();
+			}
+		}
+	}
+
+	sampler.setPosition(0, 0, 5);
+	QCOMPARE(sampler.setVoxel(!sampler.getVoxel()), true);
+	QCOMPARE(volume.getVoxel(0, 0, 5), reference.getVoxel(0, 0, 5) == 0);
+	sampler.setPosition(regTest.getUpperCorner() + Vector3DInt32(1, 0, 0));
+	QCOMPARE(sampler.setVoxel(false), false);
+}
+
+void TestBitVolume::testCubicSurfaceExtraction()
+{
+	// An occupancy volume should give the same faces as the equivalent RawVolume<uint8_t>.
+	BitVolume volume(regTest);
+	RawVolume<uint8_t> reference(regTest);
+	fillRandomly(volume, reference, 6666, 3);
+
+	auto bitMesh = extractCubicMesh(&volume, regTest);
+	auto rawMesh = extractCubicMesh(&reference, regTest);
+
+	QVERIFY(bitMesh.getNoOfVertices() > 0);
+	QCOMPARE(bitMesh.getNoOfVertices(), rawMesh.getNoOfVertices());
+	QCOMPARE(bitMesh.getNoOfIndices(), rawMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < bitMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(bitMesh.getVertex(ct).encodedPosition, rawMesh.getVertex(ct).encodedPosition);
+	}
+}
+
+QTEST_MAIN(TestBitVolume)
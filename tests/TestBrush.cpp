@@ -0,0 +1,241 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestBrush.h"
+
+#include "MemoryPager.h"
+
+#include "PolyVox/Brush.h"
+#include "PolyVox/PagedVolume.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <cmath>
+
+using namespace PolyVox;
+
+// A pattern with plenty of empty voxels, so that the Replace operation has something to leave alone.
+uint8_t testValue(int32_t x, int32_t y, int32_t z)
+{
+	const int32_t iValue = (x * 7 + y * 13 + z * 29) & 0xFF;
+	return (iValue % 3 == 0) ? 0 : static_cast<uint8_t>(iValue);
+}
+
+template <typename VolumeType>
+void fillVolume(VolumeType* pVolume, const Region& region)
+{
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				pVolume->setVoxel(x, y, z, testValue(x, y, z));
+			}
+		}
+	}
+}
+
+// Applies the brush to a volume filled by fillVolume(), and compares every voxel of 'regCheck' (and the returned region) with
+// the result of evaluating the brush one voxel at a time. Voxels outside 'regValid' are expected to be left alone.
+template <typename VolumeType, typename BrushType>
+bool checkBrush(VolumeType* pVolume, const Region& regValid, const Region& regCheck, const BrushType& brush, BrushOperation eOperation)
+{
+	const uint8_t uValue = 200;
+	fillVolume(pVolume, regValid);
+	const Region regResult = applyBrush(pVolume, brush, eOperation, uValue);
+
+	Region regExpected = Region::InvertedRegion();
+	for (int32_t z = regCheck.getLowerZ(); z <= regCheck.getUpperZ(); z++)
+	{
+		for (int32_t y = regCheck.getLowerY(); y <= regCheck.getUpperY(); y++)
+		{
+			for (int32_t x = regCheck.getLowerX(); x <= regCheck.getUpperX(); x++)
+			{
+				uint8_t uExpected = testValue(x, y, z);
+				if (regValid.containsPoint(x, y, z) && brush.getBounds().containsPoint(x, y, z) &&
+					(brush.getSignedDistance(Vector3DFloat(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z))) <= 0.0f))
+				{
+					regExpected.accumulate(x, y, z);
+					if (eOperation == BrushOperations::Union)
+					{
+						uExpected = uValue;
+					}
+					else if (eOperation == BrushOperations::Subtract)
+					{
+						uExpected = 0;
+					}
+					else if (uExpected != 0)
+					{
+						uExpected = uValue;
+					}
+				}
+
+				const uint8_t uActual = regValid.containsPoint(x, y, z) ? pVolume->getVoxel(x, y, z) : testValue(x, y, z);
+				if (uActual != uExpected)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return regResult == regExpected;
+}
+
+template <typename BrushType>
+bool checkBrushOnAllVolumes(const BrushType& brush, BrushOperation eOperation)
+{
+	const Region regValid(-30, -20, -25, 33, 40, 30);
+	Region regCheck(regValid);
+	regCheck.grow(2);
+
+	RawVolume<uint8_t> volRaw(regValid);
+	RawVolume<uint8_t, RawVolumeLayouts::Bricked> volBricked(regValid);
+	MemoryPager<uint8_t> pager;
+	PagedVolume<uint8_t> volPaged(&pager, 1024 * 1024, 16);
+	MemoryPager<uint8_t> dedupPager;
+	PagedVolume<uint8_t> volDedup(&dedupPager, 1024 * 1024, 8);
+	volDedup.setChunkDeduplicationEnabled(true);
+	MemoryPager<uint8_t> fixedPager;
+	PagedVolume<uint8_t, 32> volFixed(&fixedPager, 1024 * 1024);
+
+	// The paged volumes have no edges, so the whole of the brush is checked.
+	Region regPagedValid(regValid);
+	regPagedValid.accumulate(brush.getBounds());
+	Region regPagedCheck(regPagedValid);
+	regPagedCheck.grow(2);
+
+	return checkBrush(&volRaw, regValid, regCheck, brush, eOperation) &&
+		checkBrush(&volBricked, regValid, regCheck, brush, eOperation) &&
+		checkBrush(&volPaged, regPagedValid, regPagedCheck, brush, eOperation) &&
+		checkBrush(&volDedup, regPagedValid, regPagedCheck, brush, eOperation) &&
+		checkBrush(&volFixed, regPagedValid, regPagedCheck, brush, eOperation);
+}
+
+void TestBrush::testShapes()
+{
+	QVERIFY(checkBrushOnAllVolumes(BoxBrush(Region(-13, -7, 2, 21, 30, 17)), BrushOperations::Union));
+	QVERIFY(checkBrushOnAllVolumes(BoxBrush(Region(5, 5, 5, 5, 5, 5)), BrushOperations::Union));
+	QVERIFY(checkBrushOnAllVolumes(SphereBrush(Vector3DFloat(0.0f, 8.0f, 3.0f), 15.0f), BrushOperations::Union));
+	QVERIFY(checkBrushOnAllVolumes(SphereBrush(Vector3DFloat(-3.3f, 17.8f, 0.5f), 9.6f), BrushOperations::Union));
+	QVERIFY(checkBrushOnAllVolumes(CapsuleBrush(Vector3DFloat(-20.0f, -10.0f, -15.0f), Vector3DFloat(25.0f, 33.0f, 20.0f), 4.5f), BrushOperations::Union));
+	QVERIFY(checkBrushOnAllVolumes(CapsuleBrush(Vector3DFloat(1.0f, 2.0f, 3.0f), Vector3DFloat(1.0f, 2.0f, 3.0f), 6.0f), BrushOperations::Union));
+
+	// A torus, which isn't one of the built in shapes.
+	auto torus = [](const Vector3DFloat& v3dPos)
+	{
+		const float fRing = std::sqrt(v3dPos.getX() * v3dPos.getX() + v3dPos.getZ() * v3dPos.getZ()) - 16.0f;
+		return std::sqrt(fRing * fRing + (v3dPos.getY() - 10.0f) * (v3dPos.getY() - 10.0f)) - 5.0f;
+	};
+	QVERIFY(checkBrushOnAllVolumes(makeSdfBrush(Region(-21, 5, -21, 21, 15, 21), torus), BrushOperations::Union));
+
+	// Bounds which cut through the shape.
+	QVERIFY(checkBrushOnAllVolumes(makeSdfBrush(Region(-21, 5, -21, 0, 12, 21), torus), BrushOperations::Union));
+}
+
+void TestBrush::testOperations()
+{
+	const SphereBrush sphere(Vector3DFloat(3.0f, 4.0f, 5.0f), 18.0f);
+	QVERIFY(checkBrushOnAllVolumes(sphere, BrushOperations::Subtract));
+	QVERIFY(checkBrushOnAllVolumes(sphere, BrushOperations::Replace));
+
+	const BoxBrush box(Region(-16, -16, -16, 15, 31, 15));
+	QVERIFY(checkBrushOnAllVolumes(box, BrushOperations::Subtract));
+	QVERIFY(checkBrushOnAllVolumes(box, BrushOperations::Replace));
+
+	// Carving a tunnel through a filled block, and filling a region.
+	MemoryPager<uint8_t> pager;
+	PagedVolume<uint8_t> volume(&pager, 1024 * 1024, 16);
+	fillRegion(&volume, Region(0, 0, 0, 63, 63, 63), static_cast<uint8_t>(1));
+	applyBrush(&volume, CapsuleBrush(Vector3DFloat(-10.0f, 32.0f, 32.0f), Vector3DFloat(80.0f, 32.0f, 32.0f), 8.0f), BrushOperations::Subtract, static_cast<uint8_t>(1));
+	QCOMPARE(volume.getVoxel(0, 32, 32), static_cast<uint8_t>(0));
+	QCOMPARE(volume.getVoxel(63, 39, 35), static_cast<uint8_t>(0));
+	QCOMPARE(volume.getVoxel(63, 41, 32), static_cast<uint8_t>(1));
+	QCOMPARE(volume.getVoxel(30, 10, 50), static_cast<uint8_t>(1));
+}
+
+void TestBrush::testClipping()
+{
+	// Voxels outside a RawVolume are ignored rather than being an error.
+	RawVolume<uint8_t> volRaw(Region(0, 0, 0, 15, 15, 15));
+	Region regAffected = applyBrush(&volRaw, SphereBrush(Vector3DFloat(0.0f, 0.0f, 0.0f), 10.0f), BrushOperations::Union, static_cast<uint8_t>(1));
+	QCOMPARE(regAffected, Region(0, 0, 0, 10, 10, 10));
+	QCOMPARE(volRaw.getVoxel(0, 0, 10), static_cast<uint8_t>(1));
+	QCOMPARE(volRaw.getVoxel(5, 5, 5), static_cast<uint8_t>(1));
+	QCOMPARE(volRaw.getVoxel(6, 6, 6), static_cast<uint8_t>(0));
+
+	regAffected = applyBrush(&volRaw, SphereBrush(Vector3DFloat(-20.0f, 0.0f, 0.0f), 5.0f), BrushOperations::Union, static_cast<uint8_t>(1));
+	QVERIFY(!regAffected.isValid());
+
+	// Chunks in the corners of a sphere's bounds aren't touched, so they aren't paged in.
+	MemoryPager<uint8_t> pager;
+	PagedVolume<uint8_t> volPaged(&pager, 64 * 1024 * 1024, 16);
+	applyBrush(&volPaged, SphereBrush(Vector3DFloat(0.0f, 0.0f, 0.0f), 60.0f), BrushOperations::Union, static_cast<uint8_t>(1));
+	QVERIFY(pager.m_uNoOfPageIns < 8 * 8 * 8);
+
+	// The same goes for volumes with a fixed chunk size, which should take the same path.
+	MemoryPager<uint8_t> fixedPager;
+	PagedVolume<uint8_t, 32> volFixed(&fixedPager, 64 * 1024 * 1024);
+	applyBrush(&volFixed, SphereBrush(Vector3DFloat(0.0f, 0.0f, 0.0f), 120.0f), BrushOperations::Union, static_cast<uint8_t>(1));
+	QVERIFY(fixedPager.m_uNoOfPageIns < 8 * 8 * 8);
+	QCOMPARE(volFixed.getVoxel(0, 0, 120), static_cast<uint8_t>(1));
+	QCOMPARE(volFixed.getVoxel(70, 70, 70), static_cast<uint8_t>(0));
+}
+
+void TestBrush::testPerformance()
+{
+	MemoryPager<uint8_t> pager;
+	PagedVolume<uint8_t> volume(&pager, 64 * 1024 * 1024, 32);
+	const SphereBrush sphere(Vector3DFloat(0.0f, 0.0f, 0.0f), 60.0f);
+	const Region regBounds = sphere.getBounds();
+
+	// For comparison, testing every voxel and setting the ones inside the sphere.
+	QBENCHMARK{
+		for (int32_t z = regBounds.getLowerZ(); z <= regBounds.getUpperZ(); z++)
+		{
+			for (int32_t y = regBounds.getLowerY(); y <= regBounds.getUpperY(); y++)
+			{
+				for (int32_t x = regBounds.getLowerX(); x <= regBounds.getUpperX(); x++)
+				{
+					if (sphere.getSignedDistance(Vector3DFloat(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z))) <= 0.0f)
+					{
+						volume.setVoxel(x, y, z, 1);
+					}
+				}
+			}
+		}
+	}
+
+	QBENCHMARK{
+		applyBrush(&volume, sphere, BrushOperations::Union, static_cast<uint8_t>(2));
+	}
+
+	QCOMPARE(volume.getVoxel(0, 0, 0), static_cast<uint8_t>(2));
+	QCOMPARE(volume.getVoxel(60, 0, 0), static_cast<uint8_t>(2));
+	QCOMPARE(volume.getVoxel(60, 1, 0), static_cast<uint8_t>(0));
+}
+
+QTEST_MAIN(TestBrush)
@@ -0,0 +1,342 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestConnectedComponents.h"
+
+#include "PolyVox/ConnectedComponents.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <map>
+
+using namespace PolyVox;
+
+class IsVoxelSolid
+{
+public:
+	bool operator()(uint8_t voxel) const
+	{
+		return voxel != 0;
+	}
+};
+
+typedef ConnectedComponentLabeller<RawVolume<uint8_t>, RawVolume<uint32_t>, IsVoxelSolid> TestLabeller;
+
+// Checks that two label volumes split the voxels into the same components, even if the labels themselves differ.
+bool hasSameComponents(const RawVolume<uint32_t>& volLabels, const RawVolume<uint32_t>& volReferenceLabels, const Region& region)
+{
+	std::map<uint32_t, uint32_t> mapToReference;
+	std::map<uint32_t, uint32_t> mapFromReference;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				const uint32_t uLabel = volLabels.getVoxel(x, y, z);
+				const uint32_t uReferenceLabel = volReferenceLabels.getVoxel(x, y, z);
+				if ((uLabel == 0) || (uReferenceLabel == 0))
+				{
+					if (uLabel != uReferenceLabel)
+					{
+						return false;
+					}
+					continue;
+				}
+
+				auto toReference = mapToReference.insert(std::make_pair(uLabel, uReferenceLabel));
+				auto fromReference = mapFromReference.insert(std::make_pair(uReferenceLabel, uLabel));
+				if ((toReference.first->second != uReferenceLabel) || (fromReference.first->second != uLabel))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// Checks that the bounds and sizes reported for the components match the label volume.
+bool hasCorrectComponents(const TestLabeller& labeller, const RawVolume<uint32_t>& volLabels)
+{
+	std::map<uint32_t, ConnectedComponent> mapComponents;
+	const Region& region = labeller.getBounds();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				const uint32_t uLabel = volLabels.getVoxel(x, y, z);
+				if (uLabel != 0)
+				{
+					mapComponents[uLabel].region.accumulate(x, y, z);
+					mapComponents[uLabel].uNoOfVoxels++;
+				}
+			}
+		}
+	}
+
+	if (labeller.getComponentLabels().size() != mapComponents.size() || labeller.getNoOfComponents() != mapComponents.size())
+	{
+		return false;
+	}
+
+	for (const auto& component : mapComponents)
+	{
+		const ConnectedComponent& labelledComponent = labeller.getComponent(component.first);
+		if ((labelledComponent.uLabel != component.first) || (labelledComponent.region != component.second.region) || (labelledComponent.uNoOfVoxels != component.second.uNoOfVoxels))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void fillRandomly(RawVolume<uint8_t>& volData, uint32_t uPercentSolid, uint32_t uSeed)
+{
+	const Region& region = volData.getEnclosingRegion();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				uSeed = uSeed * 1103515245 + 12345;
+				volData.setVoxel(x, y, z, ((uSeed >> 16) % 100 < uPercentSolid) ? 1 : 0);
+			}
+		}
+	}
+}
+
+void TestConnectedComponents::testConnectivity()
+{
+	Region region(0, 0, 0, 63, 63, 63);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint32_t> volLabels(region);
+
+	// Pairs of voxels which share a face, an edge and a corner, each pair straddling the edge of a chunk.
+	volData.setVoxel(31, 5, 5, 1);
+	volData.setVoxel(32, 5, 5, 1);
+	volData.setVoxel(31, 20, 20, 1);
+	volData.setVoxel(32, 21, 20, 1);
+	volData.setVoxel(31, 31, 40, 1);
+	volData.setVoxel(32, 32, 41, 1);
+
+	TestLabeller sixConnected(&volData, &volLabels, region, IsVoxelSolid(), SixConnected);
+	sixConnected.calculate();
+	QCOMPARE(sixConnected.getNoOfComponents(), uint32_t(5));
+	QCOMPARE(volLabels.getVoxel(31, 5, 5), volLabels.getVoxel(32, 5, 5));
+	QVERIFY(volLabels.getVoxel(31, 20, 20) != volLabels.getVoxel(32, 21, 20));
+	QCOMPARE(volLabels.getVoxel(0, 0, 0), uint32_t(0));
+
+	TestLabeller eighteenConnected(&volData, &volLabels, region, IsVoxelSolid(), EighteenConnected);
+	eighteenConnected.calculate();
+	QCOMPARE(eighteenConnected.getNoOfComponents(), uint32_t(4));
+	QCOMPARE(volLabels.getVoxel(31, 20, 20), volLabels.getVoxel(32, 21, 20));
+	QVERIFY(volLabels.getVoxel(31, 31, 40) != volLabels.getVoxel(32, 32, 41));
+
+	TestLabeller twentySixConnected(&volData, &volLabels, region, IsVoxelSolid(), TwentySixConnected);
+	twentySixConnected.calculate();
+	QCOMPARE(twentySixConnected.getNoOfComponents(), uint32_t(3));
+	QCOMPARE(volLabels.getVoxel(31, 31, 40), volLabels.getVoxel(32, 32, 41));
+	QVERIFY(hasCorrectComponents(twentySixConnected, volLabels));
+
+	// Labels are given out in the order the components are first found.
+	const ConnectedComponent& component = twentySixConnected.getComponent(volLabels.getVoxel(31, 31, 40));
+	QCOMPARE(component.region, Region(31, 31, 40, 32, 32, 41));
+	QCOMPARE(component.uNoOfVoxels, uint32_t(2));
+}
+
+void TestConnectedComponents::testComponents()
+{
+	// Use negative coordinates and a size which isn't a multiple of the chunk size.
+	Region region(-40, -7, -30, 50, 60, 45);
+	RawVolume<uint8_t> volData(region);
+	fillRandomly(volData, 30, 12345);
+
+	// A ring which passes through several chunks, with a gap around it so that it isn't joined to anything else.
+	Region regRing(-35, -5, -25, 45, -5, 40);
+	for (int32_t z = regRing.getLowerZ() - 1; z <= regRing.getUpperZ() + 1; z++)
+	{
+		for (int32_t y = regRing.getLowerY() - 1; y <= regRing.getUpperY() + 1; y++)
+		{
+			for (int32_t x = regRing.getLowerX() - 1; x <= regRing.getUpperX() + 1; x++)
+			{
+				const bool bOnRing = (y == -5) && regRing.containsPoint(x, y, z) && ((x == -35) || (x == 45) || (z == -25) || (z == 40));
+				volData.setVoxel(x, y, z, bOnRing ? 1 : 0);
+			}
+		}
+	}
+
+	const Connectivity connectivities[] = { SixConnected, EighteenConnected, TwentySixConnected };
+	for (Connectivity eConnectivity : connectivities)
+	{
+		RawVolume<uint32_t> volLabels(region);
+		TestLabeller labeller(&volData, &volLabels, region, IsVoxelSolid(), eConnectivity, 3);
+		labeller.calculate();
+		QVERIFY(hasCorrectComponents(labeller, volLabels));
+
+		// The labels don't depend on the number of threads.
+		RawVolume<uint32_t> volSingleThreadedLabels(region);
+		TestLabeller singleThreadedLabeller(&volData, &volSingleThreadedLabels, region, IsVoxelSolid(), eConnectivity, 1);
+		singleThreadedLabeller.calculate();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					QCOMPARE(volLabels.getVoxel(x, y, z), volSingleThreadedLabels.getVoxel(x, y, z));
+				}
+			}
+		}
+
+		const ConnectedComponent& ring = labeller.getComponent(volLabels.getVoxel(-35, -5, -25));
+		QCOMPARE(ring.region, regRing);
+		QCOMPARE(ring.uNoOfVoxels, uint32_t(2 * 81 + 2 * 64));
+		QCOMPARE(volLabels.getVoxel(45, -5, 40), ring.uLabel);
+	}
+
+	// Six connected components are also eighteen connected, and so on.
+	RawVolume<uint32_t> volSixLabels(region);
+	RawVolume<uint32_t> volTwentySixLabels(region);
+	TestLabeller sixConnected(&volData, &volSixLabels, region, IsVoxelSolid(), SixConnected);
+	TestLabeller twentySixConnected(&volData, &volTwentySixLabels, region, IsVoxelSolid(), TwentySixConnected);
+	sixConnected.calculate();
+	twentySixConnected.calculate();
+	QVERIFY(sixConnected.getNoOfComponents() > twentySixConnected.getNoOfComponents());
+}
+
+void TestConnectedComponents::testUpdate()
+{
+	Region region(-20, 0, -20, 43, 47, 43);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint32_t> volLabels(region);
+	RawVolume<uint32_t> volReferenceLabels(region);
+
+	// A floor with two towers joined by a bridge, and some rubble.
+	fillRandomly(volData, 20, 54321);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+		{
+			volData.setVoxel(x, 0, z, 1);
+			for (int32_t y = 20; y <= 40; y++)
+			{
+				volData.setVoxel(x, y, z, 0);
+			}
+		}
+	}
+	for (int32_t y = 1; y <= 30; y++)
+	{
+		volData.setVoxel(0, y, 0, 1);
+		volData.setVoxel(30, y, 0, 1);
+	}
+	for (int32_t x = 0; x <= 30; x++)
+	{
+		volData.setVoxel(x, 30, 0, 1);
+	}
+
+	TestLabeller labeller(&volData, &volLabels, region, IsVoxelSolid(), SixConnected, 3);
+	TestLabeller referenceLabeller(&volData, &volReferenceLabels, region, IsVoxelSolid(), SixConnected, 1);
+	labeller.calculate();
+	const uint32_t uGround = volLabels.getVoxel(0, 0, 0);
+	QCOMPARE(volLabels.getVoxel(15, 30, 0), uGround);
+
+	// Each edit is applied incrementally and then compared against labels computed from scratch.
+	const Region edits[] =
+	{
+		Region(0, 25, 0, 0, 25, 0), // Break the first tower, which leaves the bridge held up by the second
+		Region(30, 22, 0, 30, 23, 0), // Break the second tower, leaving the bridge floating
+		Region(15, 30, 0, 15, 30, 0), // Break the bridge in two
+		Region(0, 25, 0, 0, 25, 0), // Repair the first tower
+		Region(-20, 10, -20, 43, 10, 43), // Add a layer which joins lots of the rubble together
+		Region(-20, 10, 5, 43, 10, 5), // And cut it in half
+		Region(20, 10, 20, 20, 10, 20), // Edit something which isn't connected to the ground
+	};
+	const uint8_t values[] = { 0, 0, 0, 1, 1, 0, 0 };
+
+	for (uint32_t uEdit = 0; uEdit < sizeof(values); uEdit++)
+	{
+		const Region& regEdit = edits[uEdit];
+		for (int32_t z = regEdit.getLowerZ(); z <= regEdit.getUpperZ(); z++)
+		{
+			for (int32_t y = regEdit.getLowerY(); y <= regEdit.getUpperY(); y++)
+			{
+				for (int32_t x = regEdit.getLowerX(); x <= regEdit.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, values[uEdit]);
+				}
+			}
+		}
+
+		const std::vector<uint32_t> vecNewLabels = labeller.update(regEdit);
+		referenceLabeller.calculate();
+
+		QVERIFY(hasSameComponents(volLabels, volReferenceLabels, region));
+		QVERIFY(hasCorrectComponents(labeller, volLabels));
+		QCOMPARE(labeller.getNoOfComponents(), referenceLabeller.getNoOfComponents());
+
+		// The new components all touch the edit.
+		Region regNeighbourhood = regEdit;
+		regNeighbourhood.grow(1);
+		for (uint32_t uLabel : vecNewLabels)
+		{
+			QVERIFY(intersects(labeller.getComponent(uLabel).region, regNeighbourhood));
+		}
+
+		if (uEdit == 1)
+		{
+			// The bridge has come away from the ground, and is one of the new components.
+			const uint32_t uBridge = volLabels.getVoxel(15, 30, 0);
+			QVERIFY(uBridge != volLabels.getVoxel(0, 0, 0));
+			QVERIFY(std::find(vecNewLabels.begin(), vecNewLabels.end(), uBridge) != vecNewLabels.end());
+			QCOMPARE(labeller.getComponent(uBridge).region, Region(0, 24, 0, 30, 30, 0));
+			QCOMPARE(labeller.getComponent(uBridge).uNoOfVoxels, uint32_t(31 + 4 + 6));
+		}
+	}
+
+	// Edits outside the bounds don't change anything.
+	QVERIFY(labeller.update(Region(100, 100, 100, 110, 110, 110)).empty());
+}
+
+void TestConnectedComponents::testPerformance()
+{
+	Region region(0, 0, 0, 127, 127, 127);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint32_t> volLabels(region);
+	fillRandomly(volData, 40, 98765);
+
+	TestLabeller labeller(&volData, &volLabels, region, IsVoxelSolid(), SixConnected);
+
+	QBENCHMARK{
+		labeller.calculate();
+	}
+
+	QVERIFY(hasCorrectComponents(labeller, volLabels));
+}
+
+QTEST_MAIN(TestConnectedComponents)
@@ -0,0 +1,236 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestConvolution.h"
+
+#include "PolyVox/Convolution.h"
+#include "PolyVox/Density.h"
+#include "PolyVox/LowPassFilter.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <random>
+
+using namespace PolyVox;
+
+namespace
+{
+	template <typename VolumeType, typename Distribution>
+	void fillWithNoise(VolumeType& volData, uint32_t uSeed, Distribution dist)
+	{
+		std::mt19937 rng(uSeed);
+		const Region& region = volData.getEnclosingRegion();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, static_cast<typename VolumeType::VoxelType>(dist(rng)));
+				}
+			}
+		}
+	}
+}
+
+void TestConvolution::testSeparableKernel()
+{
+	Region regVolume(-10, -10, -10, 29, 24, 19);
+	RawVolume<float> volData(regVolume);
+	fillWithNoise(volData, 111, std::uniform_real_distribution<float>(-1.0f, 1.0f));
+
+	// Blocks which don't divide the region, and a destination which is offset from the source.
+	Region regSrc(-8, -5, -3, 25, 20, 15);
+	Region regDst = regSrc;
+	regDst.shift(100, 50, -20);
+	RawVolume<float> volResult(regDst);
+
+	SeparableKernel<float> kernel = createGaussianKernel<float>(1.2f);
+	ConvolutionFilter< RawVolume<float>, RawVolume<float>, float > filter(&volData, regSrc, &volResult, regDst, 7);
+	filter.execute(kernel);
+
+	const Vector3DInt32 v3dRadius = kernel.getRadius();
+	QCOMPARE(v3dRadius, Vector3DInt32(4, 4, 4));
+	for (int32_t z = regSrc.getLowerZ(); z <= regSrc.getUpperZ(); z++)
+	{
+		for (int32_t y = regSrc.getLowerY(); y <= regSrc.getUpperY(); y++)
+		{
+			for (int32_t x = regSrc.getLowerX(); x <= regSrc.getUpperX(); x++)
+			{
+				double dExpected = 0.0;
+				for (int32_t dz = -v3dRadius.getZ(); dz <= v3dRadius.getZ(); dz++)
+				{
+					for (int32_t dy = -v3dRadius.getY(); dy <= v3dRadius.getY(); dy++)
+					{
+						for (int32_t dx = -v3dRadius.getX(); dx <= v3dRadius.getX(); dx++)
+						{
+							double dWeight = kernel.getWeightsX()[dx + 4] * kernel.getWeightsY()[dy + 4] * kernel.getWeightsZ()[dz + 4];
+							dExpected += dWeight * volData.getVoxel(x + dx, y + dy, z + dz);
+						}
+					}
+				}
+
+				float fResult = volResult.getVoxel(x + 100, y + 50, z - 20);
+				QVERIFY(std::abs(fResult - dExpected) < 1e-5);
+			}
+		}
+	}
+}
+
+void TestConvolution::testBoxKernel()
+{
+	Region region(0, 0, 0, 39, 29, 19);
+	RawVolume<int32_t> volData(region);
+	fillWithNoise(volData, 222, std::uniform_int_distribution<int32_t>(-1000, 1000));
+
+	// The box kernel should match the LowPassFilter exactly.
+	RawVolume<int32_t> volExpected(region);
+	LowPassFilter< RawVolume<int32_t>, RawVolume<int32_t>, int32_t > lowPassFilter(&volData, region, &volExpected, region, 5);
+	lowPassFilter.execute();
+
+	RawVolume<int32_t> volResult(region);
+	ConvolutionFilter< RawVolume<int32_t>, RawVolume<int32_t>, int32_t > filter(&volData, region, &volResult, region, 16);
+	filter.execute(createBoxKernel<int32_t>(5));
+
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				QCOMPARE(volResult.getVoxel(x, y, z), volExpected.getVoxel(x, y, z));
+			}
+		}
+	}
+}
+
+void TestConvolution::testDenseKernel()
+{
+	Region region(0, 0, 0, 35, 17, 9);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 333, std::uniform_int_distribution<int32_t>(0, 255));
+	RawVolume<Density8> volDensity(region);
+	fillWithNoise(volDensity, 333, std::uniform_int_distribution<int32_t>(0, 255));
+
+	RawVolume<uint8_t> volResult(region);
+	ConvolutionFilter< RawVolume<uint8_t>, RawVolume<uint8_t>, float > filter(&volData, region, &volResult, region);
+	filter.execute(createSharpenKernel<float>(0.5f));
+
+	// Densities go through the same code, converted by their traits.
+	RawVolume<Density8> volDensityResult(region);
+	ConvolutionFilter< RawVolume<Density8>, RawVolume<Density8>, float > densityFilter(&volDensity, region, &volDensityResult, region);
+	densityFilter.execute(createSharpenKernel<float>(0.5f));
+
+	uint32_t uNoOfClampedVoxels = 0;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				float fExpected = 4.0f * volData.getVoxel(x, y, z);
+				fExpected -= 0.5f * (volData.getVoxel(x - 1, y, z) + volData.getVoxel(x + 1, y, z));
+				fExpected -= 0.5f * (volData.getVoxel(x, y - 1, z) + volData.getVoxel(x, y + 1, z));
+				fExpected -= 0.5f * (volData.getVoxel(x, y, z - 1) + volData.getVoxel(x, y, z + 1));
+
+				// Sharpening overshoots, and the results should be clamped rather than wrapping around.
+				uint8_t uExpected;
+				if (fExpected <= 0.0f)
+				{
+					uExpected = 0;
+					uNoOfClampedVoxels++;
+				}
+				else if (fExpected >= 255.0f)
+				{
+					uExpected = 255;
+					uNoOfClampedVoxels++;
+				}
+				else
+				{
+					uExpected = static_cast<uint8_t>(fExpected + 0.5f);
+				}
+
+				QCOMPARE(volResult.getVoxel(x, y, z), uExpected);
+				QCOMPARE(volDensityResult.getVoxel(x, y, z), Density8(uExpected));
+			}
+		}
+	}
+	QVERIFY(uNoOfClampedVoxels > 0);
+}
+
+void TestConvolution::testGradientMagnitude()
+{
+	// A ramp with a gradient of (3, 4, 0), so the magnitude is five away from the edges.
+	Region region(0, 0, 0, 15, 15, 15);
+	RawVolume<uint16_t> volData(region);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, static_cast<uint16_t>(100 + x * 3 + y * 4));
+			}
+		}
+	}
+
+	RawVolume<float> volResult(region);
+	ConvolutionFilter< RawVolume<uint16_t>, RawVolume<float>, float > filter(&volData, region, &volResult, region, 5);
+	filter.executeGradientMagnitude();
+
+	for (int32_t z = 1; z < 15; z++)
+	{
+		for (int32_t y = 1; y < 15; y++)
+		{
+			for (int32_t x = 1; x < 15; x++)
+			{
+				QCOMPARE(volResult.getVoxel(x, y, z), 5.0f);
+			}
+		}
+	}
+	// At the edge the volume's border value of zero is part of the neighbourhood.
+	QVERIFY(volResult.getVoxel(0, 8, 8) > 5.0f);
+}
+
+void TestConvolution::testPerformance()
+{
+	Region region(0, 0, 0, 127, 127, 127);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 444, std::uniform_int_distribution<int32_t>(0, 255));
+	RawVolume<uint8_t> volResult(region);
+
+	ConvolutionFilter< RawVolume<uint8_t>, RawVolume<uint8_t>, float > filter(&volData, region, &volResult, region);
+	SeparableKernel<float> kernel = createGaussianKernel<float>(1.0f);
+	QBENCHMARK
+	{
+		filter.execute(kernel);
+	}
+
+	// Blurring noise brings everything towards the mean.
+	QVERIFY(volResult.getVoxel(64, 64, 64) > 64);
+	QVERIFY(volResult.getVoxel(64, 64, 64) < 192);
+}
+
+QTEST_MAIN(TestConvolution)
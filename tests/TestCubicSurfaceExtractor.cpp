@@ -187,4 +187,34 @@ void TestCubicSurfaceExtractor::testNoiseVolumePerformance()
 	QCOMPARE(noiseMesh.getNoOfVertices(), uint16_t(57905));
 }
 
+void TestCubicSurfaceExtractor::testUncheckedSampler()
+{
+	// The region is inside the RawVolume so the extractor skips the bounds checks, while the PagedVolume always
+	// needs them. Both should give exactly the same mesh.
+	RawVolume<uint32_t> rawVol(Region(0, 0, 0, 127, 127, 127));
+	createAndFillVolumeWithNoise(rawVol, 128, 0, 2);
+	FilePager<uint32_t>* filePager = new FilePager<uint32_t>();
+	PagedVolume<uint32_t> pagedVol(filePager);
+	createAndFillVolumeWithNoise(pagedVol, 128, 0, 2);
+
+	Mesh< CubicVertex< uint32_t > > rawMesh;
+	QBENCHMARK{ extractCubicMeshCustom(&rawVol, Region(32, 32, 32, 63, 63, 63), &rawMesh); }
+	Mesh< CubicVertex< uint32_t > > pagedMesh;
+	extractCubicMeshCustom(&pagedVol, Region(32, 32, 32, 63, 63, 63), &pagedMesh);
+
+	QVERIFY(rawMesh.getNoOfVertices() > 0);
+	QCOMPARE(rawMesh.getNoOfVertices(), pagedMesh.getNoOfVertices());
+	QCOMPARE(rawMesh.getNoOfIndices(), pagedMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < rawMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(rawMesh.getVertex(ct).encodedPosition, pagedMesh.getVertex(ct).encodedPosition);
+		QCOMPARE(rawMesh.getVertex(ct).data, pagedMesh.getVertex(ct).data);
+	}
+
+	// Touching the edge of the volume means the checks are needed again.
+	Mesh< CubicVertex< uint32_t > > rawEdgeMesh;
+	extractCubicMeshCustom(&rawVol, Region(96, 96, 96, 127, 127, 127), &rawEdgeMesh);
+	QVERIFY(rawEdgeMesh.getNoOfVertices() > 0);
+}
+
 QTEST_MAIN(TestCubicSurfaceExtractor)
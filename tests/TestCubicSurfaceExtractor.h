@@ -36,6 +36,7 @@ class TestCubicSurfaceExtractor: public QObject
 		void testEmptyVolumePerformance();
 		void testRealisticVolumePerformance();
 		void testNoiseVolumePerformance();
+		void testUncheckedSampler();
 };
 
 #endif
@@ -0,0 +1,239 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestDistanceField.h"
+
+#include "PolyVox/DistanceField.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <cmath>
+#include <random>
+
+using namespace PolyVox;
+
+namespace
+{
+	bool isVoxelInside(uint8_t voxel)
+	{
+		return voxel != 0;
+	}
+
+	void fillWithNoise(RawVolume<uint8_t>& volData, uint32_t uSeed, float fDensity)
+	{
+		std::mt19937 rng(uSeed);
+		std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+		const Region& region = volData.getEnclosingRegion();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, dist(rng) < fDensity ? 1 : 0);
+				}
+			}
+		}
+	}
+
+	// Finds the distance by checking every voxel, for comparison with the real implementation.
+	float bruteForceDistance(RawVolume<uint8_t>& volData, int32_t iX, int32_t iY, int32_t iZ, bool bToInside)
+	{
+		const Region& region = volData.getEnclosingRegion();
+		int32_t iBest = (std::numeric_limits<int32_t>::max)();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					if (isVoxelInside(volData.getVoxel(x, y, z)) == bToInside)
+					{
+						int32_t iDistSquared = (x - iX) * (x - iX) + (y - iY) * (y - iY) + (z - iZ) * (z - iZ);
+						iBest = (std::min)(iBest, iDistSquared);
+					}
+				}
+			}
+		}
+		return std::sqrt(static_cast<float>(iBest));
+	}
+
+	bool fieldsAreEqual(RawVolume<float>& volA, RawVolume<float>& volB)
+	{
+		const Region& region = volA.getEnclosingRegion();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					if (volA.getVoxel(x, y, z) != volB.getVoxel(x, y, z))
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
+
+void TestDistanceField::testUnsigned()
+{
+	Region region(-5, 3, 10, 14, 18, 21);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 12345, 0.01f);
+
+	RawVolume<float> volField(region);
+	calculateDistanceField(&volData, &volField, region, isVoxelInside);
+
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				QCOMPARE(volField.getVoxel(x, y, z), bruteForceDistance(volData, x, y, z, true));
+			}
+		}
+	}
+
+	// Capping the distance.
+	calculateDistanceField(&volData, &volField, region, isVoxelInside, 2.5f);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				QCOMPARE(volField.getVoxel(x, y, z), (std::min)(bruteForceDistance(volData, x, y, z, true), 2.5f));
+			}
+		}
+	}
+}
+
+void TestDistanceField::testSigned()
+{
+	Region region(0, 0, 0, 15, 15, 15);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 54321, 0.3f);
+
+	RawVolume<float> volField(region);
+	calculateSignedDistanceField(&volData, &volField, region, isVoxelInside);
+
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				bool bInside = isVoxelInside(volData.getVoxel(x, y, z));
+				float fExpected = bruteForceDistance(volData, x, y, z, !bInside) - 0.5f;
+				QCOMPARE(volField.getVoxel(x, y, z), bInside ? -fExpected : fExpected);
+			}
+		}
+	}
+
+	// A single voxel sits halfway between its own centre and its neighbours.
+	RawVolume<uint8_t> volSingle(region);
+	volSingle.setVoxel(8, 8, 8, 1);
+	calculateSignedDistanceField(&volSingle, &volField, region, isVoxelInside);
+	QCOMPARE(volField.getVoxel(8, 8, 8), -0.5f);
+	QCOMPARE(volField.getVoxel(9, 8, 8), 0.5f);
+	QCOMPARE(volField.getVoxel(12, 8, 8), 3.5f);
+	QCOMPARE(volField.getVoxel(11, 12, 8), 4.5f);
+}
+
+void TestDistanceField::testUpdate()
+{
+	Region region(0, 0, 0, 47, 47, 47);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 999, 0.002f);
+
+	const float fMaxDistance = 4.0f;
+	RawVolume<float> volField(region);
+	RawVolume<float> volSignedField(region);
+	calculateDistanceField(&volData, &volField, region, isVoxelInside, fMaxDistance);
+	calculateSignedDistanceField(&volData, &volSignedField, region, isVoxelInside, fMaxDistance);
+
+	// Carve out a box and add a wall, then update both fields.
+	Region regBox(20, 20, 20, 27, 29, 24);
+	for (int32_t z = regBox.getLowerZ(); z <= regBox.getUpperZ(); z++)
+	{
+		for (int32_t y = regBox.getLowerY(); y <= regBox.getUpperY(); y++)
+		{
+			for (int32_t x = regBox.getLowerX(); x <= regBox.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, (z == regBox.getLowerZ()) ? 1 : 0);
+			}
+		}
+	}
+	updateDistanceField(&volData, &volField, region, regBox, isVoxelInside, fMaxDistance);
+	updateSignedDistanceField(&volData, &volSignedField, region, regBox, isVoxelInside, fMaxDistance);
+
+	RawVolume<float> volExpected(region);
+	calculateDistanceField(&volData, &volExpected, region, isVoxelInside, fMaxDistance);
+	QVERIFY(fieldsAreEqual(volField, volExpected));
+	calculateSignedDistanceField(&volData, &volExpected, region, isVoxelInside, fMaxDistance);
+	QVERIFY(fieldsAreEqual(volSignedField, volExpected));
+
+	// An edit next to the edge of the bounds.
+	volData.setVoxel(0, 0, 0, 1);
+	updateSignedDistanceField(&volData, &volSignedField, region, Region(0, 0, 0, 0, 0, 0), isVoxelInside, fMaxDistance);
+	QVERIFY(fieldsAreEqual(volSignedField, volExpected) == false);
+	calculateSignedDistanceField(&volData, &volExpected, region, isVoxelInside, fMaxDistance);
+	QVERIFY(fieldsAreEqual(volSignedField, volExpected));
+}
+
+void TestDistanceField::testThreadCount()
+{
+	Region region(0, 0, 0, 63, 31, 47);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 2468, 0.05f);
+
+	RawVolume<float> volSingleThread(region);
+	RawVolume<float> volMultiThread(region);
+	calculateSignedDistanceField(&volData, &volSingleThread, region, isVoxelInside, 10.0f, 1);
+	calculateSignedDistanceField(&volData, &volMultiThread, region, isVoxelInside, 10.0f, 3);
+	QVERIFY(fieldsAreEqual(volSingleThread, volMultiThread));
+}
+
+void TestDistanceField::testPerformance()
+{
+	Region region(0, 0, 0, 127, 127, 127);
+	RawVolume<uint8_t> volData(region);
+	fillWithNoise(volData, 1357, 0.001f);
+	RawVolume<float> volField(region);
+
+	QBENCHMARK
+	{
+		calculateSignedDistanceField(&volData, &volField, region, isVoxelInside);
+	}
+
+	// A voxel can't be further from the surface than the diagonal of the volume.
+	QVERIFY(volField.getVoxel(64, 64, 64) < 222.0f);
+}
+
+QTEST_MAIN(TestDistanceField)
@@ -0,0 +1,198 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestLightPropagation.h"
+
+#include "PolyVox/LightPropagation.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+using namespace PolyVox;
+
+// Zero is air, one is stone and two is a torch.
+class TestLightController
+{
+public:
+	bool isTransparent(uint8_t voxel) const
+	{
+		return voxel == 0;
+	}
+
+	uint8_t getEmittedLight(uint8_t voxel) const
+	{
+		return (voxel == 2) ? 15 : 0;
+	}
+};
+
+typedef LightPropagator<RawVolume<uint8_t>, RawVolume<uint8_t>, TestLightController> TestLightPropagator;
+
+void TestLightPropagation::testBlockLight()
+{
+	Region region(0, 0, 0, 31, 31, 31);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint8_t> volLight(region);
+
+	volData.setVoxel(16, 16, 16, 2);
+	// A wall which the light has to go around.
+	for (int32_t y = 0; y < 32; y++)
+	{
+		for (int32_t x = 0; x < 32; x++)
+		{
+			if (x != 10)
+			{
+				volData.setVoxel(x, y, 12, 1);
+			}
+		}
+	}
+
+	TestLightPropagator propagator(&volData, &volLight, region);
+	propagator.calculate();
+
+	QCOMPARE(getBlockLight(volLight.getVoxel(16, 16, 16)), uint8_t(15));
+	QCOMPARE(getBlockLight(volLight.getVoxel(17, 16, 16)), uint8_t(14));
+	QCOMPARE(getBlockLight(volLight.getVoxel(20, 18, 16)), uint8_t(9));
+	QCOMPARE(getBlockLight(volLight.getVoxel(16, 16, 13)), uint8_t(12));
+	QCOMPARE(getBlockLight(volLight.getVoxel(16, 16, 12)), uint8_t(0)); // Inside the wall
+	QCOMPARE(getBlockLight(volLight.getVoxel(10, 16, 12)), uint8_t(5)); // In the gap in the wall
+	QCOMPARE(getBlockLight(volLight.getVoxel(13, 16, 11)), uint8_t(1)); // Around the wall
+	QCOMPARE(getBlockLight(volLight.getVoxel(16, 16, 11)), uint8_t(0)); // Too far around the wall
+	QCOMPARE(getBlockLight(volLight.getVoxel(0, 0, 31)), uint8_t(0));
+
+	// There is no roof so all the air is in full sky light.
+	QCOMPARE(getSkyLight(volLight.getVoxel(5, 0, 5)), uint8_t(15));
+	QCOMPARE(getSkyLight(volLight.getVoxel(16, 16, 16)), uint8_t(0));
+}
+
+void TestLightPropagation::testSkyLight()
+{
+	Region region(0, 0, 0, 31, 31, 31);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint8_t> volLight(region);
+
+	// A roof with a hole in it.
+	for (int32_t z = 0; z < 32; z++)
+	{
+		for (int32_t x = 0; x < 32; x++)
+		{
+			if ((x != 16) || (z != 16))
+			{
+				volData.setVoxel(x, 20, z, 1);
+			}
+		}
+	}
+
+	TestLightPropagator propagator(&volData, &volLight, region);
+	propagator.calculate();
+
+	QCOMPARE(getSkyLight(volLight.getVoxel(3, 25, 3)), uint8_t(15));
+	QCOMPARE(getSkyLight(volLight.getVoxel(16, 20, 16)), uint8_t(15));
+	QCOMPARE(getSkyLight(volLight.getVoxel(16, 0, 16)), uint8_t(15));
+	QCOMPARE(getSkyLight(volLight.getVoxel(20, 10, 16)), uint8_t(11));
+	QCOMPARE(getSkyLight(volLight.getVoxel(20, 10, 18)), uint8_t(9));
+	QCOMPARE(getSkyLight(volLight.getVoxel(0, 0, 0)), uint8_t(0));
+	QCOMPARE(getBlockLight(volLight.getVoxel(16, 0, 16)), uint8_t(0));
+}
+
+void TestLightPropagation::testIncrementalUpdate()
+{
+	// Use negative coordinates and a size which isn't a multiple of the chunk size.
+	Region region(-20, -10, -20, 27, 37, 27);
+	RawVolume<uint8_t> volData(region);
+	RawVolume<uint8_t> volLight(region);
+	RawVolume<uint8_t> volReferenceLight(region);
+	RawVolume<uint8_t> volSingleThreadedLight(region);
+
+	// Some caves, with a few torches in them.
+	uint32_t uSeed = 12345;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY() - 16; y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				uSeed = uSeed * 1103515245 + 12345;
+				const uint32_t uRandom = (uSeed >> 16) % 100;
+				volData.setVoxel(x, y, z, (uRandom < 70) ? 1 : ((uRandom < 71) ? 2 : 0));
+			}
+		}
+	}
+
+	TestLightPropagator propagator(&volData, &volLight, region, TestLightController(), 3);
+	propagator.calculate();
+
+	TestLightPropagator singleThreadedPropagator(&volData, &volSingleThreadedLight, region, TestLightController(), 1);
+	singleThreadedPropagator.calculate();
+
+	TestLightPropagator referencePropagator(&volData, &volReferenceLight, region, TestLightController(), 1);
+
+	// Each edit is applied incrementally and then compared against lighting computed from scratch.
+	const Region edits[] =
+	{
+		Region(0, 21, 0, 0, 21, 0), // Block a sky column just above the ground
+		Region(5, 5, 5, 9, 9, 9), // Clear out a cave
+		Region(5, 6, 5, 5, 6, 5), // Place a torch
+		Region(5, 6, 5, 5, 6, 5), // Remove it again
+		Region(-20, 10, -20, 27, 10, 27), // Put a roof over everything
+		Region(0, 10, 0, 1, 10, 1), // Make a hole in it
+	};
+	const uint8_t values[] = { 1, 0, 2, 0, 1, 0 };
+
+	for (uint32_t uEdit = 0; uEdit < sizeof(values); uEdit++)
+	{
+		const Region& regEdit = edits[uEdit];
+		for (int32_t z = regEdit.getLowerZ(); z <= regEdit.getUpperZ(); z++)
+		{
+			for (int32_t y = regEdit.getLowerY(); y <= regEdit.getUpperY(); y++)
+			{
+				for (int32_t x = regEdit.getLowerX(); x <= regEdit.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, values[uEdit]);
+				}
+			}
+		}
+
+		propagator.update(regEdit);
+		singleThreadedPropagator.update(regEdit);
+		referencePropagator.calculate();
+
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					QCOMPARE(volLight.getVoxel(x, y, z), volReferenceLight.getVoxel(x, y, z));
+					QCOMPARE(volSingleThreadedLight.getVoxel(x, y, z), volReferenceLight.getVoxel(x, y, z));
+				}
+			}
+		}
+	}
+
+	QBENCHMARK{
+		propagator.calculate();
+	}
+}
+
+QTEST_MAIN(TestLightPropagation)
@@ -24,12 +24,17 @@
 
 #include "TestLowPassFilter.h"
 
+#include "MemoryPager.h"
+
 #include "PolyVox/Density.h"
 #include "PolyVox/LowPassFilter.h"
+#include "PolyVox/PagedVolume.h"
 #include "PolyVox/RawVolume.h"
 
 #include <QtTest>
 
+#include <random>
+
 using namespace PolyVox;
 
 void TestLowPassFilter::testExecute()
@@ -88,4 +93,150 @@ void TestLowPassFilter::testExecute()
 	QCOMPARE(resultVolume.getVoxel(7, 7, 7), Density8(4));
 }
 
+void TestLowPassFilter::testKernelSizes()
+{
+	Region regVolume(-4, -4, -4, 19, 15, 11);
+	RawVolume<int32_t> volData(regVolume);
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int32_t> dist(-1000, 1000);
+	for (int32_t z = regVolume.getLowerZ(); z <= regVolume.getUpperZ(); z++)
+	{
+		for (int32_t y = regVolume.getLowerY(); y <= regVolume.getUpperY(); y++)
+		{
+			for (int32_t x = regVolume.getLowerX(); x <= regVolume.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, dist(rng));
+			}
+		}
+	}
+
+	// The destination is offset from the source, and both extend past the edges of the volumes.
+	Region regSrc(0, 0, 0, 15, 11, 7);
+	Region regDst(10, 20, 30, 25, 31, 37);
+	RawVolume<int32_t> resultVolume(regDst);
+
+	for (uint32_t uKernelSize = 3; uKernelSize <= 11; uKernelSize += 2)
+	{
+		LowPassFilter< RawVolume<int32_t>, RawVolume<int32_t>, int32_t > lowPassfilter(&volData, regSrc, &resultVolume, regDst, uKernelSize);
+		lowPassfilter.execute();
+
+		const int32_t iBorder = (uKernelSize - 1) / 2;
+		for (int32_t z = regSrc.getLowerZ(); z <= regSrc.getUpperZ(); z++)
+		{
+			for (int32_t y = regSrc.getLowerY(); y <= regSrc.getUpperY(); y++)
+			{
+				for (int32_t x = regSrc.getLowerX(); x <= regSrc.getUpperX(); x++)
+				{
+					int32_t iSum = 0;
+					for (int32_t dz = -iBorder; dz <= iBorder; dz++)
+					{
+						for (int32_t dy = -iBorder; dy <= iBorder; dy++)
+						{
+							for (int32_t dx = -iBorder; dx <= iBorder; dx++)
+							{
+								iSum += volData.getVoxel(x + dx, y + dy, z + dz);
+							}
+						}
+					}
+					int32_t iExpected = iSum / static_cast<int32_t>(uKernelSize * uKernelSize * uKernelSize);
+					QCOMPARE(resultVolume.getVoxel(x + 10, y + 20, z + 30), iExpected);
+				}
+			}
+		}
+	}
+}
+
+void TestLowPassFilter::testExecuteParallel()
+{
+	// Integers are used because floating point running sums depend on where each tile starts.
+	Region regVolume(-40, -40, -40, 79, 79, 79);
+	RawVolume<int32_t> volData(regVolume);
+	// A small memory limit, so that chunks are paged in and out while the threads are running.
+	MemoryPager<int32_t> srcPager;
+	PagedVolume<int32_t> volPagedData(&srcPager, 1024 * 1024, 16);
+	std::mt19937 rng(4321);
+	std::uniform_int_distribution<int32_t> dist(-1000, 1000);
+	for (int32_t z = regVolume.getLowerZ(); z <= regVolume.getUpperZ(); z++)
+	{
+		for (int32_t y = regVolume.getLowerY(); y <= regVolume.getUpperY(); y++)
+		{
+			for (int32_t x = regVolume.getLowerX(); x <= regVolume.getUpperX(); x++)
+			{
+				int32_t iValue = dist(rng);
+				volData.setVoxel(x, y, z, iValue);
+				volPagedData.setVoxel(x, y, z, iValue);
+			}
+		}
+	}
+
+	Region regSrc(-35, -30, -25, 70, 60, 50);
+	Region regDst = regSrc;
+	regDst.shift(3, -7, 11);
+
+	RawVolume<int32_t> volExpected(regDst);
+	LowPassFilter< RawVolume<int32_t>, RawVolume<int32_t>, int32_t > serialFilter(&volData, regSrc, &volExpected, regDst, 5);
+	serialFilter.execute();
+
+	// Tiles which don't divide the region exactly.
+	RawVolume<int32_t> volRawResult(regDst);
+	LowPassFilter< RawVolume<int32_t>, RawVolume<int32_t>, int32_t > rawFilter(&volData, regSrc, &volRawResult, regDst, 5);
+	rawFilter.executeParallel(3, 13);
+
+	// Paged volumes have to be accessed one thread at a time.
+	MemoryPager<int32_t> dstPager;
+	PagedVolume<int32_t> volPagedResult(&dstPager, 1024 * 1024, 16);
+	LowPassFilter< PagedVolume<int32_t>, PagedVolume<int32_t>, int32_t > pagedFilter(&volPagedData, regSrc, &volPagedResult, regDst, 5);
+	pagedFilter.executeParallel(3, 16);
+
+	for (int32_t z = regDst.getLowerZ(); z <= regDst.getUpperZ(); z++)
+	{
+		for (int32_t y = regDst.getLowerY(); y <= regDst.getUpperY(); y++)
+		{
+			for (int32_t x = regDst.getLowerX(); x <= regDst.getUpperX(); x++)
+			{
+				QCOMPARE(volRawResult.getVoxel(x, y, z), volExpected.getVoxel(x, y, z));
+				QCOMPARE(volPagedResult.getVoxel(x, y, z), volExpected.getVoxel(x, y, z));
+			}
+		}
+	}
+}
+
+void TestLowPassFilter::testPerformance()
+{
+	Region reg(0, 0, 0, 127, 127, 127);
+	RawVolume<float> volData(reg);
+	std::mt19937 rng(5678);
+	std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+	for (int32_t z = reg.getLowerZ(); z <= reg.getUpperZ(); z++)
+	{
+		for (int32_t y = reg.getLowerY(); y <= reg.getUpperY(); y++)
+		{
+			for (int32_t x = reg.getLowerX(); x <= reg.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, dist(rng));
+			}
+		}
+	}
+
+	RawVolume<float> resultVolume(reg);
+
+	// The time taken should not depend on the kernel size.
+	LowPassFilter< RawVolume<float>, RawVolume<float>, float > smallFilter(&volData, reg, &resultVolume, reg, 3);
+	QBENCHMARK{
+		smallFilter.execute();
+	}
+
+	LowPassFilter< RawVolume<float>, RawVolume<float>, float > largeFilter(&volData, reg, &resultVolume, reg, 15);
+	QBENCHMARK{
+		largeFilter.execute();
+	}
+
+	QBENCHMARK{
+		largeFilter.executeParallel();
+	}
+
+	QVERIFY(resultVolume.getVoxel(64, 64, 64) > 0.4f);
+	QVERIFY(resultVolume.getVoxel(64, 64, 64) < 0.6f);
+}
+
 QTEST_MAIN(TestLowPassFilter)
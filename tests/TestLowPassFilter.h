@@ -33,6 +33,9 @@ class TestLowPassFilter: public QObject
 	
 	private slots:
 		void testExecute();
+		void testKernelSizes();
+		void testExecuteParallel();
+		void testPerformance();
 };
 
 #endif
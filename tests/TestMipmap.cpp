@@ -0,0 +1,249 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestMipmap.h"
+
+#include "PolyVox/Material.h"
+#include "PolyVox/Mipmap.h"
+#include "PolyVox/RawVolume.h"
+#include "PolyVox/VolumeResampler.h"
+
+#include <QtTest>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+
+using namespace PolyVox;
+
+namespace
+{
+	template <typename VolumeType, typename Distribution>
+	void fillWithNoise(VolumeType& volData, uint32_t uSeed, Distribution dist)
+	{
+		std::mt19937 rng(uSeed);
+		const Region& region = volData.getEnclosingRegion();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+		{
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+			{
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, static_cast<typename VolumeType::VoxelType>(dist(rng)));
+				}
+			}
+		}
+	}
+
+	// Gets the voxels of the 2x2x2 block under (x,y,z) which are inside 'regSrc'.
+	template <typename VolumeType>
+	std::vector<typename VolumeType::VoxelType> getBlock(VolumeType& volSrc, const Region& regSrc, int32_t x, int32_t y, int32_t z)
+	{
+		std::vector<typename VolumeType::VoxelType> vecBlock;
+		for (int32_t iZ = z * 2; iZ <= z * 2 + 1; iZ++)
+		{
+			for (int32_t iY = y * 2; iY <= y * 2 + 1; iY++)
+			{
+				for (int32_t iX = x * 2; iX <= x * 2 + 1; iX++)
+				{
+					if (regSrc.containsPoint(iX, iY, iZ))
+					{
+						vecBlock.push_back(volSrc.getVoxel(iX, iY, iZ));
+					}
+				}
+			}
+		}
+		return vecBlock;
+	}
+
+	// Builds volumes for each level of a mipmap chain.
+	template <typename VoxelType>
+	std::vector< std::unique_ptr< RawVolume<VoxelType> > > createLevels(const Region& regBase, uint32_t uNoOfLevels)
+	{
+		std::vector< std::unique_ptr< RawVolume<VoxelType> > > vecLevels;
+		for (uint32_t uLevel = 1; uLevel <= uNoOfLevels; uLevel++)
+		{
+			vecLevels.emplace_back(new RawVolume<VoxelType>(getMipmapRegion(regBase, uLevel)));
+		}
+		return vecLevels;
+	}
+
+	template <typename VoxelType>
+	std::vector< RawVolume<VoxelType>* > getPointers(const std::vector< std::unique_ptr< RawVolume<VoxelType> > >& vecLevels)
+	{
+		std::vector< RawVolume<VoxelType>* > vecPointers;
+		for (auto& pLevel : vecLevels)
+		{
+			vecPointers.push_back(pLevel.get());
+		}
+		return vecPointers;
+	}
+}
+
+void TestMipmap::testRegions()
+{
+	Region regBase(-7, 0, 3, 62, 31, 36);
+	QCOMPARE(getMipmapRegion(regBase, 0), regBase);
+	QCOMPARE(getMipmapRegion(regBase, 1), Region(-4, 0, 1, 31, 15, 18));
+	QCOMPARE(getMipmapRegion(regBase, 2), Region(-2, 0, 0, 15, 7, 9));
+	QCOMPARE(getMipmapRegion(regBase, 6), Region(-1, 0, 0, 0, 0, 0));
+}
+
+void TestMipmap::testAverage()
+{
+	// Odd sizes and negative coordinates give incomplete blocks on several sides.
+	Region regBase(-7, -2, 3, 62, 40, 36);
+	RawVolume<uint8_t> volData(regBase);
+	fillWithNoise(volData, 1234, std::uniform_int_distribution<int32_t>(0, 255));
+
+	auto vecLevels = createLevels<uint8_t>(regBase, 3);
+	generateMipmaps(&volData, regBase, getPointers(vecLevels), MipmapModes::Average, 3);
+
+	RawVolume<uint8_t>* pVolSrc = &volData;
+	Region regSrc = regBase;
+	for (auto& pLevel : vecLevels)
+	{
+		const Region regLevel = getMipmapRegion(regSrc, 1);
+		for (int32_t z = regLevel.getLowerZ(); z <= regLevel.getUpperZ(); z++)
+		{
+			for (int32_t y = regLevel.getLowerY(); y <= regLevel.getUpperY(); y++)
+			{
+				for (int32_t x = regLevel.getLowerX(); x <= regLevel.getUpperX(); x++)
+				{
+					auto vecBlock = getBlock(*pVolSrc, regSrc, x, y, z);
+					uint32_t uSum = 0;
+					for (uint8_t uValue : vecBlock)
+					{
+						uSum += uValue;
+					}
+					uint8_t uExpected = static_cast<uint8_t>((uSum + vecBlock.size() / 2) / vecBlock.size());
+					QCOMPARE(pLevel->getVoxel(x, y, z), uExpected);
+				}
+			}
+		}
+
+		pVolSrc = pLevel.get();
+		regSrc = regLevel;
+	}
+}
+
+void TestMipmap::testMinimumAndMaximum()
+{
+	Region regBase(0, 0, 0, 40, 33, 17);
+	RawVolume<float> volData(regBase);
+	fillWithNoise(volData, 5678, std::uniform_real_distribution<float>(-100.0f, 100.0f));
+
+	const Region regLevel = getMipmapRegion(regBase, 1);
+	RawVolume<float> volMinimum(regLevel);
+	RawVolume<float> volMaximum(regLevel);
+	downsampleVolume(&volData, regBase, &volMinimum, MipmapModes::Minimum);
+	downsampleVolume(&volData, regBase, &volMaximum, MipmapModes::Maximum);
+
+	for (int32_t z = regLevel.getLowerZ(); z <= regLevel.getUpperZ(); z++)
+	{
+		for (int32_t y = regLevel.getLowerY(); y <= regLevel.getUpperY(); y++)
+		{
+			for (int32_t x = regLevel.getLowerX(); x <= regLevel.getUpperX(); x++)
+			{
+				auto vecBlock = getBlock(volData, regBase, x, y, z);
+				QCOMPARE(volMinimum.getVoxel(x, y, z), *std::min_element(vecBlock.begin(), vecBlock.end()));
+				QCOMPARE(volMaximum.getVoxel(x, y, z), *std::max_element(vecBlock.begin(), vecBlock.end()));
+			}
+		}
+	}
+}
+
+void TestMipmap::testMajority()
+{
+	Region regBase(0, 0, 0, 7, 7, 7);
+	RawVolume<Material8> volData(regBase);
+
+	// Five of one material and three of another.
+	for (int32_t z = 0; z < 2; z++)
+	{
+		for (int32_t y = 0; y < 2; y++)
+		{
+			for (int32_t x = 0; x < 2; x++)
+			{
+				volData.setVoxel(x, y, z, Material8(((x + y + z) < 2) ? 3 : 7));
+			}
+		}
+	}
+	// A tie, which goes to the first voxel in the block.
+	volData.setVoxel(2, 0, 0, Material8(5));
+	volData.setVoxel(3, 0, 0, Material8(9));
+	volData.setVoxel(2, 1, 0, Material8(9));
+	volData.setVoxel(3, 1, 0, Material8(5));
+	volData.setVoxel(2, 0, 1, Material8(9));
+	volData.setVoxel(3, 0, 1, Material8(5));
+	volData.setVoxel(2, 1, 1, Material8(5));
+	volData.setVoxel(3, 1, 1, Material8(9));
+
+	const Region regLevel = getMipmapRegion(regBase, 1);
+	RawVolume<Material8> volResult(regLevel);
+	downsampleVolume(&volData, regBase, &volResult, MipmapModes::Majority);
+
+	QCOMPARE(volResult.getVoxel(0, 0, 0), Material8(3));
+	QCOMPARE(volResult.getVoxel(1, 0, 0), Material8(5));
+	QCOMPARE(volResult.getVoxel(2, 2, 2), Material8(0));
+
+	// Materials can't be averaged.
+	bool bThrown = false;
+	try
+	{
+		downsampleVolume(&volData, regBase, &volResult, MipmapModes::Average);
+	}
+	catch (std::invalid_argument&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+}
+
+void TestMipmap::testPerformance()
+{
+	Region regBase(0, 0, 0, 255, 255, 127);
+	RawVolume<uint8_t> volData(regBase);
+	fillWithNoise(volData, 4321, std::uniform_int_distribution<int32_t>(0, 255));
+
+	const Region regLevel = getMipmapRegion(regBase, 1);
+	RawVolume<uint8_t> volResult(regLevel);
+	QBENCHMARK
+	{
+		downsampleVolume(&volData, regBase, &volResult, MipmapModes::Average, 1);
+	}
+
+	// For comparison with the general purpose resampler.
+	RawVolume<uint8_t> volResampled(regLevel);
+	VolumeResampler< RawVolume<uint8_t>, RawVolume<uint8_t> > resampler(&volData, regBase, &volResampled, regLevel);
+	QBENCHMARK
+	{
+		resampler.execute();
+	}
+
+	QVERIFY(volResult.getVoxel(64, 64, 32) > 64);
+	QVERIFY(volResult.getVoxel(64, 64, 32) < 192);
+}
+
+QTEST_MAIN(TestMipmap)
@@ -0,0 +1,321 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestMorphology.h"
+
+#include "MemoryPager.h"
+
+#include "PolyVox/Morphology.h"
+#include "PolyVox/PagedVolume.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <cstdlib>
+#include <random>
+
+using namespace PolyVox;
+
+// Computes dilation or erosion one voxel at a time, by visiting every voxel under the structuring element.
+void filterReference(const RawVolume<uint8_t>& volSrc, RawVolume<uint8_t>& volDst, const Region& region, bool bDilate, const StructuringElement& element)
+{
+	const Vector3DInt32& v3dRadius = element.getRadius();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				uint8_t uResult = bDilate ? 0 : 255;
+				for (int32_t dz = -v3dRadius.getZ(); dz <= v3dRadius.getZ(); dz++)
+				{
+					for (int32_t dy = -v3dRadius.getY(); dy <= v3dRadius.getY(); dy++)
+					{
+						for (int32_t dx = -v3dRadius.getX(); dx <= v3dRadius.getX(); dx++)
+						{
+							if ((element.getShape() == StructuringElementShapes::Diamond) && (std::abs(dx) + std::abs(dy) + std::abs(dz) > v3dRadius.getX()))
+							{
+								continue;
+							}
+
+							const uint8_t uValue = volSrc.getVoxel(x + dx, y + dy, z + dz);
+							uResult = bDilate ? (std::max)(uResult, uValue) : (std::min)(uResult, uValue);
+						}
+					}
+				}
+				volDst.setVoxel(x, y, z, uResult);
+			}
+		}
+	}
+}
+
+void applyReference(const RawVolume<uint8_t>& volSrc, RawVolume<uint8_t>& volDst, const Region& region, MorphologyOperation eOperation, const StructuringElement& element)
+{
+	if ((eOperation == MorphologyOperations::Dilate) || (eOperation == MorphologyOperations::Erode))
+	{
+		filterReference(volSrc, volDst, region, eOperation == MorphologyOperations::Dilate, element);
+		return;
+	}
+
+	// The first step is needed for everything the second step reads.
+	Region regFirstStep = region;
+	regFirstStep.grow(element.getRadius());
+	RawVolume<uint8_t> volFirstStep(regFirstStep);
+	filterReference(volSrc, volFirstStep, regFirstStep, eOperation == MorphologyOperations::Close, element);
+	filterReference(volFirstStep, volDst, region, eOperation == MorphologyOperations::Open, element);
+}
+
+template <typename VolumeType>
+void fillRandomly(VolumeType& volume, const Region& region, uint32_t uSeed, uint32_t uNoOfValues)
+{
+	std::mt19937 rng(uSeed);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				volume.setVoxel(x, y, z, static_cast<typename VolumeType::VoxelType>(rng() % uNoOfValues));
+			}
+		}
+	}
+}
+
+template <typename VolumeType, typename ReferenceVolumeType>
+bool isSame(const VolumeType& volume, const ReferenceVolumeType& volReference, const Region& region)
+{
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				if (static_cast<uint8_t>(volume.getVoxel(x, y, z)) != static_cast<uint8_t>(volReference.getVoxel(x, y, z)))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+const MorphologyOperation operations[] = { MorphologyOperations::Dilate, MorphologyOperations::Erode, MorphologyOperations::Open, MorphologyOperations::Close };
+
+void TestMorphology::testElements()
+{
+	QCOMPARE(createBoxElement(2).getRadius(), Vector3DInt32(2, 2, 2));
+	QCOMPARE(createDiamondElement(3).getShape(), StructuringElementShapes::Diamond);
+
+	bool bExceptionThrown = false;
+	try
+	{
+		StructuringElement element(StructuringElementShapes::Diamond, Vector3DInt32(1, 2, 1));
+	}
+	catch (const std::invalid_argument&)
+	{
+		bExceptionThrown = true;
+	}
+	QVERIFY(bExceptionThrown);
+
+	// Dilating a single voxel gives the shape of the element.
+	Region region(-8, -8, -8, 8, 8, 8);
+	RawVolume<uint8_t> volSrc(region);
+	RawVolume<uint8_t> volDst(region);
+	volSrc.setVoxel(0, 0, 0, 1);
+
+	MorphologyFilter<RawVolume<uint8_t>, RawVolume<uint8_t> > filter(&volSrc, region, &volDst, region);
+	filter.execute(MorphologyOperations::Dilate, createDiamondElement(3));
+	QCOMPARE(volDst.getVoxel(3, 0, 0), uint8_t(1));
+	QCOMPARE(volDst.getVoxel(1, -1, 1), uint8_t(1));
+	QCOMPARE(volDst.getVoxel(2, 2, 0), uint8_t(0));
+	QCOMPARE(volDst.getVoxel(0, 0, -4), uint8_t(0));
+
+	filter.execute(MorphologyOperations::Dilate, StructuringElement(StructuringElementShapes::Box, Vector3DInt32(4, 0, 1)));
+	QCOMPARE(volDst.getVoxel(-4, 0, 1), uint8_t(1));
+	QCOMPARE(volDst.getVoxel(4, 0, -1), uint8_t(1));
+	QCOMPARE(volDst.getVoxel(0, 1, 0), uint8_t(0));
+	QCOMPARE(volDst.getVoxel(5, 0, 0), uint8_t(0));
+
+	// Opening removes anything smaller than the element.
+	filter.execute(MorphologyOperations::Open, createBoxElement(1));
+	QCOMPARE(volDst.getVoxel(0, 0, 0), uint8_t(0));
+}
+
+void TestMorphology::testOperations()
+{
+	// Use negative coordinates, a size which isn't a multiple of the tile size, and a source which is offset from the destination.
+	const Region regVolume(-45, -20, -10, 40, 50, 30);
+	const Region regSrc(-40, -15, -5, 30, 40, 20);
+	const Region regDst(-35, -12, -5, 35, 43, 20);
+	RawVolume<uint8_t> volSrc(regVolume);
+	fillRandomly(volSrc, regVolume, 1234, 200);
+
+	const StructuringElement elements[] =
+	{
+		createBoxElement(1),
+		StructuringElement(StructuringElementShapes::Box, Vector3DInt32(3, 0, 2)),
+		createDiamondElement(2),
+	};
+
+	for (const StructuringElement& element : elements)
+	{
+		for (MorphologyOperation eOperation : operations)
+		{
+			RawVolume<uint8_t> volDst(regVolume);
+			MorphologyFilter<RawVolume<uint8_t>, RawVolume<uint8_t> > filter(&volSrc, regSrc, &volDst, regDst);
+			filter.execute(eOperation, element, 3);
+
+			RawVolume<uint8_t> volReference(regSrc);
+			applyReference(volSrc, volReference, regSrc, eOperation, element);
+
+			for (int32_t z = regSrc.getLowerZ(); z <= regSrc.getUpperZ(); z++)
+			{
+				for (int32_t y = regSrc.getLowerY(); y <= regSrc.getUpperY(); y++)
+				{
+					for (int32_t x = regSrc.getLowerX(); x <= regSrc.getUpperX(); x++)
+					{
+						const Vector3DInt32 v3dDst = Vector3DInt32(x, y, z) + regDst.getLowerCorner() - regSrc.getLowerCorner();
+						QCOMPARE(volDst.getVoxel(v3dDst), volReference.getVoxel(x, y, z));
+					}
+				}
+			}
+		}
+	}
+}
+
+void TestMorphology::testBitVolume()
+{
+	const Region region(-70, -3, 5, 90, 30, 40);
+	BitVolume volSrc(region);
+	RawVolume<uint8_t> volRawSrc(region);
+	fillRandomly(volRawSrc, region, 4321, 2);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				volSrc.setVoxel(x, y, z, volRawSrc.getVoxel(x, y, z) != 0);
+			}
+		}
+	}
+
+	// The words of the destination are shared between neighbouring tiles, so this also checks they don't overwrite each other.
+	const StructuringElement elements[] =
+	{
+		createBoxElement(1),
+		StructuringElement(StructuringElementShapes::Box, Vector3DInt32(7, 1, 3)),
+		createDiamondElement(2),
+	};
+
+	for (const StructuringElement& element : elements)
+	{
+		for (MorphologyOperation eOperation : operations)
+		{
+			BitVolume volDst(region);
+			MorphologyFilter<BitVolume, BitVolume> filter(&volSrc, region, &volDst, region);
+			filter.execute(eOperation, element, 3);
+
+			RawVolume<uint8_t> volReference(region);
+			applyReference(volRawSrc, volReference, region, eOperation, element);
+			QVERIFY(isSame(volDst, volReference, region));
+		}
+	}
+
+	// Voxels outside the volume have the border value.
+	volSrc.setBorderValue(true);
+	volRawSrc.setBorderValue(1);
+	BitVolume volDst(region);
+	RawVolume<uint8_t> volReference(region);
+	MorphologyFilter<BitVolume, BitVolume>(&volSrc, region, &volDst, region).execute(MorphologyOperations::Close, createDiamondElement(3));
+	applyReference(volRawSrc, volReference, region, MorphologyOperations::Close, createDiamondElement(3));
+	QVERIFY(isSame(volDst, volReference, region));
+
+	bool bExceptionThrown = false;
+	try
+	{
+		MorphologyFilter<BitVolume, BitVolume>(&volSrc, region, &volDst, region).execute(MorphologyOperations::Open, createBoxElement(16));
+	}
+	catch (const std::invalid_argument&)
+	{
+		bExceptionThrown = true;
+	}
+	QVERIFY(bExceptionThrown);
+}
+
+void TestMorphology::testPagedVolume()
+{
+	const Region region(-20, -20, -20, 50, 30, 40);
+	MemoryPager<uint8_t> srcPager;
+	MemoryPager<uint8_t> dstPager;
+	PagedVolume<uint8_t> volSrc(&srcPager, 64 * 1024 * 1024, 16);
+	PagedVolume<uint8_t> volDst(&dstPager, 64 * 1024 * 1024, 16);
+	RawVolume<uint8_t> volRawSrc(region);
+	fillRandomly(volSrc, region, 999, 50);
+	fillRandomly(volRawSrc, region, 999, 50);
+
+	// The paged volumes are locked while each tile is read and written.
+	MorphologyFilter<PagedVolume<uint8_t>, PagedVolume<uint8_t> > filter(&volSrc, region, &volDst, region);
+	filter.execute(MorphologyOperations::Close, createBoxElement(2), 3);
+
+	RawVolume<uint8_t> volReference(region);
+	MorphologyFilter<RawVolume<uint8_t>, RawVolume<uint8_t> >(&volRawSrc, region, &volReference, region).execute(MorphologyOperations::Close, createBoxElement(2), 1);
+	QVERIFY(isSame(volDst, volReference, region));
+}
+
+void TestMorphology::testPerformance()
+{
+	const Region region(0, 0, 0, 127, 127, 127);
+	RawVolume<uint8_t> volSrc(region);
+	RawVolume<uint8_t> volDst(region);
+	fillRandomly(volSrc, region, 5678, 2);
+
+	MorphologyFilter<RawVolume<uint8_t>, RawVolume<uint8_t> > filter(&volSrc, region, &volDst, region);
+	QBENCHMARK{
+		filter.execute(MorphologyOperations::Dilate, createBoxElement(1));
+	}
+
+	// The same dilation on packed occupancy.
+	BitVolume volBitSrc(region);
+	BitVolume volBitDst(region);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				volBitSrc.setVoxel(x, y, z, volSrc.getVoxel(x, y, z) != 0);
+			}
+		}
+	}
+
+	MorphologyFilter<BitVolume, BitVolume> bitFilter(&volBitSrc, region, &volBitDst, region);
+	QBENCHMARK{
+		bitFilter.execute(MorphologyOperations::Dilate, createBoxElement(1));
+	}
+	QVERIFY(isSame(volBitDst, volDst, region));
+}
+
+QTEST_MAIN(TestMorphology)
@@ -0,0 +1,169 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestMultiChannelVolume.h"
+
+#include "PolyVox/MarchingCubesSurfaceExtractor.h"
+#include "PolyVox/MaterialDensityPair.h"
+#include "PolyVox/MultiChannelVolume.h"
+#include "PolyVox/RawVolume.h"
+
+#include <QtTest>
+
+#include <cmath>
+#include <random>
+
+using namespace PolyVox;
+
+// Fills both volumes with a few overlapping blobs, with a random material in each voxel.
+template <typename VolumeType, typename OtherVolumeType>
+void fillWithBlobs(VolumeType& volume, OtherVolumeType& other)
+{
+	const Region& region = volume.getEnclosingRegion();
+	std::mt19937 rng(1234);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				const float fField = std::sin(x * 0.21f) + std::cos(y * 0.17f) + std::sin(z * 0.13f + x * 0.05f);
+				const uint8_t uDensity = static_cast<uint8_t>((std::min)(15.0f, (std::max)(0.0f, fField * 5.0f + 7.5f)));
+				const MaterialDensityPair44 voxel(static_cast<uint8_t>(rng() % 16), uDensity);
+				volume.setVoxel(x, y, z, voxel);
+				other.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+}
+
+void TestMultiChannelVolume::testGetAndSet()
+{
+	Region region(-7, 3, -12, 20, 15, 4);
+	MultiChannelVolume<MaterialDensityPair44> volume(region);
+	RawVolume<MaterialDensityPair44> reference(region);
+	fillWithBlobs(volume, reference);
+
+	volume.setBorderValue(MaterialDensityPair44(3, 9));
+	reference.setBorderValue(MaterialDensityPair44(3, 9));
+
+	Region regCheck(region);
+	regCheck.grow(1);
+	for (int32_t z = regCheck.getLowerZ(); z <= regCheck.getUpperZ(); z++)
+	{
+		for (int32_t y = regCheck.getLowerY(); y <= regCheck.getUpperY(); y++)
+		{
+			for (int32_t x = regCheck.getLowerX(); x <= regCheck.getUpperX(); x++)
+			{
+				const MaterialDensityPair44 expected = reference.getVoxel(x, y, z);
+				QCOMPARE(volume.getVoxel(x, y, z), expected);
+				QCOMPARE(volume.getDensityChannel().getVoxel(x, y, z), expected.getDensity());
+				QCOMPARE(volume.getMaterialChannel().getVoxel(x, y, z), expected.getMaterial());
+			}
+		}
+	}
+
+	// Writing to a channel changes just that part of the voxels.
+	volume.getDensityChannel().setVoxel(0, 5, 0, 2);
+	QCOMPARE(volume.getVoxel(0, 5, 0), MaterialDensityPair44(reference.getVoxel(0, 5, 0).getMaterial(), 2));
+
+	QCOMPARE(volume.calculateSizeInBytes(), static_cast<uint32_t>(2 * region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels()));
+}
+
+void TestMultiChannelVolume::testSampler()
+{
+	Region region(-7, 3, -12, 20, 15, 4);
+	MultiChannelVolume<MaterialDensityPair44> volume(region);
+	RawVolume<MaterialDensityPair44> reference(region);
+	fillWithBlobs(volume, reference);
+
+	MultiChannelVolume<MaterialDensityPair44>::Sampler sampler(&volume);
+	RawVolume<MaterialDensityPair44>::Sampler refSampler(&reference);
+	for (int32_t z = region.getLowerZ() - 1; z <= region.getUpperZ() + 1; z++)
+	{
+		for (int32_t x = region.getLowerX() - 1; x <= region.getUpperX() + 1; x++)
+		{
+			sampler.setPosition(x, region.getUpperY() + 1, z);
+			refSampler.setPosition(x, region.getUpperY() + 1, z);
+			for (int32_t y = region.getUpperY() + 1; y >= region.getLowerY() - 1; y--)
+			{
+				QCOMPARE(sampler.getPosition(), refSampler.getPosition());
+				QCOMPARE(sampler.getVoxel(), refSampler.getVoxel());
+				QCOMPARE(sampler.peekVoxel1nx1ny1nz(), refSampler.peekVoxel1nx1ny1nz());
+				QCOMPARE(sampler.peekVoxel0px1py1pz(), refSampler.peekVoxel0px1py1pz());
+				QCOMPARE(sampler.peekVoxel1px0py1nz(), refSampler.peekVoxel1px0py1nz());
+				sampler.moveNegativeY();
+				refSampler.moveNegativeY();
+			}
+		}
+	}
+
+	sampler.setPosition(1, 4, 1);
+	QCOMPARE(sampler.setVoxel(MaterialDensityPair44(5, 6)), true);
+	QCOMPARE(volume.getVoxel(1, 4, 1), MaterialDensityPair44(5, 6));
+	sampler.setPosition(region.getLowerCorner() - Vector3DInt32(1, 0, 0));
+	QCOMPARE(sampler.setVoxel(MaterialDensityPair44(5, 6)), false);
+}
+
+void TestMultiChannelVolume::testSurfaceExtraction()
+{
+	Region region(0, 0, 0, 127, 127, 127);
+	MultiChannelVolume<MaterialDensityPair44> volume(region);
+	RawVolume<MaterialDensityPair44> reference(region);
+	fillWithBlobs(volume, reference);
+
+	Region regExtract(region);
+	regExtract.shrink(1);
+
+	// The whole voxels can still be extracted, and give the same mesh as the packed voxels.
+	Mesh< MarchingCubesVertex<MaterialDensityPair44> > packedMesh;
+	QBENCHMARK{ packedMesh = extractMarchingCubesMesh(&reference, regExtract); }
+	auto fullMesh = extractMarchingCubesMesh(&volume, regExtract);
+
+	QVERIFY(packedMesh.getNoOfVertices() > 0);
+	QCOMPARE(fullMesh.getNoOfVertices(), packedMesh.getNoOfVertices());
+	QCOMPARE(fullMesh.getNoOfIndices(), packedMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < packedMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(fullMesh.getVertex(ct).encodedPosition, packedMesh.getVertex(ct).encodedPosition);
+		QCOMPARE(fullMesh.getVertex(ct).data, packedMesh.getVertex(ct).data);
+	}
+
+	// Extracting from the density channel alone reads only the densities, but gives the same geometry.
+	DefaultMarchingCubesController<MaterialDensityPair44> packedController;
+	DefaultMarchingCubesController<uint8_t> densityController;
+	densityController.setThreshold(packedController.getThreshold());
+	Mesh< MarchingCubesVertex<uint8_t> > densityMesh;
+	QBENCHMARK{ densityMesh = extractMarchingCubesMesh(&volume.getDensityChannel(), regExtract, densityController); }
+
+	QCOMPARE(densityMesh.getNoOfVertices(), packedMesh.getNoOfVertices());
+	QCOMPARE(densityMesh.getNoOfIndices(), packedMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < packedMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(densityMesh.getVertex(ct).encodedPosition, packedMesh.getVertex(ct).encodedPosition);
+		QCOMPARE(densityMesh.getVertex(ct).encodedNormal, packedMesh.getVertex(ct).encodedNormal);
+	}
+}
+
+QTEST_MAIN(TestMultiChannelVolume)
@@ -0,0 +1,339 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestRegionScheduler.h"
+
+#include "PolyVox/FilePager.h"
+#include "PolyVox/PagedVolume.h"
+#include "PolyVox/RawVolume.h"
+#include "PolyVox/RegionScheduler.h"
+
+#include <QtTest>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace PolyVox;
+
+void TestRegionScheduler::testTiles()
+{
+	RegionScheduler scheduler(1, 16);
+	QCOMPARE(scheduler.getNoOfThreads(), 1u);
+	QCOMPARE(scheduler.getTileSideLength(), 16u);
+
+	// The tiles are aligned to the grid rather than to the region, and clipped to it.
+	const Region region(-20, 3, 15, 40, 17, 16);
+	QCOMPARE(scheduler.getNoOfTiles(region), 5u * 2u * 2u);
+	QCOMPARE(scheduler.getTile(region, 0), Region(-20, 3, 15, -17, 15, 15));
+	QCOMPARE(scheduler.getTile(region, 1), Region(-16, 3, 15, -1, 15, 15));
+	QCOMPARE(scheduler.getTile(region, 19), Region(32, 16, 16, 40, 17, 16));
+
+	// With one thread the tiles are visited in order, and together they cover the region exactly once.
+	RawVolume<uint8_t> volCount(region);
+	uint32_t uExpectedTile = 0;
+	scheduler.forEachTile(region, [&](const Region& regTile, uint32_t uTile, uint32_t uWorker)
+	{
+		QCOMPARE(uTile, uExpectedTile);
+		QCOMPARE(uWorker, 0u);
+		QCOMPARE(regTile, scheduler.getTile(region, uTile));
+		uExpectedTile++;
+
+		for (int32_t z = regTile.getLowerZ(); z <= regTile.getUpperZ(); z++)
+		{
+			for (int32_t y = regTile.getLowerY(); y <= regTile.getUpperY(); y++)
+			{
+				for (int32_t x = regTile.getLowerX(); x <= regTile.getUpperX(); x++)
+				{
+					volCount.setVoxel(x, y, z, volCount.getVoxel(x, y, z) + 1);
+				}
+			}
+		}
+	});
+	QCOMPARE(uExpectedTile, 20u);
+
+	bool bAllOnce = true;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				bAllOnce = bAllOnce && (volCount.getVoxel(x, y, z) == 1);
+			}
+		}
+	}
+	QVERIFY(bAllOnce);
+
+	// Algorithms which need a particular tile size can ask for it without another scheduler.
+	QCOMPARE(scheduler.getNoOfTiles(region, 8), 9u * 3u * 2u);
+	QCOMPARE(scheduler.getTile(region, 1, 8), Region(-16, 3, 15, -9, 7, 15));
+	uExpectedTile = 0;
+	scheduler.forEachTile(region, 8, [&](const Region& regTile, uint32_t uTile, uint32_t /*uWorker*/)
+	{
+		QCOMPARE(uTile, uExpectedTile);
+		QCOMPARE(regTile, scheduler.getTile(region, uTile, 8));
+		uExpectedTile++;
+	});
+	QCOMPARE(uExpectedTile, 54u);
+
+	// Tasks which aren't tied to a region are also run in order.
+	uint32_t uExpectedTask = 0;
+	scheduler.forEachTask(5, [&](uint32_t uTask, uint32_t uWorker)
+	{
+		QCOMPARE(uTask, uExpectedTask);
+		QCOMPARE(uWorker, 0u);
+		uExpectedTask++;
+	});
+	QCOMPARE(uExpectedTask, 5u);
+
+	// An invalid region has no tiles.
+	QCOMPARE(scheduler.getNoOfTiles(Region::InvertedRegion()), 0u);
+	scheduler.forEachTile(Region::InvertedRegion(), [](const Region&, uint32_t, uint32_t) { QFAIL("There should be no tiles"); });
+
+	bool bThrown = false;
+	try
+	{
+		RegionScheduler badScheduler(1, 0);
+	}
+	catch (std::invalid_argument&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+}
+
+void TestRegionScheduler::testThreads()
+{
+	RegionScheduler scheduler(4, 8);
+	QCOMPARE(scheduler.getNoOfThreads(), 4u);
+
+	// Affinity can't be set for the calling thread, and isn't supported everywhere, but must not break anything.
+	QVERIFY(!scheduler.setThreadAffinity(0, 0));
+	scheduler.setThreadAffinity(1, 0);
+
+	// Each tile writes its own part of the volume, so the result is the same as for one thread. The scheduler is
+	// used several times, as its threads are reused.
+	const Region region(-50, -10, 0, 60, 70, 30);
+	for (uint32_t uRun = 0; uRun < 3; uRun++)
+	{
+		RawVolume<int32_t> volResult(region);
+		std::vector< std::atomic<uint32_t> > vecVisits(scheduler.getNoOfTiles(region));
+		for (auto& visits : vecVisits)
+		{
+			visits = 0;
+		}
+
+		scheduler.forEachTile(region, [&](const Region& regTile, uint32_t uTile, uint32_t uWorker)
+		{
+			QVERIFY(uWorker < 4);
+			vecVisits[uTile]++;
+			for (int32_t z = regTile.getLowerZ(); z <= regTile.getUpperZ(); z++)
+			{
+				for (int32_t y = regTile.getLowerY(); y <= regTile.getUpperY(); y++)
+				{
+					for (int32_t x = regTile.getLowerX(); x <= regTile.getUpperX(); x++)
+					{
+						volResult.setVoxel(x, y, z, x + y * 3 + z * 7 + static_cast<int32_t>(uTile));
+					}
+				}
+			}
+		});
+
+		bool bCorrect = true;
+		for (auto& visits : vecVisits)
+		{
+			bCorrect = bCorrect && (visits == 1);
+		}
+		for (uint32_t uTile = 0; uTile < vecVisits.size(); uTile++)
+		{
+			const Region regTile = scheduler.getTile(region, uTile);
+			bCorrect = bCorrect && (volResult.getVoxel(regTile.getUpperCorner()) ==
+				regTile.getUpperX() + regTile.getUpperY() * 3 + regTile.getUpperZ() * 7 + static_cast<int32_t>(uTile));
+		}
+		QVERIFY(bCorrect);
+	}
+
+	// Plain tasks share the same threads, and each runs exactly once.
+	std::vector< std::atomic<uint32_t> > vecTaskVisits(1000);
+	for (auto& visits : vecTaskVisits)
+	{
+		visits = 0;
+	}
+	scheduler.forEachTask(static_cast<uint32_t>(vecTaskVisits.size()), [&](uint32_t uTask, uint32_t uWorker)
+	{
+		QVERIFY(uWorker < 4);
+		vecTaskVisits[uTask]++;
+	});
+	bool bAllOnce = true;
+	for (auto& visits : vecTaskVisits)
+	{
+		bAllOnce = bAllOnce && (visits == 1);
+	}
+	QVERIFY(bAllOnce);
+}
+
+void TestRegionScheduler::testWorkerLocal()
+{
+	RegionScheduler scheduler(3, 16);
+	const Region region(0, 0, 0, 99, 99, 99);
+
+	// Partial sums for each worker, which are added together at the end.
+	WorkerLocal<int64_t> sums(scheduler, 0);
+	QCOMPARE(sums.getNoOfWorkers(), 3u);
+
+	// A sampler for each worker, reading a volume which supports concurrent reads.
+	RawVolume<int32_t> volData(region);
+	for (int32_t z = 0; z <= 99; z++)
+	{
+		for (int32_t y = 0; y <= 99; y++)
+		{
+			for (int32_t x = 0; x <= 99; x++)
+			{
+				volData.setVoxel(x, y, z, x + y + z);
+			}
+		}
+	}
+	WorkerLocal<RawVolume<int32_t>::Sampler> samplers(scheduler, &volData);
+
+	scheduler.forEachTile(region, [&](const Region& regTile, uint32_t /*uTile*/, uint32_t uWorker)
+	{
+		RawVolume<int32_t>::Sampler& sampler = samplers.get(uWorker);
+		int64_t& iSum = sums.get(uWorker);
+		for (int32_t z = regTile.getLowerZ(); z <= regTile.getUpperZ(); z++)
+		{
+			for (int32_t y = regTile.getLowerY(); y <= regTile.getUpperY(); y++)
+			{
+				sampler.setPosition(regTile.getLowerX(), y, z);
+				for (int32_t x = regTile.getLowerX(); x <= regTile.getUpperX(); x++)
+				{
+					iSum += sampler.getVoxel();
+					sampler.movePositiveX();
+				}
+			}
+		}
+	});
+
+	int64_t iTotal = 0;
+	for (uint32_t uWorker = 0; uWorker < sums.getNoOfWorkers(); uWorker++)
+	{
+		iTotal += sums.get(uWorker);
+	}
+	QCOMPARE(iTotal, static_cast<int64_t>(3 * 49.5 * 100 * 100 * 100));
+
+	// RawVolume can be shared freely, but a PagedVolume must be locked, and a volume used for both reading and
+	// writing shares one lock. Nothing needs locking with a single thread.
+	FilePager<int32_t> pager(".");
+	PagedVolume<int32_t> volPaged(&pager);
+	VolumeLocks< RawVolume<int32_t> > rawLocks(scheduler, &volData, &volData);
+	QVERIFY(rawLocks.getSrcMutex() == nullptr);
+	QVERIFY(rawLocks.getDstMutex() == nullptr);
+	VolumeLocks< RawVolume<int32_t>, PagedVolume<int32_t> > mixedLocks(scheduler, &volData, &volPaged);
+	QVERIFY(mixedLocks.getSrcMutex() == nullptr);
+	QVERIFY(mixedLocks.getDstMutex() != nullptr);
+	VolumeLocks< PagedVolume<int32_t> > pagedLocks(scheduler, &volPaged, &volPaged);
+	QVERIFY(pagedLocks.getSrcMutex() != nullptr);
+	QVERIFY(pagedLocks.getSrcMutex() == pagedLocks.getDstMutex());
+	RegionScheduler singleScheduler(1);
+	VolumeLocks< PagedVolume<int32_t> > singleLocks(singleScheduler, &volPaged, &volPaged);
+	QVERIFY(singleLocks.getSrcMutex() == nullptr);
+}
+
+void TestRegionScheduler::testExceptions()
+{
+	RegionScheduler scheduler(4, 4);
+	const Region region(0, 0, 0, 63, 63, 63);
+	std::atomic<uint32_t> uNoOfTilesRun(0);
+
+	bool bThrown = false;
+	try
+	{
+		scheduler.forEachTile(region, [&](const Region& /*regTile*/, uint32_t uTile, uint32_t /*uWorker*/)
+		{
+			uNoOfTilesRun++;
+			if (uTile == 10)
+			{
+				throw std::runtime_error("Tile failed");
+			}
+		});
+	}
+	catch (std::runtime_error&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+
+	// The scheduler can still be used afterwards.
+	uNoOfTilesRun = 0;
+	scheduler.forEachTile(region, [&](const Region&, uint32_t, uint32_t) { uNoOfTilesRun++; });
+	QCOMPARE(static_cast<uint32_t>(uNoOfTilesRun), 16u * 16u * 16u);
+}
+
+void TestRegionScheduler::testPerformance()
+{
+	const Region region(0, 0, 0, 255, 255, 127);
+	RawVolume<float> volData(region);
+
+	auto fillTile = [&](const Region& regTile, uint32_t /*uTile*/, uint32_t /*uWorker*/)
+	{
+		for (int32_t z = regTile.getLowerZ(); z <= regTile.getUpperZ(); z++)
+		{
+			for (int32_t y = regTile.getLowerY(); y <= regTile.getUpperY(); y++)
+			{
+				for (int32_t x = regTile.getLowerX(); x <= regTile.getUpperX(); x++)
+				{
+					volData.setVoxel(x, y, z, std::sqrt(static_cast<float>(x * y + z)));
+				}
+			}
+		}
+	};
+
+	// The same tiles visited by hand, for comparison with a single threaded scheduler (which should cost the same).
+	QBENCHMARK{
+		for (int32_t iTileZ = 0; iTileZ < 128; iTileZ += 32)
+		{
+			for (int32_t iTileY = 0; iTileY < 256; iTileY += 32)
+			{
+				for (int32_t iTileX = 0; iTileX < 256; iTileX += 32)
+				{
+					fillTile(Region(iTileX, iTileY, iTileZ, iTileX + 31, iTileY + 31, iTileZ + 31), 0, 0);
+				}
+			}
+		}
+	}
+
+	RegionScheduler singleScheduler(1);
+	QBENCHMARK{
+		singleScheduler.forEachTile(region, fillTile);
+	}
+
+	RegionScheduler scheduler(0);
+	QBENCHMARK{
+		scheduler.forEachTile(region, fillTile);
+	}
+
+	QCOMPARE(volData.getVoxel(10, 20, 30), std::sqrt(230.0f));
+}
+
+QTEST_MAIN(TestRegionScheduler)
@@ -0,0 +1,254 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestSparseVolume.h"
+
+#include "PolyVox/MarchingCubesSurfaceExtractor.h"
+#include "PolyVox/RawVolume.h"
+#include "PolyVox/SparseVolume.h"
+
+#include <QtTest>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <tuple>
+
+using namespace PolyVox;
+
+// Zero at the surface of a sphere of the given radius around the origin, rising to 255 well inside it.
+uint8_t sphereDensity(int32_t x, int32_t y, int32_t z, float fRadius)
+{
+	const float fDistance = std::sqrt(static_cast<float>(x * x + y * y + z * z));
+	const float fDensity = (fRadius - fDistance) * 64.0f + 128.0f;
+	return static_cast<uint8_t>((std::min)(255.0f, (std::max)(0.0f, fDensity)));
+}
+
+void TestSparseVolume::testGetAndSet()
+{
+	// Scattered writes across several top level nodes (which cover 4096 voxels per side), including negative
+	// positions. About a quarter of them write the background value, which deactivates the voxel.
+	SparseVolume<int32_t> volume(-1);
+	std::map< std::tuple<int32_t, int32_t, int32_t>, int32_t > mapExpected;
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int32_t> posDist(-5000, 5000);
+	std::uniform_int_distribution<int32_t> nearDist(-20, 20);
+	std::uniform_int_distribution<int32_t> valueDist(-1, 2);
+
+	for (int ct = 0; ct < 100000; ct++)
+	{
+		// Keep most writes near each other so that leaves fill up and empty again.
+		int32_t x = (ct % 4 == 0) ? posDist(rng) : nearDist(rng);
+		int32_t y = (ct % 4 == 0) ? posDist(rng) : nearDist(rng);
+		int32_t z = (ct % 4 == 0) ? posDist(rng) : nearDist(rng);
+		int32_t value = valueDist(rng);
+
+		volume.setVoxel(x, y, z, value);
+		if (value == -1)
+		{
+			mapExpected.erase(std::make_tuple(x, y, z));
+		}
+		else
+		{
+			mapExpected[std::make_tuple(x, y, z)] = value;
+		}
+
+		int32_t xRead = (ct % 3 == 0) ? posDist(rng) : nearDist(rng);
+		int32_t yRead = (ct % 3 == 0) ? posDist(rng) : nearDist(rng);
+		int32_t zRead = (ct % 3 == 0) ? posDist(rng) : nearDist(rng);
+		auto iter = mapExpected.find(std::make_tuple(xRead, yRead, zRead));
+		int32_t expected = (iter != mapExpected.end()) ? iter->second : -1;
+		QCOMPARE(volume.getVoxel(xRead, yRead, zRead), expected);
+	}
+
+	Region regExpected = Region::InvertedRegion();
+	for (const auto& voxel : mapExpected)
+	{
+		QCOMPARE(volume.getVoxel(std::get<0>(voxel.first), std::get<1>(voxel.first), std::get<2>(voxel.first)), voxel.second);
+		regExpected.accumulate(std::get<0>(voxel.first), std::get<1>(voxel.first), std::get<2>(voxel.first));
+	}
+
+	QCOMPARE(volume.getNoOfActiveVoxels(), static_cast<uint64_t>(mapExpected.size()));
+	QCOMPARE(volume.getActiveRegion(), regExpected);
+}
+
+void TestSparseVolume::testSampler()
+{
+	// A noisy block which straddles leaf boundaries (every 8 voxels) and the origin.
+	Region region(-13, -9, -17, 14, 10, 6);
+	SparseVolume<int32_t> volume;
+	std::mt19937 rng(4321);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				// Leave some voxels (and so some whole leaves) inactive.
+				volume.setVoxel(x, y, z, (rng() % 3 == 0) ? 0 : static_cast<int32_t>(rng() % 1000));
+			}
+		}
+	}
+
+	// Sweep a sampler through the region in both directions along each axis, checking all of its neighbours.
+	SparseVolume<int32_t>::Sampler sampler(&volume);
+	int32_t iChecksum = 0;
+	int32_t iExpectedChecksum = 0;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			sampler.setPosition(region.getLowerX(), y, z);
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				QCOMPARE(sampler.getPosition(), Vector3DInt32(x, y, z));
+				iChecksum += sampler.getVoxel() + sampler.peekVoxel1nx1ny1nz() + sampler.peekVoxel1px1py1pz() + sampler.peekVoxel0px1ny0pz();
+				iChecksum += sampler.peekVoxel1nx0py1pz() + sampler.peekVoxel1px0py0pz() + sampler.peekVoxel0px0py1nz();
+				iExpectedChecksum += volume.getVoxel(x, y, z) + volume.getVoxel(x - 1, y - 1, z - 1) + volume.getVoxel(x + 1, y + 1, z + 1) + volume.getVoxel(x, y - 1, z);
+				iExpectedChecksum += volume.getVoxel(x - 1, y, z + 1) + volume.getVoxel(x + 1, y, z) + volume.getVoxel(x, y, z - 1);
+				sampler.movePositiveX();
+			}
+		}
+	}
+
+	for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x--)
+	{
+		for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y--)
+		{
+			sampler.setPosition(x, y, region.getUpperZ());
+			for (int32_t z = region.getUpperZ(); z >= region.getLowerZ(); z--)
+			{
+				QCOMPARE(sampler.getPosition(), Vector3DInt32(x, y, z));
+				iChecksum += sampler.peekVoxel1px1ny1pz() + sampler.peekVoxel0px1py0pz() + sampler.peekVoxel1nx0py0pz();
+				iExpectedChecksum += volume.getVoxel(x + 1, y - 1, z + 1) + volume.getVoxel(x, y + 1, z) + volume.getVoxel(x - 1, y, z);
+				sampler.moveNegativeZ();
+			}
+		}
+	}
+
+	QCOMPARE(iChecksum, iExpectedChecksum);
+
+	// Writing through a sampler can create and delete leaves, which the sampler must notice.
+	sampler.setPosition(100, 100, 100);
+	QCOMPARE(sampler.getVoxel(), 0);
+	QCOMPARE(sampler.setVoxel(7), true);
+	QCOMPARE(sampler.getVoxel(), 7);
+	QCOMPARE(sampler.peekVoxel1px0py0pz(), 0);
+	sampler.movePositiveX();
+	QCOMPARE(sampler.peekVoxel1nx0py0pz(), 7);
+	volume.setVoxel(100, 100, 100, 0);
+	QCOMPARE(sampler.peekVoxel1nx0py0pz(), 0);
+	volume.setVoxel(100, 100, 100, 9);
+	QCOMPARE(sampler.peekVoxel1nx0py0pz(), 9);
+}
+
+void TestSparseVolume::testMemoryUsage()
+{
+	SparseVolume<uint8_t> volume;
+	const uint32_t uEmptySize = volume.calculateSizeInBytes();
+
+	// A thin spherical shell, with a radius of 100 voxels.
+	const int32_t iRadius = 100;
+	std::vector<Vector3DInt32> vecShell;
+	for (int32_t z = -iRadius - 1; z <= iRadius + 1; z++)
+	{
+		for (int32_t y = -iRadius - 1; y <= iRadius + 1; y++)
+		{
+			for (int32_t x = -iRadius - 1; x <= iRadius + 1; x++)
+			{
+				const float fDistance = std::sqrt(static_cast<float>(x * x + y * y + z * z));
+				if (std::abs(fDistance - iRadius) < 0.5f)
+				{
+					vecShell.push_back(Vector3DInt32(x, y, z));
+				}
+			}
+		}
+	}
+
+	for (const Vector3DInt32& v3dPos : vecShell)
+	{
+		volume.setVoxel(v3dPos, 1);
+	}
+
+	QCOMPARE(volume.getNoOfActiveVoxels(), static_cast<uint64_t>(vecShell.size()));
+	QCOMPARE(volume.getActiveRegion(), Region(-iRadius, -iRadius, -iRadius, iRadius, iRadius, iRadius));
+
+	// The memory should be a small multiple of the number of active voxels, rather than of the size of their bounding box
+	// (over eight million voxels here). The per-leaf bitmasks dominate for such a thin shell.
+	const uint32_t uShellSize = volume.calculateSizeInBytes() - uEmptySize;
+	QVERIFY(uShellSize < vecShell.size() * 16);
+	QVERIFY(uShellSize < (2 * iRadius + 1) * (2 * iRadius + 1) * (2 * iRadius + 1) / 8);
+
+	// Setting the voxels back to the background value should free all the leaves and nodes.
+	for (const Vector3DInt32& v3dPos : vecShell)
+	{
+		volume.setVoxel(v3dPos, 0);
+	}
+
+	QCOMPARE(volume.getNoOfActiveVoxels(), static_cast<uint64_t>(0));
+	QCOMPARE(volume.getActiveRegion().isValid(), false);
+	QVERIFY(volume.calculateSizeInBytes() < uEmptySize + 1024);
+}
+
+void TestSparseVolume::testSurfaceExtraction()
+{
+	// The same sphere in a RawVolume and (storing only the voxels with a non-zero density) in a SparseVolume should give the same mesh.
+	const float fRadius = 28.3f;
+	Region region(-32, -32, -32, 32, 32, 32);
+	RawVolume<uint8_t> rawVol(region);
+	SparseVolume<uint8_t> sparseVol;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				rawVol.setVoxel(x, y, z, sphereDensity(x, y, z, fRadius));
+				sparseVol.setVoxel(x, y, z, sphereDensity(x, y, z, fRadius));
+			}
+		}
+	}
+
+	QVERIFY(sparseVol.getNoOfActiveVoxels() < static_cast<uint64_t>(region.getWidthInVoxels()) * region.getHeightInVoxels() * region.getDepthInVoxels() / 2);
+
+	Region regExtract(region);
+	regExtract.shrink(1);
+	auto rawMesh = extractMarchingCubesMesh(&rawVol, regExtract);
+	auto sparseMesh = extractMarchingCubesMesh(&sparseVol, regExtract);
+
+	QVERIFY(rawMesh.getNoOfVertices() > 0);
+	QCOMPARE(rawMesh.getNoOfVertices(), sparseMesh.getNoOfVertices());
+	QCOMPARE(rawMesh.getNoOfIndices(), sparseMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < rawMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(rawMesh.getVertex(ct).encodedPosition, sparseMesh.getVertex(ct).encodedPosition);
+		QCOMPARE(rawMesh.getVertex(ct).encodedNormal, sparseMesh.getVertex(ct).encodedNormal);
+	}
+	for (uint32_t ct = 0; ct < rawMesh.getNoOfIndices(); ct++)
+	{
+		QCOMPARE(rawMesh.getIndex(ct), sparseMesh.getIndex(ct));
+	}
+}
+
+QTEST_MAIN(TestSparseVolume)
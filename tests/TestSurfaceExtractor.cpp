@@ -228,4 +228,54 @@ void TestSurfaceExtractor::testNoiseVolumePerformance()
 	QCOMPARE(noiseMesh.getNoOfVertices(), uint16_t(35672));
 }
 
+void TestSurfaceExtractor::testUncheckedSampler()
+{
+	// The same noise in a RawVolume, which is read without bounds checks when the region is well inside it, and in a
+	// PagedVolume which is always read with them. Both should give exactly the same mesh.
+	Region regVolume(-20, -10, 0, 75, 60, 63);
+	RawVolume<float> rawVol(regVolume);
+	FilePager<float> pager(".");
+	PagedVolume<float> pagedVol(&pager);
+	std::mt19937 rng;
+	for (int32_t z = regVolume.getLowerZ(); z <= regVolume.getUpperZ(); z++)
+	{
+		for (int32_t y = regVolume.getLowerY(); y <= regVolume.getUpperY(); y++)
+		{
+			for (int32_t x = regVolume.getLowerX(); x <= regVolume.getUpperX(); x++)
+			{
+				float voxelValue = static_cast<float>(rng()) / static_cast<float>(std::numeric_limits<int32_t>::max()) - 1.0f;
+				rawVol.setVoxel(x, y, z, voxelValue);
+				pagedVol.setVoxel(x, y, z, voxelValue);
+			}
+		}
+	}
+
+	// Only touches the edge of the volume through the one voxel border needed for the normals.
+	Region regExtract(regVolume);
+	regExtract.shrink(1);
+
+	Mesh< MarchingCubesVertex< float > > rawMesh;
+	QBENCHMARK{ extractMarchingCubesMeshCustom(&rawVol, regExtract, &rawMesh); }
+	Mesh< MarchingCubesVertex< float > > pagedMesh;
+	QBENCHMARK{ extractMarchingCubesMeshCustom(&pagedVol, regExtract, &pagedMesh); }
+
+	QVERIFY(rawMesh.getNoOfVertices() > 0);
+	QCOMPARE(rawMesh.getNoOfVertices(), pagedMesh.getNoOfVertices());
+	QCOMPARE(rawMesh.getNoOfIndices(), pagedMesh.getNoOfIndices());
+	for (uint32_t ct = 0; ct < rawMesh.getNoOfVertices(); ct++)
+	{
+		QCOMPARE(rawMesh.getVertex(ct).encodedPosition, pagedMesh.getVertex(ct).encodedPosition);
+		QCOMPARE(rawMesh.getVertex(ct).encodedNormal, pagedMesh.getVertex(ct).encodedNormal);
+	}
+	for (uint32_t ct = 0; ct < rawMesh.getNoOfIndices(); ct++)
+	{
+		QCOMPARE(rawMesh.getIndex(ct), pagedMesh.getIndex(ct));
+	}
+
+	// The whole volume needs the bounds checks, and the voxels outside it come from the border value.
+	rawVol.setBorderValue(-1.0f);
+	auto borderMesh = extractMarchingCubesMesh(&rawVol, regVolume);
+	QVERIFY(borderMesh.getNoOfVertices() > rawMesh.getNoOfVertices());
+}
+
 QTEST_MAIN(TestSurfaceExtractor)
@@ -0,0 +1,271 @@
+/*******************************************************************************
+* The MIT License (MIT)
+*
+* Copyright (c) 2015 Matthew Williams and David Williams
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*******************************************************************************/
+
+#include "TestVolumeCopy.h"
+
+#include "MemoryPager.h"
+
+#include "PolyVox/PagedVolume.h"
+#include "PolyVox/RawVolume.h"
+#include "PolyVox/VolumeCopy.h"
+#include "PolyVox/VolumeResampler.h"
+
+#include <QtTest>
+
+using namespace PolyVox;
+
+// A value which is different for every position, and which still fits in a uint8_t after being halved.
+int32_t testValue(int32_t x, int32_t y, int32_t z)
+{
+	return ((x * 7 + y * 13 + z * 29) & 0xFF) / 2 + 1;
+}
+
+template <typename VolumeType>
+void fillVolume(VolumeType* pVolume, const Region& region)
+{
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				pVolume->setVoxel(x, y, z, static_cast<typename VolumeType::VoxelType>(testValue(x, y, z)));
+			}
+		}
+	}
+}
+
+// Checks that 'regSrc' of a volume filled by fillVolume() ended up at 'v3dDstLowerCorner', and that the voxels in 'regCheck' around it are untouched.
+template <typename VolumeType>
+bool checkCopy(VolumeType* pVolume, const Region& regSrc, const Vector3DInt32& v3dDstLowerCorner, const Region& regCheck, typename VolumeType::VoxelType tUntouched)
+{
+	Region regDst = regSrc;
+	regDst.shift(v3dDstLowerCorner - regSrc.getLowerCorner());
+	const Vector3DInt32 v3dOffset = regSrc.getLowerCorner() - v3dDstLowerCorner;
+	for (int32_t z = regCheck.getLowerZ(); z <= regCheck.getUpperZ(); z++)
+	{
+		for (int32_t y = regCheck.getLowerY(); y <= regCheck.getUpperY(); y++)
+		{
+			for (int32_t x = regCheck.getLowerX(); x <= regCheck.getUpperX(); x++)
+			{
+				typename VolumeType::VoxelType tExpected = tUntouched;
+				if (regDst.containsPoint(x, y, z))
+				{
+					tExpected = static_cast<typename VolumeType::VoxelType>(testValue(x + v3dOffset.getX(), y + v3dOffset.getY(), z + v3dOffset.getZ()));
+				}
+				if (pVolume->getVoxel(x, y, z) != tExpected)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void TestVolumeCopy::testRawToRaw()
+{
+	Region regSrcVolume(-10, -5, 0, 20, 25, 30);
+	RawVolume<uint8_t> volSrc(regSrcVolume);
+	fillVolume(&volSrc, regSrcVolume);
+
+	Region regDstVolume(100, 100, 100, 140, 140, 140);
+	Region regSrc(-7, -3, 2, 15, 21, 19);
+	Vector3DInt32 v3dDstLowerCorner(105, 110, 101);
+
+	// Same voxel type
+	RawVolume<uint8_t> volDst(regDstVolume);
+	copyVolume(&volSrc, regSrc, &volDst, v3dDstLowerCorner);
+	QVERIFY(checkCopy(&volDst, regSrc, v3dDstLowerCorner, regDstVolume, 0));
+
+	// Converted voxel type
+	RawVolume<float> volFloatDst(regDstVolume);
+	copyVolume(&volSrc, regSrc, &volFloatDst, v3dDstLowerCorner);
+	QVERIFY(checkCopy(&volFloatDst, regSrc, v3dDstLowerCorner, regDstVolume, 0.0f));
+
+	// Part of the source is outside the volume, so the border value is copied.
+	volSrc.setBorderValue(200);
+	Region regPartlyOutside(15, 20, 25, 24, 29, 34);
+	RawVolume<uint8_t> volBorderDst(regDstVolume);
+	copyVolume(&volSrc, regPartlyOutside, &volBorderDst, regDstVolume.getLowerCorner());
+	QCOMPARE(volBorderDst.getVoxel(100, 100, 100), static_cast<uint8_t>(testValue(15, 20, 25)));
+	QCOMPARE(volBorderDst.getVoxel(109, 109, 109), static_cast<uint8_t>(200));
+
+	// A destination which doesn't fit in the volume is still an error.
+	bool bThrown = false;
+	try
+	{
+		copyVolume(&volSrc, regSrc, &volDst, Vector3DInt32(130, 130, 130));
+	}
+	catch (std::out_of_range&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+}
+
+void TestVolumeCopy::testPagedToPaged()
+{
+	MemoryPager<int16_t> srcPager;
+	PagedVolume<int16_t> volSrc(&srcPager, 1024 * 1024, 16);
+	Region regSrcData(-40, -40, -40, 39, 39, 39);
+	fillVolume(&volSrc, regSrcData);
+
+	// A region which covers whole chunks in the middle and partial chunks at the edges.
+	Region regSrc(-37, -20, -5, 36, 17, 30);
+	Region regCheck(regSrc);
+	regCheck.grow(20);
+
+	// Chunk aligned, so that chunks are copied directly. The small memory limit makes sure
+	// that the destination chunks are paged out and back in, so they must be marked as modified.
+	{
+		MemoryPager<int16_t> dstPager;
+		PagedVolume<int16_t> volDst(&dstPager, 1024 * 1024, 16);
+		Vector3DInt32 v3dDstLowerCorner = regSrc.getLowerCorner() + Vector3DInt32(32, -48, 16);
+		copyVolume(&volSrc, regSrc, &volDst, v3dDstLowerCorner);
+		Region regDstCheck(regCheck);
+		regDstCheck.shift(32, -48, 16);
+		QVERIFY(checkCopy(&volDst, regSrc, v3dDstLowerCorner, regDstCheck, 0));
+	}
+
+	// Chunk aligned, with conversion.
+	{
+		MemoryPager<float> dstPager;
+		PagedVolume<float> volDst(&dstPager, 1024 * 1024, 16);
+		copyVolume(&volSrc, regSrc, &volDst, regSrc.getLowerCorner());
+		QVERIFY(checkCopy(&volDst, regSrc, regSrc.getLowerCorner(), regCheck, 0.0f));
+	}
+
+	// Chunks which don't line up.
+	{
+		MemoryPager<int16_t> dstPager;
+		PagedVolume<int16_t> volDst(&dstPager, 1024 * 1024, 16);
+		Vector3DInt32 v3dDstLowerCorner = regSrc.getLowerCorner() + Vector3DInt32(3, 0, -5);
+		copyVolume(&volSrc, regSrc, &volDst, v3dDstLowerCorner);
+		Region regDstCheck(regCheck);
+		regDstCheck.shift(3, 0, -5);
+		QVERIFY(checkCopy(&volDst, regSrc, v3dDstLowerCorner, regDstCheck, 0));
+	}
+
+	// Chunks of different sizes.
+	{
+		MemoryPager<int16_t> dstPager;
+		PagedVolume<int16_t> volDst(&dstPager, 1024 * 1024, 8);
+		copyVolume(&volSrc, regSrc, &volDst, regSrc.getLowerCorner());
+		QVERIFY(checkCopy(&volDst, regSrc, regSrc.getLowerCorner(), regCheck, 0));
+	}
+
+	// Volumes with a fixed chunk size, copied to and from each other.
+	{
+		MemoryPager<int16_t> fixedPager;
+		PagedVolume<int16_t, 16> volFixed(&fixedPager, 1024 * 1024);
+		copyVolume(&volSrc, regSrc, &volFixed, regSrc.getLowerCorner());
+		QVERIFY(checkCopy(&volFixed, regSrc, regSrc.getLowerCorner(), regCheck, 0));
+
+		MemoryPager<int16_t> dstPager;
+		PagedVolume<int16_t, 16> volDst(&dstPager, 1024 * 1024);
+		Vector3DInt32 v3dDstLowerCorner = regSrc.getLowerCorner() + Vector3DInt32(-16, 0, 64);
+		copyVolume(&volFixed, regSrc, &volDst, v3dDstLowerCorner);
+		Region regDstCheck(regCheck);
+		regDstCheck.shift(-16, 0, 64);
+		QVERIFY(checkCopy(&volDst, regSrc, v3dDstLowerCorner, regDstCheck, 0));
+	}
+}
+
+void TestVolumeCopy::testBetweenRawAndPaged()
+{
+	Region regData(-20, -20, -20, 40, 40, 40);
+	RawVolume<uint8_t> volRaw(regData);
+	fillVolume(&volRaw, regData);
+
+	Region regSrc(-17, -3, 5, 33, 38, 21);
+	Region regCheck(regSrc);
+	regCheck.grow(10);
+
+	MemoryPager<int32_t> pager;
+	PagedVolume<int32_t> volPaged(&pager, 1024 * 1024, 16);
+	Vector3DInt32 v3dPagedLowerCorner(-100, 50, 7);
+	copyVolume(&volRaw, regSrc, &volPaged, v3dPagedLowerCorner);
+	Region regPagedCheck(regCheck);
+	regPagedCheck.shift(v3dPagedLowerCorner - regSrc.getLowerCorner());
+	QVERIFY(checkCopy(&volPaged, regSrc, v3dPagedLowerCorner, regPagedCheck, 0));
+
+	// Copy it back again, to a different place.
+	Region regPaged(regSrc);
+	regPaged.shift(v3dPagedLowerCorner - regSrc.getLowerCorner());
+	RawVolume<uint8_t> volRawResult(regData);
+	copyVolume(&volPaged, regPaged, &volRawResult, regData.getLowerCorner());
+	QVERIFY(checkCopy(&volRawResult, regSrc, regData.getLowerCorner(), regData, 0));
+
+	// The same with a fixed chunk size.
+	MemoryPager<int32_t> fixedPager;
+	PagedVolume<int32_t, 32> volFixed(&fixedPager, 1024 * 1024);
+	copyVolume(&volRaw, regSrc, &volFixed, v3dPagedLowerCorner);
+	QVERIFY(checkCopy(&volFixed, regSrc, v3dPagedLowerCorner, regPagedCheck, 0));
+	RawVolume<uint8_t> volFixedResult(regData);
+	copyVolume(&volFixed, regPaged, &volFixedResult, regData.getLowerCorner());
+	QVERIFY(checkCopy(&volFixedResult, regSrc, regData.getLowerCorner(), regData, 0));
+}
+
+void TestVolumeCopy::testResampler()
+{
+	Region regData(0, 0, 0, 31, 31, 31);
+	RawVolume<uint8_t> volSrc(regData);
+	fillVolume(&volSrc, regData);
+
+	Region regSrc(4, 5, 6, 20, 21, 22);
+	Region regDst(regSrc);
+	regDst.shift(10, 10, 9);
+	RawVolume<uint16_t> volDst(regData);
+	VolumeResampler< RawVolume<uint8_t>, RawVolume<uint16_t> > resampler(&volSrc, regSrc, &volDst, regDst);
+	resampler.execute();
+	QVERIFY(checkCopy(&volDst, regSrc, regDst.getLowerCorner(), regData, 0));
+}
+
+void TestVolumeCopy::testPerformance()
+{
+	Region regData(0, 0, 0, 255, 255, 127);
+	RawVolume<uint8_t> volSrc(regData);
+	fillVolume(&volSrc, regData);
+	RawVolume<uint8_t> volDst(regData);
+
+	QBENCHMARK{
+		copyVolume(&volSrc, regData, &volDst, regData.getLowerCorner());
+	}
+
+	MemoryPager<uint8_t> srcPager;
+	PagedVolume<uint8_t> volPagedSrc(&srcPager, 64 * 1024 * 1024, 32);
+	copyVolume(&volSrc, regData, &volPagedSrc, regData.getLowerCorner());
+	MemoryPager<uint8_t> dstPager;
+	PagedVolume<uint8_t> volPagedDst(&dstPager, 64 * 1024 * 1024, 32);
+
+	QBENCHMARK{
+		copyVolume(&volPagedSrc, regData, &volPagedDst, regData.getLowerCorner());
+	}
+
+	QCOMPARE(volDst.getVoxel(100, 200, 50), static_cast<uint8_t>(testValue(100, 200, 50)));
+	QCOMPARE(volPagedDst.getVoxel(100, 200, 50), static_cast<uint8_t>(testValue(100, 200, 50)));
+}
+
+QTEST_MAIN(TestVolumeCopy)
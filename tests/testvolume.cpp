@@ -25,6 +25,9 @@
 #include "testvolume.h"
 
 #include "PolyVox/FilePager.h"
+#include "PolyVox/LodVolume.h"
+#include "PolyVox/MarchingCubesSurfaceExtractor.h"
+#include "PolyVox/Mipmap.h"
 #include "PolyVox/PagedVolume.h"
 #include "PolyVox/RawVolume.h"
 
@@ -260,11 +263,17 @@ TestVolume::TestVolume()
 
 	m_pFilePager = new FilePager<int32_t>(".");
 	m_pFilePagerHighMem = new FilePager<int32_t>(".");
+	m_pFilePagerSmallChunks = new FilePager<int32_t>(".");
+	m_pFilePagerFixedChunks = new FilePager<int32_t>(".");
 
 	//Create the volumes
 	m_pRawVolume = new RawVolume<int32_t>(m_regVolume);
+	m_pRawVolumeBricked = new RawVolume<int32_t, RawVolumeLayouts::Bricked>(m_regVolume);
 	m_pPagedVolume = new PagedVolume<int32_t>(m_pFilePager, 1 * 1024 * 1024, m_uChunkSideLength);
 	m_pPagedVolumeHighMem = new PagedVolume<int32_t>(m_pFilePagerHighMem, 256 * 1024 * 1024, m_uChunkSideLength);
+	// Most sampler moves and peeks cross a chunk boundary in this volume.
+	m_pPagedVolumeSmallChunks = new PagedVolume<int32_t>(m_pFilePagerSmallChunks, 256 * 1024 * 1024, 8);
+	m_pPagedVolumeFixedChunks = new PagedVolume<int32_t, m_uChunkSideLength>(m_pFilePagerFixedChunks, 256 * 1024 * 1024);
 
 	//Fill the volume with some data
 	for (int z = m_regVolume.getLowerZ(); z <= m_regVolume.getUpperZ(); z++)
@@ -275,8 +284,11 @@ TestVolume::TestVolume()
 			{
 				int32_t value = x + y + z;
 				m_pRawVolume->setVoxel(x, y, z, value);
+				m_pRawVolumeBricked->setVoxel(x, y, z, value);
 				m_pPagedVolume->setVoxel(x, y, z, value);
 				m_pPagedVolumeHighMem->setVoxel(x, y, z, value);
+				m_pPagedVolumeSmallChunks->setVoxel(x, y, z, value);
+				m_pPagedVolumeFixedChunks->setVoxel(x, y, z, value);
 			}
 		}
 	}
@@ -300,9 +312,14 @@ TestVolume::~TestVolume()
 	delete m_pPagedVolumeChunk;
 
 	delete m_pRawVolume;
+	delete m_pRawVolumeBricked;
 	delete m_pPagedVolume;
+	delete m_pPagedVolumeSmallChunks;
+	delete m_pPagedVolumeFixedChunks;
 
 	delete m_pFilePager;
+	delete m_pFilePagerSmallChunks;
+	delete m_pFilePagerFixedChunks;
 }
 
 /*
@@ -397,6 +414,108 @@ void TestVolume::testRawVolumeSamplersWithExternalBackwards()
 	QCOMPARE(result, static_cast<int32_t>(-993539594));
 }
 
+void TestVolume::testRawVolumeBrickedDirectAccess()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testDirectAccessWithWrappingForwards(m_pRawVolumeBricked, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+
+	result = testDirectAccessWithWrappingBackwards(m_pRawVolumeBricked, m_regExternal);
+	QCOMPARE(result, static_cast<int32_t>(-993539594));
+}
+
+void TestVolume::testRawVolumeBrickedSamplers()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testSamplersWithWrappingForwards(m_pRawVolumeBricked, m_regInternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(1004598054));
+
+	result = testSamplersWithWrappingForwards(m_pRawVolumeBricked, m_regExternal);
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+	result = testSamplersWithWrappingBackwards(m_pRawVolumeBricked, m_regInternal);
+	QCOMPARE(result, static_cast<int32_t>(-269366578));
+	result = testSamplersWithWrappingBackwards(m_pRawVolumeBricked, m_regExternal);
+	QCOMPARE(result, static_cast<int32_t>(-993539594));
+}
+
+// Sums the 3x3x3 neighbourhood of every voxel in the region, sweeping along z. In the linear layout
+// each step moves a whole slice and the neighbourhood spans nine rows in three different slices.
+template <typename SamplerType, typename VolumeType>
+int64_t sumNeighbourhoodsAlongZ(VolumeType* volume, const Region& region)
+{
+	int64_t result = 0;
+	SamplerType sampler(volume);
+	for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+	{
+		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+		{
+			sampler.setPosition(x, y, region.getLowerZ());
+			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+			{
+				result += sampler.peekVoxel1nx1ny1nz() + sampler.peekVoxel0px1ny1nz() + sampler.peekVoxel1px1ny1nz();
+				result += sampler.peekVoxel1nx0py1nz() + sampler.peekVoxel0px0py1nz() + sampler.peekVoxel1px0py1nz();
+				result += sampler.peekVoxel1nx1py1nz() + sampler.peekVoxel0px1py1nz() + sampler.peekVoxel1px1py1nz();
+				result += sampler.peekVoxel1nx1ny0pz() + sampler.peekVoxel0px1ny0pz() + sampler.peekVoxel1px1ny0pz();
+				result += sampler.peekVoxel1nx0py0pz() + sampler.peekVoxel0px0py0pz() + sampler.peekVoxel1px0py0pz();
+				result += sampler.peekVoxel1nx1py0pz() + sampler.peekVoxel0px1py0pz() + sampler.peekVoxel1px1py0pz();
+				result += sampler.peekVoxel1nx1ny1pz() + sampler.peekVoxel0px1ny1pz() + sampler.peekVoxel1px1ny1pz();
+				result += sampler.peekVoxel1nx0py1pz() + sampler.peekVoxel0px0py1pz() + sampler.peekVoxel1px0py1pz();
+				result += sampler.peekVoxel1nx1py1pz() + sampler.peekVoxel0px1py1pz() + sampler.peekVoxel1px1py1pz();
+				sampler.movePositiveZ();
+			}
+		}
+	}
+	return result;
+}
+
+void TestVolume::testRawVolumeLayoutNeighbourhoods()
+{
+	// Large enough that a few slices don't fit in the cache.
+	Region regVolume(0, 0, 0, 255, 255, 255);
+	RawVolume<int32_t> volLinear(regVolume);
+	RawVolume<int32_t, RawVolumeLayouts::Bricked> volBricked(regVolume);
+	std::mt19937 rng(9876);
+	for (int32_t z = regVolume.getLowerZ(); z <= regVolume.getUpperZ(); z++)
+	{
+		for (int32_t y = regVolume.getLowerY(); y <= regVolume.getUpperY(); y++)
+		{
+			for (int32_t x = regVolume.getLowerX(); x <= regVolume.getUpperX(); x++)
+			{
+				int32_t value = static_cast<int32_t>(rng() % 1000);
+				volLinear.setVoxel(x, y, z, value);
+				volBricked.setVoxel(x, y, z, value);
+			}
+		}
+	}
+
+	Region regSweep(regVolume);
+	regSweep.shrink(1);
+
+	int64_t iLinearResult = 0;
+	QBENCHMARK
+	{
+		iLinearResult = sumNeighbourhoodsAlongZ<RawVolume<int32_t>::UncheckedSampler>(&volLinear, regSweep);
+	}
+
+	int64_t iBrickedResult = 0;
+	QBENCHMARK
+	{
+		iBrickedResult = sumNeighbourhoodsAlongZ<RawVolume<int32_t, RawVolumeLayouts::Bricked>::UncheckedSampler>(&volBricked, regSweep);
+	}
+	QCOMPARE(iBrickedResult, iLinearResult);
+
+	// The checked samplers must agree too, including when they run off the edge of the volume.
+	iLinearResult = sumNeighbourhoodsAlongZ<RawVolume<int32_t>::Sampler>(&volLinear, regVolume);
+	iBrickedResult = sumNeighbourhoodsAlongZ<RawVolume<int32_t, RawVolumeLayouts::Bricked>::Sampler>(&volBricked, regVolume);
+	QCOMPARE(iBrickedResult, iLinearResult);
+}
+
 /*
  * PagedVolume Tests
  */
@@ -481,6 +600,205 @@ void TestVolume::testPagedVolumeSamplersWithExternalBackwards()
 	QCOMPARE(result, static_cast<int32_t>(-993539594));
 }
 
+void TestVolume::testPagedVolumeDirectAccessSmallChunks()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testDirectAccessWithWrappingForwards(m_pPagedVolumeSmallChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+}
+
+void TestVolume::testPagedVolumeSamplersSmallChunks()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testSamplersWithWrappingForwards(m_pPagedVolumeSmallChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+
+	QBENCHMARK
+	{
+		result = testSamplersWithWrappingBackwards(m_pPagedVolumeSmallChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(-993539594));
+}
+
+void TestVolume::testPagedVolumeDirectAccessFixedChunkSize()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testDirectAccessWithWrappingForwards(m_pPagedVolumeFixedChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+}
+
+void TestVolume::testPagedVolumeSamplersFixedChunkSize()
+{
+	int32_t result = 0;
+	QBENCHMARK
+	{
+		result = testSamplersWithWrappingForwards(m_pPagedVolumeFixedChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(337227750));
+
+	QBENCHMARK
+	{
+		result = testSamplersWithWrappingBackwards(m_pPagedVolumeFixedChunks, m_regExternal);
+	}
+	QCOMPARE(result, static_cast<int32_t>(-993539594));
+}
+
+void TestVolume::testPagedVolumeLargeChunks()
+{
+	// Chunks this large need Morton indices beyond the old 256 voxel limit. Only two chunks are touched to keep the memory usage down.
+	FilePager<uint8_t> pager(".");
+	PagedVolume<uint8_t, 512> volData(&pager, 512 * 1024 * 1024);
+	for (int32_t x = 500; x < 524; x++)
+	{
+		volData.setVoxel(x, 511, 300, static_cast<uint8_t>(x));
+		volData.setVoxel(x, 300, 511, static_cast<uint8_t>(x + 1));
+	}
+
+	PagedVolume<uint8_t, 512>::Sampler sampler(&volData);
+	sampler.setPosition(500, 510, 300);
+	for (int32_t x = 500; x < 523; x++)
+	{
+		QCOMPARE(volData.getVoxel(x, 511, 300), static_cast<uint8_t>(x));
+		QCOMPARE(volData.getVoxel(x, 300, 511), static_cast<uint8_t>(x + 1));
+		QCOMPARE(sampler.peekVoxel1px1py0pz(), static_cast<uint8_t>(x + 1));
+		sampler.movePositiveX();
+	}
+
+	// The same data through a volume whose chunk size is only known at runtime.
+	FilePager<uint8_t> pagerRuntime(".");
+	PagedVolume<uint8_t> volRuntime(&pagerRuntime, 512 * 1024 * 1024, 512);
+	volRuntime.setVoxel(511, 300, 511, 42);
+	volRuntime.setVoxel(512, 300, 511, 43);
+	PagedVolume<uint8_t>::Sampler samplerRuntime(&volRuntime);
+	samplerRuntime.setPosition(511, 300, 511);
+	QCOMPARE(samplerRuntime.getVoxel(), static_cast<uint8_t>(42));
+	QCOMPARE(samplerRuntime.peekVoxel1px0py0pz(), static_cast<uint8_t>(43));
+}
+
+void TestVolume::testPagedVolumeChunkLargerThanTarget()
+{
+	// A 1024^3 chunk of floats is 4Gb, which does not even fit in 32 bits. It can never be within the memory target.
+	FilePager<float> pager(".");
+	bool bThrown = false;
+	try
+	{
+		PagedVolume<float> volData(&pager, 256 * 1024 * 1024, 1024);
+	}
+	catch (std::invalid_argument&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+
+	bThrown = false;
+	try
+	{
+		PagedVolume<float, 1024> volData(&pager, 256 * 1024 * 1024);
+	}
+	catch (std::invalid_argument&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+
+	// Smaller than 4Gb, but still larger than the target.
+	bThrown = false;
+	try
+	{
+		PagedVolume<float> volData(&pager, 256 * 1024 * 1024, 512);
+	}
+	catch (std::invalid_argument&)
+	{
+		bThrown = true;
+	}
+	QVERIFY(bThrown);
+}
+
+void TestVolume::testPagedVolumeSamplerWrites()
+{
+	// The volume is much bigger than the memory limit, so chunks are paged out while the samplers are using them.
+	FilePager<int32_t> pager(".");
+	PagedVolume<int32_t> volData(&pager, 1 * 1024 * 1024, 16);
+	Region regWrite(-40, -20, -30, 119, 43, 33);
+
+	PagedVolume<int32_t>::Sampler writer(&volData);
+	PagedVolume<int32_t>::Sampler reader(&volData);
+	for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+	{
+		for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+		{
+			writer.setPosition(regWrite.getLowerX(), y, z);
+			for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+			{
+				QVERIFY(writer.setVoxel(x * y + z));
+				writer.movePositiveX();
+
+				// Another sampler wandering around a distant part of the volume, and
+				// a copy which is destroyed again, should not affect the one writing.
+				reader.setPosition(-x * 7, z * 13, y * 11);
+				PagedVolume<int32_t>::Sampler copy(writer);
+				copy.movePositiveY();
+			}
+		}
+	}
+
+	volData.flushAll();
+	for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+	{
+		for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+		{
+			for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+			{
+				QCOMPARE(volData.getVoxel(x, y, z), x * y + z);
+			}
+		}
+	}
+
+	// Writing through a sampler should be faster than writing directly.
+	FilePager<int32_t> pagerFast(".");
+	PagedVolume<int32_t> volFast(&pagerFast, 64 * 1024 * 1024, 16);
+	QBENCHMARK
+	{
+		for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+		{
+			for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+			{
+				for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+				{
+					volFast.setVoxel(x, y, z, x + y + z);
+				}
+			}
+		}
+	}
+
+	PagedVolume<int32_t>::Sampler sampler(&volFast);
+	QBENCHMARK
+	{
+		for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+		{
+			for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+			{
+				sampler.setPosition(regWrite.getLowerX(), y, z);
+				for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+				{
+					sampler.setVoxel(x - y - z);
+					sampler.movePositiveX();
+				}
+			}
+		}
+	}
+	QCOMPARE(volFast.getVoxel(10, 20, 30), 10 - 20 - 30);
+}
+
 /*
  * Random access tests
  */
@@ -600,4 +918,472 @@ void TestVolume::testPagedVolumeChunkRandomAccess()
 	QCOMPARE(result, static_cast<int32_t>(71649197));
 }
 
+// Counts how often chunks are paged in, to check that reduced resolution data can be read without them.
+class CountingFilePager : public FilePager<uint8_t>
+{
+public:
+	CountingFilePager() : FilePager<uint8_t>("."), m_uNoOfChunksPagedIn(0) {}
+
+	virtual void pageIn(const Region& region, PagedVolume<uint8_t>::Chunk* pChunk)
+	{
+		m_uNoOfChunksPagedIn++;
+		FilePager<uint8_t>::pageIn(region, pChunk);
+	}
+
+	uint32_t m_uNoOfChunksPagedIn;
+};
+
+// Compares each level kept by a PagedVolume with a mipmap chain built from a copy of it.
+bool lodLevelsMatch(const PagedVolume<uint8_t>& volPaged, const std::vector<RawVolume<uint8_t>*>& vecLevels)
+{
+	for (uint32_t uLevel = 1; uLevel <= vecLevels.size(); uLevel++)
+	{
+		const Region& regLevel = vecLevels[uLevel - 1]->getEnclosingRegion();
+		for (int32_t z = regLevel.getLowerZ(); z <= regLevel.getUpperZ(); z++)
+		{
+			for (int32_t y = regLevel.getLowerY(); y <= regLevel.getUpperY(); y++)
+			{
+				for (int32_t x = regLevel.getLowerX(); x <= regLevel.getUpperX(); x++)
+				{
+					if (volPaged.getLodVoxel(uLevel, x, y, z) != vecLevels[uLevel - 1]->getVoxel(x, y, z))
+					{
+						return false;
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void TestVolume::testPagedVolumeLod()
+{
+	// Twice as many chunks as the volume can hold, so that they are paged out while the levels are in use.
+	const Region regData(-64, -32, 0, 191, 95, 63);
+	const uint32_t uNoOfLevels = 3;
+
+	CountingFilePager pager;
+	PagedVolume<uint8_t> volPaged(&pager, 1 * 1024 * 1024, m_uChunkSideLength);
+	volPaged.setNoOfLodLevels(uNoOfLevels);
+	QCOMPARE(volPaged.getNoOfLodLevels(), uNoOfLevels);
+
+	RawVolume<uint8_t> volRaw(regData);
+	std::vector<RawVolume<uint8_t>*> vecLevels;
+	for (uint32_t uLevel = 1; uLevel <= uNoOfLevels; uLevel++)
+	{
+		vecLevels.push_back(new RawVolume<uint8_t>(getMipmapRegion(regData, uLevel)));
+	}
+
+	std::mt19937 rng(42);
+	for (int32_t z = regData.getLowerZ(); z <= regData.getUpperZ(); z++)
+	{
+		for (int32_t y = regData.getLowerY(); y <= regData.getUpperY(); y++)
+		{
+			for (int32_t x = regData.getLowerX(); x <= regData.getUpperX(); x++)
+			{
+				uint8_t uValue = static_cast<uint8_t>((y < 16) ? (rng() & 0xFF) : 0);
+				volRaw.setVoxel(x, y, z, uValue);
+				volPaged.setVoxel(x, y, z, uValue);
+			}
+		}
+	}
+
+	generateMipmaps(&volRaw, regData, vecLevels, MipmapModes::Average, 1);
+	QVERIFY(lodLevelsMatch(volPaged, vecLevels));
+
+	// Changes are picked up both by chunks which are still in memory and by those which are paged out after the change.
+	for (int32_t iChange = 0; iChange < 2000; iChange++)
+	{
+		int32_t x = regData.getLowerX() + static_cast<int32_t>(rng() % regData.getWidthInVoxels());
+		int32_t y = regData.getLowerY() + static_cast<int32_t>(rng() % regData.getHeightInVoxels());
+		int32_t z = regData.getLowerZ() + static_cast<int32_t>(rng() % regData.getDepthInVoxels());
+		volRaw.setVoxel(x, y, z, 255);
+		volPaged.setVoxel(x, y, z, 255);
+	}
+	generateMipmaps(&volRaw, regData, vecLevels, MipmapModes::Average, 1);
+	QVERIFY(lodLevelsMatch(volPaged, vecLevels));
+
+	// Once everything has been paged out the levels come from the pager, without paging in any chunks.
+	volPaged.flushAll();
+	const uint32_t uNoOfChunksPagedIn = pager.m_uNoOfChunksPagedIn;
+	QVERIFY(lodLevelsMatch(volPaged, vecLevels));
+	QCOMPARE(pager.m_uNoOfChunksPagedIn, uNoOfChunksPagedIn);
+
+	// A view of a level can be used in place of a volume.
+	LodVolume<uint8_t> volLod(&volPaged, 2);
+	QCOMPARE(volLod.getVoxel(5, -3, 7), vecLevels[1]->getVoxel(5, -3, 7));
+	Region regExtract = getMipmapRegion(regData, 2);
+	regExtract.shrink(1); // The extractor looks at neighbouring voxels.
+	auto mesh = extractMarchingCubesMesh(&volLod, regExtract);
+	QVERIFY(mesh.getNoOfVertices() > 0);
+	QCOMPARE(pager.m_uNoOfChunksPagedIn, uNoOfChunksPagedIn);
+
+	for (uint32_t uLevel = 0; uLevel < uNoOfLevels; uLevel++)
+	{
+		delete vecLevels[uLevel];
+	}
+}
+
+// Exposes how many files the pager has written, to check that identical chunks are only stored once.
+class DeduplicatingFilePager : public FilePager<int32_t>
+{
+public:
+	DeduplicatingFilePager() : FilePager<int32_t>(".", true) {}
+
+	uint32_t getNoOfFiles(void) const
+	{
+		return static_cast<uint32_t>(m_vecCreatedFiles.size());
+	}
+};
+
+void TestVolume::testPagedVolumeChunkDeduplication()
+{
+	const uint32_t uChunkSizeInBytes = 16 * 16 * 16 * sizeof(int32_t);
+	const Region regChunks(0, 0, 0, 127, 31, 31); // 32 chunks.
+
+	DeduplicatingFilePager pager;
+	PagedVolume<int32_t> volData(&pager, 4 * 1024 * 1024, 16);
+	volData.setChunkDeduplicationEnabled(true);
+	QVERIFY(volData.isChunkDeduplicationEnabled());
+
+	// Empty chunks all share the same data.
+	volData.prefetch(regChunks);
+	QCOMPARE(volData.calculateSizeInBytes(), uChunkSizeInBytes);
+
+	// Writes are not seen by the identical chunks.
+	volData.setVoxel(5, 5, 5, 7);
+	QCOMPARE(volData.getVoxel(5, 5, 5), 7);
+	QCOMPARE(volData.getVoxel(21, 5, 5), 0);
+	QCOMPARE(volData.calculateSizeInBytes(), uChunkSizeInBytes * 2);
+
+	{
+		// Writing to a chunk which a sampler is in, through either the volume or another sampler.
+		PagedVolume<int32_t>::Sampler samplerA(&volData);
+		PagedVolume<int32_t>::Sampler samplerB(&volData);
+		samplerA.setPosition(40, 8, 8);
+		samplerB.setPosition(60, 8, 8);
+		volData.setVoxel(40, 8, 8, 3);
+		QCOMPARE(samplerA.getVoxel(), 3);
+		QCOMPARE(samplerB.getVoxel(), 0);
+		QCOMPARE(volData.getVoxel(88, 8, 8), 0);
+
+		QVERIFY(samplerB.setVoxel(9));
+		QCOMPARE(volData.getVoxel(60, 8, 8), 9);
+		QCOMPARE(volData.getVoxel(104, 8, 8), 0);
+
+		samplerA.setPosition(47, 8, 8);
+		QCOMPARE(samplerA.peekVoxel1px0py0pz(), 0);
+		samplerA.setPosition(63, 8, 8);
+		QCOMPARE(samplerA.peekVoxel0px0py0pz(), 0);
+		QCOMPARE(samplerA.peekVoxel1px0py0pz(), 0);
+		samplerA.setPosition(60, 8, 8);
+		QCOMPARE(samplerA.getVoxel(), 9);
+	}
+
+	// Chunks which are all modified in the same way are stored once by the pager, and share their data again when paged back in.
+	for (int32_t z = regChunks.getLowerZ(); z <= regChunks.getUpperZ(); z++)
+	{
+		for (int32_t y = regChunks.getLowerY(); y <= regChunks.getUpperY(); y++)
+		{
+			for (int32_t x = regChunks.getLowerX(); x <= regChunks.getUpperX(); x++)
+			{
+				volData.setVoxel(x, y, z, (x & 15) + (y & 15) * (z & 15));
+			}
+		}
+	}
+	QCOMPARE(volData.calculateSizeInBytes(), uChunkSizeInBytes * 32);
+
+	volData.flushAll();
+	QCOMPARE(pager.getNoOfFiles(), 32u + 1u);
+
+	volData.prefetch(regChunks);
+	QCOMPARE(volData.calculateSizeInBytes(), uChunkSizeInBytes);
+	for (int32_t z = regChunks.getLowerZ(); z <= regChunks.getUpperZ(); z++)
+	{
+		for (int32_t y = regChunks.getLowerY(); y <= regChunks.getUpperY(); y++)
+		{
+			for (int32_t x = regChunks.getLowerX(); x <= regChunks.getUpperX(); x++)
+			{
+				QCOMPARE(volData.getVoxel(x, y, z), (x & 15) + (y & 15) * (z & 15));
+			}
+		}
+	}
+
+	// As in testPagedVolumeSamplerWrites(), but with chunks being paged out while the samplers are using them.
+	DeduplicatingFilePager pagerSmall;
+	PagedVolume<int32_t> volSmall(&pagerSmall, 1 * 1024 * 1024, 16);
+	volSmall.setChunkDeduplicationEnabled(true);
+	Region regWrite(-40, -20, -30, 55, 11, 1);
+	{
+		PagedVolume<int32_t>::Sampler writer(&volSmall);
+		PagedVolume<int32_t>::Sampler reader(&volSmall);
+		for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+		{
+			for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+			{
+				writer.setPosition(regWrite.getLowerX(), y, z);
+				for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+				{
+					QVERIFY(writer.setVoxel((x & 3) * y + z));
+					writer.movePositiveX();
+					reader.setPosition(-x * 7, z * 13, y * 11);
+				}
+			}
+		}
+	}
+
+	volSmall.flushAll();
+	for (int32_t z = regWrite.getLowerZ(); z <= regWrite.getUpperZ(); z++)
+	{
+		for (int32_t y = regWrite.getLowerY(); y <= regWrite.getUpperY(); y++)
+		{
+			for (int32_t x = regWrite.getLowerX(); x <= regWrite.getUpperX(); x++)
+			{
+				QCOMPARE(volSmall.getVoxel(x, y, z), (x & 3) * y + z);
+			}
+		}
+	}
+
+	// Disabling it gives every chunk its own data again.
+	volData.setChunkDeduplicationEnabled(false);
+	QCOMPARE(volData.calculateSizeInBytes(), uChunkSizeInBytes * 32);
+	QCOMPARE(volData.getVoxel(17, 3, 4), 1 + 3 * 4);
+}
+
+void TestVolume::testPagedVolumeBatchedAccess()
+{
+	// Positions scattered over more chunks than the volume can hold, with some repeated.
+	const Region regData(-200, -100, -50, 199, 99, 49);
+	std::mt19937 rng(7);
+	std::vector<Vector3DInt32> vecPositions(100000);
+	std::vector<int32_t> vecValues(vecPositions.size());
+	for (uint32_t ct = 0; ct < vecPositions.size(); ct++)
+	{
+		vecPositions[ct] = Vector3DInt32(regData.getLowerX() + static_cast<int32_t>(rng() % regData.getWidthInVoxels()),
+			regData.getLowerY() + static_cast<int32_t>(rng() % regData.getHeightInVoxels()),
+			regData.getLowerZ() + static_cast<int32_t>(rng() % regData.getDepthInVoxels()));
+		vecValues[ct] = static_cast<int32_t>(ct);
+	}
+	for (uint32_t ct = 0; ct < 1000; ct++)
+	{
+		vecPositions[ct * 50 + 7] = vecPositions[ct * 50];
+	}
+
+	FilePager<int32_t> pager(".");
+	PagedVolume<int32_t> volData(&pager, 1 * 1024 * 1024, 16);
+	volData.setVoxels(vecPositions.data(), vecValues.data(), static_cast<uint32_t>(vecPositions.size()));
+
+	// Reading back gives the last value written to each position, with or without threads.
+	RawVolume<int32_t> volExpected(regData);
+	for (uint32_t ct = 0; ct < vecPositions.size(); ct++)
+	{
+		volExpected.setVoxel(vecPositions[ct], vecValues[ct]);
+	}
+	std::vector<int32_t> vecExpected(vecPositions.size());
+	for (uint32_t ct = 0; ct < vecPositions.size(); ct++)
+	{
+		vecExpected[ct] = volExpected.getVoxel(vecPositions[ct]);
+		QCOMPARE(volData.getVoxel(vecPositions[ct]), vecExpected[ct]);
+	}
+	QCOMPARE(vecExpected[50], 57);
+
+	std::vector<int32_t> vecResults(vecPositions.size());
+	volData.getVoxels(vecPositions.data(), static_cast<uint32_t>(vecPositions.size()), vecResults.data());
+	QVERIFY(vecResults == vecExpected);
+
+	std::fill(vecResults.begin(), vecResults.end(), -1);
+	volData.getVoxels(vecPositions.data(), static_cast<uint32_t>(vecPositions.size()), vecResults.data(), 4);
+	QVERIFY(vecResults == vecExpected);
+
+	// Writing with several threads, into chunks which share their data, gives the same result.
+	FilePager<int32_t> pagerThreads(".");
+	PagedVolume<int32_t> volThreads(&pagerThreads, 1 * 1024 * 1024, 16);
+	volThreads.setChunkDeduplicationEnabled(true);
+	volThreads.setVoxels(vecPositions.data(), vecValues.data(), static_cast<uint32_t>(vecPositions.size()), 4);
+	std::fill(vecResults.begin(), vecResults.end(), -1);
+	volThreads.getVoxels(vecPositions.data(), static_cast<uint32_t>(vecPositions.size()), vecResults.data());
+	QVERIFY(vecResults == vecExpected);
+
+	// A volume with a fixed chunk size goes through the same batched code.
+	FilePager<int32_t> pagerFixed(".");
+	PagedVolume<int32_t, 16> volFixed(&pagerFixed, 1 * 1024 * 1024);
+	volFixed.setVoxels(vecPositions.data(), vecValues.data(), static_cast<uint32_t>(vecPositions.size()), 4);
+	std::fill(vecResults.begin(), vecResults.end(), -1);
+	volFixed.getVoxels(vecPositions.data(), static_cast<uint32_t>(vecPositions.size()), vecResults.data(), 4);
+	QVERIFY(vecResults == vecExpected);
+
+	// Compared with reading the same positions one at a time, which pages chunks in and out repeatedly when they do not all fit.
+	const uint32_t uNoOfBenchmarkPositions = 5000;
+	int32_t iSum = 0;
+	QBENCHMARK
+	{
+		for (uint32_t ct = 0; ct < uNoOfBenchmarkPositions; ct++)
+		{
+			iSum += volData.getVoxel(vecPositions[ct]);
+		}
+	}
+	QBENCHMARK
+	{
+		volData.getVoxels(vecPositions.data(), uNoOfBenchmarkPositions, vecResults.data());
+	}
+	QVERIFY(iSum != 0);
+}
+
+// Adds up the voxels in a region by walking the data of each chunk, and counts how many there were.
+template <typename VolumeType>
+std::pair<int64_t, int64_t> sumWithChunkViews(VolumeType* pVolume, const Region& region)
+{
+	std::pair<int64_t, int64_t> result(0, 0);
+	pVolume->forEachChunk(region, [&](ChunkView<int32_t>& view)
+	{
+		const Region& regView = view.getRegion();
+		for (int32_t z = regView.getLowerZ(); z <= regView.getUpperZ(); z++)
+		{
+			for (int32_t y = regView.getLowerY(); y <= regView.getUpperY(); y++)
+			{
+				for (int32_t x = regView.getLowerX(); x <= regView.getUpperX(); x++)
+				{
+					result.first += view.getData()[view.getIndex(x, y, z)];
+					result.second++;
+				}
+			}
+		}
+	});
+	return result;
+}
+
+template <typename VolumeType>
+std::pair<int64_t, int64_t> sumWithGetVoxel(VolumeType* pVolume, const Region& region)
+{
+	std::pair<int64_t, int64_t> result(0, 0);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z++)
+	{
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y++)
+		{
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x++)
+			{
+				result.first += pVolume->getVoxel(x, y, z);
+				result.second++;
+			}
+		}
+	}
+	return result;
+}
+
+void TestVolume::testRawVolumeChunkViews()
+{
+	// Partly outside the volume, which is skipped.
+	const Region region(-60, 0, 20, 30, 100, 90);
+	Region regInside(region);
+	regInside.cropTo(m_regVolume);
+	const std::pair<int64_t, int64_t> expected = sumWithGetVoxel(m_pRawVolume, regInside);
+
+	QVERIFY(sumWithChunkViews(m_pRawVolume, region) == expected);
+	QVERIFY(sumWithChunkViews(m_pRawVolumeBricked, region) == expected);
+
+	uint32_t uNoOfChunks = 0;
+	m_pRawVolume->forEachChunk(region, [&](ChunkView<int32_t>& view)
+	{
+		QCOMPARE(view.getLayout(), ChunkLayouts::Linear);
+		QCOMPARE(view.getChunkRegion(), m_regVolume);
+		uNoOfChunks++;
+	});
+	QCOMPARE(uNoOfChunks, 1u);
+
+	// Writing through the views, using the layout directly.
+	RawVolume<int32_t, RawVolumeLayouts::Bricked> volBricked(Region(0, 0, 0, 20, 20, 20));
+	volBricked.forEachChunk(Region(5, 5, 5, 14, 14, 14), [](ChunkView<int32_t>& view)
+	{
+		const Region& regView = view.getRegion();
+		const Vector3DInt32 v3dLocal = regView.getLowerCorner() - view.getChunkRegion().getLowerCorner();
+		int32_t* pData = view.getWritableData();
+		for (int32_t z = 0; z < regView.getDepthInVoxels(); z++)
+		{
+			for (int32_t y = 0; y < regView.getHeightInVoxels(); y++)
+			{
+				for (int32_t x = 0; x < regView.getWidthInVoxels(); x++)
+				{
+					pData[MortonTables::x[v3dLocal.getX() + x] | MortonTables::y[v3dLocal.getY() + y] | MortonTables::z[v3dLocal.getZ() + z]] = 1;
+				}
+			}
+		}
+	});
+	QCOMPARE(sumWithGetVoxel(&volBricked, Region(0, 0, 0, 20, 20, 20)).first, static_cast<int64_t>(10 * 10 * 10));
+	QCOMPARE(volBricked.getVoxel(5, 14, 5), 1);
+	QCOMPARE(volBricked.getVoxel(4, 14, 5), 0);
+}
+
+void TestVolume::testPagedVolumeChunkViews()
+{
+	const Region region(-70, -31, 0, 40, 100, 140);
+	QVERIFY(sumWithChunkViews(m_pPagedVolume, region) == sumWithGetVoxel(m_pPagedVolume, region));
+	QVERIFY(sumWithChunkViews(m_pPagedVolumeSmallChunks, region) == sumWithGetVoxel(m_pPagedVolumeSmallChunks, region));
+	QVERIFY(sumWithChunkViews(m_pPagedVolumeFixedChunks, region) == sumWithGetVoxel(m_pPagedVolumeFixedChunks, region));
+
+	// Thresholding in place, with too little memory for all the chunks. The changes must survive being paged out.
+	const Region regData(-100, -50, -50, 99, 49, 49);
+	FilePager<int32_t> pager(".");
+	PagedVolume<int32_t> volData(&pager, 1 * 1024 * 1024, 16);
+	volData.setChunkDeduplicationEnabled(true);
+	volData.forEachChunk(regData, [](ChunkView<int32_t>& view)
+	{
+		const Region& regView = view.getRegion();
+		int32_t* pData = view.getWritableData();
+		for (int32_t z = regView.getLowerZ(); z <= regView.getUpperZ(); z++)
+		{
+			for (int32_t y = regView.getLowerY(); y <= regView.getUpperY(); y++)
+			{
+				for (int32_t x = regView.getLowerX(); x <= regView.getUpperX(); x++)
+				{
+					pData[view.getIndex(x, y, z)] = x + y + z;
+				}
+			}
+		}
+	});
+	volData.forEachChunk(regData, [](ChunkView<int32_t>& view)
+	{
+		int32_t* pData = nullptr;
+		const Region& regView = view.getRegion();
+		for (int32_t z = regView.getLowerZ(); z <= regView.getUpperZ(); z++)
+		{
+			for (int32_t y = regView.getLowerY(); y <= regView.getUpperY(); y++)
+			{
+				for (int32_t x = regView.getLowerX(); x <= regView.getUpperX(); x++)
+				{
+					const uint32_t uIndex = view.getIndex(x, y, z);
+					if (view.getData()[uIndex] > 50)
+					{
+						// Only chunks which actually change are marked as modified.
+						pData = pData ? pData : view.getWritableData();
+						pData[uIndex] = 50;
+					}
+				}
+			}
+		}
+		QCOMPARE(view.isModified(), regView.getUpperX() + regView.getUpperY() + regView.getUpperZ() > 50);
+	});
+
+	volData.flushAll();
+	QCOMPARE(volData.getVoxel(99, 49, 49), 50);
+	QCOMPARE(volData.getVoxel(20, 20, 10), 50);
+	QCOMPARE(volData.getVoxel(20, 20, 9), 49);
+	QCOMPARE(volData.getVoxel(-100, -50, -50), -200);
+
+	// A chunk which shares its data with others gets its own copy when written.
+	FilePager<int32_t> pagerShared(".");
+	PagedVolume<int32_t> volShared(&pagerShared, 64 * 1024 * 1024, 16);
+	volShared.setChunkDeduplicationEnabled(true);
+	for (int32_t x = 0; x < 64; x++)
+	{
+		volShared.getVoxel(x, 0, 0);
+	}
+	volShared.forEachChunk(Region(16, 0, 0, 16, 0, 0), [](ChunkView<int32_t>& view)
+	{
+		view.getWritableData()[view.getIndex(16, 0, 0)] = 7;
+	});
+	QCOMPARE(volShared.getVoxel(16, 0, 0), 7);
+	QCOMPARE(volShared.getVoxel(0, 0, 0), 0);
+	QCOMPARE(volShared.getVoxel(32, 0, 0), 0);
+}
+
 QTEST_MAIN(TestVolume)
@@ -50,6 +50,10 @@ private slots:
 	void testRawVolumeDirectAccessWithExternalBackwards();
 	void testRawVolumeSamplersWithExternalBackwards();
 
+	void testRawVolumeBrickedDirectAccess();
+	void testRawVolumeBrickedSamplers();
+	void testRawVolumeLayoutNeighbourhoods();
+
 	void testPagedVolumeDirectAccessAllInternalForwards();
 	void testPagedVolumeSamplersAllInternalForwards();
 	void testPagedVolumeDirectAccessWithExternalForwards();
@@ -59,12 +63,28 @@ private slots:
 	void testPagedVolumeDirectAccessWithExternalBackwards();
 	void testPagedVolumeSamplersWithExternalBackwards();
 
+	void testPagedVolumeDirectAccessSmallChunks();
+	void testPagedVolumeSamplersSmallChunks();
+	void testPagedVolumeSamplerWrites();
+
+	void testPagedVolumeDirectAccessFixedChunkSize();
+	void testPagedVolumeSamplersFixedChunkSize();
+	void testPagedVolumeLargeChunks();
+	void testPagedVolumeChunkLargerThanTarget();
+
 	void testRawVolumeDirectRandomAccess();
 	void testPagedVolumeDirectRandomAccess();
 
 	void testPagedVolumeChunkLocalAccess();
 	void testPagedVolumeChunkRandomAccess();
 
+	void testPagedVolumeLod();
+	void testPagedVolumeChunkDeduplication();
+	void testPagedVolumeBatchedAccess();
+
+	void testRawVolumeChunkViews();
+	void testPagedVolumeChunkViews();
+
 private:
 	int32_t testPagedVolumeChunkAccess(uint16_t localityMask);
 
@@ -75,10 +95,15 @@ private:
 	PolyVox::Region m_regExternal;
 	PolyVox::FilePager<int32_t>* m_pFilePager;
 	PolyVox::FilePager<int32_t>* m_pFilePagerHighMem;
+	PolyVox::FilePager<int32_t>* m_pFilePagerSmallChunks;
+	PolyVox::FilePager<int32_t>* m_pFilePagerFixedChunks;
 
 	PolyVox::RawVolume<int32_t>* m_pRawVolume;
+	PolyVox::RawVolume<int32_t, PolyVox::RawVolumeLayouts::Bricked>* m_pRawVolumeBricked;
 	PolyVox::PagedVolume<int32_t>* m_pPagedVolume;
 	PolyVox::PagedVolume<int32_t>* m_pPagedVolumeHighMem;
+	PolyVox::PagedVolume<int32_t>* m_pPagedVolumeSmallChunks;
+	PolyVox::PagedVolume<int32_t, m_uChunkSideLength>* m_pPagedVolumeFixedChunks;
 
 	PolyVox::PagedVolume<uint32_t>::Chunk* m_pPagedVolumeChunk;
 };